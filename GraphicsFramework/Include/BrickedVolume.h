@@ -0,0 +1,74 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <vector>
+#include "Interfaces/ITexture.h"
+#include "ThreadPool.h"
+
+namespace GFW
+{
+	/**
+	 * \brief Sparse storage for large 3D textures that are mostly empty or constant, like medical scans and simulation volumes.
+	 * The volume is split into bricks of 8^3 or 16^3 texels. Bricks in which every texel is the same are elided and only store an index into a palette of constant values,
+	 * the other bricks are stored in a pool of brick slots. An indirection table has one entry per brick: the pool slot of the brick, or CONSTANT_BRICK | palette index.
+	 * Texels of edge bricks that fall outside the volume repeat the nearest texel inside it. Memory scales with the amount of occupied bricks instead of the size of the volume.
+	 * The pool texture created by Upload() gives every slot a 1 texel apron, so it can be sampled with hardware trilinear filtering.
+	 * Updates that make bricks constant free their slot and palette entries can fall out of use, Compact() moves the remaining bricks together and drops them.
+	 */
+	class BrickedVolume
+	{
+	public:
+		static const uint32_t CONSTANT_BRICK = 0x80000000;	// Set in indirection entries of elided bricks, the other bits hold the palette index.
+
+		BrickedVolume(int brickSize = 8);
+
+		bool Create(int width, int height, int depth, TextureFormat format, TextureDataType type, const unsigned char* pixelData, ThreadPool* threadPool = nullptr);
+		void UpdateTexture(int x, int y, int z, int width, int height, int depth, const unsigned char* pixelData);
+		void Compact();
+
+		void Fetch(int x, int y, int z, float* result) const;
+		void Sample(float u, float v, float w, float* result) const;
+
+		bool Upload(ITexture* brickPool, ITexture* indirectionTable, ITexture* palette) const;
+
+		int GetBrickSize() const;
+		void GetBrickCount(int& x, int& y, int& z) const;
+		void GetPoolSize(int& x, int& y, int& z) const;
+		int GetPoolSlotSize() const;
+		int GetOccupiedBrickCount() const;
+		const std::vector<uint32_t>& GetIndirectionTable() const;
+		uint64_t GetDenseSize() const;
+		uint64_t GetBrickedSize() const;
+		float GetCompressionRatio() const;
+
+	private:
+		uint32_t& GetEntry(int brickX, int brickY, int brickZ);
+		const unsigned char* GetTexel(int x, int y, int z) const;
+		void GatherBrick(int brickX, int brickY, int brickZ, const unsigned char* pixelData, unsigned char* brick) const;
+		void ReadBrick(int brickX, int brickY, int brickZ, unsigned char* brick) const;
+		void PadBrick(int brickX, int brickY, int brickZ, unsigned char* brick) const;
+		bool IsConstant(const unsigned char* brick) const;
+		uint32_t GetPaletteIndex(const unsigned char* texel);
+		void ReleasePaletteIndex(uint32_t index);
+		void StoreBrick(int brickX, int brickY, int brickZ, const unsigned char* brick);
+
+		int m_brickSize;										// The amount of texels along each axis of a brick.
+		int m_brickShift;										// Log2 of the brick size.
+		int m_width;											// The width of the volume.
+		int m_height;											// The height of the volume.
+		int m_depth;											// The depth of the volume.
+		TextureFormat m_format;									// The format of the volume.
+		TextureDataType m_type;									// The type of the texel data.
+		int m_pixelSize;										// The size of a texel in bytes.
+		int m_bricksX;											// The amount of bricks along the width.
+		int m_bricksY;											// The amount of bricks along the height.
+		int m_bricksZ;											// The amount of bricks along the depth.
+		std::vector<uint32_t> m_indirection;					// The entry of every brick, x fastest.
+		std::vector<unsigned char> m_pool;						// Texel data of all slots, every slot holds a tightly packed brick.
+		std::vector<uint32_t> m_freeSlots;						// Slots in the pool that don't hold a brick.
+		std::vector<unsigned char> m_palette;					// The texel of every constant value.
+		std::map<std::vector<unsigned char>, uint32_t> m_paletteIndices;	// Palette index of every constant value.
+		std::vector<uint32_t> m_paletteUses;					// The amount of bricks using every palette entry.
+		int m_unusedPaletteEntries;								// The amount of palette entries no brick uses.
+	};
+}
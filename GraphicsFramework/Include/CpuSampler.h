@@ -0,0 +1,81 @@
+#pragma once
+#include <vector>
+#include "Interfaces/ISampler.h"
+#include "Interfaces/ITexture.h"
+#include "TextureSwizzle.h"
+
+namespace GFW
+{
+	/**
+	 * \brief 2D texture data for sampling on the CPU with CpuSampler. Every level stores 4 floats per texel, channels the format doesn't have read as 0
+	 * and a missing alpha channel reads as 1, like on the GPU. The texels can be stored in any TextureLayout, every level has offset tables for its columns
+	 * and rows that address all layouts the same way. The sampler still computes linear addresses directly, the tables are only used for the other layouts.
+	 * UpdateTexture() writes pixel data into a region of a level and Read() reads a level back as linear texels.
+	 */
+	class CpuTexture
+	{
+	public:
+		bool Create(int width, int height, bool generateMipmaps, TextureFormat format, TextureDataType type, const unsigned char* pixelData,
+			TextureLayout layout = TextureLayout::LINEAR);
+		bool UpdateTexture(int x, int y, int width, int height, int level, TextureFormat format, TextureDataType type, const unsigned char* pixelData);
+		void Read(int level, float* texels) const;
+
+		TextureLayout GetLayout() const;
+		int GetLevelCount() const;
+		int GetWidth(int level) const;
+		int GetHeight(int level) const;
+		const float* GetTexels(int level) const;
+		const size_t* GetColumnOffsets(int level) const;
+		const size_t* GetRowOffsets(int level) const;
+
+	private:
+		struct Level
+		{
+			int width;							// The width of the level.
+			int height;							// The height of the level.
+			std::vector<float> texels;			// RGBA texels of the level in the layout of the texture.
+			std::vector<size_t> columnOffsets;	// Offset in floats of every column in @texels.
+			std::vector<size_t> rowOffsets;		// Offset in floats of every row in @texels.
+		};
+
+		TextureLayout m_layout = TextureLayout::LINEAR;	// The memory layout of the texels of every level.
+		std::vector<Level> m_levels;					// All mipmap levels, starting with the base level.
+	};
+
+	/**
+	 * \brief Sampler that filters CpuTexture data on the CPU exactly the way the sampler state describes, for CPU rendering, baking and validating GPU output.
+	 * Samples are processed in batches, 8 at a time with AVX2 when the CPU supports it and 4 at a time with SSE2 otherwise. Every channel of the 4 samples is kept in its own vector, so addressing, border handling and
+	 * filtering cover the whole group and only the texel reads are per sample. The filters and edge sampling operation are template parameters of the batch
+	 * functions, so the inner loops don't branch on the sampler state.
+	 */
+	class CpuSampler : public ISampler
+	{
+	public:
+		CpuSampler();
+
+		void Create(SamplerFilter minFilter, SamplerFilter magFilter, AnisotropicFilter anisotropy, EdgeSampling edgeSampling, const Vec4& borderColor) override;
+		void SetMinifactionFilter(SamplerFilter filter) override;
+		SamplerFilter GetMinifactionFilter() override;
+		void SetMagnificationFilter(SamplerFilter filter) override;
+		SamplerFilter GetMagnificationFilter() override;
+		void SetAnisotropicFilter(AnisotropicFilter anisotropy) override;
+		AnisotropicFilter GetAnisotropicFilter() override;
+		void SetEdgeSamplingOperation(EdgeSampling edgeSampling) override;
+		EdgeSampling GetEdgeSamplingOperation() override;
+		void SetBorderColor(const Vec4& color) override;
+		Vec4 GetBorderColor() override;
+
+		void Sample(const CpuTexture& texture, const float* u, const float* v, const float* lod, int count, Vec4* result) const;
+		void SampleGradient(const CpuTexture& texture, const float* u, const float* v, const Vec4* gradients, int count, Vec4* result) const;
+
+	private:
+		void SampleBatch(const CpuTexture& texture, const float* u, const float* v, const float* lod, const Vec4* gradients, int count, Vec4* result) const;
+		void SampleBatchAvx2(const CpuTexture& texture, const float* u, const float* v, const float* lod, const Vec4* gradients, int count, Vec4* result) const;
+
+		SamplerFilter m_minFilter;			// The minification filter.
+		SamplerFilter m_magFilter;			// The magnification filter.
+		AnisotropicFilter m_anisotropy;		// The maximum amount of anisotropic samples.
+		EdgeSampling m_edgeSampling;		// The edge sampling operation.
+		Vec4 m_borderColor;					// The color of texels outside the texture with CLAMP_TO_BORDER.
+	};
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include "Interfaces/ITexture.h"
+#include "Math.h"
+#include "Structures/SphericalHarmonics.h"
+#include "ThreadPool.h"
+
+namespace GFW
+{
+	/**
+	 * \brief The faces of a cubemap, as passed to ITexture::CreateCube().
+	 */
+	struct CubemapFaces
+	{
+		const unsigned char* faces[6];	// Tightly packed pixel data of every face.
+		int size;						// The amount of texels on each side of the faces.
+		TextureFormat format;			// The format of the faces. The first 3 channels are used as color, single channel formats as grey.
+		TextureDataType type;			// The type of the pixel data. Unsigned bytes and shorts are normalized.
+	};
+
+	/**
+	 * \brief Helper functions to process cubemaps on the CPU, like prefiltering environment maps for image based lighting.
+	 * Faces are ordered +X, -X, +Y, -Y, +Z, -Z and oriented like OpenGL cubemaps, texel rows go from top to bottom.
+	 * Face coordinates u and v run from -1 to 1 across a face.
+	 */
+	namespace CubemapFilter
+	{
+		Math::Vec3 GetDirection(int face, float u, float v);
+		Math::Vec3 GetTexelDirection(int face, int x, int y, int size);
+		void GetFaceCoordinates(const Math::Vec3& direction, int& face, float& u, float& v);
+		float GetTexelSolidAngle(int x, int y, int size);
+
+		bool PrefilterSpecular(const float* const source[6], int size, int levels, TextureDataType type, unsigned char* const* destination, int sampleCount = 64,
+			ThreadPool* threadPool = nullptr);
+		bool CreatePrefilteredCube(ITexture* texture, const float* const source[6], int size, int levels, TextureDataType type, int sampleCount = 64,
+			ThreadPool* threadPool = nullptr);
+
+		bool ProjectIrradiance(const CubemapFaces& cubemap, int order, SphericalHarmonics& irradiance, ThreadPool* threadPool = nullptr);
+		bool ProjectIrradiance(const CubemapFaces* cubemaps, int count, int order, SphericalHarmonics* irradiance, ThreadPool* threadPool = nullptr);
+		Math::Vec3 EvaluateSphericalHarmonics(const SphericalHarmonics& harmonics, const Math::Vec3& direction);
+	}
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Interfaces/ITexture.h"
+#include "Structures/TextureDescription.h"
+#include "MappedFile.h"
+
+namespace GFW
+{
+	/**
+	 * \brief Enum with the texture file formats DdsKtxFile can open.
+	 */
+	enum class DdsKtxFileType
+	{
+		NONE/*No file is opened.*/,
+		DDS/*DirectDraw Surface, including the DX10 extended header.*/,
+		KTX/*Khronos Texture version 1.*/
+	};
+
+	/**
+	 * \brief DDS and KTX texture files, the formats most asset pipelines use to ship textures that are already compressed into GPU blocks.
+	 * Files are memory mapped and the pixel formats are mapped onto TextureFormat, so every slice is passed to the graphics API straight from the file
+	 * without decoding or re-encoding. Only formats that TextureFormat can represent without swizzling are supported, BGRA files for example are rejected.
+	 */
+	class DdsKtxFile
+	{
+	public:
+		DdsKtxFile();
+
+		bool Open(const char* file);
+		void Close();
+
+		bool IsOpen() const;
+		DdsKtxFileType GetFileType() const;
+		const TextureDescription& GetDescription() const;
+		unsigned char* GetSliceData(int level, int slice) const;
+		uint64_t GetSliceSize(int level) const;
+		bool Upload(ITexture* texture, bool mipmaps) const;
+
+	private:
+		bool ParseDds();
+		bool ParseKtx();
+		bool IsValidDescription() const;
+
+		MappedFile m_file;						// The mapped texture file.
+		DdsKtxFileType m_fileType;				// The format of the opened file.
+		TextureDescription m_description;		// Description of the texture in the file.
+		std::vector<uint64_t> m_sliceOffsets;	// Offset of every slice from the start of the file, indexed by level * layers * faces + slice.
+	};
+}
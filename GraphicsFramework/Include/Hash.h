@@ -0,0 +1,21 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace GFW
+{
+	/**
+	 * \brief 64 bit FNV-1a hash of a block of memory, used to key cached sources and programs and to checksum cache files.
+	 * \param data The bytes to hash.
+	 * \param size The amount of bytes to hash.
+	 * \param hash The hash of the bytes before @data, to hash several blocks as one.
+	 * \return The hash of @data.
+	 */
+	inline uint64_t HashFnv1a64(const void* data, size_t size, uint64_t hash = 14695981039346656037ull)
+	{
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		for(size_t i = 0; i < size; ++i)
+			hash = (hash ^ bytes[i]) * 1099511628211ull;
+		return hash;
+	}
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <vector>
+#include "Interfaces/ITexture.h"
+
+namespace GFW
+{
+	/**
+	 * \brief Interface for decoding image files like PNG, JPG and BMP into raw pixel data.
+	 * Implementations are called from worker threads and must be safe to use from multiple threads at the same time.
+	 */
+	class IImageDecoder
+	{
+	public:
+		virtual ~IImageDecoder() = default;
+
+		/**
+		 * \brief Interface to decode an image file into tightly packed pixel data, starting with the top row.
+		 * \param file The image file to decode.
+		 * \param width Output for the width of the image.
+		 * \param height Output for the height of the image.
+		 * \param format Output for the texture format that best matches the image.
+		 * \param type Output for the type of @pixelData.
+		 * \param pixelData Output for the decoded pixel data.
+		 * \return False if the file couldn't be read or decoded.
+		 */
+		virtual bool Decode(const char* file, int& width, int& height, TextureFormat& format, TextureDataType& type, std::vector<unsigned char>& pixelData) = 0;
+	};
+}
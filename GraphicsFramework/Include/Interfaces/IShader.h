@@ -3,6 +3,9 @@
 #include "Math.h"
 #include "Structures/ShaderAttribute.h"
 #include "Structures/ShaderParameter.h"
+#include "Structures/ShaderParameterHandle.h"
+#include "ShaderParameterBatch.h"
+#include "ShaderReflection.h"
 
 namespace GFW
 {
@@ -13,7 +16,10 @@ namespace GFW
 	using namespace Math;
 
 	/**
-	 * \brief Interface for API specific shader class
+	 * \brief Interface for API specific shader class.
+	 * Parameters are set through handles, the overloads taking a name are wrappers around GetParameterHandle(). Implementations override the handle
+	 * overloads and should add "using IShader::SetShaderParameter;" and "using IShader::SetShaderParameterArray;" so the name overloads aren't hidden.
+	 * Implementations are expected to compute the reflection once at link time, ShaderReflection stores it and resolves names to handles.
 	 */
 	class IShader
 	{
@@ -32,205 +38,1063 @@ namespace GFW
 		 */
 		virtual void CreateFromFile(const char* file) = 0;
 
+		/**
+		 * \brief Interface to check if the last Create(), CreateFromFile() or CreateFromBinary() call produced a usable program.
+		 * \return False if the program failed to compile or link, or wasn't created yet.
+		 */
+		virtual bool IsValid() = 0;
+
+		/**
+		 * \brief Interface to get the linked program as a binary, so ShaderBinaryCache can store it. The binary has to contain everything
+		 * CreateFromBinary() needs, like the binary format of the graphics API.
+		 * \param binary Output for the program binary.
+		 * \return False if the program isn't linked or the backend doesn't support program binaries.
+		 */
+		virtual bool GetProgramBinary(vector<unsigned char>& /*binary*/)
+		{
+			return false;
+		}
+
+		/**
+		 * \brief Interface to initialize a shader from a binary returned by GetProgramBinary() and the reflection stored with it,
+		 * so the reflection doesn't have to be queried again.
+		 * \param binary The program binary.
+		 * \param size The size of @binary in bytes.
+		 * \param attributes The attributes of the program when the binary was stored.
+		 * \param parameters The parameters of the program when the binary was stored.
+		 * \return False if the binary was rejected, for example after a driver update, or the backend doesn't support program binaries.
+		 */
+		virtual bool CreateFromBinary(const unsigned char* /*binary*/, size_t /*size*/, const vector<ShaderAttribute>& /*attributes*/,
+			const vector<ShaderParameter>& /*parameters*/)
+		{
+			return false;
+		}
+
 		/**
 		 * \brief Interface for requesting the shader attributes of this shader program.
-		 * \return A vector with information about all shader attributes for this shader program.
+		 * \return A vector with information about all shader attributes for this shader program, computed once when the program is linked.
 		 */
-		virtual vector<ShaderAttribute> GetShaderAttributes() = 0;
+		virtual const vector<ShaderAttribute>& GetShaderAttributes() = 0;
 
 		/**
 		 * \brief Interface for requesting information about all shader parameters in this shader program.
-		 * \return A vector with information about all shader parameters for this shader program.
+		 * \return The names, types and locations of all shader parameters for this shader program, computed once when the program is linked.
+		 * The index of a parameter in the reflection is the index of its ShaderParameterHandle.
 		 */
-		virtual vector<ShaderParameter> GetShaderParameters() = 0;
+		virtual const ShaderReflection& GetShaderReflection() = 0;
 
 		/**
-		 * \brief Interface to request information about a specific shader parameter in this shader program by name.
+		 * \brief Interface to resolve a shader parameter name to a handle. Resolve once and pass the handle to SetShaderParameter()
+		 * instead of the name to avoid string lookups on every call.
 		 * \param name The name of the shader parameter.
-		 * \return Information about the shader parameters with name @name.
+		 * \return The handle of the shader parameter, invalid if the shader program has no parameter named @name.
+		 */
+		virtual ShaderParameterHandle GetParameterHandle(const string& name) = 0;
+
+		/**
+		 * \brief Interface to resolve a hashed shader parameter name to a handle, so literal names can be hashed at compile time,
+		 * for example GetParameterHandle(ShaderParameterName("color")).
+		 * \param name The hashed name of the shader parameter.
+		 * \return The handle of the shader parameter, invalid if the shader program has no parameter with the hash of @name.
 		 */
-		virtual ShaderParameter GetShaderParameter(const string& name) = 0;
+		virtual ShaderParameterHandle GetParameterHandle(ShaderParameterName name) = 0;
 
 		/**
 		 * \brief Interface to set bool shader parameter.
-		 * \param name The name of the shader parameter.
+		 * \param handle The handle of the shader parameter, see GetParameterHandle().
 		 * \param x The value to set the shader parameter to.
 		 */
-		virtual void SetShaderParameter(const string& name, bool x) = 0;
+		virtual void SetShaderParameter(ShaderParameterHandle handle, bool x) = 0;
 
 		/**
 		* \brief Interface to set int shader parameter.
-		* \param name The name of the shader parameter.
+		* \param handle The handle of the shader parameter, see GetParameterHandle().
 		* \param x The value to set the shader parameter to.
 		*/
-		virtual void SetShaderParameter(const string& name, int x) = 0;
+		virtual void SetShaderParameter(ShaderParameterHandle handle, int x) = 0;
 
 		/**
 		* \brief Interface to set unsigned int shader parameter.
-		* \param name The name of the shader parameter.
+		* \param handle The handle of the shader parameter, see GetParameterHandle().
 		* \param x The value to set the shader parameter to.
 		*/
-		virtual void SetShaderParameter(const string& name, unsigned x) = 0;
+		virtual void SetShaderParameter(ShaderParameterHandle handle, unsigned x) = 0;
 
 		/**
 		* \brief Interface to set float shader parameter.
-		* \param name The name of the shader parameter.
+		* \param handle The handle of the shader parameter, see GetParameterHandle().
 		* \param x The value to set the shader parameter to.
 		*/
-		virtual void SetShaderParameter(const string& name, float x) = 0;
+		virtual void SetShaderParameter(ShaderParameterHandle handle, float x) = 0;
 
 		/**
 		* \brief Interface to set double shader parameter.
-		* \param name The name of the shader parameter.
+		* \param handle The handle of the shader parameter, see GetParameterHandle().
 		* \param x The value to set the shader parameter to.
 		*/
-		virtual void SetShaderParameter(const string& name, double x) = 0;
+		virtual void SetShaderParameter(ShaderParameterHandle handle, double x) = 0;
 
 		/**
 		* \brief Interface to set 2 component bool vector shader parameter.
-		* \param name The name of the shader parameter.
+		* \param handle The handle of the shader parameter, see GetParameterHandle().
 		* \param x The value to set the shader parameter to.
 		*/
-		virtual void SetShaderParameter(const string& name, const BVec2& x) = 0;
+		virtual void SetShaderParameter(ShaderParameterHandle handle, const BVec2& x) = 0;
 
 		/**
 		* \brief Interface to set 2 component int vector shader parameter.
-		* \param name The name of the shader parameter.
+		* \param handle The handle of the shader parameter, see GetParameterHandle().
 		* \param x The value to set the shader parameter to.
 		*/
-		virtual void SetShaderParameter(const string& name, const IVec2& x) = 0;
+		virtual void SetShaderParameter(ShaderParameterHandle handle, const IVec2& x) = 0;
 
 		/**
 		* \brief Interface to set 2 component unsigned int vector shader parameter.
-		* \param name The name of the shader parameter.
+		* \param handle The handle of the shader parameter, see GetParameterHandle().
 		* \param x The value to set the shader parameter to.
 		*/
-		virtual void SetShaderParameter(const string& name, const UVec2& x) = 0;
+		virtual void SetShaderParameter(ShaderParameterHandle handle, const UVec2& x) = 0;
 
 		/**
 		* \brief Interface to set 2 component float vector shader parameter.
-		* \param name The name of the shader parameter.
+		* \param handle The handle of the shader parameter, see GetParameterHandle().
 		* \param x The value to set the shader parameter to.
 		*/
-		virtual void SetShaderParameter(const string& name, const Vec2& x) = 0;
+		virtual void SetShaderParameter(ShaderParameterHandle handle, const Vec2& x) = 0;
 
 		/**
 		* \brief Interface to set 2 component double vector shader parameter.
-		* \param name The name of the shader parameter.
+		* \param handle The handle of the shader parameter, see GetParameterHandle().
 		* \param x The value to set the shader parameter to.
 		*/
-		virtual void SetShaderParameter(const string& name, const DVec2& x) = 0;
+		virtual void SetShaderParameter(ShaderParameterHandle handle, const DVec2& x) = 0;
 
 		/**
 		* \brief Interface to set 3 component bool vector shader parameter.
-		* \param name The name of the shader parameter.
+		* \param handle The handle of the shader parameter, see GetParameterHandle().
 		* \param x The value to set the shader parameter to.
 		*/
-		virtual void SetShaderParameter(const string& name, const BVec3& x) = 0;
+		virtual void SetShaderParameter(ShaderParameterHandle handle, const BVec3& x) = 0;
 
 		/**
 		* \brief Interface to set 3 component int vector shader parameter.
-		* \param name The name of the shader parameter.
+		* \param handle The handle of the shader parameter, see GetParameterHandle().
 		* \param x The value to set the shader parameter to.
 		*/
-		virtual void SetShaderParameter(const string& name, const IVec3& x) = 0;
+		virtual void SetShaderParameter(ShaderParameterHandle handle, const IVec3& x) = 0;
 
 		/**
 		* \brief Interface to set 3 component unsigned int vector shader parameter.
-		* \param name The name of the shader parameter.
+		* \param handle The handle of the shader parameter, see GetParameterHandle().
 		* \param x The value to set the shader parameter to.
 		*/
-		virtual void SetShaderParameter(const string& name, const UVec3& x) = 0;
+		virtual void SetShaderParameter(ShaderParameterHandle handle, const UVec3& x) = 0;
 
 		/**
 		* \brief Interface to set 3 component float vector shader parameter.
-		* \param name The name of the shader parameter.
+		* \param handle The handle of the shader parameter, see GetParameterHandle().
 		* \param x The value to set the shader parameter to.
 		*/
-		virtual void SetShaderParameter(const string& name, const Vec3& x) = 0;
+		virtual void SetShaderParameter(ShaderParameterHandle handle, const Vec3& x) = 0;
 
 		/**
 		* \brief Interface to set 3 component double vector shader parameter.
-		* \param name The name of the shader parameter.
+		* \param handle The handle of the shader parameter, see GetParameterHandle().
 		* \param x The value to set the shader parameter to.
 		*/
-		virtual void SetShaderParameter(const string& name, const DVec3& x) = 0;
+		virtual void SetShaderParameter(ShaderParameterHandle handle, const DVec3& x) = 0;
 
 		/**
 		* \brief Interface to set 4 component bool vector shader parameter.
-		* \param name The name of the shader parameter.
+		* \param handle The handle of the shader parameter, see GetParameterHandle().
 		* \param x The value to set the shader parameter to.
 		*/
-		virtual void SetShaderParameter(const string& name, const BVec4& x) = 0;
+		virtual void SetShaderParameter(ShaderParameterHandle handle, const BVec4& x) = 0;
 
 		/**
 		* \brief Interface to set 4 component int vector shader parameter.
-		* \param name The name of the shader parameter.
+		* \param handle The handle of the shader parameter, see GetParameterHandle().
 		* \param x The value to set the shader parameter to.
 		*/
-		virtual void SetShaderParameter(const string& name, const IVec4& x) = 0;
+		virtual void SetShaderParameter(ShaderParameterHandle handle, const IVec4& x) = 0;
 
 		/**
 		* \brief Interface to set 4 component unsigned int vector shader parameter.
-		* \param name The name of the shader parameter.
+		* \param handle The handle of the shader parameter, see GetParameterHandle().
 		* \param x The value to set the shader parameter to.
 		*/
-		virtual void SetShaderParameter(const string& name, const UVec4& x) = 0;
+		virtual void SetShaderParameter(ShaderParameterHandle handle, const UVec4& x) = 0;
 
 		/**
 		* \brief Interface to set 4 component float vector shader parameter.
-		* \param name The name of the shader parameter.
+		* \param handle The handle of the shader parameter, see GetParameterHandle().
 		* \param x The value to set the shader parameter to.
 		*/
-		virtual void SetShaderParameter(const string& name, const Vec4& x) = 0;
+		virtual void SetShaderParameter(ShaderParameterHandle handle, const Vec4& x) = 0;
 
 		/**
 		* \brief Interface to set 4 component double vector shader parameter.
-		* \param name The name of the shader parameter.
+		* \param handle The handle of the shader parameter, see GetParameterHandle().
 		* \param x The value to set the shader parameter to.
 		*/
-		virtual void SetShaderParameter(const string& name, const DVec4& x) = 0;
+		virtual void SetShaderParameter(ShaderParameterHandle handle, const DVec4& x) = 0;
 
 		/**
 		* \brief Interface to set 2x2 matrix shader parameter.
-		* \param name The name of the shader parameter.
+		* \param handle The handle of the shader parameter, see GetParameterHandle().
 		* \param x The value to set the shader parameter to.
 		*/
-		virtual void SetShaderParameter(const string& name, const Mat2& x) = 0;
+		virtual void SetShaderParameter(ShaderParameterHandle handle, const Mat2& x) = 0;
 
 		/**
 		* \brief Interface to set 3x3 matrix shader parameter.
-		* \param name The name of the shader parameter.
+		* \param handle The handle of the shader parameter, see GetParameterHandle().
 		* \param x The value to set the shader parameter to.
 		*/
-		virtual void SetShaderParameter(const string& name, const Mat3& x) = 0;
+		virtual void SetShaderParameter(ShaderParameterHandle handle, const Mat3& x) = 0;
 
 		/**
 		* \brief Interface to set 4x4 matrix shader parameter.
-		* \param name The name of the shader parameter.
+		* \param handle The handle of the shader parameter, see GetParameterHandle().
 		* \param x The value to set the shader parameter to.
 		*/
-		virtual void SetShaderParameter(const string& name, const Mat4& x) = 0;
+		virtual void SetShaderParameter(ShaderParameterHandle handle, const Mat4& x) = 0;
 
 		/**
 		* \brief Interface to set texture shader parameter.
-		* \param name The name of the shader parameter.
+		* \param handle The handle of the shader parameter, see GetParameterHandle().
 		* \param x The texture to bind to the sampler location.
 		*/
-		virtual void SetShaderParameter(const string& name, const ITexture* x) = 0;
+		virtual void SetShaderParameter(ShaderParameterHandle handle, const ITexture* x) = 0;
 
 		/**
 		* \brief Interface to set sampler shader parameter.
-		* \param name The name of the shader parameter.
+		* \param handle The handle of the shader parameter, see GetParameterHandle().
 		* \param x The sampler to bind to the sampler location.
 		*/
-		virtual void SetShaderParameter(const string& name, const ISampler* x) = 0;
+		virtual void SetShaderParameter(ShaderParameterHandle handle, const ISampler* x) = 0;
 
 		/**
 		* \brief Interface to set buffer shader parameter.
+		* \param handle The handle of the shader parameter, see GetParameterHandle().
+		* \param x The buffer to bind to the buffer binding.
+		*/
+		virtual void SetShaderParameter(ShaderParameterHandle handle, const IBuffer* x) = 0;
+
+		/**
+		 * \brief Interface to set elements of a bool array shader parameter.
+		 * \param handle The handle of the shader parameter, see GetParameterHandle().
+		 * \param x The values to set the elements to.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		virtual void SetShaderParameterArray(ShaderParameterHandle handle, const bool* x, int count, int firstElement = 0) = 0;
+
+		/**
+		 * \brief Interface to set elements of a int array shader parameter.
+		 * \param handle The handle of the shader parameter, see GetParameterHandle().
+		 * \param x The values to set the elements to.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		virtual void SetShaderParameterArray(ShaderParameterHandle handle, const int* x, int count, int firstElement = 0) = 0;
+
+		/**
+		 * \brief Interface to set elements of a unsigned int array shader parameter.
+		 * \param handle The handle of the shader parameter, see GetParameterHandle().
+		 * \param x The values to set the elements to.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		virtual void SetShaderParameterArray(ShaderParameterHandle handle, const unsigned* x, int count, int firstElement = 0) = 0;
+
+		/**
+		 * \brief Interface to set elements of a float array shader parameter.
+		 * \param handle The handle of the shader parameter, see GetParameterHandle().
+		 * \param x The values to set the elements to.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		virtual void SetShaderParameterArray(ShaderParameterHandle handle, const float* x, int count, int firstElement = 0) = 0;
+
+		/**
+		 * \brief Interface to set elements of a double array shader parameter.
+		 * \param handle The handle of the shader parameter, see GetParameterHandle().
+		 * \param x The values to set the elements to.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		virtual void SetShaderParameterArray(ShaderParameterHandle handle, const double* x, int count, int firstElement = 0) = 0;
+
+		/**
+		 * \brief Interface to set elements of a 2 component bool vector array shader parameter.
+		 * \param handle The handle of the shader parameter, see GetParameterHandle().
+		 * \param x The values to set the elements to.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		virtual void SetShaderParameterArray(ShaderParameterHandle handle, const BVec2* x, int count, int firstElement = 0) = 0;
+
+		/**
+		 * \brief Interface to set elements of a 2 component int vector array shader parameter.
+		 * \param handle The handle of the shader parameter, see GetParameterHandle().
+		 * \param x The values to set the elements to.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		virtual void SetShaderParameterArray(ShaderParameterHandle handle, const IVec2* x, int count, int firstElement = 0) = 0;
+
+		/**
+		 * \brief Interface to set elements of a 2 component unsigned int vector array shader parameter.
+		 * \param handle The handle of the shader parameter, see GetParameterHandle().
+		 * \param x The values to set the elements to.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		virtual void SetShaderParameterArray(ShaderParameterHandle handle, const UVec2* x, int count, int firstElement = 0) = 0;
+
+		/**
+		 * \brief Interface to set elements of a 2 component float vector array shader parameter.
+		 * \param handle The handle of the shader parameter, see GetParameterHandle().
+		 * \param x The values to set the elements to.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		virtual void SetShaderParameterArray(ShaderParameterHandle handle, const Vec2* x, int count, int firstElement = 0) = 0;
+
+		/**
+		 * \brief Interface to set elements of a 2 component double vector array shader parameter.
+		 * \param handle The handle of the shader parameter, see GetParameterHandle().
+		 * \param x The values to set the elements to.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		virtual void SetShaderParameterArray(ShaderParameterHandle handle, const DVec2* x, int count, int firstElement = 0) = 0;
+
+		/**
+		 * \brief Interface to set elements of a 3 component bool vector array shader parameter.
+		 * \param handle The handle of the shader parameter, see GetParameterHandle().
+		 * \param x The values to set the elements to.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		virtual void SetShaderParameterArray(ShaderParameterHandle handle, const BVec3* x, int count, int firstElement = 0) = 0;
+
+		/**
+		 * \brief Interface to set elements of a 3 component int vector array shader parameter.
+		 * \param handle The handle of the shader parameter, see GetParameterHandle().
+		 * \param x The values to set the elements to.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		virtual void SetShaderParameterArray(ShaderParameterHandle handle, const IVec3* x, int count, int firstElement = 0) = 0;
+
+		/**
+		 * \brief Interface to set elements of a 3 component unsigned int vector array shader parameter.
+		 * \param handle The handle of the shader parameter, see GetParameterHandle().
+		 * \param x The values to set the elements to.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		virtual void SetShaderParameterArray(ShaderParameterHandle handle, const UVec3* x, int count, int firstElement = 0) = 0;
+
+		/**
+		 * \brief Interface to set elements of a 3 component float vector array shader parameter.
+		 * \param handle The handle of the shader parameter, see GetParameterHandle().
+		 * \param x The values to set the elements to.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		virtual void SetShaderParameterArray(ShaderParameterHandle handle, const Vec3* x, int count, int firstElement = 0) = 0;
+
+		/**
+		 * \brief Interface to set elements of a 3 component double vector array shader parameter.
+		 * \param handle The handle of the shader parameter, see GetParameterHandle().
+		 * \param x The values to set the elements to.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		virtual void SetShaderParameterArray(ShaderParameterHandle handle, const DVec3* x, int count, int firstElement = 0) = 0;
+
+		/**
+		 * \brief Interface to set elements of a 4 component bool vector array shader parameter.
+		 * \param handle The handle of the shader parameter, see GetParameterHandle().
+		 * \param x The values to set the elements to.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		virtual void SetShaderParameterArray(ShaderParameterHandle handle, const BVec4* x, int count, int firstElement = 0) = 0;
+
+		/**
+		 * \brief Interface to set elements of a 4 component int vector array shader parameter.
+		 * \param handle The handle of the shader parameter, see GetParameterHandle().
+		 * \param x The values to set the elements to.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		virtual void SetShaderParameterArray(ShaderParameterHandle handle, const IVec4* x, int count, int firstElement = 0) = 0;
+
+		/**
+		 * \brief Interface to set elements of a 4 component unsigned int vector array shader parameter.
+		 * \param handle The handle of the shader parameter, see GetParameterHandle().
+		 * \param x The values to set the elements to.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		virtual void SetShaderParameterArray(ShaderParameterHandle handle, const UVec4* x, int count, int firstElement = 0) = 0;
+
+		/**
+		 * \brief Interface to set elements of a 4 component float vector array shader parameter.
+		 * \param handle The handle of the shader parameter, see GetParameterHandle().
+		 * \param x The values to set the elements to.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		virtual void SetShaderParameterArray(ShaderParameterHandle handle, const Vec4* x, int count, int firstElement = 0) = 0;
+
+		/**
+		 * \brief Interface to set elements of a 4 component double vector array shader parameter.
+		 * \param handle The handle of the shader parameter, see GetParameterHandle().
+		 * \param x The values to set the elements to.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		virtual void SetShaderParameterArray(ShaderParameterHandle handle, const DVec4* x, int count, int firstElement = 0) = 0;
+
+		/**
+		 * \brief Interface to set elements of a 2x2 matrix array shader parameter.
+		 * \param handle The handle of the shader parameter, see GetParameterHandle().
+		 * \param x The values to set the elements to.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		virtual void SetShaderParameterArray(ShaderParameterHandle handle, const Mat2* x, int count, int firstElement = 0) = 0;
+
+		/**
+		 * \brief Interface to set elements of a 3x3 matrix array shader parameter.
+		 * \param handle The handle of the shader parameter, see GetParameterHandle().
+		 * \param x The values to set the elements to.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		virtual void SetShaderParameterArray(ShaderParameterHandle handle, const Mat3* x, int count, int firstElement = 0) = 0;
+
+		/**
+		 * \brief Interface to set elements of a 4x4 matrix array shader parameter.
+		 * \param handle The handle of the shader parameter, see GetParameterHandle().
+		 * \param x The values to set the elements to.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		virtual void SetShaderParameterArray(ShaderParameterHandle handle, const Mat4* x, int count, int firstElement = 0) = 0;
+
+		/**
+		 * \brief Interface to set elements of a texture array shader parameter.
+		 * \param handle The handle of the shader parameter, see GetParameterHandle().
+		 * \param x The textures to bind to the sampler locations.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		virtual void SetShaderParameterArray(ShaderParameterHandle handle, const ITexture* const* x, int count, int firstElement = 0) = 0;
+
+		/**
+		 * \brief Interface to set elements of a sampler array shader parameter.
+		 * \param handle The handle of the shader parameter, see GetParameterHandle().
+		 * \param x The samplers to bind to the sampler locations.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		virtual void SetShaderParameterArray(ShaderParameterHandle handle, const ISampler* const* x, int count, int firstElement = 0) = 0;
+
+		/**
+		 * \brief Interface to set elements of a buffer array shader parameter.
+		 * \param handle The handle of the shader parameter, see GetParameterHandle().
+		 * \param x The buffers to bind to the buffer bindings.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		virtual void SetShaderParameterArray(ShaderParameterHandle handle, const IBuffer* const* x, int count, int firstElement = 0) = 0;
+
+		/**
+		 * \brief Interface to set many parameters at once, so the per-call overhead is paid once per batch. Backends can override this
+		 * to walk the entries directly, the default implementation forwards every entry to SetShaderParameterArray().
+		 * \param batch The parameters to set.
+		 */
+		virtual void SetShaderParameters(const ShaderParameterBatch& batch)
+		{
+			batch.Apply(this);
+		}
+
+		/**
+		 * \brief Set bool shader parameter by name, resolving the handle on every call.
+		 * \param name The name of the shader parameter.
+		 * \param x The value to set the shader parameter to.
+		 */
+		void SetShaderParameter(const string& name, bool x)
+		{
+			SetShaderParameter(GetParameterHandle(name), x);
+		}
+
+		/**
+		* \brief Set int shader parameter by name, resolving the handle on every call.
+		* \param name The name of the shader parameter.
+		* \param x The value to set the shader parameter to.
+		*/
+		void SetShaderParameter(const string& name, int x)
+		{
+			SetShaderParameter(GetParameterHandle(name), x);
+		}
+
+		/**
+		* \brief Set unsigned int shader parameter by name, resolving the handle on every call.
+		* \param name The name of the shader parameter.
+		* \param x The value to set the shader parameter to.
+		*/
+		void SetShaderParameter(const string& name, unsigned x)
+		{
+			SetShaderParameter(GetParameterHandle(name), x);
+		}
+
+		/**
+		* \brief Set float shader parameter by name, resolving the handle on every call.
+		* \param name The name of the shader parameter.
+		* \param x The value to set the shader parameter to.
+		*/
+		void SetShaderParameter(const string& name, float x)
+		{
+			SetShaderParameter(GetParameterHandle(name), x);
+		}
+
+		/**
+		* \brief Set double shader parameter by name, resolving the handle on every call.
+		* \param name The name of the shader parameter.
+		* \param x The value to set the shader parameter to.
+		*/
+		void SetShaderParameter(const string& name, double x)
+		{
+			SetShaderParameter(GetParameterHandle(name), x);
+		}
+
+		/**
+		* \brief Set 2 component bool vector shader parameter by name, resolving the handle on every call.
+		* \param name The name of the shader parameter.
+		* \param x The value to set the shader parameter to.
+		*/
+		void SetShaderParameter(const string& name, const BVec2& x)
+		{
+			SetShaderParameter(GetParameterHandle(name), x);
+		}
+
+		/**
+		* \brief Set 2 component int vector shader parameter by name, resolving the handle on every call.
+		* \param name The name of the shader parameter.
+		* \param x The value to set the shader parameter to.
+		*/
+		void SetShaderParameter(const string& name, const IVec2& x)
+		{
+			SetShaderParameter(GetParameterHandle(name), x);
+		}
+
+		/**
+		* \brief Set 2 component unsigned int vector shader parameter by name, resolving the handle on every call.
+		* \param name The name of the shader parameter.
+		* \param x The value to set the shader parameter to.
+		*/
+		void SetShaderParameter(const string& name, const UVec2& x)
+		{
+			SetShaderParameter(GetParameterHandle(name), x);
+		}
+
+		/**
+		* \brief Set 2 component float vector shader parameter by name, resolving the handle on every call.
+		* \param name The name of the shader parameter.
+		* \param x The value to set the shader parameter to.
+		*/
+		void SetShaderParameter(const string& name, const Vec2& x)
+		{
+			SetShaderParameter(GetParameterHandle(name), x);
+		}
+
+		/**
+		* \brief Set 2 component double vector shader parameter by name, resolving the handle on every call.
+		* \param name The name of the shader parameter.
+		* \param x The value to set the shader parameter to.
+		*/
+		void SetShaderParameter(const string& name, const DVec2& x)
+		{
+			SetShaderParameter(GetParameterHandle(name), x);
+		}
+
+		/**
+		* \brief Set 3 component bool vector shader parameter by name, resolving the handle on every call.
+		* \param name The name of the shader parameter.
+		* \param x The value to set the shader parameter to.
+		*/
+		void SetShaderParameter(const string& name, const BVec3& x)
+		{
+			SetShaderParameter(GetParameterHandle(name), x);
+		}
+
+		/**
+		* \brief Set 3 component int vector shader parameter by name, resolving the handle on every call.
+		* \param name The name of the shader parameter.
+		* \param x The value to set the shader parameter to.
+		*/
+		void SetShaderParameter(const string& name, const IVec3& x)
+		{
+			SetShaderParameter(GetParameterHandle(name), x);
+		}
+
+		/**
+		* \brief Set 3 component unsigned int vector shader parameter by name, resolving the handle on every call.
+		* \param name The name of the shader parameter.
+		* \param x The value to set the shader parameter to.
+		*/
+		void SetShaderParameter(const string& name, const UVec3& x)
+		{
+			SetShaderParameter(GetParameterHandle(name), x);
+		}
+
+		/**
+		* \brief Set 3 component float vector shader parameter by name, resolving the handle on every call.
+		* \param name The name of the shader parameter.
+		* \param x The value to set the shader parameter to.
+		*/
+		void SetShaderParameter(const string& name, const Vec3& x)
+		{
+			SetShaderParameter(GetParameterHandle(name), x);
+		}
+
+		/**
+		* \brief Set 3 component double vector shader parameter by name, resolving the handle on every call.
+		* \param name The name of the shader parameter.
+		* \param x The value to set the shader parameter to.
+		*/
+		void SetShaderParameter(const string& name, const DVec3& x)
+		{
+			SetShaderParameter(GetParameterHandle(name), x);
+		}
+
+		/**
+		* \brief Set 4 component bool vector shader parameter by name, resolving the handle on every call.
+		* \param name The name of the shader parameter.
+		* \param x The value to set the shader parameter to.
+		*/
+		void SetShaderParameter(const string& name, const BVec4& x)
+		{
+			SetShaderParameter(GetParameterHandle(name), x);
+		}
+
+		/**
+		* \brief Set 4 component int vector shader parameter by name, resolving the handle on every call.
+		* \param name The name of the shader parameter.
+		* \param x The value to set the shader parameter to.
+		*/
+		void SetShaderParameter(const string& name, const IVec4& x)
+		{
+			SetShaderParameter(GetParameterHandle(name), x);
+		}
+
+		/**
+		* \brief Set 4 component unsigned int vector shader parameter by name, resolving the handle on every call.
+		* \param name The name of the shader parameter.
+		* \param x The value to set the shader parameter to.
+		*/
+		void SetShaderParameter(const string& name, const UVec4& x)
+		{
+			SetShaderParameter(GetParameterHandle(name), x);
+		}
+
+		/**
+		* \brief Set 4 component float vector shader parameter by name, resolving the handle on every call.
+		* \param name The name of the shader parameter.
+		* \param x The value to set the shader parameter to.
+		*/
+		void SetShaderParameter(const string& name, const Vec4& x)
+		{
+			SetShaderParameter(GetParameterHandle(name), x);
+		}
+
+		/**
+		* \brief Set 4 component double vector shader parameter by name, resolving the handle on every call.
+		* \param name The name of the shader parameter.
+		* \param x The value to set the shader parameter to.
+		*/
+		void SetShaderParameter(const string& name, const DVec4& x)
+		{
+			SetShaderParameter(GetParameterHandle(name), x);
+		}
+
+		/**
+		* \brief Set 2x2 matrix shader parameter by name, resolving the handle on every call.
+		* \param name The name of the shader parameter.
+		* \param x The value to set the shader parameter to.
+		*/
+		void SetShaderParameter(const string& name, const Mat2& x)
+		{
+			SetShaderParameter(GetParameterHandle(name), x);
+		}
+
+		/**
+		* \brief Set 3x3 matrix shader parameter by name, resolving the handle on every call.
+		* \param name The name of the shader parameter.
+		* \param x The value to set the shader parameter to.
+		*/
+		void SetShaderParameter(const string& name, const Mat3& x)
+		{
+			SetShaderParameter(GetParameterHandle(name), x);
+		}
+
+		/**
+		* \brief Set 4x4 matrix shader parameter by name, resolving the handle on every call.
+		* \param name The name of the shader parameter.
+		* \param x The value to set the shader parameter to.
+		*/
+		void SetShaderParameter(const string& name, const Mat4& x)
+		{
+			SetShaderParameter(GetParameterHandle(name), x);
+		}
+
+		/**
+		* \brief Set texture shader parameter by name, resolving the handle on every call.
+		* \param name The name of the shader parameter.
+		* \param x The texture to bind to the sampler location.
+		*/
+		void SetShaderParameter(const string& name, const ITexture* x)
+		{
+			SetShaderParameter(GetParameterHandle(name), x);
+		}
+
+		/**
+		* \brief Set sampler shader parameter by name, resolving the handle on every call.
+		* \param name The name of the shader parameter.
+		* \param x The sampler to bind to the sampler location.
+		*/
+		void SetShaderParameter(const string& name, const ISampler* x)
+		{
+			SetShaderParameter(GetParameterHandle(name), x);
+		}
+
+		/**
+		* \brief Set buffer shader parameter by name, resolving the handle on every call.
 		* \param name The name of the shader parameter.
 		* \param x The buffer to bind to the buffer binding.
 		*/
-		virtual void SetShaderParameter(const string& name, const IBuffer* x) = 0;
+		void SetShaderParameter(const string& name, const IBuffer* x)
+		{
+			SetShaderParameter(GetParameterHandle(name), x);
+		}
+
+		/**
+		 * \brief Set elements of a bool array shader parameter by name, resolving the handle once per call.
+		 * \param name The name of the shader parameter.
+		 * \param x The values to set the elements to.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		void SetShaderParameterArray(const string& name, const bool* x, int count, int firstElement = 0)
+		{
+			SetShaderParameterArray(GetParameterHandle(name), x, count, firstElement);
+		}
+
+		/**
+		 * \brief Set elements of a int array shader parameter by name, resolving the handle once per call.
+		 * \param name The name of the shader parameter.
+		 * \param x The values to set the elements to.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		void SetShaderParameterArray(const string& name, const int* x, int count, int firstElement = 0)
+		{
+			SetShaderParameterArray(GetParameterHandle(name), x, count, firstElement);
+		}
+
+		/**
+		 * \brief Set elements of a unsigned int array shader parameter by name, resolving the handle once per call.
+		 * \param name The name of the shader parameter.
+		 * \param x The values to set the elements to.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		void SetShaderParameterArray(const string& name, const unsigned* x, int count, int firstElement = 0)
+		{
+			SetShaderParameterArray(GetParameterHandle(name), x, count, firstElement);
+		}
+
+		/**
+		 * \brief Set elements of a float array shader parameter by name, resolving the handle once per call.
+		 * \param name The name of the shader parameter.
+		 * \param x The values to set the elements to.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		void SetShaderParameterArray(const string& name, const float* x, int count, int firstElement = 0)
+		{
+			SetShaderParameterArray(GetParameterHandle(name), x, count, firstElement);
+		}
+
+		/**
+		 * \brief Set elements of a double array shader parameter by name, resolving the handle once per call.
+		 * \param name The name of the shader parameter.
+		 * \param x The values to set the elements to.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		void SetShaderParameterArray(const string& name, const double* x, int count, int firstElement = 0)
+		{
+			SetShaderParameterArray(GetParameterHandle(name), x, count, firstElement);
+		}
+
+		/**
+		 * \brief Set elements of a 2 component bool vector array shader parameter by name, resolving the handle once per call.
+		 * \param name The name of the shader parameter.
+		 * \param x The values to set the elements to.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		void SetShaderParameterArray(const string& name, const BVec2* x, int count, int firstElement = 0)
+		{
+			SetShaderParameterArray(GetParameterHandle(name), x, count, firstElement);
+		}
+
+		/**
+		 * \brief Set elements of a 2 component int vector array shader parameter by name, resolving the handle once per call.
+		 * \param name The name of the shader parameter.
+		 * \param x The values to set the elements to.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		void SetShaderParameterArray(const string& name, const IVec2* x, int count, int firstElement = 0)
+		{
+			SetShaderParameterArray(GetParameterHandle(name), x, count, firstElement);
+		}
+
+		/**
+		 * \brief Set elements of a 2 component unsigned int vector array shader parameter by name, resolving the handle once per call.
+		 * \param name The name of the shader parameter.
+		 * \param x The values to set the elements to.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		void SetShaderParameterArray(const string& name, const UVec2* x, int count, int firstElement = 0)
+		{
+			SetShaderParameterArray(GetParameterHandle(name), x, count, firstElement);
+		}
+
+		/**
+		 * \brief Set elements of a 2 component float vector array shader parameter by name, resolving the handle once per call.
+		 * \param name The name of the shader parameter.
+		 * \param x The values to set the elements to.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		void SetShaderParameterArray(const string& name, const Vec2* x, int count, int firstElement = 0)
+		{
+			SetShaderParameterArray(GetParameterHandle(name), x, count, firstElement);
+		}
+
+		/**
+		 * \brief Set elements of a 2 component double vector array shader parameter by name, resolving the handle once per call.
+		 * \param name The name of the shader parameter.
+		 * \param x The values to set the elements to.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		void SetShaderParameterArray(const string& name, const DVec2* x, int count, int firstElement = 0)
+		{
+			SetShaderParameterArray(GetParameterHandle(name), x, count, firstElement);
+		}
+
+		/**
+		 * \brief Set elements of a 3 component bool vector array shader parameter by name, resolving the handle once per call.
+		 * \param name The name of the shader parameter.
+		 * \param x The values to set the elements to.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		void SetShaderParameterArray(const string& name, const BVec3* x, int count, int firstElement = 0)
+		{
+			SetShaderParameterArray(GetParameterHandle(name), x, count, firstElement);
+		}
+
+		/**
+		 * \brief Set elements of a 3 component int vector array shader parameter by name, resolving the handle once per call.
+		 * \param name The name of the shader parameter.
+		 * \param x The values to set the elements to.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		void SetShaderParameterArray(const string& name, const IVec3* x, int count, int firstElement = 0)
+		{
+			SetShaderParameterArray(GetParameterHandle(name), x, count, firstElement);
+		}
+
+		/**
+		 * \brief Set elements of a 3 component unsigned int vector array shader parameter by name, resolving the handle once per call.
+		 * \param name The name of the shader parameter.
+		 * \param x The values to set the elements to.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		void SetShaderParameterArray(const string& name, const UVec3* x, int count, int firstElement = 0)
+		{
+			SetShaderParameterArray(GetParameterHandle(name), x, count, firstElement);
+		}
+
+		/**
+		 * \brief Set elements of a 3 component float vector array shader parameter by name, resolving the handle once per call.
+		 * \param name The name of the shader parameter.
+		 * \param x The values to set the elements to.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		void SetShaderParameterArray(const string& name, const Vec3* x, int count, int firstElement = 0)
+		{
+			SetShaderParameterArray(GetParameterHandle(name), x, count, firstElement);
+		}
+
+		/**
+		 * \brief Set elements of a 3 component double vector array shader parameter by name, resolving the handle once per call.
+		 * \param name The name of the shader parameter.
+		 * \param x The values to set the elements to.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		void SetShaderParameterArray(const string& name, const DVec3* x, int count, int firstElement = 0)
+		{
+			SetShaderParameterArray(GetParameterHandle(name), x, count, firstElement);
+		}
+
+		/**
+		 * \brief Set elements of a 4 component bool vector array shader parameter by name, resolving the handle once per call.
+		 * \param name The name of the shader parameter.
+		 * \param x The values to set the elements to.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		void SetShaderParameterArray(const string& name, const BVec4* x, int count, int firstElement = 0)
+		{
+			SetShaderParameterArray(GetParameterHandle(name), x, count, firstElement);
+		}
+
+		/**
+		 * \brief Set elements of a 4 component int vector array shader parameter by name, resolving the handle once per call.
+		 * \param name The name of the shader parameter.
+		 * \param x The values to set the elements to.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		void SetShaderParameterArray(const string& name, const IVec4* x, int count, int firstElement = 0)
+		{
+			SetShaderParameterArray(GetParameterHandle(name), x, count, firstElement);
+		}
+
+		/**
+		 * \brief Set elements of a 4 component unsigned int vector array shader parameter by name, resolving the handle once per call.
+		 * \param name The name of the shader parameter.
+		 * \param x The values to set the elements to.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		void SetShaderParameterArray(const string& name, const UVec4* x, int count, int firstElement = 0)
+		{
+			SetShaderParameterArray(GetParameterHandle(name), x, count, firstElement);
+		}
+
+		/**
+		 * \brief Set elements of a 4 component float vector array shader parameter by name, resolving the handle once per call.
+		 * \param name The name of the shader parameter.
+		 * \param x The values to set the elements to.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		void SetShaderParameterArray(const string& name, const Vec4* x, int count, int firstElement = 0)
+		{
+			SetShaderParameterArray(GetParameterHandle(name), x, count, firstElement);
+		}
+
+		/**
+		 * \brief Set elements of a 4 component double vector array shader parameter by name, resolving the handle once per call.
+		 * \param name The name of the shader parameter.
+		 * \param x The values to set the elements to.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		void SetShaderParameterArray(const string& name, const DVec4* x, int count, int firstElement = 0)
+		{
+			SetShaderParameterArray(GetParameterHandle(name), x, count, firstElement);
+		}
+
+		/**
+		 * \brief Set elements of a 2x2 matrix array shader parameter by name, resolving the handle once per call.
+		 * \param name The name of the shader parameter.
+		 * \param x The values to set the elements to.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		void SetShaderParameterArray(const string& name, const Mat2* x, int count, int firstElement = 0)
+		{
+			SetShaderParameterArray(GetParameterHandle(name), x, count, firstElement);
+		}
+
+		/**
+		 * \brief Set elements of a 3x3 matrix array shader parameter by name, resolving the handle once per call.
+		 * \param name The name of the shader parameter.
+		 * \param x The values to set the elements to.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		void SetShaderParameterArray(const string& name, const Mat3* x, int count, int firstElement = 0)
+		{
+			SetShaderParameterArray(GetParameterHandle(name), x, count, firstElement);
+		}
+
+		/**
+		 * \brief Set elements of a 4x4 matrix array shader parameter by name, resolving the handle once per call.
+		 * \param name The name of the shader parameter.
+		 * \param x The values to set the elements to.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		void SetShaderParameterArray(const string& name, const Mat4* x, int count, int firstElement = 0)
+		{
+			SetShaderParameterArray(GetParameterHandle(name), x, count, firstElement);
+		}
+
+		/**
+		 * \brief Set elements of a texture array shader parameter by name, resolving the handle once per call.
+		 * \param name The name of the shader parameter.
+		 * \param x The textures to bind to the sampler locations.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		void SetShaderParameterArray(const string& name, const ITexture* const* x, int count, int firstElement = 0)
+		{
+			SetShaderParameterArray(GetParameterHandle(name), x, count, firstElement);
+		}
+
+		/**
+		 * \brief Set elements of a sampler array shader parameter by name, resolving the handle once per call.
+		 * \param name The name of the shader parameter.
+		 * \param x The samplers to bind to the sampler locations.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		void SetShaderParameterArray(const string& name, const ISampler* const* x, int count, int firstElement = 0)
+		{
+			SetShaderParameterArray(GetParameterHandle(name), x, count, firstElement);
+		}
+
+		/**
+		 * \brief Set elements of a buffer array shader parameter by name, resolving the handle once per call.
+		 * \param name The name of the shader parameter.
+		 * \param x The buffers to bind to the buffer bindings.
+		 * \param count The amount of elements to set.
+		 * \param firstElement The first element to set.
+		 */
+		void SetShaderParameterArray(const string& name, const IBuffer* const* x, int count, int firstElement = 0)
+		{
+			SetShaderParameterArray(GetParameterHandle(name), x, count, firstElement);
+		}
 	};
 }
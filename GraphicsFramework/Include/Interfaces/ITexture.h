@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 #include <memory>
 
 namespace GFW
@@ -79,7 +80,8 @@ namespace GFW
 		GL_SHORT, 
 		GL_UNSIGNED_INT, 
 		GL_INT, 
-		GL_FLOAT
+		GL_FLOAT,
+		GL_HALF_FLOAT
 	};
 
 	enum class TextureMultisampleCount
@@ -102,13 +104,27 @@ namespace GFW
 		 * \brief Interface to initialize the texture as either a 1D or 2D texture.
 		 * \param width The width of the texture.
 		 * \param height The height of the texture. Setting this to 1 will create a 1D texture.
-		 * \param generateMipmaps If mipmaps should be generated for this texture.
+		 * \param generateMipmaps If mipmaps should be generated for this texture. With nullptr @pixelData only the storage of the levels is created, to be filled
+		 * with UpdateTexture().
 		 * \param format The format of the texture.
 		 * \param type The type of @pixelData.
 		 * \param pixelData The pixel data to initialize the texture to. nullptr to only create the storage.
 		 */
 		virtual void Create(int width, int height, bool generateMipmaps, TextureFormat format, TextureDataType type, unsigned char* pixelData) = 0;
 
+		/**
+		 * \brief Interface to initialize the texture as either a 1D or 2D texture from pixel data with padded rows, like a region of a larger image.
+		 * \param width The width of the texture.
+		 * \param height The height of the texture. Setting this to 1 will create a 1D texture.
+		 * \param generateMipmaps If mipmaps should be generated for this texture. With nullptr @pixelData only the storage of the levels is created, to be filled
+		 * with UpdateTexture().
+		 * \param format The format of the texture.
+		 * \param type The type of @pixelData.
+		 * \param pixelData The pixel data to initialize the texture to. nullptr to only create the storage.
+		 * \param rowPitch The distance in bytes between the starts of two rows in @pixelData, a row of blocks for compressed formats.
+		 */
+		virtual void Create(int width, int height, bool generateMipmaps, TextureFormat format, TextureDataType type, const unsigned char* pixelData, uint64_t rowPitch) = 0;
+
 		/**
 		 * \brief Interface to initialize the texture as a multisampled 2D texture.
 		 * \param width The width of the texture.
@@ -123,13 +139,30 @@ namespace GFW
 		 * \param width The width of the texture.
 		 * \param height The height of the texture.
 		 * \param depth The depth of the texture.
-		 * \param generateMipmaps If mipmaps should be generated for this texture.
+		 * \param generateMipmaps If mipmaps should be generated for this texture. With nullptr @pixelData only the storage of the levels is created, to be filled
+		 * with UpdateTexture().
 		 * \param format The format of the texture.
 		 * \param type The type of @pixelData.
 		 * \param pixelData The pixel data to initialize the texture to. nullptr to only create the storage.
 		 */
 		virtual void Create(int width, int height, int depth, bool generateMipmaps, TextureFormat format, TextureDataType type, unsigned char* pixelData) = 0;
 
+		/**
+		 * \brief Interface to initialize the texture as a 3D texture from pixel data with padded rows and slices.
+		 * \param width The width of the texture.
+		 * \param height The height of the texture.
+		 * \param depth The depth of the texture.
+		 * \param generateMipmaps If mipmaps should be generated for this texture. With nullptr @pixelData only the storage of the levels is created, to be filled
+		 * with UpdateTexture().
+		 * \param format The format of the texture.
+		 * \param type The type of @pixelData.
+		 * \param pixelData The pixel data to initialize the texture to. nullptr to only create the storage.
+		 * \param rowPitch The distance in bytes between the starts of two rows in @pixelData, a row of blocks for compressed formats.
+		 * \param slicePitch The distance in bytes between the starts of two slices in @pixelData.
+		 */
+		virtual void Create(int width, int height, int depth, bool generateMipmaps, TextureFormat format, TextureDataType type, const unsigned char* pixelData, uint64_t rowPitch,
+			uint64_t slicePitch) = 0;
+
 		/**
 		 * \brief Interface to initialize the texture as a 1D or 2D texture array.
 		 * \param width The width of the texture.
@@ -154,7 +187,7 @@ namespace GFW
 		virtual void CreateCube(int width, int height, bool generateMipmaps, TextureFormat format, TextureDataType type, unsigned char* pixelData[6]) = 0;
 
 		/**
-		 * \brief Interface to load a texture from a file. Common file types like PNG, JPG and BMP should be supported. Textures exported from this framework should also be supported.
+		 * \brief Interface to load a texture from a file. Common file types like PNG, JPG and BMP should be supported. Textures exported from this framework should also be supported, TextureContainer can be used to load those. DDS and KTX files holding compressed blocks can be passed through with DdsKtxFile.
 		 * \param file The texture file to load.
 		 * \param mipmaps When set to true mipmaps should get loaded from the file if present and should otherwise be generated. When set to false no mipmaps will be generated but mipmaps present in the file also won't be used.
 		 */
@@ -184,6 +217,20 @@ namespace GFW
 		 */
 		virtual void UpdateTexture(int x, int y, int width, int height, int level, TextureFormat format, TextureDataType type, unsigned char* pixelData) = 0;
 
+		/**
+		 * \brief Interface for updating the contents of a 2D texture or a 1D texture array from pixel data with padded rows, so a region of a larger image can be uploaded without repacking it.
+		 * \param x The offset to start writing at in the width of the texture.
+		 * \param y The offset to start writing at in the height of the texture or in the case of a 1D texture array the layer to write to.
+		 * \param width The width in pixels to write to the texture.
+		 * \param height The height in pixels to write to the texture. Should be 1 when updating a 1D texture array.
+		 * \param level The mipmap level to write to.
+		 * \param format The format of the texture.
+		 * \param type The type of @pixelData.
+		 * \param pixelData The first pixel of the region to write to the texture.
+		 * \param rowPitch The distance in bytes between the starts of two rows in @pixelData, a row of blocks for compressed formats.
+		 */
+		virtual void UpdateTexture(int x, int y, int width, int height, int level, TextureFormat format, TextureDataType type, const unsigned char* pixelData, uint64_t rowPitch) = 0;
+
 		/**
 		 * \brief Interface for updating the contents of a 3D texture of a 2D texture array.
 		 * \param x The offset to start writing at in the width of the texture.
@@ -198,12 +245,51 @@ namespace GFW
 		 * \param pixelData The pixel data to write to the texture.
 		 */
 		virtual void UpdateTexture(int x, int y, int z, int width, int height, int depth, int level, TextureFormat format, TextureDataType type, unsigned char* pixelData) = 0;
+
+		/**
+		 * \brief Interface for updating the contents of a 3D texture or a 2D texture array from pixel data with padded rows and slices.
+		 * \param x The offset to start writing at in the width of the texture.
+		 * \param y The offset to start writing at in the height of the texture.
+		 * \param z The offset to start writing at in the depth of the texture or in the case of a 2D texture array the layer to write to.
+		 * \param width The width in pixels to write to the texture.
+		 * \param height The height in pixels to write to the texture.
+		 * \param depth The depth in pixels to write to the texture. Should be 1 when updating a 2D texture array.
+		 * \param level The mipmap level to write to.
+		 * \param format The format of the texture.
+		 * \param type The type of @pixelData.
+		 * \param pixelData The first pixel of the region to write to the texture.
+		 * \param rowPitch The distance in bytes between the starts of two rows in @pixelData, a row of blocks for compressed formats.
+		 * \param slicePitch The distance in bytes between the starts of two slices in @pixelData.
+		 */
+		virtual void UpdateTexture(int x, int y, int z, int width, int height, int depth, int level, TextureFormat format, TextureDataType type, const unsigned char* pixelData,
+			uint64_t rowPitch, uint64_t slicePitch) = 0;
 		
 		/**
 		 * \brief Interface for exporting the texture data directly from the API to a buffer. Usefull for exporting compressed textures.
+		 * The exported data uses the TextureContainer layout so it can be written to a file and loaded again by CreateFromFile().
+		 * Allocates new memory on every call, use the per level Export() for frequent exports.
 		 * \param size The size of the exported data.
-		 * \return Shared pointer to the exported data.
+		 * \return Shared pointer to the exported data. Implementations should delete it with an array deleter.
 		 */
 		virtual std::shared_ptr<char> Export(int& size) = 0;
+
+		/**
+		 * \brief Interface to get the size of the data Export() writes for a single mipmap level of a layer.
+		 * \param level The mipmap level.
+		 * \param layer The layer of a texture array, the face of a cubemap (in the order +X, -X, +Y, -Y, +Z, -Z) or 0 for other textures.
+		 * \return The size in bytes of the tightly packed data of the level, in blocks for compressed formats.
+		 */
+		virtual uint64_t GetExportSize(int level, int layer) = 0;
+
+		/**
+		 * \brief Interface for exporting a single mipmap level of a layer directly from the API into memory owned by the caller, without allocating.
+		 * TextureExportPool can be used to get reusable memory for the export.
+		 * \param level The mipmap level to export.
+		 * \param layer The layer of a texture array, the face of a cubemap (in the order +X, -X, +Y, -Y, +Z, -Z) or 0 for other textures.
+		 * \param destination The memory to write the tightly packed data of the level to, in the format and data type the texture was created with.
+		 * \param destinationSize The size of @destination. Nothing is written if it's smaller than GetExportSize().
+		 * \return The amount of bytes written to @destination.
+		 */
+		virtual uint64_t Export(int level, int layer, char* destination, uint64_t destinationSize) = 0;
 	};
 }
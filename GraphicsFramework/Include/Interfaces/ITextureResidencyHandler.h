@@ -0,0 +1,22 @@
+#pragma once
+#include "Interfaces/ITexture.h"
+
+namespace GFW
+{
+	/**
+	 * \brief Interface for API specific code that frees and reloads mipmap levels of textures on request of the TextureResidencyManager.
+	 */
+	class ITextureResidencyHandler
+	{
+	public:
+		virtual ~ITextureResidencyHandler() = default;
+
+		/**
+		 * \brief Interface to change which mipmap levels of a texture are resident. Levels finer than @firstLevel should have their memory released,
+		 * levels from @firstLevel down to the smallest level should be present, reloading them from their source when they were released before.
+		 * \param texture The texture to change.
+		 * \param firstLevel The finest mipmap level that should be resident.
+		 */
+		virtual void SetResidentLevels(ITexture* texture, int firstLevel) = 0;
+	};
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdint>
+
+namespace GFW
+{
+	/**
+	 * \brief Read-only view of a file mapped into memory. Pages are loaded by the operating system on first access.
+	 * The mapping is copy-on-write, the file is never modified and pages only get copied when they're written to.
+	 */
+	class MappedFile
+	{
+	public:
+		MappedFile();
+		~MappedFile();
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		bool Open(const char* file);
+		void Close();
+
+		bool IsOpen() const;
+		unsigned char* GetData() const;
+		uint64_t GetSize() const;
+
+	private:
+		unsigned char* m_data;	// Start of the mapped file.
+		uint64_t m_size;		// The size of the mapped file in bytes.
+#ifdef _WIN32
+		void* m_file;			// Handle of the opened file.
+		void* m_mapping;		// Handle of the file mapping object.
+#endif
+	};
+}
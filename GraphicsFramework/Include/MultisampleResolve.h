@@ -0,0 +1,32 @@
+#pragma once
+#include "Interfaces/ITexture.h"
+#include "ThreadPool.h"
+
+namespace GFW
+{
+	/**
+	 * \brief Enum with the ways the samples of a multisampled pixel can be combined into a single value.
+	 * BOX averages the samples of the pixel. TENT weights the samples of the pixel and its neighbours by their distance to the pixel center, which gives smoother edges.
+	 * DEPTH_MIN and DEPTH_MAX pick the closest or farthest sample of depth formats, averaging depth values creates depths that don't belong to any surface.
+	 */
+	enum class ResolveFilter
+	{
+		BOX,
+		TENT,
+		DEPTH_MIN,
+		DEPTH_MAX
+	};
+
+	/**
+	 * \brief Helper functions to resolve multisampled pixel data on the CPU, for headless and software rendering that can't let the graphics API resolve.
+	 * Multisampled data stores the samples of every pixel next to each other, the pixels are stored row by row. The sample positions are the standard
+	 * Direct3D positions, which most hardware uses as well. Rows are resolved in parallel on a thread pool with SSE2 kernels for the common formats.
+	 */
+	namespace MultisampleResolve
+	{
+		void GetSamplePosition(TextureMultisampleCount sampleCount, int sample, float& x, float& y);
+
+		bool Resolve(ResolveFilter filter, TextureFormat format, TextureDataType type, TextureMultisampleCount sampleCount, int width, int height, const unsigned char* source,
+			unsigned char* destination, ThreadPool* threadPool = nullptr);
+	}
+}
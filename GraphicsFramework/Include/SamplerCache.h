@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "Interfaces/ISampler.h"
+
+namespace GFW
+{
+	/**
+	 * \brief Packed description of a sampler. Bits 0-2 hold the minification filter, bits 3-5 the magnification filter, bits 6-8 the anisotropic filter,
+	 * bits 9-10 the edge sampling operation and bits 11-31 the index of the border color in the SamplerCache that created the key.
+	 */
+	typedef uint32_t SamplerKey;
+
+	/**
+	 * \brief This class shares immutable samplers between everything that samples with the same configuration.
+	 * Configurations are packed into a SamplerKey and every distinct key maps onto a single sampler, so thousands of materials share a handful of samplers
+	 * and consecutive draws often bind the same one. Border colors are quantized to half floats and interned, configurations that don't sample the border
+	 * share a sampler regardless of their border color. Samplers are created on the calling thread, so the cache should be used from the thread that owns the context.
+	 */
+	class SamplerCache
+	{
+	public:
+		typedef std::function<std::unique_ptr<ISampler>()> SamplerFactory;	// Creates an empty sampler of the graphics API that's used.
+
+		SamplerCache(SamplerFactory factory);
+
+		const ISampler* Get(SamplerFilter minFilter, SamplerFilter magFilter, AnisotropicFilter anisotropy, EdgeSampling edgeSampling, const Vec4& borderColor = Vec4(0.0f));
+		const ISampler* Get(SamplerKey key);
+
+		SamplerKey GetKey(SamplerFilter minFilter, SamplerFilter magFilter, AnisotropicFilter anisotropy, EdgeSampling edgeSampling, const Vec4& borderColor = Vec4(0.0f));
+		void Unpack(SamplerKey key, SamplerFilter& minFilter, SamplerFilter& magFilter, AnisotropicFilter& anisotropy, EdgeSampling& edgeSampling, Vec4& borderColor) const;
+
+		void Clear();
+
+		int GetSamplerCount() const;
+		int GetBorderColorCount() const;
+		unsigned long long GetRequestCount() const;
+
+	private:
+		uint32_t InternBorderColor(const Vec4& color);
+
+		SamplerFactory m_factory;												// Creates the samplers.
+		std::unordered_map<SamplerKey, std::unique_ptr<ISampler>> m_samplers;	// The sampler of every key that was requested.
+		std::unordered_map<uint64_t, uint32_t> m_borderColorIndices;			// Index of every border color by its quantized channels.
+		std::vector<Vec4> m_borderColors;										// Every interned border color, after quantization.
+		unsigned long long m_requests;											// The amount of Get() calls.
+	};
+}
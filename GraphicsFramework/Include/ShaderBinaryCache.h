@@ -0,0 +1,43 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Interfaces/IShader.h"
+
+namespace GFW
+{
+	/**
+	 * \brief Persistent cache of linked shader programs, to skip compiling on startup. Programs are stored as a binary together with their
+	 * attributes and parameters, in one file per program named after a hash of the preprocessed source, which includes the variant defines,
+	 * and a string identifying the backend and driver. Files are validated with a checksum and written to a temporary file that's renamed,
+	 * so a crash while writing never leaves a partial file behind. Files that don't validate or that the backend rejects are replaced.
+	 */
+	class ShaderBinaryCache
+	{
+	public:
+		typedef std::function<std::unique_ptr<IShader>()> ShaderFactory;	// Creates an empty shader of the graphics API that's used.
+
+		ShaderBinaryCache(ShaderFactory factory, const std::string& directory, const std::string& backendIdentity);
+
+		std::unique_ptr<IShader> Create(const std::string& source);
+		bool Invalidate(const std::string& source);
+		std::string GetFilePath(const std::string& source) const;
+
+		unsigned long long GetHitCount() const;
+		unsigned long long GetMissCount() const;
+
+	private:
+		std::unique_ptr<IShader> Load(const std::string& file, uint64_t sourceHash);
+		bool Store(const std::string& file, uint64_t sourceHash, IShader* shader);
+
+		ShaderFactory m_factory;						// Creates the shaders.
+		std::string m_directory;						// Directory of the cache files, including the trailing separator.
+		uint64_t m_identityHash;						// Hash of the backend and driver identity.
+		std::atomic<unsigned long long> m_hits;			// The amount of programs created from a cached binary.
+		std::atomic<unsigned long long> m_misses;		// The amount of programs compiled from source.
+		std::atomic<unsigned long long> m_tempFiles;	// Counter to give temporary files unique names.
+	};
+}
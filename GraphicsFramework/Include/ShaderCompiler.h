@@ -0,0 +1,93 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "Interfaces/IShader.h"
+#include "ShaderPermutations.h"
+#include "ThreadPool.h"
+
+namespace GFW
+{
+	/**
+	 * \brief Enum with the states of an asynchronous shader compile.
+	 */
+	enum class ShaderCompileState
+	{
+		PENDING/*Waiting for a worker thread, being preprocessed or waiting for its program to be created.*/,
+		READY/*The program is compiled.*/,
+		FAILED/*The source or one of its includes couldn't be loaded, or the program failed to compile or link.*/
+	};
+
+	/**
+	 * \brief Progress of a single asynchronous shader compile. Returned by ShaderCompiler::CreateAsync().
+	 */
+	class ShaderCompileRequest
+	{
+	public:
+		ShaderCompileState GetState() const;
+		IShader* GetShader() const;
+		const std::string& GetPath() const;
+		uint64_t GetVariantKey() const;
+		double GetWaitTime() const;
+		double GetCompileTime() const;
+
+	private:
+		friend class ShaderCompiler;
+
+		ShaderCompileRequest(const std::string& path, uint64_t variantKey, IShader* placeholder, int priority);
+
+		std::string m_path;							// The path of the source file.
+		uint64_t m_variantKey;						// The key of the variant that is compiled.
+		int m_priority;								// Requests with a higher priority are created first by ProcessCreates().
+		ShaderPermutations::PreparedVariant m_variant;	// The preprocessed variant, waiting for ProcessCreates() to create its program.
+		bool m_prepared;							// Set while the request waits in the queue of ProcessCreates(). Guarded by the compiler's mutex.
+		IShader* m_placeholder;						// Returned by GetShader() until the program is ready.
+		std::atomic<IShader*> m_shader;				// The compiled program, owned by the ShaderPermutations.
+		std::atomic<ShaderCompileState> m_state;	// The current state of the compile.
+		std::chrono::steady_clock::time_point m_submitted;	// When the compile was requested.
+		double m_waitTime;							// Milliseconds between the request and the start of the compile.
+		double m_compileTime;						// Milliseconds spent preprocessing and compiling.
+	};
+
+	typedef std::shared_ptr<ShaderCompileRequest> ShaderCompileHandle;
+
+	/**
+	 * \brief This class compiles shader variants without blocking the calling thread. Every request is preprocessed by ShaderPermutations on its own task
+	 * on the thread pool, the programs are then created by ProcessCreates() on the thread that owns the context. When the backend supports creating shaders
+	 * on the worker threads, for example with a shared context per worker, parallelCreate creates the programs on the pool as well, so compiles run
+	 * in parallel on all workers. Until a program is ready a placeholder shader can be used in its place.
+	 */
+	class ShaderCompiler
+	{
+	public:
+		ShaderCompiler(ShaderPermutations* permutations, ThreadPool* threadPool = nullptr, bool parallelCreate = false);
+		~ShaderCompiler();
+
+		void SetPlaceholder(IShader* placeholder);
+		IShader* GetPlaceholder() const;
+
+		ShaderCompileHandle CreateAsync(const std::string& path, uint64_t variantKey, int priority = 0);
+		void Wait(const ShaderCompileHandle& handle);
+		int ProcessCreates(int maxPrograms);
+		bool IsIdle();
+
+	private:
+		void Compile(const ShaderCompileHandle& request);
+		void CreateProgram(const ShaderCompileHandle& request);
+
+		ShaderPermutations* m_permutations;			// Preprocesses, compiles and owns the programs. Not owned by the compiler.
+		ThreadPool* m_threadPool;					// Pool on which the programs are compiled.
+		bool m_parallelCreate;						// If the programs are created on the pool instead of by ProcessCreates().
+		std::atomic<IShader*> m_placeholder;		// Shader used in place of programs that aren't ready. Not owned by the compiler.
+
+		std::mutex m_mutex;							// Guards the task counter and the prepared requests.
+		std::condition_variable m_taskFinished;		// Signaled when a compile task finishes or a program is created.
+		int m_activeTasks;							// The amount of compile tasks that are submitted but haven't finished.
+		std::vector<ShaderCompileHandle> m_prepared;	// Requests that are preprocessed and wait for ProcessCreates() to create their program.
+	};
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Math.h"
+#include "Structures/ShaderParameter.h"
+#include "Structures/ShaderParameterHandle.h"
+
+namespace GFW
+{
+	class IShader;
+	class ISampler;
+
+	/**
+	 * \brief Enum of the kinds of resources a ShaderParameterBatch entry can bind.
+	 */
+	enum class ShaderParameterResource
+	{
+		NONE/*The entry holds values of its type.*/,
+		TEXTURE/*The entry holds texture pointers.*/,
+		SAMPLER/*The entry holds sampler pointers.*/,
+		BUFFER/*The entry holds buffer pointers.*/
+	};
+
+	/**
+	 * \brief Struct that describes one entry of a ShaderParameterBatch.
+	 */
+	struct ShaderParameterBatchEntry
+	{
+		ShaderParameterHandle handle;		// The handle of the shader parameter
+		ShaderParameterType type;			// The type of the values if resource is NONE, otherwise SAMPLER2D for textures and samplers and UNIFORM_BUFFER for buffers
+		ShaderParameterResource resource;	// The kind of resource pointers the entry holds
+		int count;							// The amount of elements to set
+		int firstElement;					// The first element to set
+		uint32_t offset;					// Offset of the values in the batch
+	};
+
+	/**
+	 * \brief Records heterogeneous shader parameter values, single values and array elements, so they can be set with one call to
+	 * IShader::SetShaderParameters(). Values are copied into one buffer, so the batch can be built once and applied many times.
+	 */
+	class ShaderParameterBatch
+	{
+	public:
+		ShaderParameterBatch();
+
+		void Clear();
+		void Add(ShaderParameterHandle handle, const bool* values, int count, int firstElement = 0);
+		void Add(ShaderParameterHandle handle, const int* values, int count, int firstElement = 0);
+		void Add(ShaderParameterHandle handle, const unsigned* values, int count, int firstElement = 0);
+		void Add(ShaderParameterHandle handle, const float* values, int count, int firstElement = 0);
+		void Add(ShaderParameterHandle handle, const double* values, int count, int firstElement = 0);
+		void Add(ShaderParameterHandle handle, const BVec2* values, int count, int firstElement = 0);
+		void Add(ShaderParameterHandle handle, const IVec2* values, int count, int firstElement = 0);
+		void Add(ShaderParameterHandle handle, const UVec2* values, int count, int firstElement = 0);
+		void Add(ShaderParameterHandle handle, const Vec2* values, int count, int firstElement = 0);
+		void Add(ShaderParameterHandle handle, const DVec2* values, int count, int firstElement = 0);
+		void Add(ShaderParameterHandle handle, const BVec3* values, int count, int firstElement = 0);
+		void Add(ShaderParameterHandle handle, const IVec3* values, int count, int firstElement = 0);
+		void Add(ShaderParameterHandle handle, const UVec3* values, int count, int firstElement = 0);
+		void Add(ShaderParameterHandle handle, const Vec3* values, int count, int firstElement = 0);
+		void Add(ShaderParameterHandle handle, const DVec3* values, int count, int firstElement = 0);
+		void Add(ShaderParameterHandle handle, const BVec4* values, int count, int firstElement = 0);
+		void Add(ShaderParameterHandle handle, const IVec4* values, int count, int firstElement = 0);
+		void Add(ShaderParameterHandle handle, const UVec4* values, int count, int firstElement = 0);
+		void Add(ShaderParameterHandle handle, const Vec4* values, int count, int firstElement = 0);
+		void Add(ShaderParameterHandle handle, const DVec4* values, int count, int firstElement = 0);
+		void Add(ShaderParameterHandle handle, const Mat2* values, int count, int firstElement = 0);
+		void Add(ShaderParameterHandle handle, const Mat3* values, int count, int firstElement = 0);
+		void Add(ShaderParameterHandle handle, const Mat4* values, int count, int firstElement = 0);
+		void Add(ShaderParameterHandle handle, const ITexture* const* values, int count, int firstElement = 0);
+		void Add(ShaderParameterHandle handle, const ISampler* const* values, int count, int firstElement = 0);
+		void Add(ShaderParameterHandle handle, const IBuffer* const* values, int count, int firstElement = 0);
+
+		int GetEntryCount() const;
+		const ShaderParameterBatchEntry& GetEntry(int index) const;
+		const void* GetValues(int index) const;
+
+		void Apply(IShader* shader) const;
+
+	private:
+		void Add(ShaderParameterHandle handle, ShaderParameterType type, ShaderParameterResource resource, const void* values, size_t size, int count, int firstElement);
+
+		std::vector<ShaderParameterBatchEntry> m_entries;	// All recorded entries.
+		std::vector<unsigned char> m_values;				// Values of all entries. Every entry starts at a multiple of 16 bytes, relative to the start of the buffer.
+	};
+}
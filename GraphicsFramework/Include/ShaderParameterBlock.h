@@ -0,0 +1,69 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Interfaces/IShader.h"
+#include "ShaderParameterCache.h"
+
+namespace GFW
+{
+	/**
+	 * \brief Compact parameter values of one shader program, for example the values of one material. Types, locations and value offsets are stored
+	 * in separate arrays and the values are packed into one blob, each taking only the size of its type, so applying them walks contiguous memory.
+	 * Parameter indices match the ShaderReflection and the handles of the program. Sampler parameters hold a texture and a sampler.
+	 */
+	class ShaderParameterBlock
+	{
+	public:
+		ShaderParameterBlock();
+
+		void Create(const ShaderReflection& reflection);
+
+		int GetParameterCount() const;
+		ShaderParameterType GetType(int index) const;
+		int GetLocation(int index) const;
+		const unsigned char* GetValue(int index) const;
+		size_t GetValueSize() const;
+		static size_t GetValueSize(ShaderParameterType type);
+
+		void SetShaderParameter(ShaderParameterHandle handle, bool x);
+		void SetShaderParameter(ShaderParameterHandle handle, int x);
+		void SetShaderParameter(ShaderParameterHandle handle, unsigned x);
+		void SetShaderParameter(ShaderParameterHandle handle, float x);
+		void SetShaderParameter(ShaderParameterHandle handle, double x);
+		void SetShaderParameter(ShaderParameterHandle handle, const BVec2& x);
+		void SetShaderParameter(ShaderParameterHandle handle, const IVec2& x);
+		void SetShaderParameter(ShaderParameterHandle handle, const UVec2& x);
+		void SetShaderParameter(ShaderParameterHandle handle, const Vec2& x);
+		void SetShaderParameter(ShaderParameterHandle handle, const DVec2& x);
+		void SetShaderParameter(ShaderParameterHandle handle, const BVec3& x);
+		void SetShaderParameter(ShaderParameterHandle handle, const IVec3& x);
+		void SetShaderParameter(ShaderParameterHandle handle, const UVec3& x);
+		void SetShaderParameter(ShaderParameterHandle handle, const Vec3& x);
+		void SetShaderParameter(ShaderParameterHandle handle, const DVec3& x);
+		void SetShaderParameter(ShaderParameterHandle handle, const BVec4& x);
+		void SetShaderParameter(ShaderParameterHandle handle, const IVec4& x);
+		void SetShaderParameter(ShaderParameterHandle handle, const UVec4& x);
+		void SetShaderParameter(ShaderParameterHandle handle, const Vec4& x);
+		void SetShaderParameter(ShaderParameterHandle handle, const DVec4& x);
+		void SetShaderParameter(ShaderParameterHandle handle, const Mat2& x);
+		void SetShaderParameter(ShaderParameterHandle handle, const Mat3& x);
+		void SetShaderParameter(ShaderParameterHandle handle, const Mat4& x);
+		void SetShaderParameter(ShaderParameterHandle handle, const ITexture* x);
+		void SetShaderParameter(ShaderParameterHandle handle, const ISampler* x);
+		void SetShaderParameter(ShaderParameterHandle handle, const IBuffer* x);
+
+		void Apply(IShader* shader) const;
+		void Apply(ShaderParameterCache& cache) const;
+
+	private:
+		ShaderParameterType GetType(ShaderParameterHandle handle) const;
+		void Store(ShaderParameterHandle handle, const void* value, size_t size, size_t offset = 0);
+		template<typename Target>
+		void ApplyTo(Target& target) const;
+
+		vector<ShaderParameterType> m_types;	// Type of every parameter.
+		vector<int> m_locations;				// Location or binding of every parameter.
+		vector<uint32_t> m_offsets;				// Offset of the value of every parameter in m_values.
+		vector<unsigned char> m_values;			// Packed values of all parameters.
+	};
+}
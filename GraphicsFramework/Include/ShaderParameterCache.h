@@ -0,0 +1,98 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Interfaces/IShader.h"
+
+namespace GFW
+{
+	/**
+	 * \brief Shadows the parameter values of one shader program and only forwards SetShaderParameter() to the shader when the value changed,
+	 * like ContextState does for the context. Values are compared bitwise, so -0 and 0 count as different and a NaN equal to itself.
+	 * Texture, sampler and buffer parameters are always forwarded, the units they are bound to are context state that other programs change.
+	 * Array and batch sets are always forwarded as well and drop the cached values of the parameters they set, so the next single set is forwarded.
+	 */
+	class ShaderParameterCache
+	{
+	public:
+		ShaderParameterCache(IShader* shader);
+
+		IShader* GetShader() const;
+		ShaderParameterHandle GetParameterHandle(const string& name) const;
+		ShaderParameterHandle GetParameterHandle(ShaderParameterName name) const;
+
+		void SetShaderParameter(ShaderParameterHandle handle, bool x);
+		void SetShaderParameter(ShaderParameterHandle handle, int x);
+		void SetShaderParameter(ShaderParameterHandle handle, unsigned x);
+		void SetShaderParameter(ShaderParameterHandle handle, float x);
+		void SetShaderParameter(ShaderParameterHandle handle, double x);
+		void SetShaderParameter(ShaderParameterHandle handle, const BVec2& x);
+		void SetShaderParameter(ShaderParameterHandle handle, const IVec2& x);
+		void SetShaderParameter(ShaderParameterHandle handle, const UVec2& x);
+		void SetShaderParameter(ShaderParameterHandle handle, const Vec2& x);
+		void SetShaderParameter(ShaderParameterHandle handle, const DVec2& x);
+		void SetShaderParameter(ShaderParameterHandle handle, const BVec3& x);
+		void SetShaderParameter(ShaderParameterHandle handle, const IVec3& x);
+		void SetShaderParameter(ShaderParameterHandle handle, const UVec3& x);
+		void SetShaderParameter(ShaderParameterHandle handle, const Vec3& x);
+		void SetShaderParameter(ShaderParameterHandle handle, const DVec3& x);
+		void SetShaderParameter(ShaderParameterHandle handle, const BVec4& x);
+		void SetShaderParameter(ShaderParameterHandle handle, const IVec4& x);
+		void SetShaderParameter(ShaderParameterHandle handle, const UVec4& x);
+		void SetShaderParameter(ShaderParameterHandle handle, const Vec4& x);
+		void SetShaderParameter(ShaderParameterHandle handle, const DVec4& x);
+		void SetShaderParameter(ShaderParameterHandle handle, const Mat2& x);
+		void SetShaderParameter(ShaderParameterHandle handle, const Mat3& x);
+		void SetShaderParameter(ShaderParameterHandle handle, const Mat4& x);
+		void SetShaderParameter(ShaderParameterHandle handle, const ITexture* x);
+		void SetShaderParameter(ShaderParameterHandle handle, const ISampler* x);
+		void SetShaderParameter(ShaderParameterHandle handle, const IBuffer* x);
+		void SetShaderParameterArray(ShaderParameterHandle handle, const bool* x, int count, int firstElement = 0);
+		void SetShaderParameterArray(ShaderParameterHandle handle, const int* x, int count, int firstElement = 0);
+		void SetShaderParameterArray(ShaderParameterHandle handle, const unsigned* x, int count, int firstElement = 0);
+		void SetShaderParameterArray(ShaderParameterHandle handle, const float* x, int count, int firstElement = 0);
+		void SetShaderParameterArray(ShaderParameterHandle handle, const double* x, int count, int firstElement = 0);
+		void SetShaderParameterArray(ShaderParameterHandle handle, const BVec2* x, int count, int firstElement = 0);
+		void SetShaderParameterArray(ShaderParameterHandle handle, const IVec2* x, int count, int firstElement = 0);
+		void SetShaderParameterArray(ShaderParameterHandle handle, const UVec2* x, int count, int firstElement = 0);
+		void SetShaderParameterArray(ShaderParameterHandle handle, const Vec2* x, int count, int firstElement = 0);
+		void SetShaderParameterArray(ShaderParameterHandle handle, const DVec2* x, int count, int firstElement = 0);
+		void SetShaderParameterArray(ShaderParameterHandle handle, const BVec3* x, int count, int firstElement = 0);
+		void SetShaderParameterArray(ShaderParameterHandle handle, const IVec3* x, int count, int firstElement = 0);
+		void SetShaderParameterArray(ShaderParameterHandle handle, const UVec3* x, int count, int firstElement = 0);
+		void SetShaderParameterArray(ShaderParameterHandle handle, const Vec3* x, int count, int firstElement = 0);
+		void SetShaderParameterArray(ShaderParameterHandle handle, const DVec3* x, int count, int firstElement = 0);
+		void SetShaderParameterArray(ShaderParameterHandle handle, const BVec4* x, int count, int firstElement = 0);
+		void SetShaderParameterArray(ShaderParameterHandle handle, const IVec4* x, int count, int firstElement = 0);
+		void SetShaderParameterArray(ShaderParameterHandle handle, const UVec4* x, int count, int firstElement = 0);
+		void SetShaderParameterArray(ShaderParameterHandle handle, const Vec4* x, int count, int firstElement = 0);
+		void SetShaderParameterArray(ShaderParameterHandle handle, const DVec4* x, int count, int firstElement = 0);
+		void SetShaderParameterArray(ShaderParameterHandle handle, const Mat2* x, int count, int firstElement = 0);
+		void SetShaderParameterArray(ShaderParameterHandle handle, const Mat3* x, int count, int firstElement = 0);
+		void SetShaderParameterArray(ShaderParameterHandle handle, const Mat4* x, int count, int firstElement = 0);
+		void SetShaderParameterArray(ShaderParameterHandle handle, const ITexture* const* x, int count, int firstElement = 0);
+		void SetShaderParameterArray(ShaderParameterHandle handle, const ISampler* const* x, int count, int firstElement = 0);
+		void SetShaderParameterArray(ShaderParameterHandle handle, const IBuffer* const* x, int count, int firstElement = 0);
+		void SetShaderParameters(const ShaderParameterBatch& batch);
+
+		void Invalidate();
+		void Invalidate(ShaderParameterHandle handle);
+		uint64_t GetSkippedCount() const;
+		uint64_t GetForwardedCount() const;
+		void ResetCounters();
+
+	private:
+		bool Update(ShaderParameterHandle handle, const void* value, size_t size);
+		template<typename T> void ForwardArray(ShaderParameterHandle handle, const T* x, int count, int firstElement);
+
+		struct CachedValue
+		{
+			size_t size;						// Size of the value in bytes, 0 if no value is cached
+			unsigned char value[sizeof(Mat4)];	// The last value forwarded to the shader
+		};
+
+		IShader* m_shader;					// The shader program the parameters are forwarded to.
+		std::vector<CachedValue> m_values;	// Cached value of every parameter, indexed by handle.
+		uint64_t m_skippedCount;			// Amount of sets that weren't forwarded because the value didn't change.
+		uint64_t m_forwardedCount;			// Amount of sets forwarded to the shader.
+	};
+}
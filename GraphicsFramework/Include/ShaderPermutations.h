@@ -0,0 +1,97 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Interfaces/IShader.h"
+#include "ShaderBinaryCache.h"
+#include "ThreadPool.h"
+
+namespace GFW
+{
+	/**
+	 * \brief This class compiles variants of shader sources that differ in the keywords they define. Keywords are declared in mutually exclusive sets,
+	 * every set takes a few bits of a 64 bit variant key. Sources are loaded with their #include directives resolved, the expanded sources are cached
+	 * per file, and compiled programs are memoized by the hash of the expanded source and the variant key, so the same variant is only compiled once.
+	 */
+	class ShaderPermutations
+	{
+	public:
+		typedef std::function<std::unique_ptr<IShader>()> ShaderFactory;						// Creates an empty shader of the graphics API that's used.
+		typedef std::function<bool(const std::string& path, std::string& source)> SourceLoader;	// Loads a source file, returns false if it doesn't exist.
+
+		/**
+		 * \brief A variant whose source is preprocessed but whose program may not be created yet. Filled in by PrepareVariant().
+		 */
+		struct PreparedVariant
+		{
+			uint64_t sourceHash;	// Hash of the expanded source.
+			uint64_t variantKey;	// The variant key.
+			std::string source;		// The source of the variant, empty if the variant was already compiled.
+			IShader* shader;		// The program if the variant was already compiled, nullptr otherwise.
+		};
+
+		ShaderPermutations(ShaderFactory factory, SourceLoader loader = nullptr, ThreadPool* threadPool = nullptr);
+
+		int AddKeywordSet(const std::vector<std::string>& keywords);
+		int GetKeywordSetCount() const;
+		uint64_t GetVariantKey(const std::vector<std::string>& keywords) const;
+		std::vector<std::string> GetKeywords(uint64_t variantKey) const;
+
+		IShader* GetVariant(const std::string& path, uint64_t variantKey);
+		bool PrepareVariant(const std::string& path, uint64_t variantKey, PreparedVariant& variant);
+		IShader* CreateVariant(const PreparedVariant& variant);
+		void Precompile(const std::string& path, const std::vector<uint64_t>& variantKeys, bool parallelCreate = false);
+		void InvalidateSource(const std::string& path);
+		void SetBinaryCache(ShaderBinaryCache* binaryCache);
+
+		int GetVariantCount() const;
+		unsigned long long GetHitCount() const;
+
+
+	private:
+		struct KeywordSet
+		{
+			std::vector<std::string> keywords;	// The keywords of the set, the first one is used if none is enabled.
+			int offset;							// First bit of the set in the variant key.
+			int bits;							// Amount of bits of the set in the variant key.
+		};
+
+		struct SourceNode
+		{
+			std::shared_ptr<const std::string> source;	// The source with all includes expanded, shared so variants can be built without holding the lock.
+			uint64_t hash;						// HashFnv1a64() of the expanded source.
+			std::vector<std::string> files;		// All files the expanded source was built from, including the file itself.
+		};
+
+		struct VariantId
+		{
+			uint64_t sourceHash;	// Hash of the expanded source
+			uint64_t variantKey;	// The variant key
+
+			bool operator==(const VariantId& other) const { return sourceHash == other.sourceHash && variantKey == other.variantKey; }
+		};
+
+		struct VariantIdHasher
+		{
+			size_t operator()(const VariantId& id) const { return size_t(id.sourceHash ^ (id.variantKey * 0x9E3779B97F4A7C15ull)); }
+		};
+
+		const SourceNode* ResolveSource(const std::string& path, std::vector<std::string>& stack);
+		std::string BuildVariantSource(const std::string& source, uint64_t variantKey) const;
+		std::unique_ptr<IShader> Compile(const std::string& source);
+
+		ShaderFactory m_factory;												// Creates the shaders.
+		SourceLoader m_loader;													// Loads source files.
+		ThreadPool* m_threadPool;												// Pool on which variants are precompiled.
+		ShaderBinaryCache* m_binaryCache;										// Persistent cache of compiled variants, nullptr to always compile from source.
+		std::vector<KeywordSet> m_keywordSets;									// All declared keyword sets.
+		std::unordered_map<std::string, SourceNode> m_sources;					// Expanded sources by file path.
+		std::unordered_map<VariantId, std::unique_ptr<IShader>, VariantIdHasher> m_variants;	// Compiled variants.
+		mutable std::mutex m_mutex;												// Guards the sources and variants.
+		unsigned long long m_hits;												// The amount of GetVariant() calls that returned a compiled variant.
+	};
+}
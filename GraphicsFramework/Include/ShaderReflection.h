@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Structures/ShaderAttribute.h"
+#include "Structures/ShaderParameter.h"
+#include "Structures/ShaderParameterHandle.h"
+
+namespace GFW
+{
+	/**
+	 * \brief Reflection of a linked shader program, computed once at link time and immutable afterwards, so IShader implementations
+	 * can return it by reference instead of building new vectors on every query.
+	 * Parameters are stored as flat arrays of types and locations, their names are interned into one buffer and looked up with a perfect hash
+	 * of their ShaderParameterName hash. The index of a parameter is its ShaderParameterHandle.
+	 */
+	class ShaderReflection
+	{
+	public:
+		ShaderReflection();
+
+		void Create(vector<ShaderAttribute> attributes, const vector<ShaderParameter>& parameters);
+
+		const vector<ShaderAttribute>& GetAttributes() const;
+		int GetParameterCount() const;
+		const char* GetParameterName(int index) const;
+		ShaderParameterType GetParameterType(int index) const;
+		int GetParameterLocation(int index) const;
+		const vector<ShaderParameterType>& GetParameterTypes() const;
+		const vector<int>& GetParameterLocations() const;
+
+		int FindParameter(const string& name) const;
+		int FindParameter(ShaderParameterName name) const;
+
+	private:
+		int FindSlot(uint32_t hash) const;
+		void BuildPerfectHash();
+
+		vector<ShaderAttribute> m_attributes;	// All attributes of the program.
+		vector<ShaderParameterType> m_types;	// Type of every parameter.
+		vector<int> m_locations;				// Location or binding point of every parameter.
+		vector<char> m_names;					// Null terminated names of all parameters.
+		vector<uint32_t> m_nameOffsets;			// Offset of the name of every parameter in m_names.
+		vector<uint32_t> m_nameHashes;			// ShaderParameterName hash of every parameter.
+		vector<uint32_t> m_seeds;				// Displacement seed of every bucket of the perfect hash.
+		vector<int> m_slots;					// Parameter index in every slot of the perfect hash, -1 for empty slots.
+		bool m_hashCollisions;					// If parameters with equal name hashes were left out of the perfect hash.
+	};
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+// GFW_SSE2 is defined when SSE2 intrinsics can be used. Code using them should keep a scalar fallback.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GFW_SSE2
+#include <emmintrin.h>
+#endif
+
+// GFW_AVX2 is defined when AVX2 code can be compiled next to the SSE2 code, in translation units of its own. It may only run when IsAvx2Supported() is true.
+#if defined(GFW_SSE2) && (defined(_MSC_VER) || defined(__GNUC__))
+#define GFW_AVX2
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// GFW_FORCEINLINE makes sure small functions working on SIMD values are inlined, so the values stay in registers instead of going through memory.
+#if defined(_MSC_VER)
+#define GFW_FORCEINLINE __forceinline
+#else
+#define GFW_FORCEINLINE inline __attribute__((always_inline))
+#endif
+
+#ifdef GFW_AVX2
+namespace GFW
+{
+	/**
+	 * \return True if the CPU supports AVX2 and the operating system saves the AVX registers. Only checked on the first call.
+	 */
+	inline bool IsAvx2Supported()
+	{
+#if defined(_MSC_VER)
+		static const bool supported = []()
+		{
+			int info[4];
+			__cpuid(info, 0);
+			if(info[0] < 7)
+				return false;
+			__cpuid(info, 1);
+			if((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0 || (_xgetbv(0) & 6) != 6)
+				return false;
+			__cpuidex(info, 7, 0);
+			return (info[1] & (1 << 5)) != 0;
+		}();
+#else
+		static const bool supported = __builtin_cpu_supports("avx2") != 0;
+#endif
+		return supported;
+	}
+}
+#endif
@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+
+namespace GFW
+{
+	/**
+	 * \brief FNV-1a hash of a null terminated shader parameter name. Written as a single recursive return statement so it can be evaluated at compile time.
+	 * \param name The name to hash.
+	 * \param hash The hash of the characters before @name.
+	 * \return The 32 bit FNV-1a hash of @name.
+	 */
+	constexpr uint32_t HashShaderParameterName(const char* name, uint32_t hash = 2166136261u)
+	{
+		return *name ? HashShaderParameterName(name + 1, (hash ^ uint32_t(static_cast<unsigned char>(*name))) * 16777619u) : hash;
+	}
+
+	/**
+	 * \brief Shader parameter name reduced to its hash. Constructing it from a literal in a constexpr context resolves the hash at compile time.
+	 */
+	struct ShaderParameterName
+	{
+		explicit constexpr ShaderParameterName(const char* name) : hash(HashShaderParameterName(name))
+		{
+		}
+
+		uint32_t hash;	// FNV-1a hash of the name
+	};
+
+	/**
+	 * \brief Small integer that identifies a shader parameter of one shader program, returned by IShader::GetParameterHandle().
+	 * Handles of different shader programs can't be mixed.
+	 */
+	struct ShaderParameterHandle
+	{
+		constexpr ShaderParameterHandle() : index(-1)
+		{
+		}
+
+		explicit constexpr ShaderParameterHandle(int index) : index(index)
+		{
+		}
+
+		constexpr bool IsValid() const
+		{
+			return index >= 0;
+		}
+
+		constexpr bool operator==(const ShaderParameterHandle& other) const
+		{
+			return index == other.index;
+		}
+
+		constexpr bool operator!=(const ShaderParameterHandle& other) const
+		{
+			return index != other.index;
+		}
+
+		int index;	// Index of the parameter in the shader program, -1 if the parameter doesn't exist
+	};
+}
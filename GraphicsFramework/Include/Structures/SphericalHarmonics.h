@@ -0,0 +1,15 @@
+#pragma once
+#include "Math.h"
+
+namespace GFW
+{
+	/**
+	 * \brief Struct with the RGB coefficients of a function on the sphere projected onto real spherical harmonics, like the irradiance of a light probe.
+	 * Order 2 uses the first 4 coefficients (bands 0 and 1), order 3 uses all 9 (bands 0 to 2). Coefficients are ordered by band, then from m = -l to m = l.
+	 */
+	struct SphericalHarmonics
+	{
+		int order = 3;					// The amount of bands, 2 or 3
+		Math::Vec3 coefficients[9];		// The coefficients of every basis function, unused coefficients are 0
+	};
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include "Interfaces/ITexture.h"
+
+namespace GFW
+{
+	/**
+	 * \brief Struct that describes the layout of a texture and its mipmap chain.
+	 * A texture consists of @levels mipmap levels, every level consists of @layers * @faces slices and every slice is a 1D, 2D or 3D image.
+	 */
+	struct TextureDescription
+	{
+		TextureFormat format = TextureFormat::RGBA8;				// The format of the texture
+		TextureDataType type = TextureDataType::GL_UNSIGNED_BYTE;	// The type of the pixel data
+		int width = 1;												// The width of the base level
+		int height = 1;												// The height of the base level. 1 for 1D textures
+		int depth = 1;												// The depth of the base level. 1 for anything but 3D textures
+		int layers = 1;												// The amount of array layers. 1 for textures that aren't arrays
+		int faces = 1;												// 6 for cubemaps, 1 otherwise
+		int levels = 1;												// The amount of mipmap levels, including the base level
+	};
+}
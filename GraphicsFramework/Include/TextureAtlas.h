@@ -0,0 +1,79 @@
+#pragma once
+#include <vector>
+#include "Math.h"
+#include "Interfaces/ITexture.h"
+
+namespace GFW
+{
+	using namespace Math;
+
+	/**
+	 * \brief Struct that stores where an image is placed in a texture atlas.
+	 */
+	struct TextureAtlasRegion
+	{
+		int layer;		// The array layer the image is placed in
+		int x;			// The horizontal offset of the image in pixels
+		int y;			// The vertical offset of the image in pixels
+		int width;		// The width of the image in pixels
+		int height;		// The height of the image in pixels
+		Vec4 uvRect;	// The texture coordinates of the image as (u min, v min, u max, v max)
+	};
+
+	/**
+	 * \brief This class packs many small images into the layers of a single 2D texture array, so they can be drawn without switching textures.
+	 * Images are placed with a MaxRects packer and uploaded with UpdateTexture(). Layers are added when the atlas is full.
+	 * A copy of every image is kept on the CPU so images can be moved by Repack() and the texture can be recreated when the layer count changes.
+	 */
+	class TextureAtlas
+	{
+	public:
+		TextureAtlas(ITexture* texture, int width, int height, TextureFormat format, TextureDataType type, int padding = 1, int maxLayers = 16);
+
+		int Insert(int width, int height, const unsigned char* pixelData);
+		void Remove(int id);
+		bool GetRegion(int id, TextureAtlasRegion& region) const;
+		int Repack(int maxMoves);
+
+		int GetLayerCount() const;
+		int GetEntryCount() const;
+		float GetOccupancy() const;
+		float GetFragmentation() const;
+
+	private:
+		struct Rect
+		{
+			int x, y, width, height;
+		};
+
+		struct Entry
+		{
+			bool used = false;					// If this entry holds an image.
+			int layer = 0;						// The layer the image is placed in.
+			Rect rect = {};						// The area the image occupies, including padding.
+			std::vector<unsigned char> pixels;	// Copy of the pixel data of the image.
+		};
+
+		bool FindPosition(int width, int height, int firstLayer, int lastLayer, int& layer, Rect& rect) const;
+		void Occupy(int layer, const Rect& rect);
+		void Release(int layer, const Rect& rect);
+		void PruneFreeRects(int layer);
+		void Upload(Entry& entry);
+		void ResizeLayers(int layers);
+
+		ITexture* m_texture;						// The 2D texture array the images are packed into.
+		int m_width;								// The width of every layer.
+		int m_height;								// The height of every layer.
+		TextureFormat m_format;						// The format of the texture.
+		TextureDataType m_type;						// The type of the pixel data of the images.
+		int m_pixelSize;							// The size in bytes of a pixel of the images.
+		int m_padding;								// The border kept around every image to prevent filtering from bleeding into neighbours. Filled with the edge pixels of the image.
+		int m_maxLayers;							// The maximum amount of layers the atlas can grow to.
+
+		std::vector<std::vector<Rect>> m_freeRects;	// Maximal free rectangles of every layer.
+		std::vector<Entry> m_entries;				// All entries, indexed by id.
+		std::vector<int> m_freeIds;					// Ids of unused entries.
+		long long m_usedArea;						// The sum of the areas of all images, excluding padding.
+		std::vector<unsigned char> m_uploadBuffer;	// Scratch buffer for an image with its padding filled in. Reused by every upload.
+	};
+}
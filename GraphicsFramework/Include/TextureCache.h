@@ -0,0 +1,75 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include "Interfaces/IImageDecoder.h"
+#include "Interfaces/ITexture.h"
+#include "Structures/TextureDescription.h"
+#include "ThreadPool.h"
+
+namespace GFW
+{
+	/**
+	 * \brief 128 bit hash of the contents of a texture.
+	 */
+	struct TextureHash
+	{
+		uint64_t low = 0;	// The lower 64 bits
+		uint64_t high = 0;	// The upper 64 bits
+
+		bool operator==(const TextureHash& other) const { return low == other.low && high == other.high; }
+		bool operator!=(const TextureHash& other) const { return !(*this == other); }
+	};
+
+	/**
+	 * \brief This class shares textures with identical contents. Textures are keyed by a hash of their pixel data, format, data type and dimensions,
+	 * so the same image loaded from different paths or uploaded twice only gets created once. Every Create() call returns a reference that must be released with Release().
+	 * Large images are hashed in chunks on a thread pool. Textures are created on the calling thread, so the cache should be used from the thread that owns the context.
+	 */
+	class TextureCache
+	{
+	public:
+		typedef std::function<std::unique_ptr<ITexture>()> TextureFactory;	// Creates an empty texture of the graphics API that's used.
+
+		TextureCache(TextureFactory factory, IImageDecoder* decoder = nullptr, ThreadPool* threadPool = nullptr);
+
+		ITexture* Create(int width, int height, bool generateMipmaps, TextureFormat format, TextureDataType type, const unsigned char* pixelData);
+		ITexture* Create(int width, int height, int depth, bool generateMipmaps, TextureFormat format, TextureDataType type, const unsigned char* pixelData);
+		ITexture* CreateFromFile(const char* file, bool mipmaps);
+
+		void Acquire(ITexture* texture);
+		bool Release(ITexture* texture);
+
+		int GetTextureCount() const;
+		int GetReferenceCount(ITexture* texture) const;
+		unsigned long long GetHitCount() const;
+		uint64_t GetSavedSize() const;
+
+		static TextureHash ComputeHash(const TextureDescription& description, bool mipmaps, const unsigned char* const* slices, ThreadPool* threadPool = nullptr);
+
+	private:
+		struct Entry
+		{
+			std::unique_ptr<ITexture> texture;	// The shared texture.
+			int references;						// The amount of references handed out that aren't released yet.
+			uint64_t size;						// The storage size of the texture.
+		};
+
+		struct TextureHashHasher
+		{
+			size_t operator()(const TextureHash& hash) const { return size_t(hash.low ^ (hash.high * 0x9E3779B97F4A7C15ull)); }
+		};
+
+		ITexture* Find(const TextureHash& hash);
+		ITexture* Insert(const TextureHash& hash, std::unique_ptr<ITexture> texture, uint64_t size);
+
+		TextureFactory m_factory;											// Creates the textures.
+		IImageDecoder* m_decoder;											// Decoder for image files. Not owned by the cache, nullptr to only support DDS and KTX files.
+		ThreadPool* m_threadPool;											// Pool on which the pixel data is hashed.
+		std::unordered_map<TextureHash, Entry, TextureHashHasher> m_entries;	// All cached textures by the hash of their contents.
+		std::unordered_map<ITexture*, TextureHash> m_hashes;				// The hash of every cached texture.
+		unsigned long long m_hits;											// The amount of Create() calls that returned an existing texture.
+		uint64_t m_savedSize;												// Storage that's currently not allocated thanks to sharing.
+	};
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <cstdint>
+#include "Interfaces/ITexture.h"
+#include "Structures/TextureDescription.h"
+#include "MappedFile.h"
+
+namespace GFW
+{
+	/**
+	 * \brief Native texture file format of the framework. Textures exported with ITexture::Export() use this layout so they can be loaded again by ITexture::CreateFromFile().
+	 * The file starts with a fixed size header describing the texture followed by one blob per mipmap level. Every blob starts at a 4 KiB aligned offset and holds the
+	 * tightly packed, possibly compressed, slices of that level. Files are memory mapped when loaded so the slices are passed to the graphics API without copying or decoding.
+	 */
+	class TextureContainer
+	{
+	public:
+		static const int MAX_LEVELS = 32;			// The maximum amount of mipmap levels in a container.
+		static const uint64_t LEVEL_ALIGNMENT = 4096;	// The alignment of the level blobs in the file.
+
+		TextureContainer();
+
+		bool Open(const char* file);
+		void Close();
+
+		bool IsOpen() const;
+		const TextureDescription& GetDescription() const;
+		unsigned char* GetSliceData(int level, int slice) const;
+		uint64_t GetSliceSize(int level) const;
+		bool Upload(ITexture* texture, bool mipmaps) const;
+
+		static uint64_t GetContainerSize(const TextureDescription& description);
+		static bool Write(const TextureDescription& description, const unsigned char* const* slices, char* destination, uint64_t destinationSize);
+		static bool Save(const char* file, const TextureDescription& description, const unsigned char* const* slices);
+		static void UploadLevels(ITexture* texture, const TextureDescription& description, unsigned char* const* slices, bool mipmaps);
+
+	private:
+		MappedFile m_file;						// The mapped container file.
+		TextureDescription m_description;		// Description of the texture in the container.
+		uint64_t m_levelOffsets[MAX_LEVELS];	// Offset of every level blob from the start of the file.
+	};
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "Interfaces/ITexture.h"
+
+namespace GFW
+{
+	/**
+	 * \brief This class exports textures into reference counted blocks of memory that are reused once every reference to them is released.
+	 * After the first few exports no memory is allocated anymore, which keeps tools that export many textures per second from spending their time in the allocator.
+	 * The pool can be used from multiple threads. Blocks stay valid while a reference to them exists, even after the pool is destroyed.
+	 */
+	class TextureExportPool
+	{
+	public:
+		TextureExportPool();
+		~TextureExportPool();
+		TextureExportPool(const TextureExportPool&) = delete;
+		TextureExportPool& operator=(const TextureExportPool&) = delete;
+
+		std::shared_ptr<char> Export(ITexture* texture, int level, int layer, uint64_t& size);
+		std::shared_ptr<char> Acquire(uint64_t size);
+
+		void Trim();
+		uint64_t GetPooledSize();
+		unsigned long long GetAllocationCount();
+
+	private:
+		struct Block
+		{
+			char* data;					// The memory of the block.
+			uint64_t capacity;			// The size of the memory.
+		};
+
+		/**
+		 * \brief State shared between the pool and the blocks it handed out, so blocks can return themselves after the pool is destroyed.
+		 */
+		struct State
+		{
+			std::mutex mutex;						// Guards the rest of the state.
+			std::vector<Block> freeBlocks;			// Blocks that aren't checked out.
+			uint64_t pooledSize = 0;				// The total capacity of all blocks, free or checked out.
+			unsigned long long allocations = 0;		// The amount of blocks allocated so far.
+			bool open = true;						// Cleared when the pool is destroyed. Blocks returned afterwards are deleted.
+		};
+
+		/**
+		 * \brief Deleter of a checked out block. Hands the block back to the pool under its mutex, which orders the release before the next checkout.
+		 */
+		struct BlockReturner
+		{
+			std::shared_ptr<State> state;	// The state of the pool the block belongs to.
+			uint64_t capacity;				// The size of the block.
+
+			void operator()(char* data) const;
+		};
+
+		std::shared_ptr<State> m_state;		// The blocks of the pool. Also referenced by every checked out block.
+	};
+}
@@ -0,0 +1,94 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "Interfaces/IImageDecoder.h"
+#include "ThreadPool.h"
+
+namespace GFW
+{
+	/**
+	 * \brief Enum with the stages an asynchronous texture load goes through.
+	 */
+	enum class TextureLoadState
+	{
+		QUEUED/*Waiting for a worker thread to decode the file.*/,
+		DECODING/*A worker thread is decoding the file and generating the mipmaps.*/,
+		UPLOADING/*The file is decoded and the mipmap levels are uploaded, starting with the smallest level.*/,
+		COMPLETE/*All mipmap levels are uploaded.*/,
+		FAILED/*The file couldn't be decoded.*/,
+		CANCELLED/*The load was cancelled before it completed.*/
+	};
+
+	/**
+	 * \brief Progress of a single asynchronous texture load. Returned by TextureLoader::CreateFromFileAsync().
+	 */
+	class TextureLoadRequest
+	{
+	public:
+		TextureLoadState GetState() const;
+		ITexture* GetTexture() const;
+		const std::string& GetFile() const;
+		int GetPriority() const;
+		int GetLevelCount() const;
+		int GetFinestUploadedLevel() const;
+
+	private:
+		friend class TextureLoader;
+
+		TextureLoadRequest(ITexture* texture, const char* file, bool mipmaps, int priority);
+
+		ITexture* m_texture;						// The texture that is being loaded.
+		std::string m_file;							// The file to load the texture from.
+		bool m_mipmaps;								// If mipmaps should be generated and uploaded.
+		std::atomic<int> m_priority;				// Requests with a higher priority are decoded and uploaded first.
+		std::atomic<TextureLoadState> m_state;		// The current stage of the load.
+
+		int m_width;								// The width of the decoded image. Written by the decoding worker before the request is handed over under the loader's mutex.
+		int m_height;								// The height of the decoded image. Written by the decoding worker before the request is handed over under the loader's mutex.
+		TextureFormat m_format;						// The format of the decoded image.
+		TextureDataType m_type;						// The type of the decoded pixel data.
+		std::vector<std::vector<unsigned char>> m_levels;	// Decoded pixel data per mipmap level. Released once uploaded.
+		std::atomic<int> m_levelCount;				// The amount of mipmap levels that will be uploaded. Published once all levels are generated.
+		std::atomic<int> m_finestUploadedLevel;		// The finest mipmap level uploaded so far. -1 when nothing is uploaded yet.
+	};
+
+	typedef std::shared_ptr<TextureLoadRequest> TextureLoadHandle;
+
+	/**
+	 * \brief This class loads textures from files without stalling the thread that owns the context.
+	 * Files are decoded and mipmapped on a thread pool. The mipmap levels are then uploaded from smallest to largest by ProcessUploads(),
+	 * which makes the texture usable at a low resolution long before the full resolution is available.
+	 */
+	class TextureLoader
+	{
+	public:
+		TextureLoader(IImageDecoder* decoder, ThreadPool* threadPool = nullptr);
+		~TextureLoader();
+
+		TextureLoadHandle CreateFromFileAsync(ITexture* texture, const char* file, bool mipmaps, int priority = 0);
+		void SetPriority(const TextureLoadHandle& handle, int priority);
+		void Cancel(const TextureLoadHandle& handle);
+
+		int ProcessUploads(int maxLevels);
+		bool IsIdle();
+
+	private:
+		void DecodeNext();
+		TextureLoadHandle PopHighestPriority(std::vector<TextureLoadHandle>& requests);
+
+		IImageDecoder* m_decoder;					// Decoder used to decode the files. Not owned by the loader.
+		ThreadPool* m_threadPool;					// Pool on which the files are decoded.
+
+		std::mutex m_mutex;							// Guards the queued and decoded requests.
+		std::condition_variable m_tasksFinished;	// Signaled when the last running decode task finishes.
+		std::vector<TextureLoadHandle> m_queued;	// Requests waiting to be decoded.
+		std::vector<TextureLoadHandle> m_decoded;	// Requests that are decoded and wait to be picked up by ProcessUploads().
+		int m_activeTasks;							// The amount of decode tasks that are submitted but haven't finished.
+
+		std::vector<TextureLoadHandle> m_uploading;	// Requests that are being uploaded. Only accessed on the thread calling ProcessUploads().
+	};
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <cstdint>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Interfaces/ITextureResidencyHandler.h"
+#include "Structures/TextureDescription.h"
+
+namespace GFW
+{
+	/**
+	 * \brief This class keeps the memory used by textures within a budget. The cost of every texture is calculated from its description.
+	 * When the budget is exceeded the finest mipmap levels of the least recently used textures are released, and they're restored as soon as the texture is used again.
+	 * Textures are ordered by their last use so finding the texture to evict takes O(log n).
+	 */
+	class TextureResidencyManager
+	{
+	public:
+		TextureResidencyManager(ITextureResidencyHandler* handler, uint64_t budget);
+
+		void Register(ITexture* texture, const TextureDescription& description);
+		void Unregister(ITexture* texture);
+
+		void NextFrame();
+		void Touch(ITexture* texture, int requiredLevel = 0);
+		int Enforce();
+
+		void SetBudget(uint64_t budget);
+		uint64_t GetBudget() const;
+		uint64_t GetResidentSize() const;
+		uint64_t GetRequestedSize() const;
+		float GetPressure() const;
+		unsigned long long GetEvictedLevelCount() const;
+		unsigned long long GetRestoredLevelCount() const;
+
+		int GetFirstResidentLevel(ITexture* texture) const;
+		uint64_t GetResidentSize(ITexture* texture) const;
+
+	private:
+		typedef std::pair<unsigned long long, ITexture*> LruKey;
+
+		struct Record
+		{
+			std::vector<uint64_t> sizeFromLevel;	// The size of the texture when the levels from the index onwards are resident.
+			int firstResidentLevel = 0;				// The finest mipmap level that is resident.
+			unsigned long long lastUse = 0;			// The frame the texture was last used in.
+		};
+
+		void SetResidentLevels(ITexture* texture, Record& record, int firstLevel);
+
+		ITextureResidencyHandler* m_handler;				// Handler that releases and restores the mipmap levels. Not owned by the manager.
+		uint64_t m_budget;									// The maximum amount of bytes the textures may use.
+		uint64_t m_residentSize;							// The amount of bytes the resident levels of all textures use.
+		uint64_t m_requestedSize;							// The amount of bytes all textures would use with all their levels resident.
+		unsigned long long m_frame;							// The current frame.
+		unsigned long long m_evictedLevels;					// The amount of mipmap levels released so far.
+		unsigned long long m_restoredLevels;				// The amount of mipmap levels restored so far.
+
+		std::unordered_map<ITexture*, Record> m_records;	// Residency information of every registered texture.
+		std::set<LruKey> m_evictable;						// Textures with levels that can be released, ordered by last use.
+	};
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+
+namespace GFW
+{
+	/**
+	 * \brief Enum with memory layouts for CPU side texel data.
+	 * LINEAR stores the texels row by row. TILED_4X4 and TILED_8X8 store square tiles of texels after each other, with the texels of a tile row by row,
+	 * 3D textures are stored slice by slice. MORTON stores the texels in Z-order by interleaving the bits of the coordinates, for 2D and 3D.
+	 * Tiled layouts pad the dimensions to a multiple of the tile size, MORTON pads them to a power of two.
+	 */
+	enum class TextureLayout
+	{
+		LINEAR,
+		TILED_4X4,
+		TILED_8X8,
+		MORTON
+	};
+
+	/**
+	 * \brief Helper functions to convert CPU side texel data between linear and cache friendly layouts, so neighbouring texels in all directions are close in memory.
+	 * Texels are copied as opaque values of pixelSize bytes, so every format and data type is supported except compressed formats.
+	 */
+	namespace TextureSwizzle
+	{
+		uint64_t GetLayoutSize(TextureLayout layout, int pixelSize, int width, int height, int depth = 1);
+		uint64_t GetTexelIndex(TextureLayout layout, int width, int height, int depth, int x, int y, int z = 0);
+
+		void Swizzle(TextureLayout layout, int pixelSize, int width, int height, int depth, const unsigned char* source, unsigned char* destination);
+		void Swizzle(TextureLayout layout, int pixelSize, int width, int height, int depth, int x, int y, int z, int regionWidth, int regionHeight, int regionDepth,
+			const unsigned char* source, unsigned char* destination);
+		void Unswizzle(TextureLayout layout, int pixelSize, int width, int height, int depth, const unsigned char* source, unsigned char* destination);
+		void Unswizzle(TextureLayout layout, int pixelSize, int width, int height, int depth, int x, int y, int z, int regionWidth, int regionHeight, int regionDepth,
+			const unsigned char* source, unsigned char* destination);
+	}
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+#include "Interfaces/ITexture.h"
+
+namespace GFW
+{
+	/**
+	 * \brief Helper functions to reason about texture formats, texture sizes and mipmap chains without a graphics API.
+	 * Sizes of client side pixel data depend on the TextureDataType, sizes of the storage used by the API depend on the TextureFormat.
+	 */
+	namespace TextureUtilities
+	{
+		bool IsCompressed(TextureFormat format);
+		bool IsDepthOrStencil(TextureFormat format);
+		bool IsInteger(TextureFormat format);
+		int GetChannelCount(TextureFormat format);
+		int GetBytesPerPixel(TextureFormat format);
+		int GetCompressedBlockSize(TextureFormat format);
+		TextureDataType GetDefaultDataType(TextureFormat format);
+
+		int GetDataTypeSize(TextureDataType type);
+		int GetPixelSize(TextureFormat format, TextureDataType type);
+		int GetSampleCount(TextureMultisampleCount sampleCount);
+
+		int GetMipmapCount(int width, int height = 1, int depth = 1);
+		int GetMipmapDimension(int dimension, int level);
+
+		uint64_t GetRowSize(TextureFormat format, TextureDataType type, int width);
+		uint64_t GetDataSize(TextureFormat format, TextureDataType type, int width, int height, int depth = 1);
+		uint64_t GetStorageSize(TextureFormat format, int width, int height, int depth = 1);
+		uint64_t GetStorageSize(TextureFormat format, int width, int height, int depth, int layers, int levels);
+
+		void CopyPitched(const unsigned char* source, uint64_t sourceRowPitch, uint64_t sourceSlicePitch, unsigned char* destination, uint64_t destinationRowPitch,
+			uint64_t destinationSlicePitch, uint64_t rowSize, int rows, int slices = 1);
+
+		uint16_t FloatToHalf(float value);
+		float HalfToFloat(uint16_t value);
+		float ReadComponent(const unsigned char* data, TextureDataType type, size_t index);
+
+		bool GenerateMipmap(TextureFormat format, TextureDataType type, const unsigned char* source, int width, int height, unsigned char* destination);
+	}
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace GFW
+{
+	/**
+	 * \brief Pool of worker threads that executes submitted tasks in order of priority. Tasks with the same priority are executed in the order they were submitted.
+	 * Used by the framework for work that shouldn't stall the thread that owns the graphics context, like decoding and filtering texture data.
+	 */
+	class ThreadPool
+	{
+	public:
+		ThreadPool(unsigned threadCount = 0);
+		~ThreadPool();
+
+		void Submit(std::function<void()> task, int priority = 0);
+		void ParallelFor(int begin, int end, const std::function<void(int, int)>& body, int grainSize = 1);
+
+		unsigned GetThreadCount() const;
+
+		static ThreadPool& GetDefault();
+
+	private:
+		void WorkerLoop();
+
+		struct Task
+		{
+			std::function<void()> function;	// The function to execute.
+			int priority;					// Tasks with a higher priority are executed first.
+			unsigned long long order;		// Submission order, used to keep tasks with equal priority first in first out.
+		};
+
+		struct TaskCompare
+		{
+			bool operator()(const Task& a, const Task& b) const
+			{
+				return a.priority != b.priority ? a.priority < b.priority : a.order > b.order;
+			}
+		};
+
+		std::vector<std::thread> m_threads;									// The worker threads.
+		std::priority_queue<Task, std::vector<Task>, TaskCompare> m_tasks;	// Tasks waiting to be executed.
+		std::mutex m_mutex;													// Guards the task queue.
+		std::condition_variable m_condition;								// Signaled when a task is submitted or the pool is stopping.
+		unsigned long long m_submitted;										// The number of tasks submitted so far.
+		bool m_stopping;													// Set when the pool is being destroyed.
+	};
+}
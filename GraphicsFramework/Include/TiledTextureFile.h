@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include "Structures/TextureDescription.h"
+#include "MappedFile.h"
+
+namespace GFW
+{
+	/**
+	 * \brief File format that stores every mipmap level of a 2D texture as a grid of equally sized square tiles. Used as the source of a VirtualTexture.
+	 * Every tile is surrounded by a border of pixels copied from its neighbours, so tiles can be filtered without seams once they're placed in a tile cache.
+	 * Tiles are stored at 4 KiB aligned offsets, level by level and row by row, and are read straight from the memory mapped file.
+	 */
+	class TiledTextureFile
+	{
+	public:
+		static const int MAX_LEVELS = 16;	// The maximum amount of mipmap levels in a tiled file.
+
+		/**
+		 * \brief Function that reads a region of a mipmap level of the source texture as tightly packed pixel data.
+		 */
+		typedef std::function<void(int level, int x, int y, int width, int height, unsigned char* destination)> RegionReader;
+
+		TiledTextureFile();
+
+		bool Open(const char* file);
+		void Close();
+
+		bool IsOpen() const;
+		const TextureDescription& GetDescription() const;
+		int GetTileSize() const;
+		int GetBorder() const;
+		int GetPaddedTileSize() const;
+		int GetTileCountX(int level) const;
+		int GetTileCountY(int level) const;
+		uint64_t GetTileDataSize() const;
+		const unsigned char* GetTileData(int level, int x, int y) const;
+
+		static bool Save(const char* file, const TextureDescription& description, int tileSize, int border, const RegionReader& readRegion);
+
+	private:
+		MappedFile m_file;							// The mapped tiled file.
+		TextureDescription m_description;			// Description of the texture in the file.
+		int m_tileSize;								// The size of a tile without its border.
+		int m_border;								// The width of the border around every tile.
+		uint64_t m_tileStride;						// The distance in bytes between consecutive tiles in the file.
+		uint64_t m_levelOffsets[MAX_LEVELS];		// Offset of the first tile of every level from the start of the file.
+	};
+}
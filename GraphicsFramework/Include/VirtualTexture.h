@@ -0,0 +1,91 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "Interfaces/ITexture.h"
+#include "TiledTextureFile.h"
+#include "ThreadPool.h"
+
+namespace GFW
+{
+	/**
+	 * \brief This class streams the tiles of a texture that's too large for memory into a fixed size tile cache.
+	 * The physical texture holds the resident tiles in a grid of slots. The page table texture has one RGBA8 texel per tile of every mipmap level,
+	 * storing the slot column (R), slot row (G) and mipmap level (B) of the tile that should be sampled for it. Tiles that aren't resident point to their
+	 * closest resident ancestor, and the coarsest level is always resident, so every lookup is valid. File levels coarser than the last page table mipmap
+	 * have a single tile and aren't stored in the page table, their entries reach it through the last mipmap.
+	 * Every frame the feedback of the renderer, the tiles it wanted to sample, is analyzed into load requests. Tiles are read on a thread pool and
+	 * uploaded by Update(), replacing the least recently used tiles once the cache is full. Memory use only depends on the cache size.
+	 */
+	class VirtualTexture
+	{
+	public:
+		VirtualTexture(ITexture* physicalTexture, ITexture* pageTable, int slotsX, int slotsY, ThreadPool* threadPool = nullptr);
+		~VirtualTexture();
+
+		bool Open(const char* file);
+
+		void AnalyzeFeedback(const uint32_t* feedback, int count);
+		int Update(int maxUploads);
+
+		const TiledTextureFile& GetFile() const;
+		int GetResidentTileCount() const;
+		int GetPendingTileCount();
+		unsigned long long GetCacheHits() const;
+		unsigned long long GetCacheMisses() const;
+
+		static uint32_t PackFeedback(int x, int y, int level);
+		static void UnpackFeedback(uint32_t feedback, int& x, int& y, int& level);
+
+		static const uint32_t FEEDBACK_NONE = 0xFFFFFFFF;	// Feedback value for pixels that didn't sample the virtual texture.
+
+	private:
+		struct Slot
+		{
+			uint32_t tile = FEEDBACK_NONE;		// The packed tile stored in this slot.
+			bool pinned = false;				// Pinned slots are never evicted.
+			std::list<int>::iterator lruPosition;	// Position of this slot in the LRU list.
+		};
+
+		struct LoadedTile
+		{
+			uint32_t tile;						// The packed tile that was read.
+			std::vector<unsigned char> pixels;	// The pixel data of the tile.
+		};
+
+		void RequestTile(uint32_t tile);
+		void Touch(int slot);
+		int AcquireSlot();
+		void PlaceTile(uint32_t tile, int slot, const unsigned char* pixels);
+		void EvictTile(int slot);
+		void RefreshPageTable(int level, int x, int y);
+		void UploadPageTable(int level, int x0, int y0, int x1, int y1);
+
+		ITexture* m_physicalTexture;						// Texture holding the resident tiles.
+		ITexture* m_pageTable;								// Texture mapping every tile to a slot in the physical texture.
+		int m_slotsX;										// The amount of slot columns in the physical texture.
+		int m_slotsY;										// The amount of slot rows in the physical texture.
+		ThreadPool* m_threadPool;							// Pool on which tiles are read.
+		TiledTextureFile m_file;							// The source of the tiles.
+
+		std::vector<Slot> m_slots;							// All slots of the physical texture.
+		std::list<int> m_lru;								// Slots ordered from most to least recently used.
+		std::vector<int> m_freeSlots;						// Slots that don't hold a tile.
+		std::unordered_map<uint32_t, int> m_residentTiles;	// Slot of every resident tile.
+		std::vector<std::vector<uint32_t>> m_pageEntries;	// CPU copy of the page table, per mipmap level of the file.
+		int m_pageTableLevels;								// The amount of mipmap levels of the page table texture. Can be less than the levels of the file.
+
+		std::mutex m_mutex;									// Guards the loaded tiles and the running loads.
+		std::condition_variable m_loadsFinished;			// Signaled when the last running load finishes.
+		std::unordered_set<uint32_t> m_pendingTiles;		// Tiles that are being read.
+		std::vector<LoadedTile> m_loadedTiles;				// Tiles that are read and wait to be uploaded.
+		int m_runningLoads;									// The amount of load tasks that haven't finished.
+
+		unsigned long long m_cacheHits;						// Requested tiles that were already resident.
+		unsigned long long m_cacheMisses;					// Requested tiles that had to be loaded.
+	};
+}
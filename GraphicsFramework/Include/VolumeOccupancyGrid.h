@@ -0,0 +1,58 @@
+#pragma once
+#include <vector>
+#include "Interfaces/ITexture.h"
+#include "Math.h"
+#include "ThreadPool.h"
+
+namespace GFW
+{
+	/**
+	 * \brief Multi-level min/max grid over a channel of a 3D texture to skip empty space while ray marching.
+	 * Every cell of level 0 stores the range of values of the texels it covers plus the texels one step beyond its edges, so it also bounds trilinear
+	 * interpolation inside the cell. Every next level halves the resolution until a single cell covers the volume. A ray only has to be marched where it
+	 * crosses cells whose range overlaps the values the transfer function doesn't map to transparent.
+	 * Volume coordinates are normalized, the volume covers [0, 1] on every axis like texture coordinates.
+	 */
+	class VolumeOccupancyGrid
+	{
+	public:
+		VolumeOccupancyGrid(int cellSize = 8);
+
+		bool Build(int width, int height, int depth, TextureFormat format, TextureDataType type, const unsigned char* pixelData, int channel = 0, ThreadPool* threadPool = nullptr);
+		void Refit(const unsigned char* pixelData, int x, int y, int z, int width, int height, int depth, ThreadPool* threadPool = nullptr);
+
+		bool IsOccupied(int level, int x, int y, int z, float minValue, float maxValue) const;
+		int FindOccupiedSegments(const Math::Vec3& origin, const Math::Vec3& direction, float minValue, float maxValue, std::vector<Math::Vec2>& segments) const;
+
+		bool Upload(ITexture* texture, int level) const;
+
+		int GetCellSize() const;
+		int GetLevelCount() const;
+		void GetLevelSize(int level, int& x, int& y, int& z) const;
+		const std::vector<Math::Vec2>& GetLevel(int level) const;
+
+	private:
+		struct Level
+		{
+			int width;						// The amount of cells along the width of the volume.
+			int height;						// The amount of cells along the height of the volume.
+			int depth;						// The amount of cells along the depth of the volume.
+			std::vector<Math::Vec2> ranges;	// The minimum (x) and maximum (y) value of every cell, x fastest.
+		};
+
+		void BuildCells(const unsigned char* pixelData, const Math::IVec3& first, const Math::IVec3& last, ThreadPool& threadPool);
+		void ReduceCells(int level, const Math::IVec3& first, const Math::IVec3& last);
+		void Traverse(int level, int x, int y, int z, const Math::Vec3& origin, const Math::Vec3& direction, float minValue, float maxValue,
+			std::vector<Math::Vec2>& segments) const;
+		bool IntersectCell(int level, int x, int y, int z, const Math::Vec3& origin, const Math::Vec3& direction, float& enter, float& exit) const;
+
+		int m_cellSize;				// The amount of texels along each axis of a level 0 cell.
+		int m_width;				// The width of the volume.
+		int m_height;				// The height of the volume.
+		int m_depth;				// The depth of the volume.
+		TextureFormat m_format;		// The format of the volume.
+		TextureDataType m_type;		// The type of the texel data.
+		int m_channel;				// The channel the ranges are built from.
+		std::vector<Level> m_levels;	// All levels, from finest to coarsest.
+	};
+}
@@ -0,0 +1,583 @@
+#include <BrickedVolume.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "Logging.h"
+#include "TextureUtilities.h"
+
+const uint32_t GFW::BrickedVolume::CONSTANT_BRICK;
+
+/**
+ * \param brickSize The amount of texels along each axis of a brick, 8 or 16. Smaller bricks elide more empty space, larger bricks need a smaller indirection table.
+ */
+GFW::BrickedVolume::BrickedVolume(int brickSize) : m_brickSize(brickSize), m_brickShift(brickSize == 16 ? 4 : 3), m_width(0), m_height(0), m_depth(0),
+	m_format(TextureFormat::R8), m_type(TextureDataType::GL_UNSIGNED_BYTE), m_pixelSize(1), m_bricksX(0), m_bricksY(0), m_bricksZ(0),
+	m_unusedPaletteEntries(0)
+{
+	GFW_ASSERT(brickSize == 8 || brickSize == 16);
+}
+
+/**
+ * \brief Initialize the volume from dense texel data, replacing the previous contents. Bricks are classified and copied into the pool in parallel.
+ * \param width The width of the volume.
+ * \param height The height of the volume.
+ * \param depth The depth of the volume.
+ * \param format The format of the volume. Compressed, depth, stencil and integer formats aren't supported.
+ * \param type The type of @pixelData. Unsigned bytes, unsigned shorts, floats and half floats are supported.
+ * \param pixelData Tightly packed texel data of the volume.
+ * \param threadPool The pool to classify the bricks on. nullptr to use the default thread pool.
+ * \return False if the format or type isn't supported.
+ */
+bool GFW::BrickedVolume::Create(int width, int height, int depth, TextureFormat format, TextureDataType type, const unsigned char* pixelData, ThreadPool* threadPool)
+{
+	GFW_ASSERT(width > 0 && height > 0 && depth > 0 && pixelData != nullptr);
+	if(TextureUtilities::IsCompressed(format) || TextureUtilities::IsDepthOrStencil(format) || TextureUtilities::IsInteger(format) ||
+		(type != TextureDataType::GL_UNSIGNED_BYTE && type != TextureDataType::GL_UNSIGNED_SHORT && type != TextureDataType::GL_FLOAT && type != TextureDataType::GL_HALF_FLOAT))
+		return false;
+
+	m_width = width;
+	m_height = height;
+	m_depth = depth;
+	m_format = format;
+	m_type = type;
+	m_pixelSize = TextureUtilities::GetPixelSize(format, type);
+	m_bricksX = (width + m_brickSize - 1) >> m_brickShift;
+	m_bricksY = (height + m_brickSize - 1) >> m_brickShift;
+	m_bricksZ = (depth + m_brickSize - 1) >> m_brickShift;
+	m_indirection.assign(size_t(m_bricksX) * m_bricksY * m_bricksZ, 0);
+	m_pool.clear();
+	m_freeSlots.clear();
+	m_palette.clear();
+	m_paletteIndices.clear();
+	m_paletteUses.clear();
+	m_unusedPaletteEntries = 0;
+
+	// Bricks are gathered once to find the constant ones, slots are then assigned in order and the other bricks are gathered straight into their slots.
+	const size_t brickBytes = size_t(m_brickSize) * m_brickSize * m_brickSize * m_pixelSize;
+	std::vector<unsigned char> constant(m_indirection.size());
+	ThreadPool& pool = threadPool ? *threadPool : ThreadPool::GetDefault();
+	pool.ParallelFor(0, m_bricksY * m_bricksZ, [&](int begin, int end)
+	{
+		std::vector<unsigned char> brick(brickBytes);
+		for(int row = begin; row < end; ++row)
+		{
+			for(int brickX = 0; brickX < m_bricksX; ++brickX)
+			{
+				GatherBrick(brickX, row % m_bricksY, row / m_bricksY, pixelData, brick.data());
+				constant[size_t(row) * m_bricksX + brickX] = IsConstant(brick.data()) ? 1 : 0;
+			}
+		}
+	});
+
+	uint32_t slotCount = 0;
+	for(size_t brick = 0; brick < m_indirection.size(); ++brick)
+	{
+		if(constant[brick])
+		{
+			const size_t x = size_t(brick % m_bricksX) << m_brickShift;
+			const size_t y = size_t(brick / m_bricksX % m_bricksY) << m_brickShift;
+			const size_t z = size_t(brick / m_bricksX / m_bricksY) << m_brickShift;
+			m_indirection[brick] = CONSTANT_BRICK | GetPaletteIndex(pixelData + ((z * m_height + y) * m_width + x) * m_pixelSize);
+		}
+		else
+			m_indirection[brick] = slotCount++;
+	}
+
+	m_pool.resize(brickBytes * slotCount);
+	pool.ParallelFor(0, m_bricksY * m_bricksZ, [&](int begin, int end)
+	{
+		for(int row = begin; row < end; ++row)
+		{
+			for(int brickX = 0; brickX < m_bricksX; ++brickX)
+			{
+				const uint32_t entry = m_indirection[size_t(row) * m_bricksX + brickX];
+				if(!(entry & CONSTANT_BRICK))
+					GatherBrick(brickX, row % m_bricksY, row / m_bricksY, pixelData, m_pool.data() + brickBytes * entry);
+			}
+		}
+	});
+	return true;
+}
+
+/**
+ * \brief Update a region of the volume. Only the bricks the region touches are reclassified, bricks that become constant release their slot and
+ * bricks that stop being constant get one. Released slots are reused by later updates, call Compact() to give them back.
+ * \param x The offset to start writing at in the width of the volume.
+ * \param y The offset to start writing at in the height of the volume.
+ * \param z The offset to start writing at in the depth of the volume.
+ * \param width The width in texels to write.
+ * \param height The height in texels to write.
+ * \param depth The depth in texels to write.
+ * \param pixelData Tightly packed texel data of the region, in the format and type the volume was created with.
+ */
+void GFW::BrickedVolume::UpdateTexture(int x, int y, int z, int width, int height, int depth, const unsigned char* pixelData)
+{
+	GFW_ASSERT(x >= 0 && y >= 0 && z >= 0 && width > 0 && height > 0 && depth > 0 && x + width <= m_width && y + height <= m_height && z + depth <= m_depth);
+	std::vector<unsigned char> brick(size_t(m_brickSize) * m_brickSize * m_brickSize * m_pixelSize);
+	for(int brickZ = z >> m_brickShift; brickZ <= (z + depth - 1) >> m_brickShift; ++brickZ)
+	{
+		for(int brickY = y >> m_brickShift; brickY <= (y + height - 1) >> m_brickShift; ++brickY)
+		{
+			for(int brickX = x >> m_brickShift; brickX <= (x + width - 1) >> m_brickShift; ++brickX)
+			{
+				ReadBrick(brickX, brickY, brickZ, brick.data());
+
+				// The overlap of the region and the brick in volume coordinates.
+				const int x0 = std::max(x, brickX << m_brickShift);
+				const int y0 = std::max(y, brickY << m_brickShift);
+				const int z0 = std::max(z, brickZ << m_brickShift);
+				const int x1 = std::min(x + width, (brickX + 1) << m_brickShift);
+				const int y1 = std::min(y + height, (brickY + 1) << m_brickShift);
+				const int z1 = std::min(z + depth, (brickZ + 1) << m_brickShift);
+				const int mask = m_brickSize - 1;
+				for(int texelZ = z0; texelZ < z1; ++texelZ)
+				{
+					for(int texelY = y0; texelY < y1; ++texelY)
+					{
+						const unsigned char* source = pixelData + ((size_t(texelZ - z) * height + (texelY - y)) * width + (x0 - x)) * m_pixelSize;
+						unsigned char* destination = brick.data() + ((size_t(texelZ & mask) * m_brickSize + (texelY & mask)) * m_brickSize + (x0 & mask)) * m_pixelSize;
+						memcpy(destination, source, size_t(x1 - x0) * m_pixelSize);
+					}
+				}
+
+				PadBrick(brickX, brickY, brickZ, brick.data());
+				StoreBrick(brickX, brickY, brickZ, brick.data());
+			}
+		}
+	}
+}
+
+/**
+ * \brief Give back the memory of slots and palette entries that updates freed. Bricks in slots past the occupied count move into the free slots below it,
+ * so the pool shrinks to the occupied bricks, and palette entries no brick uses are removed. Indirection entries are rewritten to match, so the volume
+ * has to be uploaded again afterwards.
+ */
+void GFW::BrickedVolume::Compact()
+{
+	const size_t brickBytes = size_t(m_brickSize) * m_brickSize * m_brickSize * m_pixelSize;
+	if(!m_freeSlots.empty())
+	{
+		// Free slots below the occupied count are holes, every brick above it moves into one of them.
+		const uint32_t occupied = uint32_t(GetOccupiedBrickCount());
+		std::vector<uint32_t> holes;
+		for(const uint32_t slot : m_freeSlots)
+		{
+			if(slot < occupied)
+				holes.push_back(slot);
+		}
+
+		for(uint32_t& entry : m_indirection)
+		{
+			if(!(entry & CONSTANT_BRICK) && entry >= occupied)
+			{
+				const uint32_t hole = holes.back();
+				holes.pop_back();
+				memcpy(m_pool.data() + brickBytes * hole, m_pool.data() + brickBytes * entry, brickBytes);
+				entry = hole;
+			}
+		}
+		GFW_ASSERT(holes.empty());
+
+		m_pool.resize(brickBytes * occupied);
+		m_pool.shrink_to_fit();
+		m_freeSlots.clear();
+		m_freeSlots.shrink_to_fit();
+	}
+
+	if(m_unusedPaletteEntries > 0)
+	{
+		std::vector<uint32_t> remap(m_paletteUses.size());
+		std::vector<unsigned char> palette;
+		std::vector<uint32_t> uses;
+		palette.reserve(m_palette.size() - size_t(m_unusedPaletteEntries) * m_pixelSize);
+		m_paletteIndices.clear();
+		for(size_t index = 0; index < m_paletteUses.size(); ++index)
+		{
+			if(m_paletteUses[index] == 0)
+				continue;
+
+			const unsigned char* value = m_palette.data() + index * m_pixelSize;
+			remap[index] = uint32_t(uses.size());
+			m_paletteIndices[std::vector<unsigned char>(value, value + m_pixelSize)] = remap[index];
+			palette.insert(palette.end(), value, value + m_pixelSize);
+			uses.push_back(m_paletteUses[index]);
+		}
+
+		for(uint32_t& entry : m_indirection)
+		{
+			if(entry & CONSTANT_BRICK)
+				entry = CONSTANT_BRICK | remap[entry & ~CONSTANT_BRICK];
+		}
+		m_palette.swap(palette);
+		m_paletteUses.swap(uses);
+		m_unusedPaletteEntries = 0;
+	}
+}
+
+/**
+ * \brief Read a single texel of the volume. Coordinates outside the volume are clamped to the edge.
+ * \param x The column of the texel.
+ * \param y The row of the texel.
+ * \param z The slice of the texel.
+ * \param result Output for every channel of the texel, normalized for unsigned bytes and shorts.
+ */
+void GFW::BrickedVolume::Fetch(int x, int y, int z, float* result) const
+{
+	const unsigned char* texel = GetTexel(std::min(std::max(x, 0), m_width - 1), std::min(std::max(y, 0), m_height - 1), std::min(std::max(z, 0), m_depth - 1));
+	const int channels = TextureUtilities::GetChannelCount(m_format);
+	for(int channel = 0; channel < channels; ++channel)
+		result[channel] = TextureUtilities::ReadComponent(texel, m_type, channel);
+}
+
+/**
+ * \brief Sample the volume with trilinear filtering and clamp to edge addressing, like a 3D texture with linear filtering.
+ * \param u The normalized horizontal coordinate.
+ * \param v The normalized vertical coordinate.
+ * \param w The normalized depth coordinate.
+ * \param result Output for every channel of the filtered value.
+ */
+void GFW::BrickedVolume::Sample(float u, float v, float w, float* result) const
+{
+	const float x = u * m_width - 0.5f;
+	const float y = v * m_height - 0.5f;
+	const float z = w * m_depth - 0.5f;
+	const float floorX = std::floor(x);
+	const float floorY = std::floor(y);
+	const float floorZ = std::floor(z);
+	const float weights[3] = { x - floorX, y - floorY, z - floorZ };
+	const int x0 = int(floorX);
+	const int y0 = int(floorY);
+	const int z0 = int(floorZ);
+
+	const int channels = TextureUtilities::GetChannelCount(m_format);
+	float corners[8][4];
+	for(int corner = 0; corner < 8; ++corner)
+		Fetch(x0 + (corner & 1), y0 + ((corner >> 1) & 1), z0 + (corner >> 2), corners[corner]);
+
+	for(int channel = 0; channel < channels; ++channel)
+	{
+		float values[4];
+		for(int edge = 0; edge < 4; ++edge)
+			values[edge] = corners[edge * 2][channel] + (corners[edge * 2 + 1][channel] - corners[edge * 2][channel]) * weights[0];
+		const float front = values[0] + (values[1] - values[0]) * weights[1];
+		const float back = values[2] + (values[3] - values[2]) * weights[1];
+		result[channel] = front + (back - front) * weights[2];
+	}
+}
+
+/**
+ * \brief Upload the bricked volume to textures for sampling on the GPU. The shader looks up the indirection entry of a brick and either reads the palette
+ * or the brick at slot (entry % poolX, entry / poolX % poolY, entry / (poolX * poolY)) of the pool, see GetPoolSize(). Every slot is GetPoolSlotSize() texels
+ * wide and holds the brick surrounded by a 1 texel apron of its neighbouring texels in the volume, the brick starts 1 texel into the slot. Hardware trilinear
+ * filtering of a position inside a brick therefore never reads a neighbouring slot. Freed slots and unused palette entries are uploaded as well, call Compact() first
+ * after updates to leave them out.
+ * \param brickPool Created as a 3D texture holding all slots.
+ * \param indirectionTable Created as an R32UI 3D texture with one entry per brick.
+ * \param palette Created as a 1D texture with the value of every constant brick.
+ * \return False if the volume isn't created.
+ */
+bool GFW::BrickedVolume::Upload(ITexture* brickPool, ITexture* indirectionTable, ITexture* palette) const
+{
+	GFW_ASSERT(brickPool && indirectionTable && palette);
+	if(m_indirection.empty())
+		return false;
+
+	int poolX;
+	int poolY;
+	int poolZ;
+	GetPoolSize(poolX, poolY, poolZ);
+	const int slotSize = GetPoolSlotSize();
+	const uint64_t rowPitch = uint64_t(slotSize) * m_pixelSize;
+	const uint64_t slicePitch = rowPitch * slotSize;
+	brickPool->Create(poolX * slotSize, poolY * slotSize, poolZ * slotSize, false, m_format, m_type, nullptr);
+
+	// The apron is read through the indirection table, so it also holds the texels of constant neighbours and repeats the edge of the volume outside it.
+	std::vector<unsigned char> slot(size_t(slicePitch) * slotSize);
+	for(int brickZ = 0; brickZ < m_bricksZ; ++brickZ)
+	{
+		for(int brickY = 0; brickY < m_bricksY; ++brickY)
+		{
+			for(int brickX = 0; brickX < m_bricksX; ++brickX)
+			{
+				const uint32_t entry = m_indirection[(size_t(brickZ) * m_bricksY + brickY) * m_bricksX + brickX];
+				if(entry & CONSTANT_BRICK)
+					continue;
+
+				unsigned char* texel = slot.data();
+				for(int z = 0; z < slotSize; ++z)
+				{
+					const int volumeZ = std::min(std::max((brickZ << m_brickShift) + z - 1, 0), m_depth - 1);
+					for(int y = 0; y < slotSize; ++y)
+					{
+						const int volumeY = std::min(std::max((brickY << m_brickShift) + y - 1, 0), m_height - 1);
+						for(int x = 0; x < slotSize; ++x, texel += m_pixelSize)
+						{
+							const int volumeX = std::min(std::max((brickX << m_brickShift) + x - 1, 0), m_width - 1);
+							memcpy(texel, GetTexel(volumeX, volumeY, volumeZ), size_t(m_pixelSize));
+						}
+					}
+				}
+				brickPool->UpdateTexture(int(entry) % poolX * slotSize, int(entry) / poolX % poolY * slotSize, int(entry) / (poolX * poolY) * slotSize,
+					slotSize, slotSize, slotSize, 0, m_format, m_type, slot.data(), rowPitch, slicePitch);
+			}
+		}
+	}
+
+	indirectionTable->Create(m_bricksX, m_bricksY, m_bricksZ, false, TextureFormat::R32UI, TextureDataType::GL_UNSIGNED_INT,
+		reinterpret_cast<const unsigned char*>(m_indirection.data()), uint64_t(m_bricksX) * 4, uint64_t(m_bricksX) * m_bricksY * 4);
+
+	// A volume without constant bricks still gets a palette texture so it can always be bound.
+	std::vector<unsigned char> paletteData(m_palette);
+	paletteData.resize(std::max(paletteData.size(), size_t(m_pixelSize)));
+	palette->Create(int(paletteData.size()) / m_pixelSize, 1, false, m_format, m_type, paletteData.data(), uint64_t(paletteData.size()));
+	return true;
+}
+
+/**
+ * \return The amount of texels along each axis of a brick.
+ */
+int GFW::BrickedVolume::GetBrickSize() const
+{
+	return m_brickSize;
+}
+
+/**
+ * \brief Get the amount of bricks along every axis of the volume, which is also the size of the indirection table.
+ */
+void GFW::BrickedVolume::GetBrickCount(int& x, int& y, int& z) const
+{
+	x = m_bricksX;
+	y = m_bricksY;
+	z = m_bricksZ;
+}
+
+/**
+ * \brief Get the amount of slots along every axis of the pool texture created by Upload(). The slots are laid out as a cube that grows along the depth.
+ */
+void GFW::BrickedVolume::GetPoolSize(int& x, int& y, int& z) const
+{
+	const int slotCount = int(m_pool.size() / (size_t(m_brickSize) * m_brickSize * m_brickSize * m_pixelSize));
+	int side = 1;
+	while(side * side * side < slotCount)
+		++side;
+	x = side;
+	y = side;
+	z = std::max(1, (slotCount + side * side - 1) / (side * side));
+}
+
+/**
+ * \return The amount of texels along each axis of a slot in the pool texture created by Upload(), the brick size plus a 1 texel apron on both sides.
+ */
+int GFW::BrickedVolume::GetPoolSlotSize() const
+{
+	return m_brickSize + 2;
+}
+
+/**
+ * \return The amount of bricks that aren't constant and occupy a slot.
+ */
+int GFW::BrickedVolume::GetOccupiedBrickCount() const
+{
+	return int(m_pool.size() / (size_t(m_brickSize) * m_brickSize * m_brickSize * m_pixelSize) - m_freeSlots.size());
+}
+
+/**
+ * \return The entry of every brick, x fastest. See CONSTANT_BRICK.
+ */
+const std::vector<uint32_t>& GFW::BrickedVolume::GetIndirectionTable() const
+{
+	return m_indirection;
+}
+
+/**
+ * \return The size in bytes the volume would take as a dense 3D texture.
+ */
+uint64_t GFW::BrickedVolume::GetDenseSize() const
+{
+	return uint64_t(m_width) * m_height * m_depth * m_pixelSize;
+}
+
+/**
+ * \return The size in bytes of the occupied slots of the pool, the indirection table and the palette entries in use. Freed slots and unused palette entries
+ * aren't counted, Compact() releases them.
+ */
+uint64_t GFW::BrickedVolume::GetBrickedSize() const
+{
+	const uint64_t brickBytes = uint64_t(m_brickSize) * m_brickSize * m_brickSize * m_pixelSize;
+	return uint64_t(GetOccupiedBrickCount()) * brickBytes + m_indirection.size() * sizeof(uint32_t) +
+		(m_palette.size() / m_pixelSize - m_unusedPaletteEntries) * uint64_t(m_pixelSize);
+}
+
+/**
+ * \return The dense size divided by the bricked size. Higher is better, below 1 the volume is too dense to benefit from bricking.
+ */
+float GFW::BrickedVolume::GetCompressionRatio() const
+{
+	const uint64_t brickedSize = GetBrickedSize();
+	return brickedSize ? float(double(GetDenseSize()) / double(brickedSize)) : 0.0f;
+}
+
+/**
+ * \return The indirection entry of a brick.
+ */
+uint32_t& GFW::BrickedVolume::GetEntry(int brickX, int brickY, int brickZ)
+{
+	return m_indirection[(size_t(brickZ) * m_bricksY + brickY) * m_bricksX + brickX];
+}
+
+/**
+ * \return Pointer to a texel inside the volume, in the pool or the palette.
+ */
+const unsigned char* GFW::BrickedVolume::GetTexel(int x, int y, int z) const
+{
+	const uint32_t entry = m_indirection[(size_t(z >> m_brickShift) * m_bricksY + (y >> m_brickShift)) * m_bricksX + (x >> m_brickShift)];
+	if(entry & CONSTANT_BRICK)
+		return m_palette.data() + size_t(entry & ~CONSTANT_BRICK) * m_pixelSize;
+
+	const int mask = m_brickSize - 1;
+	const size_t texel = ((size_t(entry) * m_brickSize + (z & mask)) * m_brickSize + (y & mask)) * m_brickSize + (x & mask);
+	return m_pool.data() + texel * m_pixelSize;
+}
+
+/**
+ * \brief Copy a brick out of dense texel data. Texels outside the volume repeat the nearest texel inside it.
+ */
+void GFW::BrickedVolume::GatherBrick(int brickX, int brickY, int brickZ, const unsigned char* pixelData, unsigned char* brick) const
+{
+	const int x = brickX << m_brickShift;
+	const size_t validBytes = size_t(std::min(m_brickSize, m_width - x)) * m_pixelSize;
+	const size_t rowBytes = size_t(m_brickSize) * m_pixelSize;
+	for(int localZ = 0; localZ < m_brickSize; ++localZ)
+	{
+		const int z = std::min((brickZ << m_brickShift) + localZ, m_depth - 1);
+		for(int localY = 0; localY < m_brickSize; ++localY)
+		{
+			const int y = std::min((brickY << m_brickShift) + localY, m_height - 1);
+			unsigned char* row = brick + (size_t(localZ) * m_brickSize + localY) * rowBytes;
+			memcpy(row, pixelData + ((size_t(z) * m_height + y) * m_width + x) * m_pixelSize, validBytes);
+			for(size_t padding = validBytes; padding < rowBytes; padding += m_pixelSize)
+				memcpy(row + padding, row + validBytes - m_pixelSize, size_t(m_pixelSize));
+		}
+	}
+}
+
+/**
+ * \brief Copy the current contents of a brick, from its slot or expanded from its constant value.
+ */
+void GFW::BrickedVolume::ReadBrick(int brickX, int brickY, int brickZ, unsigned char* brick) const
+{
+	const size_t brickBytes = size_t(m_brickSize) * m_brickSize * m_brickSize * m_pixelSize;
+	const uint32_t entry = m_indirection[(size_t(brickZ) * m_bricksY + brickY) * m_bricksX + brickX];
+	if(entry & CONSTANT_BRICK)
+	{
+		const unsigned char* value = m_palette.data() + size_t(entry & ~CONSTANT_BRICK) * m_pixelSize;
+		for(size_t offset = 0; offset < brickBytes; offset += m_pixelSize)
+			memcpy(brick + offset, value, size_t(m_pixelSize));
+	}
+	else
+		memcpy(brick, m_pool.data() + brickBytes * entry, brickBytes);
+}
+
+/**
+ * \brief Make the texels of an edge brick that fall outside the volume repeat the nearest texel inside it again.
+ */
+void GFW::BrickedVolume::PadBrick(int brickX, int brickY, int brickZ, unsigned char* brick) const
+{
+	const int validX = std::min(m_brickSize, m_width - (brickX << m_brickShift));
+	const int validY = std::min(m_brickSize, m_height - (brickY << m_brickShift));
+	const int validZ = std::min(m_brickSize, m_depth - (brickZ << m_brickShift));
+	if(validX == m_brickSize && validY == m_brickSize && validZ == m_brickSize)
+		return;
+
+	for(int z = 0; z < m_brickSize; ++z)
+	{
+		for(int y = 0; y < m_brickSize; ++y)
+		{
+			for(int x = 0; x < m_brickSize; ++x)
+			{
+				const int sourceX = std::min(x, validX - 1);
+				const int sourceY = std::min(y, validY - 1);
+				const int sourceZ = std::min(z, validZ - 1);
+				if(sourceX != x || sourceY != y || sourceZ != z)
+				{
+					memcpy(brick + ((size_t(z) * m_brickSize + y) * m_brickSize + x) * m_pixelSize,
+						brick + ((size_t(sourceZ) * m_brickSize + sourceY) * m_brickSize + sourceX) * m_pixelSize, size_t(m_pixelSize));
+				}
+			}
+		}
+	}
+}
+
+/**
+ * \return If every texel of a brick is the same. A brick is constant exactly when it equals itself shifted by one texel.
+ */
+bool GFW::BrickedVolume::IsConstant(const unsigned char* brick) const
+{
+	const size_t brickBytes = size_t(m_brickSize) * m_brickSize * m_brickSize * m_pixelSize;
+	return memcmp(brick, brick + m_pixelSize, brickBytes - m_pixelSize) == 0;
+}
+
+/**
+ * \return The palette index of a constant value for a brick that starts using it, added to the palette if it isn't in it yet.
+ */
+uint32_t GFW::BrickedVolume::GetPaletteIndex(const unsigned char* texel)
+{
+	const std::vector<unsigned char> value(texel, texel + m_pixelSize);
+	const auto index = m_paletteIndices.find(value);
+	if(index != m_paletteIndices.end())
+	{
+		if(m_paletteUses[index->second]++ == 0)
+			--m_unusedPaletteEntries;
+		return index->second;
+	}
+
+	const uint32_t newIndex = uint32_t(m_palette.size() / m_pixelSize);
+	m_palette.insert(m_palette.end(), value.begin(), value.end());
+	m_paletteIndices[value] = newIndex;
+	m_paletteUses.push_back(1);
+	return newIndex;
+}
+
+/**
+ * \brief Record that a brick stopped using a palette entry. Entries stay in the palette until Compact() removes the unused ones.
+ */
+void GFW::BrickedVolume::ReleasePaletteIndex(uint32_t index)
+{
+	GFW_ASSERT(m_paletteUses[index] > 0);
+	if(--m_paletteUses[index] == 0)
+		++m_unusedPaletteEntries;
+}
+
+/**
+ * \brief Store new contents of a brick. Constant bricks are elided and release their slot, other bricks reuse their slot or take a free one.
+ */
+void GFW::BrickedVolume::StoreBrick(int brickX, int brickY, int brickZ, const unsigned char* brick)
+{
+	const size_t brickBytes = size_t(m_brickSize) * m_brickSize * m_brickSize * m_pixelSize;
+	uint32_t& entry = GetEntry(brickX, brickY, brickZ);
+	if(IsConstant(brick))
+	{
+		if(!(entry & CONSTANT_BRICK))
+			m_freeSlots.push_back(entry);
+		else
+			ReleasePaletteIndex(entry & ~CONSTANT_BRICK);
+		entry = CONSTANT_BRICK | GetPaletteIndex(brick);
+		return;
+	}
+
+	if(entry & CONSTANT_BRICK)
+	{
+		ReleasePaletteIndex(entry & ~CONSTANT_BRICK);
+		if(m_freeSlots.empty())
+		{
+			entry = uint32_t(m_pool.size() / brickBytes);
+			m_pool.resize(m_pool.size() + brickBytes);
+		}
+		else
+		{
+			entry = m_freeSlots.back();
+			m_freeSlots.pop_back();
+		}
+	}
+	memcpy(m_pool.data() + brickBytes * entry, brick, brickBytes);
+}
@@ -0,0 +1,417 @@
+#include <CpuSampler.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "Logging.h"
+#include "Simd.h"
+#include "TextureUtilities.h"
+
+namespace
+{
+	const int GROUP_SIZE = 4;
+#ifdef GFW_SSE2
+	typedef __m128 Lanes;
+
+	inline Lanes LoadLanes(const float* values) { return _mm_loadu_ps(values); }
+	inline Lanes Broadcast(float value) { return _mm_set1_ps(value); }
+	inline Lanes Add(Lanes a, Lanes b) { return _mm_add_ps(a, b); }
+	inline Lanes Sub(Lanes a, Lanes b) { return _mm_sub_ps(a, b); }
+	inline Lanes Mul(Lanes a, Lanes b) { return _mm_mul_ps(a, b); }
+	inline Lanes Min(Lanes a, Lanes b) { return _mm_min_ps(a, b); }
+	inline Lanes Max(Lanes a, Lanes b) { return _mm_max_ps(a, b); }
+	inline Lanes Less(Lanes a, Lanes b) { return _mm_cmplt_ps(a, b); }
+	inline Lanes GreaterEqual(Lanes a, Lanes b) { return _mm_cmpge_ps(a, b); }
+	inline Lanes And(Lanes a, Lanes b) { return _mm_and_ps(a, b); }
+	inline Lanes Select(Lanes mask, Lanes a, Lanes b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+	inline int GetMask(Lanes mask) { return _mm_movemask_ps(mask); }
+	inline void StoreLanes(Lanes lanes, float* values) { _mm_storeu_ps(values, lanes); }
+
+	// Coordinates stay far below 2^31, so truncating and correcting negative values gives the floor.
+	inline Lanes Floor(Lanes x)
+	{
+		const Lanes truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+		return _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, x), _mm_set1_ps(1.0f)));
+	}
+
+	inline Lanes Lerp(Lanes a, Lanes b, Lanes t) { return _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), t)); }
+	inline void StoreIndices(Lanes lanes, int* indices) { _mm_storeu_si128(reinterpret_cast<__m128i*>(indices), _mm_cvttps_epi32(lanes)); }
+
+	/**
+	 * \brief Load the RGBA texel of every lane and transpose them, so every channel holds the values of all lanes.
+	 */
+	inline void LoadTexels(const float* const texels[GROUP_SIZE], Lanes& r, Lanes& g, Lanes& b, Lanes& a)
+	{
+		r = _mm_loadu_ps(texels[0]);
+		g = _mm_loadu_ps(texels[1]);
+		b = _mm_loadu_ps(texels[2]);
+		a = _mm_loadu_ps(texels[3]);
+		_MM_TRANSPOSE4_PS(r, g, b, a);
+	}
+
+	/**
+	 * \brief Transpose the channels back into one RGBA value per lane and store the first @count of them.
+	 */
+	inline void StoreTexels(Lanes r, Lanes g, Lanes b, Lanes a, float* texels, int count)
+	{
+		_MM_TRANSPOSE4_PS(r, g, b, a);
+		const Lanes values[GROUP_SIZE] = { r, g, b, a };
+		for(int lane = 0; lane < count; ++lane)
+			_mm_storeu_ps(texels + lane * 4, values[lane]);
+	}
+#else
+	struct Lanes
+	{
+		float values[GROUP_SIZE];	// One value per sample of the group.
+	};
+
+	template<typename Function>
+	inline Lanes Apply(Function function)
+	{
+		Lanes result;
+		for(int lane = 0; lane < GROUP_SIZE; ++lane)
+			result.values[lane] = function(lane);
+		return result;
+	}
+
+	inline Lanes LoadLanes(const float* values) { return Apply([&](int lane) { return values[lane]; }); }
+	inline Lanes Broadcast(float value) { return Lanes{ { value, value, value, value } }; }
+	inline Lanes Add(Lanes a, Lanes b) { return Apply([&](int lane) { return a.values[lane] + b.values[lane]; }); }
+	inline Lanes Sub(Lanes a, Lanes b) { return Apply([&](int lane) { return a.values[lane] - b.values[lane]; }); }
+	inline Lanes Mul(Lanes a, Lanes b) { return Apply([&](int lane) { return a.values[lane] * b.values[lane]; }); }
+	inline Lanes Min(Lanes a, Lanes b) { return Apply([&](int lane) { return std::min(a.values[lane], b.values[lane]); }); }
+	inline Lanes Max(Lanes a, Lanes b) { return Apply([&](int lane) { return std::max(a.values[lane], b.values[lane]); }); }
+	inline Lanes Less(Lanes a, Lanes b) { return Apply([&](int lane) { return a.values[lane] < b.values[lane] ? 1.0f : 0.0f; }); }
+	inline Lanes GreaterEqual(Lanes a, Lanes b) { return Apply([&](int lane) { return a.values[lane] >= b.values[lane] ? 1.0f : 0.0f; }); }
+	inline Lanes And(Lanes a, Lanes b) { return Apply([&](int lane) { return a.values[lane] != 0.0f && b.values[lane] != 0.0f ? 1.0f : 0.0f; }); }
+	inline Lanes Select(Lanes mask, Lanes a, Lanes b) { return Apply([&](int lane) { return mask.values[lane] != 0.0f ? a.values[lane] : b.values[lane]; }); }
+	inline Lanes Floor(Lanes x) { return Apply([&](int lane) { return std::floor(x.values[lane]); }); }
+	inline void StoreLanes(Lanes lanes, float* values) { memcpy(values, lanes.values, sizeof(lanes.values)); }
+
+	inline int GetMask(Lanes mask)
+	{
+		int bits = 0;
+		for(int lane = 0; lane < GROUP_SIZE; ++lane)
+			bits |= (mask.values[lane] != 0.0f ? 1 : 0) << lane;
+		return bits;
+	}
+
+	inline Lanes Lerp(Lanes a, Lanes b, Lanes t) { return Apply([&](int lane) { return a.values[lane] + (b.values[lane] - a.values[lane]) * t.values[lane]; }); }
+
+	inline void StoreIndices(Lanes lanes, int* indices)
+	{
+		for(int lane = 0; lane < GROUP_SIZE; ++lane)
+			indices[lane] = int(lanes.values[lane]);
+	}
+
+	inline void LoadTexels(const float* const texels[GROUP_SIZE], Lanes& r, Lanes& g, Lanes& b, Lanes& a)
+	{
+		for(int lane = 0; lane < GROUP_SIZE; ++lane)
+		{
+			r.values[lane] = texels[lane][0];
+			g.values[lane] = texels[lane][1];
+			b.values[lane] = texels[lane][2];
+			a.values[lane] = texels[lane][3];
+		}
+	}
+
+	inline void StoreTexels(Lanes r, Lanes g, Lanes b, Lanes a, float* texels, int count)
+	{
+		for(int lane = 0; lane < count; ++lane)
+		{
+			texels[lane * 4] = r.values[lane];
+			texels[lane * 4 + 1] = g.values[lane];
+			texels[lane * 4 + 2] = b.values[lane];
+			texels[lane * 4 + 3] = a.values[lane];
+		}
+	}
+#endif
+
+	/**
+	 * \return True if CpuTexture can convert pixel data of @format and @type to floats.
+	 */
+	bool IsSupported(GFW::TextureFormat format, GFW::TextureDataType type)
+	{
+		return !GFW::TextureUtilities::IsCompressed(format) && !GFW::TextureUtilities::IsDepthOrStencil(format) && !GFW::TextureUtilities::IsInteger(format) &&
+			(type == GFW::TextureDataType::GL_UNSIGNED_BYTE || type == GFW::TextureDataType::GL_UNSIGNED_SHORT || type == GFW::TextureDataType::GL_FLOAT ||
+			type == GFW::TextureDataType::GL_HALF_FLOAT);
+	}
+}
+
+#include "CpuSamplerKernel.inl"
+
+/**
+ * \brief Initialize the texture from client side pixel data, converting it to floats.
+ * \param width The width of the texture.
+ * \param height The height of the texture. Setting this to 1 will create a 1D texture.
+ * \param generateMipmaps If mipmaps should be generated with a box filter.
+ * \param format The format of the texture. Compressed, depth, stencil and integer formats aren't supported.
+ * \param type The type of @pixelData. Unsigned bytes, unsigned shorts, floats and half floats are supported.
+ * \param pixelData Tightly packed pixel data, starting with the top row.
+ * \param layout The memory layout of the texels. Tiled and Morton layouts keep 2D neighbourhoods close in memory, which helps sampling patterns that don't follow the rows.
+ * \return False if the format or type isn't supported.
+ */
+bool GFW::CpuTexture::Create(int width, int height, bool generateMipmaps, TextureFormat format, TextureDataType type, const unsigned char* pixelData, TextureLayout layout)
+{
+	GFW_ASSERT(width > 0 && height > 0 && pixelData != nullptr);
+	if(!IsSupported(format, type))
+		return false;
+
+	m_layout = layout;
+	const int levelCount = generateMipmaps ? TextureUtilities::GetMipmapCount(width, height) : 1;
+	m_levels.assign(size_t(levelCount), Level());
+	for(int level = 0; level < levelCount; ++level)
+	{
+		Level& current = m_levels[level];
+		current.width = TextureUtilities::GetMipmapDimension(width, level);
+		current.height = TextureUtilities::GetMipmapDimension(height, level);
+		current.texels.resize(size_t(TextureSwizzle::GetLayoutSize(layout, sizeof(float) * 4, current.width, current.height) / sizeof(float)));
+		current.columnOffsets.resize(size_t(current.width));
+		current.rowOffsets.resize(size_t(current.height));
+		for(int x = 0; x < current.width; ++x)
+			current.columnOffsets[x] = size_t(TextureSwizzle::GetTexelIndex(layout, current.width, current.height, 1, x, 0)) * 4;
+		for(int y = 0; y < current.height; ++y)
+			current.rowOffsets[y] = size_t(TextureSwizzle::GetTexelIndex(layout, current.width, current.height, 1, 0, y)) * 4;
+	}
+
+	UpdateTexture(0, 0, width, height, 0, format, type, pixelData);
+
+	// Every level is box filtered from the previous one through the offset tables, so the same code works for every layout.
+	for(int level = 1; level < levelCount; ++level)
+	{
+		const Level& parent = m_levels[level - 1];
+		Level& child = m_levels[level];
+		for(int y = 0; y < child.height; ++y)
+		{
+			const float* row0 = parent.texels.data() + parent.rowOffsets[std::min(y * 2, parent.height - 1)];
+			const float* row1 = parent.texels.data() + parent.rowOffsets[std::min(y * 2 + 1, parent.height - 1)];
+			float* destination = child.texels.data() + child.rowOffsets[y];
+			for(int x = 0; x < child.width; ++x)
+			{
+				const size_t x0 = parent.columnOffsets[std::min(x * 2, parent.width - 1)];
+				const size_t x1 = parent.columnOffsets[std::min(x * 2 + 1, parent.width - 1)];
+				const Lanes sum = Add(Add(LoadLanes(row0 + x0), LoadLanes(row0 + x1)), Add(LoadLanes(row1 + x0), LoadLanes(row1 + x1)));
+				StoreLanes(Mul(sum, Broadcast(0.25f)), destination + child.columnOffsets[x]);
+			}
+		}
+	}
+	return true;
+}
+
+/**
+ * \brief Overwrite a region of a mipmap level with client side pixel data, converting it to floats. Other levels aren't updated.
+ * \param x The column to start writing at.
+ * \param y The row to start writing at.
+ * \param width The width in pixels to write.
+ * \param height The height in pixels to write.
+ * \param level The mipmap level to write to.
+ * \param format The format of @pixelData. Compressed, depth, stencil and integer formats aren't supported.
+ * \param type The type of @pixelData. Unsigned bytes, unsigned shorts, floats and half floats are supported.
+ * \param pixelData Tightly packed pixel data of the region, starting with the top row.
+ * \return False if the format or type isn't supported.
+ */
+bool GFW::CpuTexture::UpdateTexture(int x, int y, int width, int height, int level, TextureFormat format, TextureDataType type, const unsigned char* pixelData)
+{
+	GFW_ASSERT(level >= 0 && level < GetLevelCount() && pixelData != nullptr);
+	Level& destination = m_levels[level];
+	GFW_ASSERT(x >= 0 && y >= 0 && width >= 0 && height >= 0 && x + width <= destination.width && y + height <= destination.height);
+	if(!IsSupported(format, type))
+		return false;
+
+	// The pixel data is converted straight into the layout through the offset tables of the level.
+	const int channels = TextureUtilities::GetChannelCount(format);
+	for(int row = 0; row < height; ++row)
+	{
+		float* texels = destination.texels.data() + destination.rowOffsets[y + row];
+		for(int column = 0; column < width; ++column)
+		{
+			float* texel = texels + destination.columnOffsets[x + column];
+			const size_t component = (size_t(row) * width + column) * channels;
+			for(int channel = 0; channel < 4; ++channel)
+				texel[channel] = channel < channels ? TextureUtilities::ReadComponent(pixelData, type, component + channel) : (channel == 3 ? 1.0f : 0.0f);
+		}
+	}
+	return true;
+}
+
+/**
+ * \brief Read a mipmap level back as linear RGBA texels, unswizzling it from the layout of the texture.
+ * \param level The mipmap level to read.
+ * \param texels Output for GetWidth() * GetHeight() RGBA texels, starting with the top row.
+ */
+void GFW::CpuTexture::Read(int level, float* texels) const
+{
+	const Level& source = m_levels[level];
+	TextureSwizzle::Unswizzle(m_layout, sizeof(float) * 4, source.width, source.height, 1, reinterpret_cast<const unsigned char*>(source.texels.data()),
+		reinterpret_cast<unsigned char*>(texels));
+}
+
+/**
+ * \return The memory layout of the texels.
+ */
+GFW::TextureLayout GFW::CpuTexture::GetLayout() const
+{
+	return m_layout;
+}
+
+/**
+ * \return The amount of mipmap levels, 0 if the texture isn't created.
+ */
+int GFW::CpuTexture::GetLevelCount() const
+{
+	return int(m_levels.size());
+}
+
+/**
+ * \return The width of mipmap @level.
+ */
+int GFW::CpuTexture::GetWidth(int level) const
+{
+	return m_levels[level].width;
+}
+
+/**
+ * \return The height of mipmap @level.
+ */
+int GFW::CpuTexture::GetHeight(int level) const
+{
+	return m_levels[level].height;
+}
+
+/**
+ * \return The RGBA texels of mipmap @level, stored in the layout of the texture. The texel at (x, y) starts at GetRowOffsets()[y] + GetColumnOffsets()[x].
+ */
+const float* GFW::CpuTexture::GetTexels(int level) const
+{
+	return m_levels[level].texels.data();
+}
+
+/**
+ * \return The offset in floats of every column of mipmap @level in its texels.
+ */
+const size_t* GFW::CpuTexture::GetColumnOffsets(int level) const
+{
+	return m_levels[level].columnOffsets.data();
+}
+
+/**
+ * \return The offset in floats of every row of mipmap @level in its texels.
+ */
+const size_t* GFW::CpuTexture::GetRowOffsets(int level) const
+{
+	return m_levels[level].rowOffsets.data();
+}
+
+GFW::CpuSampler::CpuSampler() : m_minFilter(SamplerFilter::NEAREST_MIPMAP_LINEAR), m_magFilter(SamplerFilter::LINEAR), m_anisotropy(AnisotropicFilter::FILTER_NONE),
+	m_edgeSampling(EdgeSampling::REPEAT), m_borderColor(0.0f)
+{
+}
+
+/**
+ * \brief Initialize the sampler state.
+ * \param minFilter The type of texture filtering to apply when sampling a texture. Minification filter.
+ * \param magFilter The type of texture filtering to apply when sampling a texture. Magnification filter.
+ * \param anisotropy The maximum amount of anisotropic samples to use when filtering.
+ * \param edgeSampling The type of edge sampling operation to use when sampling a texture.
+ * \param borderColor The border color to use when sampling outside the texture.
+ */
+void GFW::CpuSampler::Create(SamplerFilter minFilter, SamplerFilter magFilter, AnisotropicFilter anisotropy, EdgeSampling edgeSampling, const Vec4& borderColor)
+{
+	m_minFilter = minFilter;
+	m_magFilter = magFilter;
+	m_anisotropy = anisotropy;
+	m_edgeSampling = edgeSampling;
+	m_borderColor = borderColor;
+}
+
+void GFW::CpuSampler::SetMinifactionFilter(SamplerFilter filter)
+{
+	m_minFilter = filter;
+}
+
+GFW::SamplerFilter GFW::CpuSampler::GetMinifactionFilter()
+{
+	return m_minFilter;
+}
+
+void GFW::CpuSampler::SetMagnificationFilter(SamplerFilter filter)
+{
+	m_magFilter = filter;
+}
+
+GFW::SamplerFilter GFW::CpuSampler::GetMagnificationFilter()
+{
+	return m_magFilter;
+}
+
+void GFW::CpuSampler::SetAnisotropicFilter(AnisotropicFilter anisotropy)
+{
+	m_anisotropy = anisotropy;
+}
+
+GFW::AnisotropicFilter GFW::CpuSampler::GetAnisotropicFilter()
+{
+	return m_anisotropy;
+}
+
+void GFW::CpuSampler::SetEdgeSamplingOperation(EdgeSampling edgeSampling)
+{
+	m_edgeSampling = edgeSampling;
+}
+
+GFW::EdgeSampling GFW::CpuSampler::GetEdgeSamplingOperation()
+{
+	return m_edgeSampling;
+}
+
+void GFW::CpuSampler::SetBorderColor(const Vec4& color)
+{
+	m_borderColor = color;
+}
+
+GFW::Vec4 GFW::CpuSampler::GetBorderColor()
+{
+	return m_borderColor;
+}
+
+/**
+ * \brief Sample a texture at explicit levels of detail, like textureLod() in GLSL. Anisotropic filtering doesn't apply without gradients.
+ * \param texture The texture to sample.
+ * \param u The normalized horizontal coordinate of every sample.
+ * \param v The normalized vertical coordinate of every sample. 0 is the top row.
+ * \param lod The level of detail of every sample. Samples with a level of detail of at most 0 use the magnification filter.
+ * \param count The amount of samples.
+ * \param result Output for the filtered RGBA value of every sample.
+ */
+void GFW::CpuSampler::Sample(const CpuTexture& texture, const float* u, const float* v, const float* lod, int count, Vec4* result) const
+{
+	SampleBatch(texture, u, v, lod, nullptr, count, result);
+}
+
+/**
+ * \brief Sample a texture with levels of detail and anisotropic filtering derived from the coordinate derivatives, like textureGrad() in GLSL.
+ * \param texture The texture to sample.
+ * \param u The normalized horizontal coordinate of every sample.
+ * \param v The normalized vertical coordinate of every sample. 0 is the top row.
+ * \param gradients The derivatives of every sample: du/dx, dv/dx, du/dy and dv/dy.
+ * \param count The amount of samples.
+ * \param result Output for the filtered RGBA value of every sample.
+ */
+void GFW::CpuSampler::SampleGradient(const CpuTexture& texture, const float* u, const float* v, const Vec4* gradients, int count, Vec4* result) const
+{
+	SampleBatch(texture, u, v, nullptr, gradients, count, result);
+}
+
+/**
+ * \brief Sample a batch with the widest kernel the CPU supports: 8 samples at a time with AVX2, otherwise 4 with SSE2. Both give the same results.
+ */
+void GFW::CpuSampler::SampleBatch(const CpuTexture& texture, const float* u, const float* v, const float* lod, const Vec4* gradients, int count, Vec4* result) const
+{
+#ifdef GFW_AVX2
+	if(IsAvx2Supported())
+	{
+		SampleBatchAvx2(texture, u, v, lod, gradients, count, result);
+		return;
+	}
+#endif
+	RunBatch(texture, m_minFilter, m_magFilter, m_edgeSampling, m_borderColor, 1 << int(m_anisotropy), u, v, lod, gradients, count, result);
+}
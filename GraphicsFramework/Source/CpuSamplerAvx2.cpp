@@ -0,0 +1,98 @@
+#include <CpuSampler.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "Logging.h"
+#include "Simd.h"
+
+#ifdef GFW_AVX2
+// The project compiles this file with /arch:AVX2, other compilers enable AVX2 for the code below only.
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+namespace
+{
+	const int GROUP_SIZE = 8;
+	typedef __m256 Lanes;
+
+	inline Lanes LoadLanes(const float* values) { return _mm256_loadu_ps(values); }
+	inline Lanes Broadcast(float value) { return _mm256_set1_ps(value); }
+	inline Lanes Add(Lanes a, Lanes b) { return _mm256_add_ps(a, b); }
+	inline Lanes Sub(Lanes a, Lanes b) { return _mm256_sub_ps(a, b); }
+	inline Lanes Mul(Lanes a, Lanes b) { return _mm256_mul_ps(a, b); }
+	inline Lanes Min(Lanes a, Lanes b) { return _mm256_min_ps(a, b); }
+	inline Lanes Max(Lanes a, Lanes b) { return _mm256_max_ps(a, b); }
+	inline Lanes Less(Lanes a, Lanes b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+	inline Lanes GreaterEqual(Lanes a, Lanes b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+	inline Lanes And(Lanes a, Lanes b) { return _mm256_and_ps(a, b); }
+	inline Lanes Select(Lanes mask, Lanes a, Lanes b) { return _mm256_blendv_ps(b, a, mask); }
+	inline int GetMask(Lanes mask) { return _mm256_movemask_ps(mask); }
+	inline void StoreLanes(Lanes lanes, float* values) { _mm256_storeu_ps(values, lanes); }
+
+	// The same floor as the SSE2 kernel, so both give the same results.
+	inline Lanes Floor(Lanes x)
+	{
+		const Lanes truncated = _mm256_cvtepi32_ps(_mm256_cvttps_epi32(x));
+		return _mm256_sub_ps(truncated, _mm256_and_ps(_mm256_cmp_ps(truncated, x, _CMP_GT_OQ), _mm256_set1_ps(1.0f)));
+	}
+
+	// No FMA, a fused multiply-add would round differently than the SSE2 kernel.
+	inline Lanes Lerp(Lanes a, Lanes b, Lanes t) { return _mm256_add_ps(a, _mm256_mul_ps(_mm256_sub_ps(b, a), t)); }
+	inline void StoreIndices(Lanes lanes, int* indices) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(indices), _mm256_cvttps_epi32(lanes)); }
+
+	/**
+	 * \brief Load the RGBA texel of every lane and transpose them, so every channel holds the values of all lanes. Lanes 0-3 and 4-7 are transposed
+	 * in the low and high half of the registers.
+	 */
+	inline void LoadTexels(const float* const texels[GROUP_SIZE], Lanes& r, Lanes& g, Lanes& b, Lanes& a)
+	{
+		const Lanes texels04 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(texels[0])), _mm_loadu_ps(texels[4]), 1);
+		const Lanes texels15 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(texels[1])), _mm_loadu_ps(texels[5]), 1);
+		const Lanes texels26 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(texels[2])), _mm_loadu_ps(texels[6]), 1);
+		const Lanes texels37 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(texels[3])), _mm_loadu_ps(texels[7]), 1);
+		const Lanes rg01 = _mm256_unpacklo_ps(texels04, texels15);
+		const Lanes ba01 = _mm256_unpackhi_ps(texels04, texels15);
+		const Lanes rg23 = _mm256_unpacklo_ps(texels26, texels37);
+		const Lanes ba23 = _mm256_unpackhi_ps(texels26, texels37);
+		r = _mm256_shuffle_ps(rg01, rg23, _MM_SHUFFLE(1, 0, 1, 0));
+		g = _mm256_shuffle_ps(rg01, rg23, _MM_SHUFFLE(3, 2, 3, 2));
+		b = _mm256_shuffle_ps(ba01, ba23, _MM_SHUFFLE(1, 0, 1, 0));
+		a = _mm256_shuffle_ps(ba01, ba23, _MM_SHUFFLE(3, 2, 3, 2));
+	}
+
+	/**
+	 * \brief Transpose the channels back into one RGBA value per lane and store the first @count of them.
+	 */
+	inline void StoreTexels(Lanes r, Lanes g, Lanes b, Lanes a, float* texels, int count)
+	{
+		const Lanes rg01 = _mm256_unpacklo_ps(r, g);
+		const Lanes rg23 = _mm256_unpackhi_ps(r, g);
+		const Lanes ba01 = _mm256_unpacklo_ps(b, a);
+		const Lanes ba23 = _mm256_unpackhi_ps(b, a);
+		const Lanes values[4] = { _mm256_shuffle_ps(rg01, ba01, _MM_SHUFFLE(1, 0, 1, 0)), _mm256_shuffle_ps(rg01, ba01, _MM_SHUFFLE(3, 2, 3, 2)),
+			_mm256_shuffle_ps(rg23, ba23, _MM_SHUFFLE(1, 0, 1, 0)), _mm256_shuffle_ps(rg23, ba23, _MM_SHUFFLE(3, 2, 3, 2)) };
+		for(int lane = 0; lane < count; ++lane)
+			_mm_storeu_ps(texels + lane * 4, lane < 4 ? _mm256_castps256_ps128(values[lane]) : _mm256_extractf128_ps(values[lane - 4], 1));
+	}
+}
+
+#include "CpuSamplerKernel.inl"
+
+/**
+ * \brief SampleBatch() with the AVX2 kernel, 8 samples at a time. Only call this if IsAvx2Supported() is true.
+ */
+void GFW::CpuSampler::SampleBatchAvx2(const CpuTexture& texture, const float* u, const float* v, const float* lod, const Vec4* gradients, int count, Vec4* result) const
+{
+	RunBatch(texture, m_minFilter, m_magFilter, m_edgeSampling, m_borderColor, 1 << int(m_anisotropy), u, v, lod, gradients, count, result);
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+#endif
@@ -0,0 +1,495 @@
+// The sampling kernel of CpuSampler, shared by CpuSampler.cpp (SSE2 or scalar) and CpuSamplerAvx2.cpp (AVX2). Every includer first defines GROUP_SIZE,
+// Lanes and the lane operations for its instruction set, so the kernel is compiled once per instruction set. Everything is in an anonymous namespace,
+// so the copies of different translation units never mix.
+
+namespace
+{
+	const int MAX_LEVELS = 32;	// A 2D texture with int dimensions has at most 31 mipmap levels.
+
+	/**
+	 * \brief How a minification filter picks mipmap levels.
+	 */
+	enum class MipFilter
+	{
+		NONE/*Only the base level is used.*/,
+		NEAREST/*The nearest level is used.*/,
+		LINEAR/*The two nearest levels are blended.*/
+	};
+
+	constexpr bool IsLinear(GFW::SamplerFilter filter)
+	{
+		return filter == GFW::SamplerFilter::LINEAR || filter == GFW::SamplerFilter::LINEAR_MIPMAP_NEAREST || filter == GFW::SamplerFilter::LINEAR_MIPMAP_LINEAR;
+	}
+
+	constexpr MipFilter GetMipFilter(GFW::SamplerFilter filter)
+	{
+		return filter == GFW::SamplerFilter::NEAREST || filter == GFW::SamplerFilter::LINEAR ? MipFilter::NONE :
+			(filter == GFW::SamplerFilter::NEAREST_MIPMAP_NEAREST || filter == GFW::SamplerFilter::LINEAR_MIPMAP_NEAREST ? MipFilter::NEAREST : MipFilter::LINEAR);
+	}
+
+	/**
+	 * \brief RGBA values of a group, one vector per channel with a value per lane. Filtering works on the channels so every operation covers the whole group.
+	 */
+	struct ColorLanes
+	{
+		Lanes r;	// Red of every lane.
+		Lanes g;	// Green of every lane.
+		Lanes b;	// Blue of every lane.
+		Lanes a;	// Alpha of every lane.
+	};
+
+	inline ColorLanes BroadcastColor(const GFW::Math::Vec4& color)
+	{
+		return ColorLanes{ Broadcast(color.x), Broadcast(color.y), Broadcast(color.z), Broadcast(color.w) };
+	}
+
+	inline ColorLanes LoadColors(const float* const texels[GROUP_SIZE])
+	{
+		ColorLanes colors;
+		LoadTexels(texels, colors.r, colors.g, colors.b, colors.a);
+		return colors;
+	}
+
+	inline void StoreColors(const ColorLanes& colors, GFW::Math::Vec4* result, int count)
+	{
+		StoreTexels(colors.r, colors.g, colors.b, colors.a, &result->x, count);
+	}
+
+	inline ColorLanes LerpColors(const ColorLanes& a, const ColorLanes& b, Lanes t)
+	{
+		return ColorLanes{ Lerp(a.r, b.r, t), Lerp(a.g, b.g, t), Lerp(a.b, b.b, t), Lerp(a.a, b.a, t) };
+	}
+
+	inline ColorLanes SelectColors(Lanes mask, const ColorLanes& a, const ColorLanes& b)
+	{
+		return ColorLanes{ Select(mask, a.r, b.r), Select(mask, a.g, b.g), Select(mask, a.b, b.b), Select(mask, a.a, b.a) };
+	}
+
+	inline ColorLanes AddScaledColors(const ColorLanes& a, const ColorLanes& b, Lanes scale)
+	{
+		return ColorLanes{ Add(a.r, Mul(b.r, scale)), Add(a.g, Mul(b.g, scale)), Add(a.b, Mul(b.b, scale)), Add(a.a, Mul(b.a, scale)) };
+	}
+
+	/**
+	 * \brief A mipmap level of a CpuTexture.
+	 */
+	struct LevelView
+	{
+		const float* texels;			// RGBA texels of the level, in the layout of the texture.
+		const size_t* columnOffsets;	// Offset in floats of every column in @texels, nullptr for the linear layout.
+		const size_t* rowOffsets;		// Offset in floats of every row in @texels, nullptr for the linear layout.
+		size_t pitch;					// Floats per row in the linear layout.
+		float sizes[4];					// The width, height and their reciprocals as floats, so groups don't have to convert and divide them.
+	};
+
+	/**
+	 * \brief Gather size @index of the level of every lane. Most groups sample a single level, which only needs a broadcast.
+	 */
+	GFW_FORCEINLINE Lanes GatherSizes(const LevelView* const levels[GROUP_SIZE], int index)
+	{
+		float sizes[GROUP_SIZE];
+		bool uniform = true;
+		for(int lane = 0; lane < GROUP_SIZE; ++lane)
+		{
+			sizes[lane] = levels[lane]->sizes[index];
+			uniform = uniform && levels[lane] == levels[0];
+		}
+		return uniform ? Broadcast(sizes[0]) : LoadLanes(sizes);
+	}
+
+	/**
+	 * \brief Everything a batch function needs besides the template parameters.
+	 */
+	struct BatchInput
+	{
+		const LevelView* levels;				// All levels of the texture.
+		int levelCount;							// The amount of levels.
+		const float* u;							// Horizontal coordinate of every sample.
+		const float* v;							// Vertical coordinate of every sample.
+		const float* lod;						// Level of detail of every sample, nullptr when @gradients is used.
+		const GFW::Math::Vec4* gradients;		// Coordinate derivatives of every sample, nullptr when @lod is used.
+		int count;								// The amount of samples.
+		int maxAnisotropy;						// The maximum amount of anisotropic taps per sample.
+		ColorLanes border;						// The border color in every lane.
+	};
+
+	/**
+	 * \brief Wraps integer texel coordinates into the level according to an edge sampling operation. @valid is only written for CLAMP_TO_BORDER,
+	 * where it marks the coordinates inside the level, the returned coordinate is then clamped so it can always be read.
+	 * @inverseSize is 1 / @size, so the repeating operations don't divide.
+	 */
+	template<GFW::EdgeSampling EDGE>
+	struct EdgeAddress;
+
+	template<>
+	struct EdgeAddress<GFW::EdgeSampling::REPEAT>
+	{
+		static Lanes Apply(Lanes coordinate, Lanes size, Lanes inverseSize, Lanes&)
+		{
+			// The reciprocal can round to the neighbouring period, which the two corrections undo.
+			Lanes wrapped = Sub(coordinate, Mul(Floor(Mul(coordinate, inverseSize)), size));
+			wrapped = Select(GreaterEqual(wrapped, size), Sub(wrapped, size), wrapped);
+			return Select(Less(wrapped, Broadcast(0.0f)), Add(wrapped, size), wrapped);
+		}
+	};
+
+	template<>
+	struct EdgeAddress<GFW::EdgeSampling::MIRRORED_REPEAT>
+	{
+		static Lanes Apply(Lanes coordinate, Lanes size, Lanes inverseSize, Lanes& valid)
+		{
+			const Lanes period = Add(size, size);
+			const Lanes wrapped = EdgeAddress<GFW::EdgeSampling::REPEAT>::Apply(coordinate, period, Mul(inverseSize, Broadcast(0.5f)), valid);
+			return Select(GreaterEqual(wrapped, size), Sub(Sub(period, Broadcast(1.0f)), wrapped), wrapped);
+		}
+	};
+
+	template<>
+	struct EdgeAddress<GFW::EdgeSampling::CLAMP_TO_EDGE>
+	{
+		static Lanes Apply(Lanes coordinate, Lanes size, Lanes, Lanes&)
+		{
+			return Min(Max(coordinate, Broadcast(0.0f)), Sub(size, Broadcast(1.0f)));
+		}
+	};
+
+	template<>
+	struct EdgeAddress<GFW::EdgeSampling::CLAMP_TO_BORDER>
+	{
+		static Lanes Apply(Lanes coordinate, Lanes size, Lanes, Lanes& valid)
+		{
+			valid = And(GreaterEqual(coordinate, Broadcast(0.0f)), Less(coordinate, size));
+			return Min(Max(coordinate, Broadcast(0.0f)), Sub(size, Broadcast(1.0f)));
+		}
+	};
+
+	/**
+	 * \brief Find the start of the wrapped row of every lane.
+	 */
+	GFW_FORCEINLINE void GetRows(const LevelView* const levels[GROUP_SIZE], Lanes rows, const float* rowTexels[GROUP_SIZE])
+	{
+		int rowIndices[GROUP_SIZE];
+		StoreIndices(rows, rowIndices);
+		if(levels[0]->rowOffsets == nullptr)
+		{
+			for(int lane = 0; lane < GROUP_SIZE; ++lane)
+				rowTexels[lane] = levels[lane]->texels + size_t(rowIndices[lane]) * levels[lane]->pitch;
+		}
+		else
+		{
+			for(int lane = 0; lane < GROUP_SIZE; ++lane)
+				rowTexels[lane] = levels[lane]->texels + levels[lane]->rowOffsets[rowIndices[lane]];
+		}
+	}
+
+	/**
+	 * \brief Find the offset of the wrapped column of every lane from the start of its row.
+	 */
+	GFW_FORCEINLINE void GetColumns(const LevelView* const levels[GROUP_SIZE], Lanes columns, size_t columnOffsets[GROUP_SIZE])
+	{
+		int columnIndices[GROUP_SIZE];
+		if(levels[0]->columnOffsets == nullptr)
+		{
+			StoreIndices(Mul(columns, Broadcast(4.0f)), columnIndices);
+			for(int lane = 0; lane < GROUP_SIZE; ++lane)
+				columnOffsets[lane] = size_t(columnIndices[lane]);
+		}
+		else
+		{
+			StoreIndices(columns, columnIndices);
+			for(int lane = 0; lane < GROUP_SIZE; ++lane)
+				columnOffsets[lane] = levels[lane]->columnOffsets[columnIndices[lane]];
+		}
+	}
+
+	/**
+	 * \brief Read the texel at @columns from the row of every lane. Lanes outside the level get the border color with CLAMP_TO_BORDER.
+	 */
+	template<GFW::EdgeSampling EDGE>
+	GFW_FORCEINLINE ColorLanes FetchTexels(const float* const rowTexels[GROUP_SIZE], const size_t columns[GROUP_SIZE], Lanes valid, const ColorLanes& border)
+	{
+		const float* texels[GROUP_SIZE];
+		for(int lane = 0; lane < GROUP_SIZE; ++lane)
+			texels[lane] = rowTexels[lane] + columns[lane];
+		const ColorLanes colors = LoadColors(texels);
+		return EDGE == GFW::EdgeSampling::CLAMP_TO_BORDER ? SelectColors(valid, colors, border) : colors;
+	}
+
+	/**
+	 * \brief Wrap the coordinates after @wrapped, which are already wrapped by EdgeAddress. With REPEAT that's a single compare instead of wrapping again.
+	 */
+	template<GFW::EdgeSampling EDGE>
+	GFW_FORCEINLINE Lanes AddressNext(Lanes coordinate, Lanes wrapped, Lanes size, Lanes inverseSize, Lanes& valid)
+	{
+		if(EDGE != GFW::EdgeSampling::REPEAT)
+			return EdgeAddress<EDGE>::Apply(Add(coordinate, Broadcast(1.0f)), size, inverseSize, valid);
+		const Lanes next = Add(wrapped, Broadcast(1.0f));
+		return Select(Less(next, size), next, Broadcast(0.0f));
+	}
+
+	/**
+	 * \brief Sample a group of samples from one level per sample with nearest or bilinear filtering.
+	 * Only the texel reads are per lane, the addressing, border handling and the bilinear blend work on all lanes at once.
+	 */
+	template<bool LINEAR, GFW::EdgeSampling EDGE>
+	GFW_FORCEINLINE ColorLanes SampleLevel(const LevelView* const levels[GROUP_SIZE], Lanes u, Lanes v, const ColorLanes& border)
+	{
+		const Lanes width = GatherSizes(levels, 0);
+		const Lanes height = GatherSizes(levels, 1);
+		const Lanes inverseWidth = GatherSizes(levels, 2);
+		const Lanes inverseHeight = GatherSizes(levels, 3);
+		const Lanes offset = Broadcast(LINEAR ? 0.5f : 0.0f);
+		const Lanes x = Sub(Mul(u, width), offset);
+		const Lanes y = Sub(Mul(v, height), offset);
+		const Lanes x0 = Floor(x);
+		const Lanes y0 = Floor(y);
+
+		Lanes validX0 = Broadcast(0.0f);
+		Lanes validY0 = Broadcast(0.0f);
+		const Lanes columns0 = EdgeAddress<EDGE>::Apply(x0, width, inverseWidth, validX0);
+		const Lanes rows0 = EdgeAddress<EDGE>::Apply(y0, height, inverseHeight, validY0);
+		size_t columnOffsets0[GROUP_SIZE];
+		const float* rowTexels0[GROUP_SIZE];
+		GetColumns(levels, columns0, columnOffsets0);
+		GetRows(levels, rows0, rowTexels0);
+		const ColorLanes color00 = FetchTexels<EDGE>(rowTexels0, columnOffsets0, And(validX0, validY0), border);
+		if(!LINEAR)
+			return color00;
+
+		Lanes validX1 = Broadcast(0.0f);
+		Lanes validY1 = Broadcast(0.0f);
+		size_t columnOffsets1[GROUP_SIZE];
+		const float* rowTexels1[GROUP_SIZE];
+		GetColumns(levels, AddressNext<EDGE>(x0, columns0, width, inverseWidth, validX1), columnOffsets1);
+		GetRows(levels, AddressNext<EDGE>(y0, rows0, height, inverseHeight, validY1), rowTexels1);
+		const ColorLanes color10 = FetchTexels<EDGE>(rowTexels0, columnOffsets1, And(validX1, validY0), border);
+		const ColorLanes color01 = FetchTexels<EDGE>(rowTexels1, columnOffsets0, And(validX0, validY1), border);
+		const ColorLanes color11 = FetchTexels<EDGE>(rowTexels1, columnOffsets1, And(validX1, validY1), border);
+
+		const Lanes weightX = Sub(x, x0);
+		return LerpColors(LerpColors(color00, color10, weightX), LerpColors(color01, color11, weightX), Sub(y, y0));
+	}
+
+	/**
+	 * \brief Sample a group at the given levels of detail. Samples with a level of detail of at most 0 are magnified, the others minified.
+	 */
+	template<GFW::SamplerFilter MIN_FILTER, bool MAG_LINEAR, GFW::EdgeSampling EDGE>
+	GFW_FORCEINLINE ColorLanes SampleGroup(const BatchInput& input, Lanes u, Lanes v, Lanes lod)
+	{
+		const LevelView* baseLevels[GROUP_SIZE];
+		for(int lane = 0; lane < GROUP_SIZE; ++lane)
+			baseLevels[lane] = input.levels;
+		const Lanes zero = Broadcast(0.0f);
+
+		// Magnification only differs from minification at level 0 if the filters differ in linearity.
+		Lanes magnified = zero;
+		int magnifiedMask = 0;
+		ColorLanes magnifiedColors;
+		if(IsLinear(MIN_FILTER) != MAG_LINEAR)
+		{
+			magnified = GreaterEqual(zero, lod);
+			magnifiedMask = GetMask(magnified);
+			if(magnifiedMask)
+			{
+				magnifiedColors = SampleLevel<MAG_LINEAR, EDGE>(baseLevels, u, v, input.border);
+				if(magnifiedMask == (1 << GROUP_SIZE) - 1)
+					return magnifiedColors;
+			}
+		}
+
+		ColorLanes colors;
+		const Lanes lastLevel = Broadcast(float(input.levelCount - 1));
+		if(GetMipFilter(MIN_FILTER) == MipFilter::NONE)
+			colors = SampleLevel<IsLinear(MIN_FILTER), EDGE>(baseLevels, u, v, input.border);
+		else if(GetMipFilter(MIN_FILTER) == MipFilter::NEAREST)
+		{
+			int levelIndices[GROUP_SIZE];
+			StoreIndices(Min(Add(Max(lod, zero), Broadcast(0.5f)), lastLevel), levelIndices);
+			const LevelView* levels[GROUP_SIZE];
+			for(int lane = 0; lane < GROUP_SIZE; ++lane)
+				levels[lane] = input.levels + levelIndices[lane];
+			colors = SampleLevel<IsLinear(MIN_FILTER), EDGE>(levels, u, v, input.border);
+		}
+		else
+		{
+			const Lanes level = Min(Max(lod, zero), lastLevel);
+			const Lanes level0 = Floor(level);
+			const Lanes weight = Sub(level, level0);
+			int levelIndices[GROUP_SIZE];
+			StoreIndices(level0, levelIndices);
+			const LevelView* levels0[GROUP_SIZE];
+			const LevelView* levels1[GROUP_SIZE];
+			for(int lane = 0; lane < GROUP_SIZE; ++lane)
+			{
+				levels0[lane] = input.levels + levelIndices[lane];
+				levels1[lane] = input.levels + std::min(levelIndices[lane] + 1, input.levelCount - 1);
+			}
+
+			colors = SampleLevel<IsLinear(MIN_FILTER), EDGE>(levels0, u, v, input.border);
+			if(GetMask(Less(zero, weight)))
+				colors = LerpColors(colors, SampleLevel<IsLinear(MIN_FILTER), EDGE>(levels1, u, v, input.border), weight);
+		}
+		return magnifiedMask ? SelectColors(magnified, magnifiedColors, colors) : colors;
+	}
+
+	/**
+	 * \brief Sample a batch in groups. With gradients the level of detail and the anisotropic taps are derived from the footprint of every sample:
+	 * up to the maximum anisotropy taps are spread along the major axis of the footprint, and the level of detail follows the footprint divided by the taps.
+	 */
+	template<GFW::SamplerFilter MIN_FILTER, bool MAG_LINEAR, GFW::EdgeSampling EDGE>
+	void SampleBatch(const BatchInput& input, GFW::Math::Vec4* result)
+	{
+		const float baseWidth = input.levels[0].sizes[0];
+		const float baseHeight = input.levels[0].sizes[1];
+		for(int first = 0; first < input.count; first += GROUP_SIZE)
+		{
+			// Full groups with explicit levels of detail are loaded straight from the input.
+			if(input.lod && first + GROUP_SIZE <= input.count)
+			{
+				StoreColors(SampleGroup<MIN_FILTER, MAG_LINEAR, EDGE>(input, LoadLanes(input.u + first), LoadLanes(input.v + first), LoadLanes(input.lod + first)),
+					result + first, GROUP_SIZE);
+				continue;
+			}
+
+			// The last group repeats its last sample to fill the lanes.
+			float u[GROUP_SIZE];
+			float v[GROUP_SIZE];
+			float lod[GROUP_SIZE];
+			int taps[GROUP_SIZE];
+			float axesU[GROUP_SIZE];
+			float axesV[GROUP_SIZE];
+			int maxTaps = 1;
+			for(int lane = 0; lane < GROUP_SIZE; ++lane)
+			{
+				const int sample = std::min(first + lane, input.count - 1);
+				u[lane] = input.u[sample];
+				v[lane] = input.v[sample];
+				taps[lane] = 1;
+				axesU[lane] = 0.0f;
+				axesV[lane] = 0.0f;
+				if(input.lod)
+				{
+					lod[lane] = input.lod[sample];
+					continue;
+				}
+
+				const GFW::Math::Vec4& gradient = input.gradients[sample];
+				const float lengthX = std::sqrt(gradient.x * gradient.x * baseWidth * baseWidth + gradient.y * gradient.y * baseHeight * baseHeight);
+				const float lengthY = std::sqrt(gradient.z * gradient.z * baseWidth * baseWidth + gradient.w * gradient.w * baseHeight * baseHeight);
+				const float major = std::max(lengthX, lengthY);
+				const float minor = std::min(lengthX, lengthY);
+				if(input.maxAnisotropy > 1 && major > minor)
+				{
+					taps[lane] = minor > 0.0f ? std::min(int(std::ceil(major / minor)), input.maxAnisotropy) : input.maxAnisotropy;
+					axesU[lane] = lengthX >= lengthY ? gradient.x : gradient.z;
+					axesV[lane] = lengthX >= lengthY ? gradient.y : gradient.w;
+				}
+				lod[lane] = std::log2(std::max(major / taps[lane], 1e-30f));
+				maxTaps = std::max(maxTaps, taps[lane]);
+			}
+
+			ColorLanes colors;
+			if(maxTaps == 1)
+				colors = SampleGroup<MIN_FILTER, MAG_LINEAR, EDGE>(input, LoadLanes(u), LoadLanes(v), LoadLanes(lod));
+			else
+			{
+				float offsets[GROUP_SIZE];
+				float weights[GROUP_SIZE];
+				colors = BroadcastColor(GFW::Math::Vec4(0.0f));
+				for(int tap = 0; tap < maxTaps; ++tap)
+				{
+					// Lanes with fewer taps repeat their center with a weight of 0.
+					for(int lane = 0; lane < GROUP_SIZE; ++lane)
+					{
+						offsets[lane] = tap < taps[lane] ? (tap + 0.5f) / taps[lane] - 0.5f : 0.0f;
+						weights[lane] = tap < taps[lane] ? 1.0f / taps[lane] : 0.0f;
+					}
+					const Lanes offset = LoadLanes(offsets);
+					const ColorLanes tapColors = SampleGroup<MIN_FILTER, MAG_LINEAR, EDGE>(input, Add(LoadLanes(u), Mul(LoadLanes(axesU), offset)),
+						Add(LoadLanes(v), Mul(LoadLanes(axesV), offset)), LoadLanes(lod));
+					colors = AddScaledColors(colors, tapColors, LoadLanes(weights));
+				}
+			}
+			StoreColors(colors, result + first, std::min(GROUP_SIZE, input.count - first));
+		}
+	}
+
+	typedef void (*BatchFunction)(const BatchInput& input, GFW::Math::Vec4* result);
+
+	template<GFW::SamplerFilter MIN_FILTER, bool MAG_LINEAR>
+	BatchFunction GetBatchFunctionForEdge(GFW::EdgeSampling edgeSampling)
+	{
+		switch(edgeSampling)
+		{
+		case GFW::EdgeSampling::REPEAT:
+			return &SampleBatch<MIN_FILTER, MAG_LINEAR, GFW::EdgeSampling::REPEAT>;
+		case GFW::EdgeSampling::MIRRORED_REPEAT:
+			return &SampleBatch<MIN_FILTER, MAG_LINEAR, GFW::EdgeSampling::MIRRORED_REPEAT>;
+		case GFW::EdgeSampling::CLAMP_TO_EDGE:
+			return &SampleBatch<MIN_FILTER, MAG_LINEAR, GFW::EdgeSampling::CLAMP_TO_EDGE>;
+		default:
+			return &SampleBatch<MIN_FILTER, MAG_LINEAR, GFW::EdgeSampling::CLAMP_TO_BORDER>;
+		}
+	}
+
+	template<GFW::SamplerFilter MIN_FILTER>
+	BatchFunction GetBatchFunctionForMagnification(bool magLinear, GFW::EdgeSampling edgeSampling)
+	{
+		return magLinear ? GetBatchFunctionForEdge<MIN_FILTER, true>(edgeSampling) : GetBatchFunctionForEdge<MIN_FILTER, false>(edgeSampling);
+	}
+
+	/**
+	 * \return The instantiation of SampleBatch() for a sampler state.
+	 */
+	BatchFunction GetBatchFunction(GFW::SamplerFilter minFilter, GFW::SamplerFilter magFilter, GFW::EdgeSampling edgeSampling)
+	{
+		const bool magLinear = IsLinear(magFilter);
+		switch(minFilter)
+		{
+		case GFW::SamplerFilter::NEAREST:
+			return GetBatchFunctionForMagnification<GFW::SamplerFilter::NEAREST>(magLinear, edgeSampling);
+		case GFW::SamplerFilter::LINEAR:
+			return GetBatchFunctionForMagnification<GFW::SamplerFilter::LINEAR>(magLinear, edgeSampling);
+		case GFW::SamplerFilter::NEAREST_MIPMAP_NEAREST:
+			return GetBatchFunctionForMagnification<GFW::SamplerFilter::NEAREST_MIPMAP_NEAREST>(magLinear, edgeSampling);
+		case GFW::SamplerFilter::LINEAR_MIPMAP_NEAREST:
+			return GetBatchFunctionForMagnification<GFW::SamplerFilter::LINEAR_MIPMAP_NEAREST>(magLinear, edgeSampling);
+		case GFW::SamplerFilter::NEAREST_MIPMAP_LINEAR:
+			return GetBatchFunctionForMagnification<GFW::SamplerFilter::NEAREST_MIPMAP_LINEAR>(magLinear, edgeSampling);
+		default:
+			return GetBatchFunctionForMagnification<GFW::SamplerFilter::LINEAR_MIPMAP_LINEAR>(magLinear, edgeSampling);
+		}
+	}
+
+	/**
+	 * \brief Sample a batch with the instantiation of SampleBatch() for a sampler state. Either @lod or @gradients is nullptr, @maxAnisotropy only
+	 * applies to gradients.
+	 */
+	void RunBatch(const GFW::CpuTexture& texture, GFW::SamplerFilter minFilter, GFW::SamplerFilter magFilter, GFW::EdgeSampling edgeSampling,
+		const GFW::Math::Vec4& borderColor, int maxAnisotropy, const float* u, const float* v, const float* lod, const GFW::Math::Vec4* gradients, int count,
+		GFW::Math::Vec4* result)
+	{
+		GFW_ASSERT(texture.GetLevelCount() > 0 && texture.GetLevelCount() <= MAX_LEVELS);
+		LevelView levels[MAX_LEVELS];
+		for(int level = 0; level < texture.GetLevelCount(); ++level)
+		{
+			const float width = float(texture.GetWidth(level));
+			const float height = float(texture.GetHeight(level));
+			const bool linear = texture.GetLayout() == GFW::TextureLayout::LINEAR;
+			levels[level] = { texture.GetTexels(level), linear ? nullptr : texture.GetColumnOffsets(level), linear ? nullptr : texture.GetRowOffsets(level),
+				size_t(texture.GetWidth(level)) * 4, { width, height, 1.0f / width, 1.0f / height } };
+		}
+
+		BatchInput input;
+		input.levels = levels;
+		input.levelCount = texture.GetLevelCount();
+		input.u = u;
+		input.v = v;
+		input.lod = lod;
+		input.gradients = gradients;
+		input.count = count;
+		input.maxAnisotropy = maxAnisotropy;
+		input.border = BroadcastColor(borderColor);
+		GetBatchFunction(minFilter, magFilter, edgeSampling)(input, result);
+	}
+}
@@ -0,0 +1,637 @@
+#include <CubemapFilter.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <vector>
+#include "Logging.h"
+#include "Simd.h"
+#include "Structures/TextureDescription.h"
+#include "TextureContainer.h"
+#include "TextureUtilities.h"
+
+namespace
+{
+	const float PI = 3.14159265358979f;
+	const int ROWS_PER_TASK = 4;
+
+	/**
+	 * \brief An importance sampled direction of the GGX lobe, in tangent space around the reflection vector.
+	 */
+	struct LobeSample
+	{
+		GFW::Math::Vec3 direction;	// Direction of the sample, z is along the reflection vector.
+		float weight;				// The cosine between the sample and the reflection vector.
+		float level;				// The source mipmap level to read, so the texels cover the solid angle of the sample.
+	};
+
+	/**
+	 * \brief The source cubemap with a full mipmap chain, 4 floats per texel.
+	 */
+	struct SourceChain
+	{
+		int size;								// The size of the base level.
+		int levels;								// The amount of mipmap levels.
+		std::vector<std::vector<float>> faces;	// Texel data, indexed by level * 6 + face.
+	};
+
+#ifdef GFW_SSE2
+	typedef __m128 Color;
+
+	inline Color LoadColor(const float* texel) { return _mm_loadu_ps(texel); }
+	inline Color ZeroColor() { return _mm_setzero_ps(); }
+	inline Color AddColor(Color a, Color b) { return _mm_add_ps(a, b); }
+	inline Color ScaleColor(Color color, float scale) { return _mm_mul_ps(color, _mm_set1_ps(scale)); }
+	inline Color LerpColor(Color a, Color b, float t) { return _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), _mm_set1_ps(t))); }
+	inline void StoreColor(Color color, float* texel) { _mm_storeu_ps(texel, color); }
+#else
+	typedef GFW::Math::Vec4 Color;
+
+	inline Color LoadColor(const float* texel) { return Color(texel[0], texel[1], texel[2], texel[3]); }
+	inline Color ZeroColor() { return Color(0.0f); }
+	inline Color AddColor(Color a, Color b) { return a + b; }
+	inline Color ScaleColor(Color color, float scale) { return color * scale; }
+	inline Color LerpColor(Color a, Color b, float t) { return a + (b - a) * t; }
+	inline void StoreColor(Color color, float* texel) { memcpy(texel, &color[0], sizeof(float) * 4); }
+#endif
+
+	/**
+	 * \brief Bilinearly sample a face, clamping to the edge of the face.
+	 */
+	Color SampleFace(const float* texels, int size, float u, float v)
+	{
+		const float x = std::min(std::max((u * 0.5f + 0.5f) * size - 0.5f, 0.0f), float(size - 1));
+		const float y = std::min(std::max((v * 0.5f + 0.5f) * size - 0.5f, 0.0f), float(size - 1));
+		const int x0 = int(x);
+		const int y0 = int(y);
+		const int x1 = std::min(x0 + 1, size - 1);
+		const int y1 = std::min(y0 + 1, size - 1);
+
+		const Color top = LerpColor(LoadColor(texels + (y0 * size + x0) * 4), LoadColor(texels + (y0 * size + x1) * 4), x - x0);
+		const Color bottom = LerpColor(LoadColor(texels + (y1 * size + x0) * 4), LoadColor(texels + (y1 * size + x1) * 4), x - x0);
+		return LerpColor(top, bottom, y - y0);
+	}
+
+	/**
+	 * \brief Trilinearly sample the source cubemap in a direction.
+	 */
+	Color SampleCube(const SourceChain& source, const GFW::Math::Vec3& direction, float level)
+	{
+		int face;
+		float u, v;
+		GFW::CubemapFilter::GetFaceCoordinates(direction, face, u, v);
+
+		const int level0 = int(level);
+		const Color color0 = SampleFace(source.faces[level0 * 6 + face].data(), GFW::TextureUtilities::GetMipmapDimension(source.size, level0), u, v);
+		if(level0 + 1 >= source.levels || level == float(level0))
+			return color0;
+
+		const Color color1 = SampleFace(source.faces[(level0 + 1) * 6 + face].data(), GFW::TextureUtilities::GetMipmapDimension(source.size, level0 + 1), u, v);
+		return LerpColor(color0, color1, level - level0);
+	}
+
+	/**
+	 * \return Point @index of a Hammersley set of @count points.
+	 */
+	GFW::Math::Vec2 Hammersley(uint32_t index, uint32_t count)
+	{
+		uint32_t bits = index;
+		bits = (bits << 16) | (bits >> 16);
+		bits = ((bits & 0x55555555) << 1) | ((bits & 0xAAAAAAAA) >> 1);
+		bits = ((bits & 0x33333333) << 2) | ((bits & 0xCCCCCCCC) >> 2);
+		bits = ((bits & 0x0F0F0F0F) << 4) | ((bits & 0xF0F0F0F0) >> 4);
+		bits = ((bits & 0x00FF00FF) << 8) | ((bits & 0xFF00FF00) >> 8);
+		return GFW::Math::Vec2(float(index) / count, float(bits) * 2.3283064365386963e-10f);
+	}
+
+	/**
+	 * \brief Importance sample the GGX lobe of @roughness. The view and normal are assumed to equal the reflection vector, so the samples are the same for every texel
+	 * and are calculated once per level. Every sample reads from the source level whose texels cover the solid angle of the sample, which removes the noise of low sample counts.
+	 */
+	std::vector<LobeSample> BuildLobeSamples(float roughness, int sampleCount, int sourceSize, int sourceLevels)
+	{
+		const float alpha = roughness * roughness;
+		const float alpha2 = alpha * alpha;
+		const float texelSolidAngle = 4.0f * PI / (6.0f * sourceSize * sourceSize);
+
+		std::vector<LobeSample> samples;
+		for(int i = 0; i < sampleCount; ++i)
+		{
+			const GFW::Math::Vec2 point = Hammersley(uint32_t(i), uint32_t(sampleCount));
+			const float phi = 2.0f * PI * point.x;
+			const float cosTheta = std::sqrt((1.0f - point.y) / (1.0f + (alpha2 - 1.0f) * point.y));
+			const float sinTheta = std::sqrt(1.0f - cosTheta * cosTheta);
+			const GFW::Math::Vec3 halfVector(sinTheta * std::cos(phi), sinTheta * std::sin(phi), cosTheta);
+			const GFW::Math::Vec3 direction = 2.0f * cosTheta * halfVector - GFW::Math::Vec3(0.0f, 0.0f, 1.0f);
+			if(direction.z <= 0.0f)
+				continue;
+
+			// With the view along the normal the pdf of the reflected direction is D / 4.
+			const float denominator = cosTheta * cosTheta * (alpha2 - 1.0f) + 1.0f;
+			const float pdf = alpha2 / (PI * denominator * denominator) * 0.25f;
+			const float sampleSolidAngle = 1.0f / (sampleCount * pdf + 0.0001f);
+
+			LobeSample sample;
+			sample.direction = direction;
+			sample.weight = direction.z;
+			sample.level = std::min(std::max(0.5f * std::log2(sampleSolidAngle / texelSolidAngle) + 1.0f, 0.0f), float(sourceLevels - 1));
+			samples.push_back(sample);
+		}
+		return samples;
+	}
+
+	void StoreTexel(Color color, GFW::TextureDataType type, unsigned char* destination)
+	{
+		float values[4];
+		StoreColor(color, values);
+		if(type == GFW::TextureDataType::GL_FLOAT)
+			memcpy(destination, values, sizeof(values));
+		else
+		{
+			uint16_t halves[4];
+			for(int channel = 0; channel < 4; ++channel)
+				halves[channel] = GFW::TextureUtilities::FloatToHalf(values[channel]);
+			memcpy(destination, halves, sizeof(halves));
+		}
+	}
+
+	void FilterRows(const SourceChain& source, const std::vector<LobeSample>& samples, int size, GFW::TextureDataType type, unsigned char* const* faces, int begin, int end)
+	{
+		const size_t pixelSize = type == GFW::TextureDataType::GL_FLOAT ? 16 : 8;
+		for(int row = begin; row < end; ++row)
+		{
+			const int face = row / size;
+			const int y = row % size;
+			unsigned char* destination = faces[face] + size_t(y) * size * pixelSize;
+			for(int x = 0; x < size; ++x)
+			{
+				const GFW::Math::Vec3 normal = GFW::CubemapFilter::GetTexelDirection(face, x, y, size);
+				const GFW::Math::Vec3 up = std::abs(normal.z) < 0.999f ? GFW::Math::Vec3(0.0f, 0.0f, 1.0f) : GFW::Math::Vec3(1.0f, 0.0f, 0.0f);
+				const GFW::Math::Vec3 tangent = GFW::Math::Normalize(GFW::Math::Cross(up, normal));
+				const GFW::Math::Vec3 bitangent = GFW::Math::Cross(normal, tangent);
+
+				Color sum = ZeroColor();
+				float totalWeight = 0.0f;
+				for(const LobeSample& sample : samples)
+				{
+					const GFW::Math::Vec3 direction = tangent * sample.direction.x + bitangent * sample.direction.y + normal * sample.direction.z;
+					sum = AddColor(sum, ScaleColor(SampleCube(source, direction, sample.level), sample.weight));
+					totalWeight += sample.weight;
+				}
+				StoreTexel(ScaleColor(sum, 1.0f / totalWeight), type, destination + x * pixelSize);
+			}
+		}
+	}
+
+	const int SH_ROWS_PER_TASK = 16;
+	const float SH_BAND0 = 0.282095f;
+	const float SH_BAND1 = 0.488603f;
+	const float SH_BAND2_XY = 1.092548f;
+	const float SH_BAND2_ZZ = 0.315392f;
+	const float SH_BAND2_XX_YY = 0.546274f;
+
+	// Direction of every face as a linear function of (u, v, 1), per axis.
+	const float FACE_AXES[6][3][3] =
+	{
+		{ { 0.0f, 0.0f, 1.0f }, { 0.0f, -1.0f, 0.0f }, { -1.0f, 0.0f, 0.0f } },
+		{ { 0.0f, 0.0f, -1.0f }, { 0.0f, -1.0f, 0.0f }, { 1.0f, 0.0f, 0.0f } },
+		{ { 1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 1.0f, 0.0f } },
+		{ { 1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, -1.0f }, { 0.0f, -1.0f, 0.0f } },
+		{ { 1.0f, 0.0f, 0.0f }, { 0.0f, -1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f } },
+		{ { -1.0f, 0.0f, 0.0f }, { 0.0f, -1.0f, 0.0f }, { 0.0f, 0.0f, -1.0f } }
+	};
+
+	/**
+	 * \brief Per texel data shared by all faces of the same size. Rows are padded to a multiple of 4 texels with zero weights.
+	 */
+	struct TexelTable
+	{
+		int stride;					// The padded amount of texels per row.
+		std::vector<float> u;		// The horizontal face coordinate of every column.
+		std::vector<float> weights;	// The solid angle of every texel.
+	};
+
+	/**
+	 * \brief The coefficients accumulated over a block of rows, reduced in a fixed order once every block is done so the result doesn't depend on the threads.
+	 */
+	struct PartialSums
+	{
+		float sums[9][3];	// RGB sum of every basis function.
+	};
+
+	void BuildTexelTable(int size, TexelTable& table)
+	{
+		table.stride = (size + 3) / 4 * 4;
+		table.u.assign(size_t(table.stride), 0.0f);
+		table.weights.assign(size_t(table.stride) * size, 0.0f);
+		for(int x = 0; x < size; ++x)
+			table.u[x] = (x + 0.5f) / size * 2.0f - 1.0f;
+		for(int y = 0; y < size; ++y)
+		{
+			for(int x = 0; x < size; ++x)
+				table.weights[size_t(y) * table.stride + x] = GFW::CubemapFilter::GetTexelSolidAngle(x, y, size);
+		}
+	}
+
+	bool IsProjectable(const GFW::CubemapFaces& cubemap)
+	{
+		return cubemap.size > 0 && !GFW::TextureUtilities::IsCompressed(cubemap.format) && !GFW::TextureUtilities::IsInteger(cubemap.format) &&
+			!GFW::TextureUtilities::IsDepthOrStencil(cubemap.format) && (cubemap.type == GFW::TextureDataType::GL_UNSIGNED_BYTE ||
+			cubemap.type == GFW::TextureDataType::GL_UNSIGNED_SHORT || cubemap.type == GFW::TextureDataType::GL_FLOAT || cubemap.type == GFW::TextureDataType::GL_HALF_FLOAT);
+	}
+
+
+	/**
+	 * \brief Convert a row of a face to separate red, green and blue floats.
+	 */
+	void ReadRow(const GFW::CubemapFaces& cubemap, int face, int y, float* red, float* green, float* blue)
+	{
+		const int channels = GFW::TextureUtilities::GetChannelCount(cubemap.format);
+		const size_t rowStart = size_t(y) * cubemap.size * channels;
+		for(int x = 0; x < cubemap.size; ++x)
+		{
+			const size_t texel = rowStart + size_t(x) * channels;
+			red[x] = GFW::TextureUtilities::ReadComponent(cubemap.faces[face], cubemap.type, texel);
+			green[x] = channels > 1 ? GFW::TextureUtilities::ReadComponent(cubemap.faces[face], cubemap.type, texel + 1) : red[x];
+			blue[x] = channels > 2 ? GFW::TextureUtilities::ReadComponent(cubemap.faces[face], cubemap.type, texel + 2) : (channels == 1 ? red[x] : 0.0f);
+		}
+	}
+
+	/**
+	 * \brief Accumulate the solid angle weighted projection of a block of rows of a face onto the basis functions.
+	 */
+	void ProjectRows(const GFW::CubemapFaces& cubemap, const TexelTable& table, int coefficientCount, int face, int begin, int end, PartialSums& partial)
+	{
+		std::vector<float> colors(size_t(table.stride) * 3, 0.0f);
+		float* red = colors.data();
+		float* green = red + table.stride;
+		float* blue = green + table.stride;
+		const float (&axes)[3][3] = FACE_AXES[face];
+
+#ifdef GFW_SSE2
+		__m128 sums[9][3];
+		for(int i = 0; i < 9; ++i)
+			sums[i][0] = sums[i][1] = sums[i][2] = _mm_setzero_ps();
+#else
+		memset(partial.sums, 0, sizeof(partial.sums));
+#endif
+
+		for(int y = begin; y < end; ++y)
+		{
+			ReadRow(cubemap, face, y, red, green, blue);
+			const float v = (y + 0.5f) / cubemap.size * 2.0f - 1.0f;
+			const float* weights = table.weights.data() + size_t(y) * table.stride;
+
+#ifdef GFW_SSE2
+			// 4 texels at a time, the padding texels have zero weight.
+			const __m128 scaleU[3] = { _mm_set1_ps(axes[0][0]), _mm_set1_ps(axes[1][0]), _mm_set1_ps(axes[2][0]) };
+			const __m128 offset[3] = { _mm_set1_ps(axes[0][1] * v + axes[0][2]), _mm_set1_ps(axes[1][1] * v + axes[1][2]), _mm_set1_ps(axes[2][1] * v + axes[2][2]) };
+			const __m128 lengthBase = _mm_set1_ps(v * v + 1.0f);
+			for(int x = 0; x < table.stride; x += 4)
+			{
+				const __m128 u = _mm_loadu_ps(table.u.data() + x);
+				const __m128 inverseLength = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(u, u), lengthBase)));
+				const __m128 dx = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(scaleU[0], u), offset[0]), inverseLength);
+				const __m128 dy = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(scaleU[1], u), offset[1]), inverseLength);
+				const __m128 dz = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(scaleU[2], u), offset[2]), inverseLength);
+
+				__m128 basis[9];
+				basis[0] = _mm_set1_ps(SH_BAND0);
+				basis[1] = _mm_mul_ps(_mm_set1_ps(SH_BAND1), dy);
+				basis[2] = _mm_mul_ps(_mm_set1_ps(SH_BAND1), dz);
+				basis[3] = _mm_mul_ps(_mm_set1_ps(SH_BAND1), dx);
+				basis[4] = _mm_mul_ps(_mm_set1_ps(SH_BAND2_XY), _mm_mul_ps(dx, dy));
+				basis[5] = _mm_mul_ps(_mm_set1_ps(SH_BAND2_XY), _mm_mul_ps(dy, dz));
+				basis[6] = _mm_mul_ps(_mm_set1_ps(SH_BAND2_ZZ), _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(3.0f), _mm_mul_ps(dz, dz)), _mm_set1_ps(1.0f)));
+				basis[7] = _mm_mul_ps(_mm_set1_ps(SH_BAND2_XY), _mm_mul_ps(dx, dz));
+				basis[8] = _mm_mul_ps(_mm_set1_ps(SH_BAND2_XX_YY), _mm_sub_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+
+				const __m128 weight = _mm_loadu_ps(weights + x);
+				const __m128 r = _mm_mul_ps(_mm_loadu_ps(red + x), weight);
+				const __m128 g = _mm_mul_ps(_mm_loadu_ps(green + x), weight);
+				const __m128 b = _mm_mul_ps(_mm_loadu_ps(blue + x), weight);
+				for(int i = 0; i < coefficientCount; ++i)
+				{
+					sums[i][0] = _mm_add_ps(sums[i][0], _mm_mul_ps(basis[i], r));
+					sums[i][1] = _mm_add_ps(sums[i][1], _mm_mul_ps(basis[i], g));
+					sums[i][2] = _mm_add_ps(sums[i][2], _mm_mul_ps(basis[i], b));
+				}
+			}
+#else
+			for(int x = 0; x < cubemap.size; ++x)
+			{
+				const float u = table.u[x];
+				const float inverseLength = 1.0f / std::sqrt(u * u + v * v + 1.0f);
+				const float dx = (axes[0][0] * u + axes[0][1] * v + axes[0][2]) * inverseLength;
+				const float dy = (axes[1][0] * u + axes[1][1] * v + axes[1][2]) * inverseLength;
+				const float dz = (axes[2][0] * u + axes[2][1] * v + axes[2][2]) * inverseLength;
+				const float basis[9] = { SH_BAND0, SH_BAND1 * dy, SH_BAND1 * dz, SH_BAND1 * dx, SH_BAND2_XY * dx * dy, SH_BAND2_XY * dy * dz,
+					SH_BAND2_ZZ * (3.0f * dz * dz - 1.0f), SH_BAND2_XY * dx * dz, SH_BAND2_XX_YY * (dx * dx - dy * dy) };
+				for(int i = 0; i < coefficientCount; ++i)
+				{
+					partial.sums[i][0] += basis[i] * red[x] * weights[x];
+					partial.sums[i][1] += basis[i] * green[x] * weights[x];
+					partial.sums[i][2] += basis[i] * blue[x] * weights[x];
+				}
+			}
+#endif
+		}
+
+#ifdef GFW_SSE2
+		for(int i = 0; i < 9; ++i)
+		{
+			for(int channel = 0; channel < 3; ++channel)
+			{
+				float lanes[4];
+				_mm_storeu_ps(lanes, sums[i][channel]);
+				partial.sums[i][channel] = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+			}
+		}
+#endif
+	}
+}
+
+/**
+ * \brief Get the direction that points at a position on a face.
+ * \param face The face, ordered +X, -X, +Y, -Y, +Z, -Z.
+ * \param u The horizontal position on the face, from -1 (left) to 1 (right).
+ * \param v The vertical position on the face, from -1 (top) to 1 (bottom).
+ * \return The direction, not normalized.
+ */
+GFW::Math::Vec3 GFW::CubemapFilter::GetDirection(int face, float u, float v)
+{
+	switch(face)
+	{
+	case 0: return Math::Vec3(1.0f, -v, -u);
+	case 1: return Math::Vec3(-1.0f, -v, u);
+	case 2: return Math::Vec3(u, 1.0f, v);
+	case 3: return Math::Vec3(u, -1.0f, -v);
+	case 4: return Math::Vec3(u, -v, 1.0f);
+	default: return Math::Vec3(-u, -v, -1.0f);
+	}
+}
+
+/**
+ * \return The normalized direction that points at the center of texel (@x, @y) of a face with @size texels on each side.
+ */
+GFW::Math::Vec3 GFW::CubemapFilter::GetTexelDirection(int face, int x, int y, int size)
+{
+	return Math::Normalize(GetDirection(face, (x + 0.5f) / size * 2.0f - 1.0f, (y + 0.5f) / size * 2.0f - 1.0f));
+}
+
+/**
+ * \brief Find the face and the position on it that a direction points at. The inverse of GetDirection().
+ * \param direction The direction, doesn't need to be normalized.
+ * \param face Set to the face.
+ * \param u Set to the horizontal position on the face, from -1 to 1.
+ * \param v Set to the vertical position on the face, from -1 to 1.
+ */
+void GFW::CubemapFilter::GetFaceCoordinates(const Math::Vec3& direction, int& face, float& u, float& v)
+{
+	const Math::Vec3 absolute = Math::Abs(direction);
+	if(absolute.x >= absolute.y && absolute.x >= absolute.z)
+	{
+		face = direction.x > 0.0f ? 0 : 1;
+		u = (direction.x > 0.0f ? -direction.z : direction.z) / absolute.x;
+		v = -direction.y / absolute.x;
+	}
+	else if(absolute.y >= absolute.z)
+	{
+		face = direction.y > 0.0f ? 2 : 3;
+		u = direction.x / absolute.y;
+		v = (direction.y > 0.0f ? direction.z : -direction.z) / absolute.y;
+	}
+	else
+	{
+		face = direction.z > 0.0f ? 4 : 5;
+		u = (direction.z > 0.0f ? direction.x : -direction.x) / absolute.z;
+		v = -direction.y / absolute.z;
+	}
+}
+
+/**
+ * \brief Calculate the solid angle a texel of a face covers. Texels near the edges of a face cover less of the sphere than texels in the center.
+ * \param x The column of the texel.
+ * \param y The row of the texel.
+ * \param size The amount of texels on each side of the face.
+ * \return The solid angle in steradians. The solid angles of all texels of all faces add up to 4 pi.
+ */
+float GFW::CubemapFilter::GetTexelSolidAngle(int x, int y, int size)
+{
+	// The solid angle of the area between the center of the face and a position on it is atan2(u * v, sqrt(u * u + v * v + 1)).
+	const auto area = [](float u, float v) { return std::atan2(u * v, std::sqrt(u * u + v * v + 1.0f)); };
+	const float u0 = float(x) / size * 2.0f - 1.0f;
+	const float v0 = float(y) / size * 2.0f - 1.0f;
+	const float u1 = float(x + 1) / size * 2.0f - 1.0f;
+	const float v1 = float(y + 1) / size * 2.0f - 1.0f;
+	return area(u0, v0) - area(u0, v1) - area(u1, v0) + area(u1, v1);
+}
+
+/**
+ * \brief Prefilter an environment cubemap with the GGX distribution for image based lighting. Level 0 is a copy of the source, the roughness increases linearly
+ * to 1 at the last level. Every texel importance samples the lobe of its level, the faces and rows are filtered in parallel.
+ * \param source The base level of the faces of the environment, 4 floats per texel.
+ * \param size The amount of texels on each side of the faces.
+ * \param levels The amount of levels to generate. Limited to the full mipmap chain of @size.
+ * \param type GL_FLOAT for RGBA32F output or GL_HALF_FLOAT for RGBA16F output.
+ * \param destination Output for the tightly packed faces of every level, indexed by level * 6 + face like TextureContainer::UploadLevels() expects.
+ * \param sampleCount The amount of samples per texel.
+ * \param threadPool The pool to filter on. nullptr to use the default thread pool.
+ * \return False if @type isn't supported.
+ */
+bool GFW::CubemapFilter::PrefilterSpecular(const float* const source[6], int size, int levels, TextureDataType type, unsigned char* const* destination, int sampleCount,
+	ThreadPool* threadPool)
+{
+	GFW_ASSERT(source && destination && size > 0 && levels > 0 && sampleCount > 0);
+	if(type != TextureDataType::GL_FLOAT && type != TextureDataType::GL_HALF_FLOAT)
+		return false;
+
+	SourceChain chain;
+	chain.size = size;
+	chain.levels = TextureUtilities::GetMipmapCount(size);
+	chain.faces.resize(size_t(chain.levels) * 6);
+	for(int face = 0; face < 6; ++face)
+		chain.faces[face].assign(source[face], source[face] + size_t(size) * size * 4);
+	for(int level = 1; level < chain.levels; ++level)
+	{
+		const int levelSize = TextureUtilities::GetMipmapDimension(size, level);
+		const int parentSize = TextureUtilities::GetMipmapDimension(size, level - 1);
+		for(int face = 0; face < 6; ++face)
+		{
+			std::vector<float>& faceData = chain.faces[level * 6 + face];
+			faceData.resize(size_t(levelSize) * levelSize * 4);
+			TextureUtilities::GenerateMipmap(TextureFormat::RGBA32F, TextureDataType::GL_FLOAT, reinterpret_cast<const unsigned char*>(chain.faces[(level - 1) * 6 + face].data()),
+				parentSize, parentSize, reinterpret_cast<unsigned char*>(faceData.data()));
+		}
+	}
+
+	ThreadPool& pool = threadPool ? *threadPool : ThreadPool::GetDefault();
+	levels = std::min(levels, chain.levels);
+	const size_t pixelSize = type == TextureDataType::GL_FLOAT ? 16 : 8;
+	for(int level = 0; level < levels; ++level)
+	{
+		const int levelSize = TextureUtilities::GetMipmapDimension(size, level);
+		unsigned char* const* faces = destination + level * 6;
+		if(level == 0)
+		{
+			for(int face = 0; face < 6; ++face)
+			{
+				for(size_t texel = 0; texel < size_t(size) * size; ++texel)
+					StoreTexel(LoadColor(source[face] + texel * 4), type, faces[face] + texel * pixelSize);
+			}
+			continue;
+		}
+
+		const float roughness = float(level) / float(levels - 1);
+		const std::vector<LobeSample> samples = BuildLobeSamples(roughness, sampleCount, size, chain.levels);
+		pool.ParallelFor(0, levelSize * 6, [&](int begin, int end) { FilterRows(chain, samples, levelSize, type, faces, begin, end); }, ROWS_PER_TASK);
+	}
+	return true;
+}
+
+/**
+ * \brief Prefilter an environment cubemap with PrefilterSpecular() and initialize a cubemap texture with the result.
+ * \param texture The texture to initialize as cubemap with @levels mipmap levels.
+ * \param source The base level of the faces of the environment, 4 floats per texel.
+ * \param size The amount of texels on each side of the faces.
+ * \param levels The amount of levels to generate. Limited to the full mipmap chain of @size.
+ * \param type GL_FLOAT for an RGBA32F texture or GL_HALF_FLOAT for an RGBA16F texture.
+ * \param sampleCount The amount of samples per texel.
+ * \param threadPool The pool to filter on. nullptr to use the default thread pool.
+ * \return False if @type isn't supported.
+ */
+bool GFW::CubemapFilter::CreatePrefilteredCube(ITexture* texture, const float* const source[6], int size, int levels, TextureDataType type, int sampleCount,
+	ThreadPool* threadPool)
+{
+	GFW_ASSERT(texture);
+	TextureDescription description;
+	description.format = type == TextureDataType::GL_FLOAT ? TextureFormat::RGBA32F : TextureFormat::RGBA16F;
+	description.type = type;
+	description.width = size;
+	description.height = size;
+	description.faces = 6;
+	description.levels = std::min(levels, TextureUtilities::GetMipmapCount(size));
+
+	std::vector<std::vector<unsigned char>> data(size_t(description.levels) * 6);
+	std::vector<unsigned char*> slices(data.size());
+	for(size_t slice = 0; slice < data.size(); ++slice)
+	{
+		const int levelSize = TextureUtilities::GetMipmapDimension(size, int(slice / 6));
+		data[slice].resize(size_t(TextureUtilities::GetDataSize(description.format, type, levelSize, levelSize)));
+		slices[slice] = data[slice].data();
+	}
+
+	if(!PrefilterSpecular(source, size, description.levels, type, slices.data(), sampleCount, threadPool))
+		return false;
+	TextureContainer::UploadLevels(texture, description, slices.data(), true);
+	return true;
+}
+
+/**
+ * \brief Project the irradiance of a cubemap onto spherical harmonics. Every texel is weighted by its solid angle and the projected radiance is convolved
+ * with the cosine lobe, so evaluating the result in the direction of a normal gives the irradiance. Divide by pi for the radiance of a white diffuse surface.
+ * \param cubemap The faces of the cubemap.
+ * \param order 2 for 4 coefficients or 3 for 9 coefficients.
+ * \param irradiance Set to the coefficients of the irradiance.
+ * \param threadPool The pool to project on. nullptr to use the default thread pool.
+ * \return False if @order or the format of the cubemap isn't supported.
+ */
+bool GFW::CubemapFilter::ProjectIrradiance(const CubemapFaces& cubemap, int order, SphericalHarmonics& irradiance, ThreadPool* threadPool)
+{
+	return ProjectIrradiance(&cubemap, 1, order, &irradiance, threadPool);
+}
+
+/**
+ * \brief Project the irradiance of many cubemaps onto spherical harmonics at once, like all light probes of a scene.
+ * The rows of all cubemaps are split into blocks that are projected in parallel, so small probes still use every thread.
+ * \param cubemaps The faces of every cubemap.
+ * \param count The amount of cubemaps.
+ * \param order 2 for 4 coefficients or 3 for 9 coefficients.
+ * \param irradiance Output for the coefficients of the irradiance of every cubemap.
+ * \param threadPool The pool to project on. nullptr to use the default thread pool.
+ * \return False if @order or the format of one of the cubemaps isn't supported, nothing is projected in that case.
+ */
+bool GFW::CubemapFilter::ProjectIrradiance(const CubemapFaces* cubemaps, int count, int order, SphericalHarmonics* irradiance, ThreadPool* threadPool)
+{
+	GFW_ASSERT(count >= 0 && (count == 0 || (cubemaps && irradiance)));
+	if(order != 2 && order != 3)
+		return false;
+	for(int i = 0; i < count; ++i)
+	{
+		if(!IsProjectable(cubemaps[i]))
+			return false;
+	}
+
+	// Blocks of rows are numbered across all cubemaps, every block writes its own partial sums.
+	// Tables are resolved to pointers here, the workers must not touch the map.
+	std::map<int, TexelTable> tables;
+	std::vector<const TexelTable*> cubemapTables(size_t(count), nullptr);
+	std::vector<int> firstBlocks(size_t(count) + 1, 0);
+	for(int i = 0; i < count; ++i)
+	{
+		auto table = tables.find(cubemaps[i].size);
+		if(table == tables.end())
+		{
+			table = tables.emplace(cubemaps[i].size, TexelTable()).first;
+			BuildTexelTable(cubemaps[i].size, table->second);
+		}
+		cubemapTables[i] = &table->second;
+		firstBlocks[i + 1] = firstBlocks[i] + 6 * ((cubemaps[i].size + SH_ROWS_PER_TASK - 1) / SH_ROWS_PER_TASK);
+	}
+
+	const int coefficientCount = order * order;
+	std::vector<PartialSums> partials(size_t(firstBlocks[count]));
+	ThreadPool& pool = threadPool ? *threadPool : ThreadPool::GetDefault();
+	pool.ParallelFor(0, firstBlocks[count], [&](int begin, int end)
+	{
+		for(int block = begin; block < end; ++block)
+		{
+			const int cubemap = int(std::upper_bound(firstBlocks.begin(), firstBlocks.end(), block) - firstBlocks.begin()) - 1;
+			const int size = cubemaps[cubemap].size;
+			const int blocksPerFace = (size + SH_ROWS_PER_TASK - 1) / SH_ROWS_PER_TASK;
+			const int faceBlock = block - firstBlocks[cubemap];
+			const int firstRow = faceBlock % blocksPerFace * SH_ROWS_PER_TASK;
+			ProjectRows(cubemaps[cubemap], *cubemapTables[cubemap], coefficientCount, faceBlock / blocksPerFace, firstRow, std::min(firstRow + SH_ROWS_PER_TASK, size), partials[block]);
+		}
+	});
+
+	// Convolving with the cosine lobe scales every band by a constant.
+	const float bandScales[3] = { PI, 2.0f * PI / 3.0f, PI / 4.0f };
+	for(int i = 0; i < count; ++i)
+	{
+		irradiance[i].order = order;
+		for(int coefficient = 0; coefficient < 9; ++coefficient)
+			irradiance[i].coefficients[coefficient] = Math::Vec3(0.0f);
+
+		for(int block = firstBlocks[i]; block < firstBlocks[i + 1]; ++block)
+		{
+			for(int coefficient = 0; coefficient < coefficientCount; ++coefficient)
+				irradiance[i].coefficients[coefficient] += Math::Vec3(partials[block].sums[coefficient][0], partials[block].sums[coefficient][1], partials[block].sums[coefficient][2]);
+		}
+		for(int coefficient = 0; coefficient < coefficientCount; ++coefficient)
+			irradiance[i].coefficients[coefficient] *= bandScales[coefficient == 0 ? 0 : coefficient < 4 ? 1 : 2];
+	}
+	return true;
+}
+
+/**
+ * \brief Evaluate spherical harmonics in a direction.
+ * \param harmonics The coefficients to evaluate.
+ * \param direction The normalized direction.
+ * \return The RGB value of the function in @direction.
+ */
+GFW::Math::Vec3 GFW::CubemapFilter::EvaluateSphericalHarmonics(const SphericalHarmonics& harmonics, const Math::Vec3& direction)
+{
+	const float x = direction.x;
+	const float y = direction.y;
+	const float z = direction.z;
+	Math::Vec3 result = harmonics.coefficients[0] * SH_BAND0;
+	result += harmonics.coefficients[1] * (SH_BAND1 * y) + harmonics.coefficients[2] * (SH_BAND1 * z) + harmonics.coefficients[3] * (SH_BAND1 * x);
+	if(harmonics.order > 2)
+	{
+		result += harmonics.coefficients[4] * (SH_BAND2_XY * x * y) + harmonics.coefficients[5] * (SH_BAND2_XY * y * z) +
+			harmonics.coefficients[6] * (SH_BAND2_ZZ * (3.0f * z * z - 1.0f)) + harmonics.coefficients[7] * (SH_BAND2_XY * x * z) +
+			harmonics.coefficients[8] * (SH_BAND2_XX_YY * (x * x - y * y));
+	}
+	return result;
+}
@@ -0,0 +1,507 @@
+#include <DdsKtxFile.h>
+#include <cstring>
+#include "Logging.h"
+#include "TextureContainer.h"
+#include "TextureUtilities.h"
+
+namespace
+{
+	const char DDS_MAGIC[4] = { 'D', 'D', 'S', ' ' };
+	const unsigned char KTX_IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+	const uint32_t KTX_ENDIANNESS = 0x04030201;
+
+	const uint32_t DDSD_MIPMAPCOUNT = 0x20000;
+	const uint32_t DDPF_ALPHAPIXELS = 0x1;
+	const uint32_t DDPF_FOURCC = 0x4;
+	const uint32_t DDPF_RGB = 0x40;
+	const uint32_t DDPF_LUMINANCE = 0x20000;
+	const uint32_t DDPF_BUMPDUDV = 0x80000;
+	const uint32_t DDSCAPS2_CUBEMAP = 0x200;
+	const uint32_t DDSCAPS2_CUBEMAP_ALLFACES = 0xFC00;
+	const uint32_t DDSCAPS2_VOLUME = 0x200000;
+	const uint32_t DDS_DIMENSION_TEXTURE1D = 2;
+	const uint32_t DDS_DIMENSION_TEXTURE3D = 4;
+	const uint32_t DDS_RESOURCE_MISC_TEXTURECUBE = 0x4;
+
+	/**
+	 * \brief The pixel format in a DDS header. All values are stored little endian.
+	 */
+	struct DdsPixelFormat
+	{
+		uint32_t size;			// Always 32
+		uint32_t flags;			// DDPF flags describing which of the other fields are valid
+		uint32_t fourCC;		// Four character code or D3DFORMAT of compressed and floating point formats
+		uint32_t rgbBitCount;	// Bits per pixel of uncompressed formats
+		uint32_t redMask;		// Mask of the red channel of uncompressed formats
+		uint32_t greenMask;		// Mask of the green channel of uncompressed formats
+		uint32_t blueMask;		// Mask of the blue channel of uncompressed formats
+		uint32_t alphaMask;		// Mask of the alpha channel of uncompressed formats
+	};
+
+	/**
+	 * \brief The header following the magic of a DDS file.
+	 */
+	struct DdsHeader
+	{
+		uint32_t size;				// Always 124
+		uint32_t flags;				// DDSD flags describing which of the other fields are valid
+		uint32_t height;			// Height of the base level
+		uint32_t width;				// Width of the base level
+		uint32_t pitchOrLinearSize;	// Unused, the sizes are derived from the format
+		uint32_t depth;				// Depth of the base level of volume textures
+		uint32_t mipMapCount;		// Amount of mipmap levels when DDSD_MIPMAPCOUNT is set
+		uint32_t reserved1[11];		// Unused
+		DdsPixelFormat pixelFormat;	// Format of the pixel data
+		uint32_t caps;				// DDSCAPS flags
+		uint32_t caps2;				// DDSCAPS2 flags for cubemaps and volume textures
+		uint32_t caps3;				// Unused
+		uint32_t caps4;				// Unused
+		uint32_t reserved2;			// Unused
+	};
+
+	/**
+	 * \brief The extended header following DdsHeader when the four character code is "DX10".
+	 */
+	struct DdsHeaderDx10
+	{
+		uint32_t dxgiFormat;		// DXGI_FORMAT of the pixel data
+		uint32_t resourceDimension;	// 2 for 1D, 3 for 2D and 4 for 3D textures
+		uint32_t miscFlag;			// DDS_RESOURCE_MISC_TEXTURECUBE for cubemaps
+		uint32_t arraySize;			// Amount of array layers, of cubemaps for cubemap arrays
+		uint32_t miscFlags2;		// Alpha mode, unused
+	};
+
+	/**
+	 * \brief The header following the identifier of a KTX file.
+	 */
+	struct KtxHeader
+	{
+		uint32_t endianness;			// 0x04030201 in the endianness the file is written in
+		uint32_t glType;				// Data type of uncompressed pixel data, 0 for compressed formats
+		uint32_t glTypeSize;			// Size of @glType for endianness conversion
+		uint32_t glFormat;				// Pixel format of uncompressed pixel data, 0 for compressed formats
+		uint32_t glInternalFormat;		// The sized internal format of the texture
+		uint32_t glBaseInternalFormat;	// The base internal format of the texture
+		uint32_t pixelWidth;			// Width of the base level
+		uint32_t pixelHeight;			// Height of the base level, 0 for 1D textures
+		uint32_t pixelDepth;			// Depth of the base level, 0 for anything but 3D textures
+		uint32_t numberOfArrayElements;	// Amount of array layers, 0 for textures that aren't arrays
+		uint32_t numberOfFaces;			// 6 for cubemaps, 1 otherwise
+		uint32_t numberOfMipmapLevels;	// Amount of mipmap levels, 0 when the mipmaps should be generated
+		uint32_t bytesOfKeyValueData;	// Size of the key value data following the header
+	};
+
+	/**
+	 * \brief Maps a format identifier used by a file format onto a TextureFormat.
+	 */
+	struct FormatMapping
+	{
+		uint32_t identifier;			// DXGI_FORMAT, D3DFORMAT or OpenGL internal format
+		GFW::TextureFormat format;		// The matching TextureFormat
+	};
+
+	const FormatMapping DXGI_FORMATS[] =
+	{
+		{ 2, GFW::TextureFormat::RGBA32F }, { 3, GFW::TextureFormat::RGBA32UI }, { 4, GFW::TextureFormat::RGBA32I },
+		{ 6, GFW::TextureFormat::RGB32F }, { 7, GFW::TextureFormat::RGB32UI }, { 8, GFW::TextureFormat::RGB32I },
+		{ 10, GFW::TextureFormat::RGBA16F }, { 11, GFW::TextureFormat::RGBA16 }, { 12, GFW::TextureFormat::RGBA16UI }, { 14, GFW::TextureFormat::RGBA16I },
+		{ 16, GFW::TextureFormat::RG32F }, { 17, GFW::TextureFormat::RG32UI }, { 18, GFW::TextureFormat::RG32I },
+		{ 28, GFW::TextureFormat::RGBA8 }, { 30, GFW::TextureFormat::RGBA8UI }, { 31, GFW::TextureFormat::RGBA8_SNORM }, { 32, GFW::TextureFormat::RGBA8I },
+		{ 34, GFW::TextureFormat::RG16F }, { 35, GFW::TextureFormat::RG16 }, { 36, GFW::TextureFormat::RG16UI }, { 37, GFW::TextureFormat::RG16_SNORM },
+		{ 38, GFW::TextureFormat::RG16I }, { 41, GFW::TextureFormat::R32F }, { 42, GFW::TextureFormat::R32UI }, { 43, GFW::TextureFormat::R32I },
+		{ 49, GFW::TextureFormat::RG8 }, { 50, GFW::TextureFormat::RG8UI }, { 51, GFW::TextureFormat::RG8_SNORM }, { 52, GFW::TextureFormat::RG8I },
+		{ 54, GFW::TextureFormat::R16F }, { 56, GFW::TextureFormat::R16 }, { 57, GFW::TextureFormat::R16UI }, { 58, GFW::TextureFormat::R16_SNORM },
+		{ 59, GFW::TextureFormat::R16I }, { 61, GFW::TextureFormat::R8 }, { 62, GFW::TextureFormat::R8UI }, { 63, GFW::TextureFormat::R8_SNORM },
+		{ 64, GFW::TextureFormat::R8I },
+		{ 71, GFW::TextureFormat::COMPRESSED_RGBA_S3TC_DXT1 }, { 72, GFW::TextureFormat::COMPRESSED_SRGB_ALPHA_S3TC_DXT1 },
+		{ 74, GFW::TextureFormat::COMPRESSED_RGBA_S3TC_DXT3 }, { 75, GFW::TextureFormat::COMPRESSED_SRGB_ALPHA_S3TC_DXT3 },
+		{ 77, GFW::TextureFormat::COMPRESSED_RGBA_S3TC_DXT5 }, { 78, GFW::TextureFormat::COMPRESSED_SRGB_ALPHA_S3TC_DXT5 }
+	};
+
+	// Four character codes and D3DFORMAT values of DDS files without the DX10 header.
+	const FormatMapping DDS_FOURCC_FORMATS[] =
+	{
+		{ 0x31545844 /*DXT1*/, GFW::TextureFormat::COMPRESSED_RGBA_S3TC_DXT1 },
+		{ 0x32545844 /*DXT2*/, GFW::TextureFormat::COMPRESSED_RGBA_S3TC_DXT3 }, { 0x33545844 /*DXT3*/, GFW::TextureFormat::COMPRESSED_RGBA_S3TC_DXT3 },
+		{ 0x34545844 /*DXT4*/, GFW::TextureFormat::COMPRESSED_RGBA_S3TC_DXT5 }, { 0x35545844 /*DXT5*/, GFW::TextureFormat::COMPRESSED_RGBA_S3TC_DXT5 },
+		{ 36, GFW::TextureFormat::RGBA16 }, { 111, GFW::TextureFormat::R16F }, { 112, GFW::TextureFormat::RG16F }, { 113, GFW::TextureFormat::RGBA16F },
+		{ 114, GFW::TextureFormat::R32F }, { 115, GFW::TextureFormat::RG32F }, { 116, GFW::TextureFormat::RGBA32F }
+	};
+
+	const FormatMapping KTX_FORMATS[] =
+	{
+		{ 0x8229, GFW::TextureFormat::R8 }, { 0x8F94, GFW::TextureFormat::R8_SNORM }, { 0x822A, GFW::TextureFormat::R16 }, { 0x8F98, GFW::TextureFormat::R16_SNORM },
+		{ 0x822B, GFW::TextureFormat::RG8 }, { 0x8F95, GFW::TextureFormat::RG8_SNORM }, { 0x822C, GFW::TextureFormat::RG16 }, { 0x8F99, GFW::TextureFormat::RG16_SNORM },
+		{ 0x8F9A, GFW::TextureFormat::RGB16_SNORM }, { 0x8058, GFW::TextureFormat::RGBA8 }, { 0x8F97, GFW::TextureFormat::RGBA8_SNORM }, { 0x805B, GFW::TextureFormat::RGBA16 },
+		{ 0x822D, GFW::TextureFormat::R16F }, { 0x822F, GFW::TextureFormat::RG16F }, { 0x881A, GFW::TextureFormat::RGBA16F }, { 0x822E, GFW::TextureFormat::R32F },
+		{ 0x8230, GFW::TextureFormat::RG32F }, { 0x8815, GFW::TextureFormat::RGB32F }, { 0x8814, GFW::TextureFormat::RGBA32F },
+		{ 0x8231, GFW::TextureFormat::R8I }, { 0x8232, GFW::TextureFormat::R8UI }, { 0x8233, GFW::TextureFormat::R16I }, { 0x8234, GFW::TextureFormat::R16UI },
+		{ 0x8235, GFW::TextureFormat::R32I }, { 0x8236, GFW::TextureFormat::R32UI }, { 0x8237, GFW::TextureFormat::RG8I }, { 0x8238, GFW::TextureFormat::RG8UI },
+		{ 0x8239, GFW::TextureFormat::RG16I }, { 0x823A, GFW::TextureFormat::RG16UI }, { 0x823B, GFW::TextureFormat::RG32I }, { 0x823C, GFW::TextureFormat::RG32UI },
+		{ 0x8D83, GFW::TextureFormat::RGB32I }, { 0x8D71, GFW::TextureFormat::RGB32UI }, { 0x8D8E, GFW::TextureFormat::RGBA8I }, { 0x8D7C, GFW::TextureFormat::RGBA8UI },
+		{ 0x8D88, GFW::TextureFormat::RGBA16I }, { 0x8D76, GFW::TextureFormat::RGBA16UI }, { 0x8D82, GFW::TextureFormat::RGBA32I }, { 0x8D70, GFW::TextureFormat::RGBA32UI },
+		{ 0x83F0, GFW::TextureFormat::COMPRESSED_RGB_S3TC_DXT1 }, { 0x83F1, GFW::TextureFormat::COMPRESSED_RGBA_S3TC_DXT1 },
+		{ 0x83F2, GFW::TextureFormat::COMPRESSED_RGBA_S3TC_DXT3 }, { 0x83F3, GFW::TextureFormat::COMPRESSED_RGBA_S3TC_DXT5 },
+		{ 0x8C4C, GFW::TextureFormat::COMPRESSED_SRGB_S3TC_DXT1 }, { 0x8C4D, GFW::TextureFormat::COMPRESSED_SRGB_ALPHA_S3TC_DXT1 },
+		{ 0x8C4E, GFW::TextureFormat::COMPRESSED_SRGB_ALPHA_S3TC_DXT3 }, { 0x8C4F, GFW::TextureFormat::COMPRESSED_SRGB_ALPHA_S3TC_DXT5 }
+	};
+
+	const uint32_t KTX_TYPES[][2] =
+	{
+		{ 0x1401, uint32_t(GFW::TextureDataType::GL_UNSIGNED_BYTE) }, { 0x1400, uint32_t(GFW::TextureDataType::GL_BYTE) },
+		{ 0x1403, uint32_t(GFW::TextureDataType::GL_UNSIGNED_SHORT) }, { 0x1402, uint32_t(GFW::TextureDataType::GL_SHORT) },
+		{ 0x1405, uint32_t(GFW::TextureDataType::GL_UNSIGNED_INT) }, { 0x1404, uint32_t(GFW::TextureDataType::GL_INT) },
+		{ 0x1406, uint32_t(GFW::TextureDataType::GL_FLOAT) }, { 0x140B, uint32_t(GFW::TextureDataType::GL_HALF_FLOAT) }
+	};
+
+	template<size_t N>
+	bool FindFormat(const FormatMapping (&mappings)[N], uint32_t identifier, GFW::TextureFormat& format)
+	{
+		for(const FormatMapping& mapping : mappings)
+		{
+			if(mapping.identifier == identifier)
+			{
+				format = mapping.format;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/**
+	 * \return The data type of pixel data stored in a file with @format. 16 bit floating point formats are stored as half floats.
+	 */
+	GFW::TextureDataType GetFileDataType(GFW::TextureFormat format)
+	{
+		if(format == GFW::TextureFormat::R16F || format == GFW::TextureFormat::RG16F || format == GFW::TextureFormat::RGBA16F)
+			return GFW::TextureDataType::GL_HALF_FLOAT;
+		return GFW::TextureUtilities::GetDefaultDataType(format);
+	}
+
+	/**
+	 * \return The OpenGL client format uncompressed pixel data with @format is stored in, integer formats use the _INTEGER variants.
+	 */
+	uint32_t GetKtxClientFormat(GFW::TextureFormat format)
+	{
+		const uint32_t formats[4] = { 0x1903 /*GL_RED*/, 0x8227 /*GL_RG*/, 0x1907 /*GL_RGB*/, 0x1908 /*GL_RGBA*/ };
+		const uint32_t integerFormats[4] = { 0x8D94 /*GL_RED_INTEGER*/, 0x8228 /*GL_RG_INTEGER*/, 0x8D98 /*GL_RGB_INTEGER*/, 0x8D99 /*GL_RGBA_INTEGER*/ };
+		return (GFW::TextureUtilities::IsInteger(format) ? integerFormats : formats)[GFW::TextureUtilities::GetChannelCount(format) - 1];
+	}
+
+	/**
+	 * \return True if uncompressed pixel data of @type can be passed through for @format. The components have to match the format,
+	 * 16 bit floating point formats also accept floats like the graphics API does.
+	 */
+	bool IsValidKtxType(GFW::TextureFormat format, GFW::TextureDataType type)
+	{
+		const GFW::TextureDataType fileType = GetFileDataType(format);
+		return type == fileType || (fileType == GFW::TextureDataType::GL_HALF_FLOAT && type == GFW::TextureDataType::GL_FLOAT);
+	}
+
+	/**
+	 * \brief Map the pixel format of a DDS file without the DX10 header onto a TextureFormat.
+	 * \return False if the pixel format can't be represented without swizzling or converting the pixel data.
+	 */
+	bool FindDdsFormat(const DdsPixelFormat& pixelFormat, GFW::TextureFormat& format)
+	{
+		if(pixelFormat.flags & DDPF_FOURCC)
+			return FindFormat(DDS_FOURCC_FORMATS, pixelFormat.fourCC, format);
+
+		const uint32_t bumpMasks[4] = { pixelFormat.redMask, pixelFormat.greenMask, pixelFormat.blueMask, pixelFormat.alphaMask };
+		const uint32_t masks[4] = { pixelFormat.redMask, pixelFormat.greenMask, pixelFormat.blueMask, (pixelFormat.flags & DDPF_ALPHAPIXELS) ? pixelFormat.alphaMask : 0 };
+		const uint32_t rgba8[4] = { 0xFF, 0xFF00, 0xFF0000, 0xFF000000 };
+		const uint32_t rg8[4] = { 0xFF, 0xFF00, 0, 0 };
+		const uint32_t rg16[4] = { 0xFFFF, 0xFFFF0000, 0, 0 };
+		if(pixelFormat.flags & (DDPF_RGB | DDPF_LUMINANCE))
+		{
+			if(pixelFormat.rgbBitCount == 32 && memcmp(masks, rgba8, sizeof(masks)) == 0)
+				format = GFW::TextureFormat::RGBA8;
+			else if(pixelFormat.rgbBitCount == 32 && memcmp(masks, rg16, sizeof(masks)) == 0)
+				format = GFW::TextureFormat::RG16;
+			else if(pixelFormat.rgbBitCount == 16 && memcmp(masks, rg8, sizeof(masks)) == 0 && (pixelFormat.flags & DDPF_RGB))
+				format = GFW::TextureFormat::RG8;
+			else if(pixelFormat.rgbBitCount == 16 && masks[0] == 0xFFFF && !masks[1] && !masks[2] && !masks[3])
+				format = GFW::TextureFormat::R16;
+			else if(pixelFormat.rgbBitCount == 8 && masks[0] == 0xFF && !masks[1] && !masks[2] && !masks[3])
+				format = GFW::TextureFormat::R8;
+			else
+				return false;
+			return true;
+		}
+		if(pixelFormat.flags & DDPF_BUMPDUDV)
+		{
+			if(pixelFormat.rgbBitCount == 32 && memcmp(bumpMasks, rgba8, sizeof(bumpMasks)) == 0)
+				format = GFW::TextureFormat::RGBA8_SNORM;
+			else if(pixelFormat.rgbBitCount == 16 && memcmp(bumpMasks, rg8, sizeof(bumpMasks)) == 0)
+				format = GFW::TextureFormat::RG8_SNORM;
+			else
+				return false;
+			return true;
+		}
+		return false;
+	}
+
+	uint64_t AlignTo4(uint64_t offset)
+	{
+		return (offset + 3) / 4 * 4;
+	}
+}
+
+GFW::DdsKtxFile::DdsKtxFile() : m_fileType(DdsKtxFileType::NONE)
+{
+}
+
+/**
+ * \brief Map a DDS or KTX file into memory and parse its header. The file format is detected from the contents of the file. Closes the previously opened file.
+ * \param file The texture file to open.
+ * \return False if the file couldn't be mapped, isn't a DDS or KTX file or holds a texture that can't be passed to the graphics API as is.
+ */
+bool GFW::DdsKtxFile::Open(const char* file)
+{
+	Close();
+	if(!m_file.Open(file))
+		return false;
+
+	bool success = false;
+	if(m_file.GetSize() >= sizeof(DDS_MAGIC) + sizeof(DdsHeader) && memcmp(m_file.GetData(), DDS_MAGIC, sizeof(DDS_MAGIC)) == 0)
+		success = ParseDds();
+	else if(m_file.GetSize() >= sizeof(KTX_IDENTIFIER) + sizeof(KtxHeader) && memcmp(m_file.GetData(), KTX_IDENTIFIER, sizeof(KTX_IDENTIFIER)) == 0)
+		success = ParseKtx();
+
+	if(!success)
+		Close();
+	return success;
+}
+
+/**
+ * \brief Unmap the texture file. Pointers returned by GetSliceData() become invalid.
+ */
+void GFW::DdsKtxFile::Close()
+{
+	m_file.Close();
+	m_fileType = DdsKtxFileType::NONE;
+	m_description = TextureDescription();
+	m_sliceOffsets.clear();
+}
+
+/**
+ * \return If a texture file is opened.
+ */
+bool GFW::DdsKtxFile::IsOpen() const
+{
+	return m_file.IsOpen();
+}
+
+/**
+ * \return The format of the opened file. NONE if no file is opened.
+ */
+GFW::DdsKtxFileType GFW::DdsKtxFile::GetFileType() const
+{
+	return m_fileType;
+}
+
+/**
+ * \return Description of the texture stored in the file.
+ */
+const GFW::TextureDescription& GFW::DdsKtxFile::GetDescription() const
+{
+	return m_description;
+}
+
+/**
+ * \brief Get a pointer to the pixel data of a single slice directly in the mapped file.
+ * \param level The mipmap level of the slice.
+ * \param slice The slice within the level. Slices are ordered by layer and then by cubemap face.
+ * \return Pointer to the tightly packed pixel data of the slice.
+ */
+unsigned char* GFW::DdsKtxFile::GetSliceData(int level, int slice) const
+{
+	const int sliceCount = m_description.layers * m_description.faces;
+	GFW_ASSERT(IsOpen() && level >= 0 && level < m_description.levels && slice >= 0 && slice < sliceCount);
+	return m_file.GetData() + m_sliceOffsets[size_t(level) * sliceCount + slice];
+}
+
+/**
+ * \return The size in bytes of a single slice of mipmap @level.
+ */
+uint64_t GFW::DdsKtxFile::GetSliceSize(int level) const
+{
+	return TextureUtilities::GetDataSize(m_description.format, m_description.type, TextureUtilities::GetMipmapDimension(m_description.width, level),
+		TextureUtilities::GetMipmapDimension(m_description.height, level), TextureUtilities::GetMipmapDimension(m_description.depth, level));
+}
+
+/**
+ * \brief Initialize a texture with the contents of the file. The slices are passed straight from the mapped file to the texture.
+ * \param texture The texture to initialize.
+ * \param mipmaps When set to true the mipmaps in the file are used, or generated when the file has none. When set to false only the base level is used.
+ * \return False if no file is opened.
+ */
+bool GFW::DdsKtxFile::Upload(ITexture* texture, bool mipmaps) const
+{
+	if(!IsOpen())
+		return false;
+
+	const int sliceCount = m_description.layers * m_description.faces;
+	std::vector<unsigned char*> slices(size_t(m_description.levels * sliceCount));
+	for(int level = 0; level < m_description.levels; ++level)
+		for(int slice = 0; slice < sliceCount; ++slice)
+			slices[level * sliceCount + slice] = GetSliceData(level, slice);
+
+	TextureContainer::UploadLevels(texture, m_description, slices.data(), mipmaps);
+	return true;
+}
+
+/**
+ * \brief Parse the headers of a DDS file and find every slice. DDS files store all levels of a slice before the next slice.
+ * \return False if the file isn't a valid DDS file or uses an unsupported format.
+ */
+bool GFW::DdsKtxFile::ParseDds()
+{
+	DdsHeader header;
+	memcpy(&header, m_file.GetData() + sizeof(DDS_MAGIC), sizeof(header));
+	if(header.size != sizeof(DdsHeader) || header.pixelFormat.size != sizeof(DdsPixelFormat))
+		return false;
+
+	uint64_t offset = sizeof(DDS_MAGIC) + sizeof(DdsHeader);
+	m_description.width = int(header.width);
+	m_description.height = int(header.height);
+	m_description.depth = (header.caps2 & DDSCAPS2_VOLUME) ? int(header.depth) : 1;
+	m_description.levels = (header.flags & DDSD_MIPMAPCOUNT) && header.mipMapCount > 0 ? int(header.mipMapCount) : 1;
+	if(header.caps2 & DDSCAPS2_CUBEMAP)
+	{
+		// Cubemaps with missing faces can't be created.
+		if((header.caps2 & DDSCAPS2_CUBEMAP_ALLFACES) != DDSCAPS2_CUBEMAP_ALLFACES)
+			return false;
+		m_description.faces = 6;
+	}
+
+	if((header.pixelFormat.flags & DDPF_FOURCC) && header.pixelFormat.fourCC == 0x30315844 /*DX10*/)
+	{
+		DdsHeaderDx10 extended;
+		if(m_file.GetSize() < offset + sizeof(extended))
+			return false;
+		memcpy(&extended, m_file.GetData() + offset, sizeof(extended));
+		offset += sizeof(extended);
+
+		if(!FindFormat(DXGI_FORMATS, extended.dxgiFormat, m_description.format))
+			return false;
+		m_description.layers = int(extended.arraySize);
+		m_description.faces = (extended.miscFlag & DDS_RESOURCE_MISC_TEXTURECUBE) ? 6 : 1;
+		if(extended.resourceDimension == DDS_DIMENSION_TEXTURE1D)
+			m_description.height = 1;
+		m_description.depth = extended.resourceDimension == DDS_DIMENSION_TEXTURE3D ? int(header.depth) : 1;
+	}
+	else if(!FindDdsFormat(header.pixelFormat, m_description.format))
+		return false;
+	m_description.type = GetFileDataType(m_description.format);
+
+	if(!IsValidDescription())
+		return false;
+
+	const int sliceCount = m_description.layers * m_description.faces;
+	m_sliceOffsets.resize(size_t(m_description.levels) * sliceCount);
+	for(int slice = 0; slice < sliceCount; ++slice)
+	{
+		for(int level = 0; level < m_description.levels; ++level)
+		{
+			m_sliceOffsets[size_t(level) * sliceCount + slice] = offset;
+			offset += GetSliceSize(level);
+		}
+	}
+	if(offset > m_file.GetSize())
+		return false;
+
+	m_fileType = DdsKtxFileType::DDS;
+	return true;
+}
+
+/**
+ * \brief Parse the header of a KTX file and find every slice. KTX files store all slices of a level before the next level, every level is preceded by its size.
+ * \return False if the file isn't a valid KTX file, is written in the opposite endianness, uses an unsupported format, stores uncompressed pixel data
+ * in a client format or type that doesn't match the internal format or has padded rows.
+ */
+bool GFW::DdsKtxFile::ParseKtx()
+{
+	KtxHeader header;
+	memcpy(&header, m_file.GetData() + sizeof(KTX_IDENTIFIER), sizeof(header));
+	if(header.endianness != KTX_ENDIANNESS || !FindFormat(KTX_FORMATS, header.glInternalFormat, m_description.format))
+		return false;
+
+	// Uncompressed pixel data is passed through as is, so it has to be stored in the components of the internal format.
+	m_description.type = GetFileDataType(m_description.format);
+	if(!TextureUtilities::IsCompressed(m_description.format))
+	{
+		if(header.glFormat != GetKtxClientFormat(m_description.format))
+			return false;
+
+		bool found = false;
+		for(const uint32_t (&type)[2] : KTX_TYPES)
+		{
+			if(type[0] == header.glType)
+			{
+				m_description.type = TextureDataType(type[1]);
+				found = true;
+			}
+		}
+		if(!found || !IsValidKtxType(m_description.format, m_description.type))
+			return false;
+	}
+
+	m_description.width = int(header.pixelWidth);
+	m_description.height = header.pixelHeight ? int(header.pixelHeight) : 1;
+	m_description.depth = header.pixelDepth ? int(header.pixelDepth) : 1;
+	m_description.layers = header.numberOfArrayElements ? int(header.numberOfArrayElements) : 1;
+	m_description.faces = int(header.numberOfFaces);
+	m_description.levels = header.numberOfMipmapLevels ? int(header.numberOfMipmapLevels) : 1;
+	if(!IsValidDescription())
+		return false;
+
+	// Faces of cubemaps that aren't arrays are padded to 4 bytes separately and the size of a level is the size of a single face.
+	const int sliceCount = m_description.layers * m_description.faces;
+	const bool paddedFaces = m_description.faces == 6 && header.numberOfArrayElements == 0;
+	uint64_t offset = sizeof(KTX_IDENTIFIER) + sizeof(KtxHeader) + uint64_t(header.bytesOfKeyValueData);
+	m_sliceOffsets.resize(size_t(m_description.levels) * sliceCount);
+	for(int level = 0; level < m_description.levels; ++level)
+	{
+		// Rows are padded to 4 bytes, slices with padded rows can't be passed through.
+		const uint64_t sliceSize = GetSliceSize(level);
+		const int rows = TextureUtilities::GetMipmapDimension(m_description.height, level) * TextureUtilities::GetMipmapDimension(m_description.depth, level);
+		if(!TextureUtilities::IsCompressed(m_description.format) && rows > 1 &&
+			TextureUtilities::GetRowSize(m_description.format, m_description.type, TextureUtilities::GetMipmapDimension(m_description.width, level)) % 4 != 0)
+			return false;
+
+		uint32_t imageSize;
+		if(offset + sizeof(imageSize) > m_file.GetSize())
+			return false;
+		memcpy(&imageSize, m_file.GetData() + offset, sizeof(imageSize));
+		if(imageSize != (paddedFaces ? sliceSize : sliceSize * sliceCount))
+			return false;
+		offset += sizeof(imageSize);
+
+		for(int slice = 0; slice < sliceCount; ++slice)
+		{
+			m_sliceOffsets[size_t(level) * sliceCount + slice] = offset;
+			offset += sliceSize;
+			if(paddedFaces)
+				offset = AlignTo4(offset);
+		}
+		if(offset > m_file.GetSize())
+			return false;
+		offset = AlignTo4(offset);
+	}
+
+	m_fileType = DdsKtxFileType::KTX;
+	return true;
+}
+
+/**
+ * \return False if the parsed description can't be created through ITexture, like cubemap arrays and 3D arrays.
+ */
+bool GFW::DdsKtxFile::IsValidDescription() const
+{
+	const TextureDescription& description = m_description;
+	return description.width > 0 && description.height > 0 && description.depth > 0 && description.layers > 0 && (description.faces == 1 || description.faces == 6) &&
+		description.levels > 0 && description.levels <= TextureUtilities::GetMipmapCount(description.width, description.height, description.depth) &&
+		(description.faces == 1 || (description.layers == 1 && description.depth == 1 && description.width == description.height)) &&
+		(description.depth == 1 || description.layers == 1);
+}
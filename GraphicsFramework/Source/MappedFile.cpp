@@ -0,0 +1,125 @@
+#include <MappedFile.h>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+GFW::MappedFile::MappedFile() : m_data(nullptr), m_size(0), m_file(INVALID_HANDLE_VALUE), m_mapping(nullptr)
+{
+}
+#else
+GFW::MappedFile::MappedFile() : m_data(nullptr), m_size(0)
+{
+}
+#endif
+
+GFW::MappedFile::~MappedFile()
+{
+	Close();
+}
+
+/**
+ * \brief Map a file into memory. Closes the previously mapped file.
+ * \param file The file to map.
+ * \return False if the file couldn't be opened or mapped. Empty files can't be mapped.
+ */
+bool GFW::MappedFile::Open(const char* file)
+{
+	Close();
+
+#ifdef _WIN32
+	m_file = CreateFileA(file, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if(m_file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	if(!GetFileSizeEx(m_file, &size) || size.QuadPart == 0)
+	{
+		Close();
+		return false;
+	}
+
+	m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+	if(m_mapping)
+		m_data = static_cast<unsigned char*>(MapViewOfFile(m_mapping, FILE_MAP_COPY, 0, 0, 0));
+	if(!m_data)
+	{
+		Close();
+		return false;
+	}
+	m_size = uint64_t(size.QuadPart);
+#else
+	const int descriptor = open(file, O_RDONLY);
+	if(descriptor < 0)
+		return false;
+
+	struct stat status;
+	if(fstat(descriptor, &status) != 0 || status.st_size == 0)
+	{
+		close(descriptor);
+		return false;
+	}
+
+	void* data = mmap(nullptr, size_t(status.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, descriptor, 0);
+	close(descriptor);
+	if(data == MAP_FAILED)
+		return false;
+
+	m_data = static_cast<unsigned char*>(data);
+	m_size = uint64_t(status.st_size);
+#endif
+	return true;
+}
+
+/**
+ * \brief Unmap the file. Pointers to the mapped data become invalid.
+ */
+void GFW::MappedFile::Close()
+{
+#ifdef _WIN32
+	if(m_data)
+		UnmapViewOfFile(m_data);
+	if(m_mapping)
+		CloseHandle(m_mapping);
+	if(m_file != INVALID_HANDLE_VALUE)
+		CloseHandle(m_file);
+	m_mapping = nullptr;
+	m_file = INVALID_HANDLE_VALUE;
+#else
+	if(m_data)
+		munmap(m_data, size_t(m_size));
+#endif
+	m_data = nullptr;
+	m_size = 0;
+}
+
+/**
+ * \return If a file is mapped.
+ */
+bool GFW::MappedFile::IsOpen() const
+{
+	return m_data != nullptr;
+}
+
+/**
+ * \return Pointer to the start of the mapped file. nullptr if no file is mapped.
+ */
+unsigned char* GFW::MappedFile::GetData() const
+{
+	return m_data;
+}
+
+/**
+ * \return The size of the mapped file in bytes.
+ */
+uint64_t GFW::MappedFile::GetSize() const
+{
+	return m_size;
+}
@@ -0,0 +1,504 @@
+#include <MultisampleResolve.h>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <vector>
+#include "Logging.h"
+#include "Simd.h"
+#include "TextureUtilities.h"
+
+namespace
+{
+	const int ROWS_PER_TASK = 8;
+
+	// Standard sample positions in 1/16th of a pixel relative to the pixel center.
+	const signed char SAMPLE_POSITIONS_2X[2][2] = { { 4, 4 }, { -4, -4 } };
+	const signed char SAMPLE_POSITIONS_4X[4][2] = { { -2, -6 }, { 6, -2 }, { -6, 2 }, { 2, 6 } };
+	const signed char SAMPLE_POSITIONS_8X[8][2] = { { 1, -3 }, { -1, 3 }, { 5, 1 }, { -3, -5 }, { -5, 5 }, { -7, -1 }, { 3, 7 }, { 7, -7 } };
+
+	/**
+	 * \brief A sample of a neighbouring pixel that contributes to the tent filter.
+	 */
+	struct TentTap
+	{
+		int offsetX;		// Horizontal offset of the neighbouring pixel.
+		int offsetY;		// Vertical offset of the neighbouring pixel.
+		int sample;			// The sample of the neighbouring pixel.
+		ptrdiff_t offset;	// Offset in components from the first sample of a pixel to the sample of the neighbour, valid when the neighbour isn't clamped.
+		float weight;		// The normalized weight of the sample.
+	};
+
+	/**
+	 * \brief The parameters shared by all rows of a resolve.
+	 */
+	struct ResolveJob
+	{
+		const unsigned char* source;	// The multisampled pixel data.
+		unsigned char* destination;		// The resolved pixel data.
+		int width;						// The width of the image.
+		int height;						// The height of the image.
+		int channels;					// The amount of channels per pixel.
+		int samples;					// The amount of samples per pixel.
+		std::vector<TentTap> taps;		// The taps of the tent filter.
+	};
+
+	std::vector<TentTap> BuildTentTaps(GFW::TextureMultisampleCount sampleCount, int width, int channels)
+	{
+		const int samples = GFW::TextureUtilities::GetSampleCount(sampleCount);
+		std::vector<TentTap> taps;
+		float totalWeight = 0.0f;
+		for(int offsetY = -1; offsetY <= 1; ++offsetY)
+		{
+			for(int offsetX = -1; offsetX <= 1; ++offsetX)
+			{
+				for(int sample = 0; sample < samples; ++sample)
+				{
+					float x, y;
+					GFW::MultisampleResolve::GetSamplePosition(sampleCount, sample, x, y);
+					const float weight = std::max(1.0f - std::abs(offsetX + x), 0.0f) * std::max(1.0f - std::abs(offsetY + y), 0.0f);
+					if(weight > 0.0f)
+					{
+						const TentTap tap = { offsetX, offsetY, sample, ((ptrdiff_t(offsetY) * width + offsetX) * samples + sample) * channels, weight };
+						taps.push_back(tap);
+						totalWeight += weight;
+					}
+				}
+			}
+		}
+
+		for(TentTap& tap : taps)
+			tap.weight /= totalWeight;
+		return taps;
+	}
+
+	/**
+	 * \brief A half float component. Converts to and from float, so the scalar kernels accumulate it like the other component types.
+	 */
+	struct Half
+	{
+		uint16_t bits;	// The half float bits.
+
+		Half() = default;
+		explicit Half(float value) : bits(GFW::TextureUtilities::FloatToHalf(value)) {}
+		explicit operator float() const { return GFW::TextureUtilities::HalfToFloat(bits); }
+		bool operator<(Half other) const { return float(*this) < float(other); }
+	};
+
+	/**
+	 * \brief Convert an accumulated value back to a component, rounding and clamping integers to their range.
+	 */
+	template<typename ComponentType, typename AccumulatorType>
+	ComponentType ToComponent(AccumulatorType value)
+	{
+		if(std::is_floating_point<ComponentType>::value)
+			return ComponentType(value);
+		const AccumulatorType rounded = std::floor(value + AccumulatorType(0.5));
+		return ComponentType(std::min(std::max(rounded, AccumulatorType(std::numeric_limits<ComponentType>::lowest())), AccumulatorType(std::numeric_limits<ComponentType>::max())));
+	}
+
+	template<>
+	Half ToComponent<Half, float>(float value)
+	{
+		return Half(value);
+	}
+
+	/**
+	 * \brief Scalar kernels for every component type and channel count. 32 bit integers are accumulated in double precision so they don't lose bits,
+	 * half floats in single precision.
+	 */
+	template<typename ComponentType>
+	struct ScalarKernels
+	{
+		typedef typename std::conditional<sizeof(ComponentType) == 4 && !std::is_floating_point<ComponentType>::value, double, float>::type AccumulatorType;
+
+		static void Box(const ResolveJob& job, int y)
+		{
+			const ComponentType* source = reinterpret_cast<const ComponentType*>(job.source) + size_t(y) * job.width * job.samples * job.channels;
+			ComponentType* destination = reinterpret_cast<ComponentType*>(job.destination) + size_t(y) * job.width * job.channels;
+			const AccumulatorType scale = AccumulatorType(1) / job.samples;
+
+			for(int x = 0; x < job.width; ++x)
+			{
+				const ComponentType* pixel = source + size_t(x) * job.samples * job.channels;
+				for(int channel = 0; channel < job.channels; ++channel)
+				{
+					AccumulatorType sum = 0;
+					for(int sample = 0; sample < job.samples; ++sample)
+						sum += AccumulatorType(pixel[sample * job.channels + channel]);
+					destination[x * job.channels + channel] = ToComponent<ComponentType>(sum * scale);
+				}
+			}
+		}
+
+		static void Tent(const ResolveJob& job, int y)
+		{
+			const ComponentType* source = reinterpret_cast<const ComponentType*>(job.source);
+			ComponentType* destination = reinterpret_cast<ComponentType*>(job.destination) + size_t(y) * job.width * job.channels;
+
+			const bool interiorRow = y > 0 && y < job.height - 1;
+			for(int x = 0; x < job.width; ++x)
+			{
+				AccumulatorType sum[4] = {};
+				const bool interior = interiorRow && x > 0 && x < job.width - 1;
+				const ComponentType* pixel = source + (size_t(y) * job.width + x) * job.samples * job.channels;
+				for(const TentTap& tap : job.taps)
+				{
+					const ComponentType* sample = interior ? pixel + tap.offset : source + ((size_t(std::min(std::max(y + tap.offsetY, 0), job.height - 1)) * job.width +
+						std::min(std::max(x + tap.offsetX, 0), job.width - 1)) * job.samples + tap.sample) * job.channels;
+					for(int channel = 0; channel < job.channels; ++channel)
+						sum[channel] += AccumulatorType(tap.weight) * AccumulatorType(sample[channel]);
+				}
+				for(int channel = 0; channel < job.channels; ++channel)
+					destination[x * job.channels + channel] = ToComponent<ComponentType>(sum[channel]);
+			}
+		}
+
+		template<bool maximum>
+		static void Depth(const ResolveJob& job, int y)
+		{
+			const ComponentType* source = reinterpret_cast<const ComponentType*>(job.source) + size_t(y) * job.width * job.samples;
+			ComponentType* destination = reinterpret_cast<ComponentType*>(job.destination) + size_t(y) * job.width;
+
+			for(int x = 0; x < job.width; ++x)
+			{
+				const ComponentType* pixel = source + size_t(x) * job.samples;
+				ComponentType depth = pixel[0];
+				for(int sample = 1; sample < job.samples; ++sample)
+					depth = maximum ? std::max(depth, pixel[sample]) : std::min(depth, pixel[sample]);
+				destination[x] = depth;
+			}
+		}
+	};
+
+	/**
+	 * \brief Vector kernels, only specialized for the component types that have them. Return false to fall back to the scalar kernels.
+	 */
+	template<typename ComponentType>
+	struct SimdKernels
+	{
+		static bool Box(const ResolveJob&, int) { return false; }
+		static bool Tent(const ResolveJob&, int) { return false; }
+		template<bool maximum>
+		static bool Depth(const ResolveJob&, int) { return false; }
+	};
+
+#ifdef GFW_SSE2
+	inline __m128 LoadPixel(const uint8_t* pixel)
+	{
+		int32_t value;
+		memcpy(&value, pixel, sizeof(value));
+		const __m128i zero = _mm_setzero_si128();
+		return _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(value), zero), zero));
+	}
+
+	inline __m128 LoadPixel(const uint16_t* pixel)
+	{
+		return _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(pixel)), _mm_setzero_si128()));
+	}
+
+	inline __m128 LoadPixel(const float* pixel)
+	{
+		return _mm_loadu_ps(pixel);
+	}
+
+	inline void StorePixel(__m128 value, uint8_t* pixel)
+	{
+		const __m128i integers = _mm_cvtps_epi32(value);
+		const __m128i shorts = _mm_packs_epi32(integers, integers);
+		const int32_t packed = _mm_cvtsi128_si32(_mm_packus_epi16(shorts, shorts));
+		memcpy(pixel, &packed, sizeof(packed));
+	}
+
+	inline void StorePixel(__m128 value, uint16_t* pixel)
+	{
+		// SSE2 has no unsigned 32 to 16 bit pack, so the values are shifted into the signed range, packed with saturation and shifted back.
+		const __m128 clamped = _mm_min_ps(_mm_max_ps(value, _mm_setzero_ps()), _mm_set1_ps(65535.0f));
+		const __m128i integers = _mm_sub_epi32(_mm_cvtps_epi32(clamped), _mm_set1_epi32(32768));
+		const __m128i shorts = _mm_xor_si128(_mm_packs_epi32(integers, integers), _mm_set1_epi16(short(0x8000)));
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(pixel), shorts);
+	}
+
+	inline void StorePixel(__m128 value, float* pixel)
+	{
+		_mm_storeu_ps(pixel, value);
+	}
+
+	/**
+	 * \brief Kernels for 4 channel pixels, where a pixel fits in a single vector.
+	 */
+	template<typename ComponentType>
+	struct FourChannelKernels
+	{
+		static bool Box(const ResolveJob& job, int y)
+		{
+			if(job.channels != 4)
+				return false;
+
+			const ComponentType* source = reinterpret_cast<const ComponentType*>(job.source) + size_t(y) * job.width * job.samples * 4;
+			ComponentType* destination = reinterpret_cast<ComponentType*>(job.destination) + size_t(y) * job.width * 4;
+			const __m128 scale = _mm_set1_ps(1.0f / job.samples);
+			for(int x = 0; x < job.width; ++x)
+			{
+				const ComponentType* pixel = source + size_t(x) * job.samples * 4;
+				__m128 sum = LoadPixel(pixel);
+				for(int sample = 1; sample < job.samples; ++sample)
+					sum = _mm_add_ps(sum, LoadPixel(pixel + sample * 4));
+				StorePixel(_mm_mul_ps(sum, scale), destination + x * 4);
+			}
+			return true;
+		}
+
+		static bool Tent(const ResolveJob& job, int y)
+		{
+			if(job.channels != 4)
+				return false;
+
+			const ComponentType* source = reinterpret_cast<const ComponentType*>(job.source);
+			ComponentType* destination = reinterpret_cast<ComponentType*>(job.destination) + size_t(y) * job.width * 4;
+			const bool interiorRow = y > 0 && y < job.height - 1;
+			for(int x = 0; x < job.width; ++x)
+			{
+				__m128 sum = _mm_setzero_ps();
+				const ComponentType* pixel = source + (size_t(y) * job.width + x) * job.samples * 4;
+				if(interiorRow && x > 0 && x < job.width - 1)
+				{
+					// Neighbours of interior pixels are never clamped, so the taps are fixed offsets.
+					for(const TentTap& tap : job.taps)
+						sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(tap.weight), LoadPixel(pixel + tap.offset)));
+				}
+				else
+				{
+					for(const TentTap& tap : job.taps)
+					{
+						const int sourceX = std::min(std::max(x + tap.offsetX, 0), job.width - 1);
+						const int sourceY = std::min(std::max(y + tap.offsetY, 0), job.height - 1);
+						const ComponentType* sample = source + ((size_t(sourceY) * job.width + sourceX) * job.samples + tap.sample) * 4;
+						sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(tap.weight), LoadPixel(sample)));
+					}
+				}
+				StorePixel(sum, destination + x * 4);
+			}
+			return true;
+		}
+
+		template<bool maximum>
+		static bool Depth(const ResolveJob&, int)
+		{
+			return false;
+		}
+	};
+
+	/**
+	 * \brief 8 bit kernels. Boxes of 4 channel pixels are summed in 16 bit integers, which is exact and avoids converting every sample to float.
+	 */
+	template<>
+	struct SimdKernels<uint8_t> : FourChannelKernels<uint8_t>
+	{
+		static bool Box(const ResolveJob& job, int y)
+		{
+			if(job.channels != 4)
+				return false;
+
+			const uint8_t* source = job.source + size_t(y) * job.width * job.samples * 4;
+			uint8_t* destination = job.destination + size_t(y) * job.width * 4;
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i rounding = _mm_set1_epi16(short(job.samples / 2));
+			const int shift = job.samples == 2 ? 1 : job.samples == 4 ? 2 : 3;
+
+			for(int x = 0; x < job.width; ++x)
+			{
+				// Every 16 bit lane sums a channel of every other sample, folding the two halves together leaves the sum of all samples.
+				const uint8_t* pixel = source + size_t(x) * job.samples * 4;
+				__m128i sum;
+				if(job.samples == 2)
+					sum = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(pixel)), zero);
+				else
+				{
+					sum = zero;
+					for(int sample = 0; sample < job.samples; sample += 4)
+					{
+						const __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixel + sample * 4));
+						sum = _mm_add_epi16(sum, _mm_add_epi16(_mm_unpacklo_epi8(samples, zero), _mm_unpackhi_epi8(samples, zero)));
+					}
+				}
+				sum = _mm_add_epi16(sum, _mm_srli_si128(sum, 8));
+				sum = _mm_srli_epi16(_mm_add_epi16(sum, rounding), shift);
+				const int32_t packed = _mm_cvtsi128_si32(_mm_packus_epi16(sum, sum));
+				memcpy(destination + x * 4, &packed, sizeof(packed));
+			}
+			return true;
+		}
+	};
+
+	template<>
+	struct SimdKernels<uint16_t> : FourChannelKernels<uint16_t>
+	{
+	};
+
+	/**
+	 * \brief Float kernels. Depth is reduced 4 samples at a time with vector min and max.
+	 */
+	template<>
+	struct SimdKernels<float> : FourChannelKernels<float>
+	{
+		template<bool maximum>
+		static bool Depth(const ResolveJob& job, int y)
+		{
+			if(job.samples < 4)
+				return false;
+
+			const float* source = reinterpret_cast<const float*>(job.source) + size_t(y) * job.width * job.samples;
+			float* destination = reinterpret_cast<float*>(job.destination) + size_t(y) * job.width;
+			for(int x = 0; x < job.width; ++x)
+			{
+				const float* pixel = source + size_t(x) * job.samples;
+				__m128 depth = _mm_loadu_ps(pixel);
+				for(int sample = 4; sample < job.samples; sample += 4)
+					depth = maximum ? _mm_max_ps(depth, _mm_loadu_ps(pixel + sample)) : _mm_min_ps(depth, _mm_loadu_ps(pixel + sample));
+
+				const __m128 swapped = _mm_shuffle_ps(depth, depth, _MM_SHUFFLE(1, 0, 3, 2));
+				depth = maximum ? _mm_max_ps(depth, swapped) : _mm_min_ps(depth, swapped);
+				const __m128 neighbour = _mm_shuffle_ps(depth, depth, _MM_SHUFFLE(2, 3, 0, 1));
+				depth = maximum ? _mm_max_ps(depth, neighbour) : _mm_min_ps(depth, neighbour);
+				_mm_store_ss(destination + x, depth);
+			}
+			return true;
+		}
+	};
+#endif
+
+	template<typename ComponentType>
+	void ResolveRows(GFW::ResolveFilter filter, const ResolveJob& job, int begin, int end)
+	{
+		for(int y = begin; y < end; ++y)
+		{
+			switch(filter)
+			{
+			case GFW::ResolveFilter::BOX:
+				if(!SimdKernels<ComponentType>::Box(job, y))
+					ScalarKernels<ComponentType>::Box(job, y);
+				break;
+			case GFW::ResolveFilter::TENT:
+				if(!SimdKernels<ComponentType>::Tent(job, y))
+					ScalarKernels<ComponentType>::Tent(job, y);
+				break;
+			case GFW::ResolveFilter::DEPTH_MIN:
+				if(!SimdKernels<ComponentType>::template Depth<false>(job, y))
+					ScalarKernels<ComponentType>::template Depth<false>(job, y);
+				break;
+			case GFW::ResolveFilter::DEPTH_MAX:
+				if(!SimdKernels<ComponentType>::template Depth<true>(job, y))
+					ScalarKernels<ComponentType>::template Depth<true>(job, y);
+				break;
+			}
+		}
+	}
+
+	template<typename ComponentType>
+	void ResolveImage(GFW::ResolveFilter filter, const ResolveJob& job, GFW::ThreadPool& threadPool)
+	{
+		threadPool.ParallelFor(0, job.height, [filter, &job](int begin, int end) { ResolveRows<ComponentType>(filter, job, begin, end); }, ROWS_PER_TASK);
+	}
+}
+
+/**
+ * \brief Get the position of a sample within its pixel.
+ * \param sampleCount The sample count of the texture.
+ * \param sample The index of the sample.
+ * \param x Set to the horizontal offset from the pixel center, between -0.5 and 0.5.
+ * \param y Set to the vertical offset from the pixel center, between -0.5 and 0.5. Positive is down.
+ */
+void GFW::MultisampleResolve::GetSamplePosition(TextureMultisampleCount sampleCount, int sample, float& x, float& y)
+{
+	GFW_ASSERT(sample >= 0 && sample < TextureUtilities::GetSampleCount(sampleCount));
+
+	const signed char* position;
+	switch(sampleCount)
+	{
+	case TextureMultisampleCount::MULTISAMPLE_2X:
+		position = SAMPLE_POSITIONS_2X[sample];
+		break;
+	case TextureMultisampleCount::MULTISAMPLE_4X:
+		position = SAMPLE_POSITIONS_4X[sample];
+		break;
+	case TextureMultisampleCount::MULTISAMPLE_8X:
+		position = SAMPLE_POSITIONS_8X[sample];
+		break;
+	default:
+		x = y = 0.0f;
+		return;
+	}
+	x = position[0] / 16.0f;
+	y = position[1] / 16.0f;
+}
+
+/**
+ * \brief Resolve multisampled pixel data to a single sample per pixel.
+ * \param filter How the samples are combined. DEPTH_MIN and DEPTH_MAX only work on depth formats without stencil.
+ * \param format The format of the pixel data. Compressed, integer and stencil formats can't be resolved.
+ * \param type The type of the components of the pixel data, both for @source and @destination. Half floats are converted to float to be combined.
+ * \param sampleCount The amount of samples per pixel in @source.
+ * \param width The width of the image.
+ * \param height The height of the image.
+ * \param source The multisampled pixel data, with the samples of every pixel next to each other.
+ * \param destination The tightly packed resolved pixel data.
+ * \param threadPool The pool to resolve the rows on. nullptr to use the default thread pool.
+ * \return False if the format can't be resolved with @filter.
+ */
+bool GFW::MultisampleResolve::Resolve(ResolveFilter filter, TextureFormat format, TextureDataType type, TextureMultisampleCount sampleCount, int width, int height,
+	const unsigned char* source, unsigned char* destination, ThreadPool* threadPool)
+{
+	const bool depth = format >= TextureFormat::DEPTH_COMPONENT16 && format <= TextureFormat::DEPTH_COMPONENT32F;
+	if(TextureUtilities::IsCompressed(format) || TextureUtilities::IsInteger(format) || (TextureUtilities::IsDepthOrStencil(format) && !depth) ||
+		((filter == ResolveFilter::DEPTH_MIN || filter == ResolveFilter::DEPTH_MAX) && !depth))
+		return false;
+
+	ResolveJob job;
+	job.source = source;
+	job.destination = destination;
+	job.width = width;
+	job.height = height;
+	job.channels = TextureUtilities::GetChannelCount(format);
+	job.samples = TextureUtilities::GetSampleCount(sampleCount);
+	if(job.samples == 1)
+	{
+		memcpy(destination, source, size_t(TextureUtilities::GetDataSize(format, type, width, height)));
+		return true;
+	}
+	if(filter == ResolveFilter::TENT)
+		job.taps = BuildTentTaps(sampleCount, width, job.channels);
+
+	ThreadPool& pool = threadPool ? *threadPool : ThreadPool::GetDefault();
+	switch(type)
+	{
+	case TextureDataType::GL_UNSIGNED_BYTE:
+		ResolveImage<uint8_t>(filter, job, pool);
+		break;
+	case TextureDataType::GL_BYTE:
+		ResolveImage<int8_t>(filter, job, pool);
+		break;
+	case TextureDataType::GL_UNSIGNED_SHORT:
+		ResolveImage<uint16_t>(filter, job, pool);
+		break;
+	case TextureDataType::GL_SHORT:
+		ResolveImage<int16_t>(filter, job, pool);
+		break;
+	case TextureDataType::GL_UNSIGNED_INT:
+		ResolveImage<uint32_t>(filter, job, pool);
+		break;
+	case TextureDataType::GL_INT:
+		ResolveImage<int32_t>(filter, job, pool);
+		break;
+	case TextureDataType::GL_FLOAT:
+		ResolveImage<float>(filter, job, pool);
+		break;
+	case TextureDataType::GL_HALF_FLOAT:
+		ResolveImage<Half>(filter, job, pool);
+		break;
+	}
+	return true;
+}
@@ -0,0 +1,155 @@
+#include <SamplerCache.h>
+#include "Logging.h"
+#include "TextureUtilities.h"
+
+namespace
+{
+	const int MIN_FILTER_SHIFT = 0;
+	const int MAG_FILTER_SHIFT = 3;
+	const int ANISOTROPY_SHIFT = 6;
+	const int EDGE_SAMPLING_SHIFT = 9;
+	const int BORDER_COLOR_SHIFT = 11;
+	const uint32_t FIELD_MASK = 0x7;
+	const uint32_t EDGE_SAMPLING_MASK = 0x3;
+	const uint32_t MAX_BORDER_COLORS = 1u << (32 - BORDER_COLOR_SHIFT);
+}
+
+/**
+ * \param factory Function that creates an empty sampler whenever a configuration is requested for the first time.
+ */
+GFW::SamplerCache::SamplerCache(SamplerFactory factory) : m_factory(factory), m_requests(0)
+{
+	GFW_ASSERT(m_factory);
+
+	// Transparent black is always index 0, it's the border color of every key that doesn't sample the border.
+	InternBorderColor(Vec4(0.0f));
+}
+
+/**
+ * \brief Get the shared sampler of a configuration. The sampler is created the first time the configuration is requested.
+ * \param minFilter The type of texture filtering to apply when sampling a texture. Minification filter.
+ * \param magFilter The type of texture filtering to apply when sampling a texture. Magnification filter.
+ * \param anisotropy The maximum amount of anisotropic samples to use when filtering.
+ * \param edgeSampling The type of edge sampling operation to use when sampling a texture.
+ * \param borderColor The border color to use when sampling outside the texture. Quantized to half floats, ignored unless @edgeSampling is CLAMP_TO_BORDER.
+ * \return The sampler. Owned by the cache and valid until Clear() is called or the cache is destroyed.
+ */
+const GFW::ISampler* GFW::SamplerCache::Get(SamplerFilter minFilter, SamplerFilter magFilter, AnisotropicFilter anisotropy, EdgeSampling edgeSampling,
+	const Vec4& borderColor)
+{
+	return Get(GetKey(minFilter, magFilter, anisotropy, edgeSampling, borderColor));
+}
+
+/**
+ * \brief Get the shared sampler of a key created by GetKey(). Materials can store the key instead of the configuration.
+ * \param key The packed configuration.
+ * \return The sampler. Owned by the cache and valid until Clear() is called or the cache is destroyed.
+ */
+const GFW::ISampler* GFW::SamplerCache::Get(SamplerKey key)
+{
+	++m_requests;
+	std::unique_ptr<ISampler>& sampler = m_samplers[key];
+	if(!sampler)
+	{
+		SamplerFilter minFilter;
+		SamplerFilter magFilter;
+		AnisotropicFilter anisotropy;
+		EdgeSampling edgeSampling;
+		Vec4 borderColor;
+		Unpack(key, minFilter, magFilter, anisotropy, edgeSampling, borderColor);
+		sampler = m_factory();
+		sampler->Create(minFilter, magFilter, anisotropy, edgeSampling, borderColor);
+	}
+	return sampler.get();
+}
+
+/**
+ * \brief Pack a configuration into a key. The border color is interned by the cache, so keys are only valid for the cache that created them.
+ * \param minFilter The type of texture filtering to apply when sampling a texture. Minification filter.
+ * \param magFilter The type of texture filtering to apply when sampling a texture. Magnification filter.
+ * \param anisotropy The maximum amount of anisotropic samples to use when filtering.
+ * \param edgeSampling The type of edge sampling operation to use when sampling a texture.
+ * \param borderColor The border color to use when sampling outside the texture. Quantized to half floats, ignored unless @edgeSampling is CLAMP_TO_BORDER.
+ * \return The packed configuration.
+ */
+GFW::SamplerKey GFW::SamplerCache::GetKey(SamplerFilter minFilter, SamplerFilter magFilter, AnisotropicFilter anisotropy, EdgeSampling edgeSampling, const Vec4& borderColor)
+{
+	const uint32_t borderColorIndex = edgeSampling == EdgeSampling::CLAMP_TO_BORDER ? InternBorderColor(borderColor) : 0;
+	return (uint32_t(minFilter) << MIN_FILTER_SHIFT) | (uint32_t(magFilter) << MAG_FILTER_SHIFT) | (uint32_t(anisotropy) << ANISOTROPY_SHIFT) |
+		(uint32_t(edgeSampling) << EDGE_SAMPLING_SHIFT) | (borderColorIndex << BORDER_COLOR_SHIFT);
+}
+
+/**
+ * \brief Unpack a key created by GetKey() into its configuration.
+ * \param key The packed configuration.
+ * \param minFilter Output for the minification filter.
+ * \param magFilter Output for the magnification filter.
+ * \param anisotropy Output for the anisotropic filter.
+ * \param edgeSampling Output for the edge sampling operation.
+ * \param borderColor Output for the quantized border color.
+ */
+void GFW::SamplerCache::Unpack(SamplerKey key, SamplerFilter& minFilter, SamplerFilter& magFilter, AnisotropicFilter& anisotropy, EdgeSampling& edgeSampling,
+	Vec4& borderColor) const
+{
+	GFW_ASSERT((key >> BORDER_COLOR_SHIFT) < m_borderColors.size());
+	minFilter = SamplerFilter((key >> MIN_FILTER_SHIFT) & FIELD_MASK);
+	magFilter = SamplerFilter((key >> MAG_FILTER_SHIFT) & FIELD_MASK);
+	anisotropy = AnisotropicFilter((key >> ANISOTROPY_SHIFT) & FIELD_MASK);
+	edgeSampling = EdgeSampling((key >> EDGE_SAMPLING_SHIFT) & EDGE_SAMPLING_MASK);
+	borderColor = m_borderColors[key >> BORDER_COLOR_SHIFT];
+}
+
+/**
+ * \brief Destroy all samplers. Keys stay valid, their samplers are created again when requested.
+ */
+void GFW::SamplerCache::Clear()
+{
+	m_samplers.clear();
+}
+
+/**
+ * \return The amount of distinct samplers the cache holds.
+ */
+int GFW::SamplerCache::GetSamplerCount() const
+{
+	return int(m_samplers.size());
+}
+
+/**
+ * \return The amount of distinct border colors interned so far, including transparent black.
+ */
+int GFW::SamplerCache::GetBorderColorCount() const
+{
+	return int(m_borderColors.size());
+}
+
+/**
+ * \return The amount of Get() calls. Compare with GetSamplerCount() to see how many samplers are shared.
+ */
+unsigned long long GFW::SamplerCache::GetRequestCount() const
+{
+	return m_requests;
+}
+
+/**
+ * \return The index of a border color, quantized to half floats and added to the cache if it isn't in it yet.
+ */
+uint32_t GFW::SamplerCache::InternBorderColor(const Vec4& color)
+{
+	uint64_t quantized = 0;
+	for(int channel = 0; channel < 4; ++channel)
+		quantized |= uint64_t(TextureUtilities::FloatToHalf(color[channel])) << (channel * 16);
+
+	const auto index = m_borderColorIndices.find(quantized);
+	if(index != m_borderColorIndices.end())
+		return index->second;
+
+	GFW_ASSERT(m_borderColors.size() < MAX_BORDER_COLORS);
+	const uint32_t newIndex = uint32_t(m_borderColors.size());
+	Vec4 quantizedColor;
+	for(int channel = 0; channel < 4; ++channel)
+		quantizedColor[channel] = TextureUtilities::HalfToFloat(uint16_t(quantized >> (channel * 16)));
+	m_borderColors.push_back(quantizedColor);
+	m_borderColorIndices[quantized] = newIndex;
+	return newIndex;
+}
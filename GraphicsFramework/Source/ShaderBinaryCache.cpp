@@ -0,0 +1,285 @@
+#include <ShaderBinaryCache.h>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include "Hash.h"
+#include "Logging.h"
+#include "MappedFile.h"
+
+namespace
+{
+	const char CACHE_MAGIC[4] = { 'G', 'F', 'W', 'S' };
+	const uint32_t CACHE_VERSION = 1;
+
+	/**
+	 * \brief Header of a cache file, followed by the payload: the program binary, the attributes and the parameters.
+	 */
+	struct CacheHeader
+	{
+		char magic[4];			// CACHE_MAGIC
+		uint32_t version;		// CACHE_VERSION
+		uint64_t sourceHash;	// Hash of the source the program was compiled from
+		uint64_t identityHash;	// Hash of the backend identity the program was compiled with
+		uint64_t payloadSize;	// Size of the payload in bytes
+		uint64_t payloadHash;	// Checksum of the payload
+	};
+
+	template<typename T>
+	void Append(std::vector<unsigned char>& buffer, const T& value)
+	{
+		const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&value);
+		buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+	}
+
+	/**
+	 * \brief Reads values from a payload, failing instead of reading past its end.
+	 */
+	struct PayloadReader
+	{
+		const unsigned char* data;	// Start of the unread payload
+		uint64_t remaining;			// Amount of unread bytes
+
+		template<typename T>
+		bool Read(T& value)
+		{
+			if(remaining < sizeof(T))
+				return false;
+			memcpy(&value, data, sizeof(T));
+			data += sizeof(T);
+			remaining -= sizeof(T);
+			return true;
+		}
+
+		bool Skip(uint64_t size)
+		{
+			if(remaining < size)
+				return false;
+			data += size;
+			remaining -= size;
+			return true;
+		}
+	};
+}
+
+/**
+ * \brief Create a cache in a directory. The directory has to exist.
+ * \param factory Creates an empty shader of the graphics API that's used.
+ * \param directory The directory to store the cache files in.
+ * \param backendIdentity Identifies the backend and driver, for example the renderer, vendor and version strings of the context.
+ * Programs cached with a different identity aren't used.
+ */
+GFW::ShaderBinaryCache::ShaderBinaryCache(ShaderFactory factory, const std::string& directory, const std::string& backendIdentity) : m_factory(std::move(factory)),
+	m_directory(directory), m_identityHash(HashFnv1a64(backendIdentity.data(), backendIdentity.size())), m_hits(0), m_misses(0), m_tempFiles(0)
+{
+	GFW_ASSERT(m_factory != nullptr);
+	if(!m_directory.empty() && m_directory.back() != '/' && m_directory.back() != '\\')
+		m_directory += '/';
+}
+
+/**
+ * \brief Create a shader program from the cache, or compile it and store its binary when it isn't cached yet. Can be called from multiple threads
+ * if the shaders the factory returns can be created on them.
+ * \param source The preprocessed source of the program, including the variant defines.
+ * \return The program. Compiled from source if the cached binary is missing or invalid, or the backend doesn't support program binaries.
+ */
+std::unique_ptr<GFW::IShader> GFW::ShaderBinaryCache::Create(const std::string& source)
+{
+	const uint64_t sourceHash = HashFnv1a64(source.data(), source.size());
+	const std::string file = GetFilePath(source);
+	std::unique_ptr<IShader> shader = Load(file, sourceHash);
+	if(shader)
+	{
+		++m_hits;
+		return shader;
+	}
+
+	++m_misses;
+	shader = m_factory();
+	shader->Create(source.c_str());
+	if(shader->IsValid())
+		Store(file, sourceHash, shader.get());
+	return shader;
+}
+
+/**
+ * \brief Remove the cached binary of a program, so it's compiled again the next time it's created.
+ * \param source The preprocessed source of the program.
+ * \return True if a cached binary was removed.
+ */
+bool GFW::ShaderBinaryCache::Invalidate(const std::string& source)
+{
+	return remove(GetFilePath(source).c_str()) == 0;
+}
+
+/**
+ * \return The path of the cache file of a program.
+ */
+std::string GFW::ShaderBinaryCache::GetFilePath(const std::string& source) const
+{
+	const uint64_t key = HashFnv1a64(source.data(), source.size()) ^ (m_identityHash * 0x9E3779B97F4A7C15ull);
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+	return m_directory + name;
+}
+
+/**
+ * \return The amount of programs created from a cached binary.
+ */
+unsigned long long GFW::ShaderBinaryCache::GetHitCount() const
+{
+	return m_hits;
+}
+
+/**
+ * \return The amount of programs compiled from source.
+ */
+unsigned long long GFW::ShaderBinaryCache::GetMissCount() const
+{
+	return m_misses;
+}
+
+/**
+ * \brief Create a program from a cache file. Files that don't belong to @sourceHash and the backend identity, are damaged or rejected by the backend are removed.
+ * \param file The path of the cache file.
+ * \param sourceHash The hash of the source of the program.
+ * \return The program, nullptr if the file doesn't exist or can't be used.
+ */
+std::unique_ptr<GFW::IShader> GFW::ShaderBinaryCache::Load(const std::string& file, uint64_t sourceHash)
+{
+	std::unique_ptr<IShader> shader;
+	{
+		MappedFile mapping;
+		if(!mapping.Open(file.c_str()))
+			return nullptr;
+
+		CacheHeader header;
+		PayloadReader reader = { mapping.GetData(), mapping.GetSize() };
+		bool valid = reader.Read(header) && memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) == 0 && header.version == CACHE_VERSION &&
+			header.sourceHash == sourceHash && header.identityHash == m_identityHash && header.payloadSize == reader.remaining &&
+			HashFnv1a64(reader.data, reader.remaining) == header.payloadHash;
+
+		uint64_t binarySize = 0;
+		const unsigned char* binary = nullptr;
+		uint32_t attributeCount = 0;
+		uint32_t parameterCount = 0;
+		std::vector<ShaderAttribute> attributes;
+		std::vector<ShaderParameter> parameters;
+		if(valid && reader.Read(binarySize))
+		{
+			binary = reader.data;
+			valid = reader.Skip(binarySize) && reader.Read(attributeCount);
+			for(uint32_t i = 0; i < attributeCount && valid; ++i)
+			{
+				int32_t values[2];
+				valid = reader.Read(values);
+				attributes.push_back(ShaderAttribute{ static_cast<ShaderAttributeType>(values[0]), values[1] });
+			}
+
+			valid = valid && reader.Read(parameterCount);
+			for(uint32_t i = 0; i < parameterCount && valid; ++i)
+			{
+				int32_t values[2];
+				uint32_t nameLength = 0;
+				valid = reader.Read(values) && reader.Read(nameLength) && reader.remaining >= nameLength;
+				if(valid)
+				{
+					ShaderParameter parameter = {};
+					parameter.name.assign(reinterpret_cast<const char*>(reader.data), nameLength);
+					parameter.type = static_cast<ShaderParameterType>(values[0]);
+					parameter.location = values[1];
+					parameters.push_back(std::move(parameter));
+					reader.Skip(nameLength);
+				}
+			}
+			valid = valid && reader.remaining == 0;
+		}
+		else
+			valid = false;
+
+		if(valid)
+		{
+			shader = m_factory();
+			if(!shader->CreateFromBinary(binary, size_t(binarySize), attributes, parameters))
+				shader.reset();
+		}
+	}
+
+	// The mapping has to be closed before the file can be removed on Windows.
+	if(!shader)
+		remove(file.c_str());
+	return shader;
+}
+
+/**
+ * \brief Write the binary and reflection of a program to a cache file. The file is written under a temporary name and then renamed.
+ * \param file The path of the cache file.
+ * \param sourceHash The hash of the source of the program.
+ * \param shader The compiled program.
+ * \return False if the backend doesn't support program binaries or the file couldn't be written.
+ */
+bool GFW::ShaderBinaryCache::Store(const std::string& file, uint64_t sourceHash, IShader* shader)
+{
+	std::vector<unsigned char> binary;
+	if(!shader->GetProgramBinary(binary))
+		return false;
+
+	std::vector<unsigned char> payload;
+	Append(payload, uint64_t(binary.size()));
+	payload.insert(payload.end(), binary.begin(), binary.end());
+	const std::vector<ShaderAttribute>& attributes = shader->GetShaderAttributes();
+	Append(payload, uint32_t(attributes.size()));
+	for(const ShaderAttribute& attribute : attributes)
+	{
+		Append(payload, int32_t(attribute.type));
+		Append(payload, int32_t(attribute.location));
+	}
+	const ShaderReflection& reflection = shader->GetShaderReflection();
+	Append(payload, uint32_t(reflection.GetParameterCount()));
+	for(int i = 0; i < reflection.GetParameterCount(); ++i)
+	{
+		const char* name = reflection.GetParameterName(i);
+		const size_t nameLength = strlen(name);
+		Append(payload, int32_t(reflection.GetParameterType(i)));
+		Append(payload, int32_t(reflection.GetParameterLocation(i)));
+		Append(payload, uint32_t(nameLength));
+		payload.insert(payload.end(), name, name + nameLength);
+	}
+
+	CacheHeader header;
+	memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+	header.version = CACHE_VERSION;
+	header.sourceHash = sourceHash;
+	header.identityHash = m_identityHash;
+	header.payloadSize = payload.size();
+	header.payloadHash = HashFnv1a64(payload.data(), payload.size());
+
+	// Threads and processes writing the same program each use their own temporary file.
+	char suffix[96];
+	snprintf(suffix, sizeof(suffix), ".%llx.%llx.%llx.tmp", static_cast<unsigned long long>(std::chrono::steady_clock::now().time_since_epoch().count()),
+		static_cast<unsigned long long>(std::hash<std::thread::id>()(std::this_thread::get_id())), static_cast<unsigned long long>(m_tempFiles++));
+	const std::string temporary = file + suffix;
+	FILE* stream = fopen(temporary.c_str(), "wb");
+	if(!stream)
+		return false;
+
+	const bool written = fwrite(&header, sizeof(header), 1, stream) == 1 && fwrite(payload.data(), 1, payload.size(), stream) == payload.size();
+	if(fclose(stream) != 0 || !written)
+	{
+		remove(temporary.c_str());
+		return false;
+	}
+
+	// rename() doesn't replace existing files on Windows. Readers validate the checksum, so replacing in two steps is safe.
+	if(rename(temporary.c_str(), file.c_str()) != 0)
+	{
+		remove(file.c_str());
+		if(rename(temporary.c_str(), file.c_str()) != 0)
+		{
+			remove(temporary.c_str());
+			return false;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,232 @@
+#include <ShaderCompiler.h>
+#include <algorithm>
+#include "Logging.h"
+
+GFW::ShaderCompileRequest::ShaderCompileRequest(const std::string& path, uint64_t variantKey, IShader* placeholder, int priority)
+	: m_path(path), m_variantKey(variantKey), m_priority(priority), m_variant(), m_prepared(false), m_placeholder(placeholder), m_shader(nullptr), m_state(ShaderCompileState::PENDING),
+	m_submitted(std::chrono::steady_clock::now()), m_waitTime(0.0), m_compileTime(0.0)
+{
+}
+
+/**
+ * \return The current state of the compile.
+ */
+GFW::ShaderCompileState GFW::ShaderCompileRequest::GetState() const
+{
+	return m_state;
+}
+
+/**
+ * \return The compiled program when the compile is ready, the placeholder of the compiler at the time of the request otherwise.
+ */
+GFW::IShader* GFW::ShaderCompileRequest::GetShader() const
+{
+	return m_state == ShaderCompileState::READY ? m_shader.load() : m_placeholder;
+}
+
+/**
+ * \return The path of the source file.
+ */
+const std::string& GFW::ShaderCompileRequest::GetPath() const
+{
+	return m_path;
+}
+
+/**
+ * \return The key of the variant that is compiled.
+ */
+uint64_t GFW::ShaderCompileRequest::GetVariantKey() const
+{
+	return m_variantKey;
+}
+
+/**
+ * \return The milliseconds the request waited for a worker thread. Only valid once the compile is ready or failed.
+ */
+double GFW::ShaderCompileRequest::GetWaitTime() const
+{
+	return m_waitTime;
+}
+
+/**
+ * \return The milliseconds spent preprocessing and compiling the program, close to 0 if the variant was already compiled. When the program is created
+ * by ProcessCreates() the time it waited for that call isn't included. Only valid once the compile is ready or failed.
+ */
+double GFW::ShaderCompileRequest::GetCompileTime() const
+{
+	return m_compileTime;
+}
+
+/**
+ * \brief Creates the compiler.
+ * \param permutations Preprocesses and compiles the programs and keeps them. Must outlive the compiler.
+ * \param threadPool The pool to compile on. nullptr to use the default thread pool.
+ * \param parallelCreate If the programs are also created on the thread pool. Only set this if IShader::Create() of the shaders the permutations create
+ * may be called from worker threads. Otherwise the programs are created by ProcessCreates() and Wait().
+ */
+GFW::ShaderCompiler::ShaderCompiler(ShaderPermutations* permutations, ThreadPool* threadPool, bool parallelCreate)
+	: m_permutations(permutations), m_threadPool(threadPool ? threadPool : &ThreadPool::GetDefault()), m_parallelCreate(parallelCreate), m_placeholder(nullptr),
+	m_activeTasks(0)
+{
+	GFW_ASSERT(m_permutations != nullptr);
+}
+
+/**
+ * \brief Waits for the running compile tasks to finish. Programs of requests that still wait for ProcessCreates() aren't created.
+ */
+GFW::ShaderCompiler::~ShaderCompiler()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_taskFinished.wait(lock, [this]() { return m_activeTasks == 0; });
+}
+
+/**
+ * \brief Set the shader that requests return until their program is ready, for example a flat colored shader.
+ * \param placeholder The placeholder, nullptr to return nullptr until programs are ready. Not owned by the compiler.
+ */
+void GFW::ShaderCompiler::SetPlaceholder(IShader* placeholder)
+{
+	m_placeholder = placeholder;
+}
+
+/**
+ * \return The shader that new requests return until their program is ready.
+ */
+GFW::IShader* GFW::ShaderCompiler::GetPlaceholder() const
+{
+	return m_placeholder;
+}
+
+/**
+ * \brief Start compiling a shader variant. Returns immediately, the source is preprocessed on the thread pool and the program is created by ProcessCreates(),
+ * or on the thread pool as well when the compiler was created with parallelCreate.
+ * \param path The path of the source file.
+ * \param variantKey The key of the variant, see ShaderPermutations::GetVariantKey().
+ * \param priority Compiles with a higher priority start before compiles with a lower priority.
+ * \return Handle to poll the state of the compile and get the program.
+ */
+GFW::ShaderCompileHandle GFW::ShaderCompiler::CreateAsync(const std::string& path, uint64_t variantKey, int priority)
+{
+	ShaderCompileHandle handle(new ShaderCompileRequest(path, variantKey, m_placeholder, priority));
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		++m_activeTasks;
+	}
+
+	m_threadPool->Submit([this, handle]() { Compile(handle); }, priority);
+	return handle;
+}
+
+/**
+ * \brief Block until a compile is ready or failed, for programs that are needed right away. Unless the compiler was created with parallelCreate
+ * the program is created on the calling thread once it's preprocessed, so this has to be called on the thread that calls ProcessCreates().
+ * \param handle The compile to wait for.
+ */
+void GFW::ShaderCompiler::Wait(const ShaderCompileHandle& handle)
+{
+	GFW_ASSERT(handle != nullptr);
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_taskFinished.wait(lock, [&handle]() { return handle->m_state != ShaderCompileState::PENDING || handle->m_prepared; });
+		if(handle->m_state != ShaderCompileState::PENDING)
+			return;
+
+		m_prepared.erase(std::find(m_prepared.begin(), m_prepared.end(), handle));
+		handle->m_prepared = false;
+	}
+	CreateProgram(handle);
+}
+
+/**
+ * \brief Create the programs of preprocessed requests, highest priority first. Call this regularly on the thread that owns the context,
+ * it does nothing when the compiler was created with parallelCreate.
+ * \param maxPrograms The maximum amount of programs to create, limits the time spent in this call.
+ * \return The amount of programs created.
+ */
+int GFW::ShaderCompiler::ProcessCreates(int maxPrograms)
+{
+	int created = 0;
+	while(created < maxPrograms)
+	{
+		ShaderCompileHandle request;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if(m_prepared.empty())
+				break;
+
+			auto highest = std::max_element(m_prepared.begin(), m_prepared.end(),
+				[](const ShaderCompileHandle& a, const ShaderCompileHandle& b) { return a->m_priority < b->m_priority; });
+			request = std::move(*highest);
+			*highest = std::move(m_prepared.back());
+			m_prepared.pop_back();
+			request->m_prepared = false;
+		}
+
+		CreateProgram(request);
+		++created;
+	}
+	return created;
+}
+
+/**
+ * \return True when there are no compiles left.
+ */
+bool GFW::ShaderCompiler::IsIdle()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_activeTasks == 0 && m_prepared.empty();
+}
+
+/**
+ * \brief Executed on the thread pool. Preprocesses the variant of a request and creates its program when the compiler was created with parallelCreate,
+ * or hands the request over to ProcessCreates() otherwise.
+ */
+void GFW::ShaderCompiler::Compile(const ShaderCompileHandle& request)
+{
+	const auto start = std::chrono::steady_clock::now();
+	request->m_waitTime = std::chrono::duration<double, std::milli>(start - request->m_submitted).count();
+	IShader* shader = nullptr;
+	bool prepared = false;
+	if(m_parallelCreate)
+		shader = m_permutations->GetVariant(request->m_path, request->m_variantKey);
+	else if(m_permutations->PrepareVariant(request->m_path, request->m_variantKey, request->m_variant))
+	{
+		// Variants that are already compiled don't have to wait for the owning thread.
+		prepared = request->m_variant.shader == nullptr;
+		shader = request->m_variant.shader && request->m_variant.shader->IsValid() ? request->m_variant.shader : nullptr;
+	}
+	request->m_compileTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if(prepared)
+	{
+		request->m_prepared = true;
+		m_prepared.push_back(request);
+	}
+	else
+	{
+		request->m_shader = shader;
+		request->m_state = shader ? ShaderCompileState::READY : ShaderCompileState::FAILED;
+	}
+	--m_activeTasks;
+	m_taskFinished.notify_all();
+}
+
+/**
+ * \brief Create the program of a preprocessed request on the calling thread and publish it.
+ */
+void GFW::ShaderCompiler::CreateProgram(const ShaderCompileHandle& request)
+{
+	const auto start = std::chrono::steady_clock::now();
+	IShader* shader = m_permutations->CreateVariant(request->m_variant);
+	if(!shader->IsValid())
+		shader = nullptr;
+	request->m_compileTime += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	request->m_variant.source.clear();
+	request->m_variant.source.shrink_to_fit();
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	request->m_shader = shader;
+	request->m_state = shader ? ShaderCompileState::READY : ShaderCompileState::FAILED;
+	m_taskFinished.notify_all();
+}
@@ -0,0 +1,482 @@
+#include <ShaderParameterBatch.h>
+#include <cstring>
+#include "Interfaces/IShader.h"
+#include "Logging.h"
+
+namespace
+{
+	const size_t VALUE_ALIGNMENT = 16;
+}
+
+GFW::ShaderParameterBatch::ShaderParameterBatch()
+{
+}
+
+/**
+ * \brief Remove all entries, keeping the allocated memory for the next batch.
+ */
+void GFW::ShaderParameterBatch::Clear()
+{
+	m_entries.clear();
+	m_values.clear();
+}
+
+/**
+ * \brief Record bool values.
+ * \param handle The handle of the shader parameter.
+ * \param values The values to set, copied into the batch.
+ * \param count The amount of elements to set, 1 for parameters that aren't arrays.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterBatch::Add(ShaderParameterHandle handle, const bool* values, int count, int firstElement)
+{
+	Add(handle, ShaderParameterType::BOOL, ShaderParameterResource::NONE, values, sizeof(bool), count, firstElement);
+}
+
+/**
+ * \brief Record int values.
+ * \param handle The handle of the shader parameter.
+ * \param values The values to set, copied into the batch.
+ * \param count The amount of elements to set, 1 for parameters that aren't arrays.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterBatch::Add(ShaderParameterHandle handle, const int* values, int count, int firstElement)
+{
+	Add(handle, ShaderParameterType::INT, ShaderParameterResource::NONE, values, sizeof(int), count, firstElement);
+}
+
+/**
+ * \brief Record unsigned int values.
+ * \param handle The handle of the shader parameter.
+ * \param values The values to set, copied into the batch.
+ * \param count The amount of elements to set, 1 for parameters that aren't arrays.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterBatch::Add(ShaderParameterHandle handle, const unsigned* values, int count, int firstElement)
+{
+	Add(handle, ShaderParameterType::UNSIGNED_INT, ShaderParameterResource::NONE, values, sizeof(unsigned), count, firstElement);
+}
+
+/**
+ * \brief Record float values.
+ * \param handle The handle of the shader parameter.
+ * \param values The values to set, copied into the batch.
+ * \param count The amount of elements to set, 1 for parameters that aren't arrays.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterBatch::Add(ShaderParameterHandle handle, const float* values, int count, int firstElement)
+{
+	Add(handle, ShaderParameterType::FLOAT, ShaderParameterResource::NONE, values, sizeof(float), count, firstElement);
+}
+
+/**
+ * \brief Record double values.
+ * \param handle The handle of the shader parameter.
+ * \param values The values to set, copied into the batch.
+ * \param count The amount of elements to set, 1 for parameters that aren't arrays.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterBatch::Add(ShaderParameterHandle handle, const double* values, int count, int firstElement)
+{
+	Add(handle, ShaderParameterType::DOUBLE, ShaderParameterResource::NONE, values, sizeof(double), count, firstElement);
+}
+
+/**
+ * \brief Record 2 component bool vector values.
+ * \param handle The handle of the shader parameter.
+ * \param values The values to set, copied into the batch.
+ * \param count The amount of elements to set, 1 for parameters that aren't arrays.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterBatch::Add(ShaderParameterHandle handle, const BVec2* values, int count, int firstElement)
+{
+	Add(handle, ShaderParameterType::BVEC2, ShaderParameterResource::NONE, values, sizeof(BVec2), count, firstElement);
+}
+
+/**
+ * \brief Record 2 component int vector values.
+ * \param handle The handle of the shader parameter.
+ * \param values The values to set, copied into the batch.
+ * \param count The amount of elements to set, 1 for parameters that aren't arrays.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterBatch::Add(ShaderParameterHandle handle, const IVec2* values, int count, int firstElement)
+{
+	Add(handle, ShaderParameterType::IVEC2, ShaderParameterResource::NONE, values, sizeof(IVec2), count, firstElement);
+}
+
+/**
+ * \brief Record 2 component unsigned int vector values.
+ * \param handle The handle of the shader parameter.
+ * \param values The values to set, copied into the batch.
+ * \param count The amount of elements to set, 1 for parameters that aren't arrays.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterBatch::Add(ShaderParameterHandle handle, const UVec2* values, int count, int firstElement)
+{
+	Add(handle, ShaderParameterType::UVEC2, ShaderParameterResource::NONE, values, sizeof(UVec2), count, firstElement);
+}
+
+/**
+ * \brief Record 2 component float vector values.
+ * \param handle The handle of the shader parameter.
+ * \param values The values to set, copied into the batch.
+ * \param count The amount of elements to set, 1 for parameters that aren't arrays.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterBatch::Add(ShaderParameterHandle handle, const Vec2* values, int count, int firstElement)
+{
+	Add(handle, ShaderParameterType::VEC2, ShaderParameterResource::NONE, values, sizeof(Vec2), count, firstElement);
+}
+
+/**
+ * \brief Record 2 component double vector values.
+ * \param handle The handle of the shader parameter.
+ * \param values The values to set, copied into the batch.
+ * \param count The amount of elements to set, 1 for parameters that aren't arrays.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterBatch::Add(ShaderParameterHandle handle, const DVec2* values, int count, int firstElement)
+{
+	Add(handle, ShaderParameterType::DVEC2, ShaderParameterResource::NONE, values, sizeof(DVec2), count, firstElement);
+}
+
+/**
+ * \brief Record 3 component bool vector values.
+ * \param handle The handle of the shader parameter.
+ * \param values The values to set, copied into the batch.
+ * \param count The amount of elements to set, 1 for parameters that aren't arrays.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterBatch::Add(ShaderParameterHandle handle, const BVec3* values, int count, int firstElement)
+{
+	Add(handle, ShaderParameterType::BVEC3, ShaderParameterResource::NONE, values, sizeof(BVec3), count, firstElement);
+}
+
+/**
+ * \brief Record 3 component int vector values.
+ * \param handle The handle of the shader parameter.
+ * \param values The values to set, copied into the batch.
+ * \param count The amount of elements to set, 1 for parameters that aren't arrays.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterBatch::Add(ShaderParameterHandle handle, const IVec3* values, int count, int firstElement)
+{
+	Add(handle, ShaderParameterType::IVEC3, ShaderParameterResource::NONE, values, sizeof(IVec3), count, firstElement);
+}
+
+/**
+ * \brief Record 3 component unsigned int vector values.
+ * \param handle The handle of the shader parameter.
+ * \param values The values to set, copied into the batch.
+ * \param count The amount of elements to set, 1 for parameters that aren't arrays.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterBatch::Add(ShaderParameterHandle handle, const UVec3* values, int count, int firstElement)
+{
+	Add(handle, ShaderParameterType::UVEC3, ShaderParameterResource::NONE, values, sizeof(UVec3), count, firstElement);
+}
+
+/**
+ * \brief Record 3 component float vector values.
+ * \param handle The handle of the shader parameter.
+ * \param values The values to set, copied into the batch.
+ * \param count The amount of elements to set, 1 for parameters that aren't arrays.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterBatch::Add(ShaderParameterHandle handle, const Vec3* values, int count, int firstElement)
+{
+	Add(handle, ShaderParameterType::VEC3, ShaderParameterResource::NONE, values, sizeof(Vec3), count, firstElement);
+}
+
+/**
+ * \brief Record 3 component double vector values.
+ * \param handle The handle of the shader parameter.
+ * \param values The values to set, copied into the batch.
+ * \param count The amount of elements to set, 1 for parameters that aren't arrays.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterBatch::Add(ShaderParameterHandle handle, const DVec3* values, int count, int firstElement)
+{
+	Add(handle, ShaderParameterType::DVEC3, ShaderParameterResource::NONE, values, sizeof(DVec3), count, firstElement);
+}
+
+/**
+ * \brief Record 4 component bool vector values.
+ * \param handle The handle of the shader parameter.
+ * \param values The values to set, copied into the batch.
+ * \param count The amount of elements to set, 1 for parameters that aren't arrays.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterBatch::Add(ShaderParameterHandle handle, const BVec4* values, int count, int firstElement)
+{
+	Add(handle, ShaderParameterType::BVEC4, ShaderParameterResource::NONE, values, sizeof(BVec4), count, firstElement);
+}
+
+/**
+ * \brief Record 4 component int vector values.
+ * \param handle The handle of the shader parameter.
+ * \param values The values to set, copied into the batch.
+ * \param count The amount of elements to set, 1 for parameters that aren't arrays.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterBatch::Add(ShaderParameterHandle handle, const IVec4* values, int count, int firstElement)
+{
+	Add(handle, ShaderParameterType::IVEC4, ShaderParameterResource::NONE, values, sizeof(IVec4), count, firstElement);
+}
+
+/**
+ * \brief Record 4 component unsigned int vector values.
+ * \param handle The handle of the shader parameter.
+ * \param values The values to set, copied into the batch.
+ * \param count The amount of elements to set, 1 for parameters that aren't arrays.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterBatch::Add(ShaderParameterHandle handle, const UVec4* values, int count, int firstElement)
+{
+	Add(handle, ShaderParameterType::UVEC4, ShaderParameterResource::NONE, values, sizeof(UVec4), count, firstElement);
+}
+
+/**
+ * \brief Record 4 component float vector values.
+ * \param handle The handle of the shader parameter.
+ * \param values The values to set, copied into the batch.
+ * \param count The amount of elements to set, 1 for parameters that aren't arrays.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterBatch::Add(ShaderParameterHandle handle, const Vec4* values, int count, int firstElement)
+{
+	Add(handle, ShaderParameterType::VEC4, ShaderParameterResource::NONE, values, sizeof(Vec4), count, firstElement);
+}
+
+/**
+ * \brief Record 4 component double vector values.
+ * \param handle The handle of the shader parameter.
+ * \param values The values to set, copied into the batch.
+ * \param count The amount of elements to set, 1 for parameters that aren't arrays.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterBatch::Add(ShaderParameterHandle handle, const DVec4* values, int count, int firstElement)
+{
+	Add(handle, ShaderParameterType::DVEC4, ShaderParameterResource::NONE, values, sizeof(DVec4), count, firstElement);
+}
+
+/**
+ * \brief Record 2x2 matrix values.
+ * \param handle The handle of the shader parameter.
+ * \param values The values to set, copied into the batch.
+ * \param count The amount of elements to set, 1 for parameters that aren't arrays.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterBatch::Add(ShaderParameterHandle handle, const Mat2* values, int count, int firstElement)
+{
+	Add(handle, ShaderParameterType::MAT2, ShaderParameterResource::NONE, values, sizeof(Mat2), count, firstElement);
+}
+
+/**
+ * \brief Record 3x3 matrix values.
+ * \param handle The handle of the shader parameter.
+ * \param values The values to set, copied into the batch.
+ * \param count The amount of elements to set, 1 for parameters that aren't arrays.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterBatch::Add(ShaderParameterHandle handle, const Mat3* values, int count, int firstElement)
+{
+	Add(handle, ShaderParameterType::MAT3, ShaderParameterResource::NONE, values, sizeof(Mat3), count, firstElement);
+}
+
+/**
+ * \brief Record 4x4 matrix values.
+ * \param handle The handle of the shader parameter.
+ * \param values The values to set, copied into the batch.
+ * \param count The amount of elements to set, 1 for parameters that aren't arrays.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterBatch::Add(ShaderParameterHandle handle, const Mat4* values, int count, int firstElement)
+{
+	Add(handle, ShaderParameterType::MAT4, ShaderParameterResource::NONE, values, sizeof(Mat4), count, firstElement);
+}
+
+/**
+ * \brief Record texture bindings.
+ * \param handle The handle of the shader parameter.
+ * \param values The textures to bind to the sampler locations, the pointers are copied into the batch.
+ * \param count The amount of elements to set, 1 for parameters that aren't arrays.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterBatch::Add(ShaderParameterHandle handle, const ITexture* const* values, int count, int firstElement)
+{
+	Add(handle, ShaderParameterType::SAMPLER2D, ShaderParameterResource::TEXTURE, values, sizeof(const ITexture*), count, firstElement);
+}
+
+/**
+ * \brief Record sampler bindings.
+ * \param handle The handle of the shader parameter.
+ * \param values The samplers to bind to the sampler locations, the pointers are copied into the batch.
+ * \param count The amount of elements to set, 1 for parameters that aren't arrays.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterBatch::Add(ShaderParameterHandle handle, const ISampler* const* values, int count, int firstElement)
+{
+	Add(handle, ShaderParameterType::SAMPLER2D, ShaderParameterResource::SAMPLER, values, sizeof(const ISampler*), count, firstElement);
+}
+
+/**
+ * \brief Record buffer bindings.
+ * \param handle The handle of the shader parameter.
+ * \param values The buffers to bind to the buffer bindings, the pointers are copied into the batch.
+ * \param count The amount of elements to set, 1 for parameters that aren't arrays.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterBatch::Add(ShaderParameterHandle handle, const IBuffer* const* values, int count, int firstElement)
+{
+	Add(handle, ShaderParameterType::UNIFORM_BUFFER, ShaderParameterResource::BUFFER, values, sizeof(const IBuffer*), count, firstElement);
+}
+
+/**
+ * \return The amount of recorded entries.
+ */
+int GFW::ShaderParameterBatch::GetEntryCount() const
+{
+	return int(m_entries.size());
+}
+
+/**
+ * \return The description of entry @index.
+ */
+const GFW::ShaderParameterBatchEntry& GFW::ShaderParameterBatch::GetEntry(int index) const
+{
+	return m_entries[index];
+}
+
+/**
+ * \return The values of entry @index, an array of the type or resource pointer of the entry.
+ */
+const void* GFW::ShaderParameterBatch::GetValues(int index) const
+{
+	return m_values.data() + m_entries[index].offset;
+}
+
+/**
+ * \brief Forward every entry to IShader::SetShaderParameterArray(). This is what IShader::SetShaderParameters() does by default.
+ * \param shader The shader program to set the parameters on.
+ */
+void GFW::ShaderParameterBatch::Apply(IShader* shader) const
+{
+	GFW_ASSERT(shader != nullptr);
+	for(size_t i = 0; i < m_entries.size(); ++i)
+	{
+		const ShaderParameterBatchEntry& entry = m_entries[i];
+		const void* values = m_values.data() + entry.offset;
+		switch(entry.resource)
+		{
+		case ShaderParameterResource::TEXTURE:
+			shader->SetShaderParameterArray(entry.handle, static_cast<const ITexture* const*>(values), entry.count, entry.firstElement);
+			continue;
+		case ShaderParameterResource::SAMPLER:
+			shader->SetShaderParameterArray(entry.handle, static_cast<const ISampler* const*>(values), entry.count, entry.firstElement);
+			continue;
+		case ShaderParameterResource::BUFFER:
+			shader->SetShaderParameterArray(entry.handle, static_cast<const IBuffer* const*>(values), entry.count, entry.firstElement);
+			continue;
+		default:
+			break;
+		}
+
+		switch(entry.type)
+		{
+		case ShaderParameterType::BOOL:
+			shader->SetShaderParameterArray(entry.handle, static_cast<const bool*>(values), entry.count, entry.firstElement);
+			break;
+		case ShaderParameterType::INT:
+			shader->SetShaderParameterArray(entry.handle, static_cast<const int*>(values), entry.count, entry.firstElement);
+			break;
+		case ShaderParameterType::UNSIGNED_INT:
+			shader->SetShaderParameterArray(entry.handle, static_cast<const unsigned*>(values), entry.count, entry.firstElement);
+			break;
+		case ShaderParameterType::FLOAT:
+			shader->SetShaderParameterArray(entry.handle, static_cast<const float*>(values), entry.count, entry.firstElement);
+			break;
+		case ShaderParameterType::DOUBLE:
+			shader->SetShaderParameterArray(entry.handle, static_cast<const double*>(values), entry.count, entry.firstElement);
+			break;
+		case ShaderParameterType::BVEC2:
+			shader->SetShaderParameterArray(entry.handle, static_cast<const BVec2*>(values), entry.count, entry.firstElement);
+			break;
+		case ShaderParameterType::IVEC2:
+			shader->SetShaderParameterArray(entry.handle, static_cast<const IVec2*>(values), entry.count, entry.firstElement);
+			break;
+		case ShaderParameterType::UVEC2:
+			shader->SetShaderParameterArray(entry.handle, static_cast<const UVec2*>(values), entry.count, entry.firstElement);
+			break;
+		case ShaderParameterType::VEC2:
+			shader->SetShaderParameterArray(entry.handle, static_cast<const Vec2*>(values), entry.count, entry.firstElement);
+			break;
+		case ShaderParameterType::DVEC2:
+			shader->SetShaderParameterArray(entry.handle, static_cast<const DVec2*>(values), entry.count, entry.firstElement);
+			break;
+		case ShaderParameterType::BVEC3:
+			shader->SetShaderParameterArray(entry.handle, static_cast<const BVec3*>(values), entry.count, entry.firstElement);
+			break;
+		case ShaderParameterType::IVEC3:
+			shader->SetShaderParameterArray(entry.handle, static_cast<const IVec3*>(values), entry.count, entry.firstElement);
+			break;
+		case ShaderParameterType::UVEC3:
+			shader->SetShaderParameterArray(entry.handle, static_cast<const UVec3*>(values), entry.count, entry.firstElement);
+			break;
+		case ShaderParameterType::VEC3:
+			shader->SetShaderParameterArray(entry.handle, static_cast<const Vec3*>(values), entry.count, entry.firstElement);
+			break;
+		case ShaderParameterType::DVEC3:
+			shader->SetShaderParameterArray(entry.handle, static_cast<const DVec3*>(values), entry.count, entry.firstElement);
+			break;
+		case ShaderParameterType::BVEC4:
+			shader->SetShaderParameterArray(entry.handle, static_cast<const BVec4*>(values), entry.count, entry.firstElement);
+			break;
+		case ShaderParameterType::IVEC4:
+			shader->SetShaderParameterArray(entry.handle, static_cast<const IVec4*>(values), entry.count, entry.firstElement);
+			break;
+		case ShaderParameterType::UVEC4:
+			shader->SetShaderParameterArray(entry.handle, static_cast<const UVec4*>(values), entry.count, entry.firstElement);
+			break;
+		case ShaderParameterType::VEC4:
+			shader->SetShaderParameterArray(entry.handle, static_cast<const Vec4*>(values), entry.count, entry.firstElement);
+			break;
+		case ShaderParameterType::DVEC4:
+			shader->SetShaderParameterArray(entry.handle, static_cast<const DVec4*>(values), entry.count, entry.firstElement);
+			break;
+		case ShaderParameterType::MAT2:
+			shader->SetShaderParameterArray(entry.handle, static_cast<const Mat2*>(values), entry.count, entry.firstElement);
+			break;
+		case ShaderParameterType::MAT3:
+			shader->SetShaderParameterArray(entry.handle, static_cast<const Mat3*>(values), entry.count, entry.firstElement);
+			break;
+		case ShaderParameterType::MAT4:
+			shader->SetShaderParameterArray(entry.handle, static_cast<const Mat4*>(values), entry.count, entry.firstElement);
+			break;
+		default:
+			GFW_ASSERT(false);
+			break;
+		}
+	}
+}
+
+/**
+ * \brief Record an entry and copy its values.
+ * \param handle The handle of the shader parameter.
+ * \param type The type of the values.
+ * \param resource The kind of resource pointers in @values, NONE for values of @type.
+ * \param values The values to copy.
+ * \param size The size of a single value in bytes.
+ * \param count The amount of values.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterBatch::Add(ShaderParameterHandle handle, ShaderParameterType type, ShaderParameterResource resource, const void* values, size_t size, int count,
+	int firstElement)
+{
+	GFW_ASSERT(values != nullptr && count > 0 && firstElement >= 0);
+	const size_t offset = (m_values.size() + VALUE_ALIGNMENT - 1) / VALUE_ALIGNMENT * VALUE_ALIGNMENT;
+	m_values.resize(offset + size * size_t(count));
+	memcpy(m_values.data() + offset, values, size * size_t(count));
+	m_entries.push_back(ShaderParameterBatchEntry{ handle, type, resource, count, firstElement, uint32_t(offset) });
+}
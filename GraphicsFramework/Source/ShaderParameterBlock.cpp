@@ -0,0 +1,591 @@
+#include <ShaderParameterBlock.h>
+#include <cstring>
+#include "Logging.h"
+
+namespace
+{
+	bool IsSampler(GFW::ShaderParameterType type)
+	{
+		return type >= GFW::ShaderParameterType::SAMPLER1D && type <= GFW::ShaderParameterType::SAMPLERCUBE;
+	}
+
+	/**
+	 * \return The alignment of values of @type in the value blob. Bools are packed bytewise.
+	 */
+	size_t GetValueAlignment(GFW::ShaderParameterType type)
+	{
+		switch(type)
+		{
+		case GFW::ShaderParameterType::BOOL:
+		case GFW::ShaderParameterType::BVEC2:
+		case GFW::ShaderParameterType::BVEC3:
+		case GFW::ShaderParameterType::BVEC4:
+			return 1;
+		case GFW::ShaderParameterType::DOUBLE:
+		case GFW::ShaderParameterType::DVEC2:
+		case GFW::ShaderParameterType::DVEC3:
+		case GFW::ShaderParameterType::DVEC4:
+			return sizeof(double);
+		case GFW::ShaderParameterType::UNIFORM_BUFFER:
+		case GFW::ShaderParameterType::SHADER_STORAGE_BUFFER:
+			return sizeof(void*);
+		default:
+			return IsSampler(type) ? sizeof(void*) : sizeof(float);
+		}
+	}
+
+	template<typename T>
+	T Load(const unsigned char* value)
+	{
+		T x;
+		memcpy(&x, value, sizeof(T));
+		return x;
+	}
+}
+
+GFW::ShaderParameterBlock::ShaderParameterBlock()
+{
+}
+
+/**
+ * \brief Lay out the values of the parameters of a shader program. All values start out as 0, like the parameters of a freshly linked program.
+ * \param reflection The reflection of the program, see IShader::GetShaderReflection().
+ */
+void GFW::ShaderParameterBlock::Create(const ShaderReflection& reflection)
+{
+	m_types = reflection.GetParameterTypes();
+	m_locations = reflection.GetParameterLocations();
+	m_offsets.resize(m_types.size());
+	size_t size = 0;
+	for(size_t i = 0; i < m_types.size(); ++i)
+	{
+		const size_t alignment = GetValueAlignment(m_types[i]);
+		size = (size + alignment - 1) / alignment * alignment;
+		m_offsets[i] = uint32_t(size);
+		size += GetValueSize(m_types[i]);
+	}
+	m_values.assign(size, 0);
+}
+
+/**
+ * \return The amount of parameters.
+ */
+int GFW::ShaderParameterBlock::GetParameterCount() const
+{
+	return int(m_types.size());
+}
+
+/**
+ * \return The type of parameter @index.
+ */
+GFW::ShaderParameterType GFW::ShaderParameterBlock::GetType(int index) const
+{
+	return m_types[index];
+}
+
+/**
+ * \return The location or binding of parameter @index.
+ */
+int GFW::ShaderParameterBlock::GetLocation(int index) const
+{
+	return m_locations[index];
+}
+
+/**
+ * \return The packed value of parameter @index, GetValueSize(GetType(@index)) bytes.
+ */
+const unsigned char* GFW::ShaderParameterBlock::GetValue(int index) const
+{
+	return m_values.data() + m_offsets[index];
+}
+
+/**
+ * \return The size of all packed values in bytes.
+ */
+size_t GFW::ShaderParameterBlock::GetValueSize() const
+{
+	return m_values.size();
+}
+
+/**
+ * \return The size of a packed value of @type in bytes. Sampler values are a texture and a sampler pointer, buffer values a buffer pointer.
+ */
+size_t GFW::ShaderParameterBlock::GetValueSize(ShaderParameterType type)
+{
+	switch(type)
+	{
+	case ShaderParameterType::BOOL:
+		return sizeof(bool);
+	case ShaderParameterType::INT:
+		return sizeof(int);
+	case ShaderParameterType::UNSIGNED_INT:
+		return sizeof(unsigned);
+	case ShaderParameterType::FLOAT:
+		return sizeof(float);
+	case ShaderParameterType::DOUBLE:
+		return sizeof(double);
+	case ShaderParameterType::BVEC2:
+		return sizeof(BVec2);
+	case ShaderParameterType::IVEC2:
+		return sizeof(IVec2);
+	case ShaderParameterType::UVEC2:
+		return sizeof(UVec2);
+	case ShaderParameterType::VEC2:
+		return sizeof(Vec2);
+	case ShaderParameterType::DVEC2:
+		return sizeof(DVec2);
+	case ShaderParameterType::BVEC3:
+		return sizeof(BVec3);
+	case ShaderParameterType::IVEC3:
+		return sizeof(IVec3);
+	case ShaderParameterType::UVEC3:
+		return sizeof(UVec3);
+	case ShaderParameterType::VEC3:
+		return sizeof(Vec3);
+	case ShaderParameterType::DVEC3:
+		return sizeof(DVec3);
+	case ShaderParameterType::BVEC4:
+		return sizeof(BVec4);
+	case ShaderParameterType::IVEC4:
+		return sizeof(IVec4);
+	case ShaderParameterType::UVEC4:
+		return sizeof(UVec4);
+	case ShaderParameterType::VEC4:
+		return sizeof(Vec4);
+	case ShaderParameterType::DVEC4:
+		return sizeof(DVec4);
+	case ShaderParameterType::MAT2:
+		return sizeof(Mat2);
+	case ShaderParameterType::MAT3:
+		return sizeof(Mat3);
+	case ShaderParameterType::MAT4:
+		return sizeof(Mat4);
+	case ShaderParameterType::UNIFORM_BUFFER:
+	case ShaderParameterType::SHADER_STORAGE_BUFFER:
+		return sizeof(const IBuffer*);
+	default:
+		return sizeof(const ITexture*) + sizeof(const ISampler*);
+	}
+}
+
+/**
+ * \brief Set the value of a bool parameter.
+ * \param handle The handle of the parameter.
+ * \param x The new value.
+ */
+void GFW::ShaderParameterBlock::SetShaderParameter(ShaderParameterHandle handle, bool x)
+{
+	GFW_ASSERT(GetType(handle) == ShaderParameterType::BOOL);
+	Store(handle, &x, sizeof(x));
+}
+
+/**
+ * \brief Set the value of a int parameter.
+ * \param handle The handle of the parameter.
+ * \param x The new value.
+ */
+void GFW::ShaderParameterBlock::SetShaderParameter(ShaderParameterHandle handle, int x)
+{
+	GFW_ASSERT(GetType(handle) == ShaderParameterType::INT);
+	Store(handle, &x, sizeof(x));
+}
+
+/**
+ * \brief Set the value of a unsigned int parameter.
+ * \param handle The handle of the parameter.
+ * \param x The new value.
+ */
+void GFW::ShaderParameterBlock::SetShaderParameter(ShaderParameterHandle handle, unsigned x)
+{
+	GFW_ASSERT(GetType(handle) == ShaderParameterType::UNSIGNED_INT);
+	Store(handle, &x, sizeof(x));
+}
+
+/**
+ * \brief Set the value of a float parameter.
+ * \param handle The handle of the parameter.
+ * \param x The new value.
+ */
+void GFW::ShaderParameterBlock::SetShaderParameter(ShaderParameterHandle handle, float x)
+{
+	GFW_ASSERT(GetType(handle) == ShaderParameterType::FLOAT);
+	Store(handle, &x, sizeof(x));
+}
+
+/**
+ * \brief Set the value of a double parameter.
+ * \param handle The handle of the parameter.
+ * \param x The new value.
+ */
+void GFW::ShaderParameterBlock::SetShaderParameter(ShaderParameterHandle handle, double x)
+{
+	GFW_ASSERT(GetType(handle) == ShaderParameterType::DOUBLE);
+	Store(handle, &x, sizeof(x));
+}
+
+/**
+ * \brief Set the value of a 2 component bool vector parameter.
+ * \param handle The handle of the parameter.
+ * \param x The new value.
+ */
+void GFW::ShaderParameterBlock::SetShaderParameter(ShaderParameterHandle handle, const BVec2& x)
+{
+	GFW_ASSERT(GetType(handle) == ShaderParameterType::BVEC2);
+	Store(handle, &x, sizeof(x));
+}
+
+/**
+ * \brief Set the value of a 2 component int vector parameter.
+ * \param handle The handle of the parameter.
+ * \param x The new value.
+ */
+void GFW::ShaderParameterBlock::SetShaderParameter(ShaderParameterHandle handle, const IVec2& x)
+{
+	GFW_ASSERT(GetType(handle) == ShaderParameterType::IVEC2);
+	Store(handle, &x, sizeof(x));
+}
+
+/**
+ * \brief Set the value of a 2 component unsigned int vector parameter.
+ * \param handle The handle of the parameter.
+ * \param x The new value.
+ */
+void GFW::ShaderParameterBlock::SetShaderParameter(ShaderParameterHandle handle, const UVec2& x)
+{
+	GFW_ASSERT(GetType(handle) == ShaderParameterType::UVEC2);
+	Store(handle, &x, sizeof(x));
+}
+
+/**
+ * \brief Set the value of a 2 component float vector parameter.
+ * \param handle The handle of the parameter.
+ * \param x The new value.
+ */
+void GFW::ShaderParameterBlock::SetShaderParameter(ShaderParameterHandle handle, const Vec2& x)
+{
+	GFW_ASSERT(GetType(handle) == ShaderParameterType::VEC2);
+	Store(handle, &x, sizeof(x));
+}
+
+/**
+ * \brief Set the value of a 2 component double vector parameter.
+ * \param handle The handle of the parameter.
+ * \param x The new value.
+ */
+void GFW::ShaderParameterBlock::SetShaderParameter(ShaderParameterHandle handle, const DVec2& x)
+{
+	GFW_ASSERT(GetType(handle) == ShaderParameterType::DVEC2);
+	Store(handle, &x, sizeof(x));
+}
+
+/**
+ * \brief Set the value of a 3 component bool vector parameter.
+ * \param handle The handle of the parameter.
+ * \param x The new value.
+ */
+void GFW::ShaderParameterBlock::SetShaderParameter(ShaderParameterHandle handle, const BVec3& x)
+{
+	GFW_ASSERT(GetType(handle) == ShaderParameterType::BVEC3);
+	Store(handle, &x, sizeof(x));
+}
+
+/**
+ * \brief Set the value of a 3 component int vector parameter.
+ * \param handle The handle of the parameter.
+ * \param x The new value.
+ */
+void GFW::ShaderParameterBlock::SetShaderParameter(ShaderParameterHandle handle, const IVec3& x)
+{
+	GFW_ASSERT(GetType(handle) == ShaderParameterType::IVEC3);
+	Store(handle, &x, sizeof(x));
+}
+
+/**
+ * \brief Set the value of a 3 component unsigned int vector parameter.
+ * \param handle The handle of the parameter.
+ * \param x The new value.
+ */
+void GFW::ShaderParameterBlock::SetShaderParameter(ShaderParameterHandle handle, const UVec3& x)
+{
+	GFW_ASSERT(GetType(handle) == ShaderParameterType::UVEC3);
+	Store(handle, &x, sizeof(x));
+}
+
+/**
+ * \brief Set the value of a 3 component float vector parameter.
+ * \param handle The handle of the parameter.
+ * \param x The new value.
+ */
+void GFW::ShaderParameterBlock::SetShaderParameter(ShaderParameterHandle handle, const Vec3& x)
+{
+	GFW_ASSERT(GetType(handle) == ShaderParameterType::VEC3);
+	Store(handle, &x, sizeof(x));
+}
+
+/**
+ * \brief Set the value of a 3 component double vector parameter.
+ * \param handle The handle of the parameter.
+ * \param x The new value.
+ */
+void GFW::ShaderParameterBlock::SetShaderParameter(ShaderParameterHandle handle, const DVec3& x)
+{
+	GFW_ASSERT(GetType(handle) == ShaderParameterType::DVEC3);
+	Store(handle, &x, sizeof(x));
+}
+
+/**
+ * \brief Set the value of a 4 component bool vector parameter.
+ * \param handle The handle of the parameter.
+ * \param x The new value.
+ */
+void GFW::ShaderParameterBlock::SetShaderParameter(ShaderParameterHandle handle, const BVec4& x)
+{
+	GFW_ASSERT(GetType(handle) == ShaderParameterType::BVEC4);
+	Store(handle, &x, sizeof(x));
+}
+
+/**
+ * \brief Set the value of a 4 component int vector parameter.
+ * \param handle The handle of the parameter.
+ * \param x The new value.
+ */
+void GFW::ShaderParameterBlock::SetShaderParameter(ShaderParameterHandle handle, const IVec4& x)
+{
+	GFW_ASSERT(GetType(handle) == ShaderParameterType::IVEC4);
+	Store(handle, &x, sizeof(x));
+}
+
+/**
+ * \brief Set the value of a 4 component unsigned int vector parameter.
+ * \param handle The handle of the parameter.
+ * \param x The new value.
+ */
+void GFW::ShaderParameterBlock::SetShaderParameter(ShaderParameterHandle handle, const UVec4& x)
+{
+	GFW_ASSERT(GetType(handle) == ShaderParameterType::UVEC4);
+	Store(handle, &x, sizeof(x));
+}
+
+/**
+ * \brief Set the value of a 4 component float vector parameter.
+ * \param handle The handle of the parameter.
+ * \param x The new value.
+ */
+void GFW::ShaderParameterBlock::SetShaderParameter(ShaderParameterHandle handle, const Vec4& x)
+{
+	GFW_ASSERT(GetType(handle) == ShaderParameterType::VEC4);
+	Store(handle, &x, sizeof(x));
+}
+
+/**
+ * \brief Set the value of a 4 component double vector parameter.
+ * \param handle The handle of the parameter.
+ * \param x The new value.
+ */
+void GFW::ShaderParameterBlock::SetShaderParameter(ShaderParameterHandle handle, const DVec4& x)
+{
+	GFW_ASSERT(GetType(handle) == ShaderParameterType::DVEC4);
+	Store(handle, &x, sizeof(x));
+}
+
+/**
+ * \brief Set the value of a 2x2 matrix parameter.
+ * \param handle The handle of the parameter.
+ * \param x The new value.
+ */
+void GFW::ShaderParameterBlock::SetShaderParameter(ShaderParameterHandle handle, const Mat2& x)
+{
+	GFW_ASSERT(GetType(handle) == ShaderParameterType::MAT2);
+	Store(handle, &x, sizeof(x));
+}
+
+/**
+ * \brief Set the value of a 3x3 matrix parameter.
+ * \param handle The handle of the parameter.
+ * \param x The new value.
+ */
+void GFW::ShaderParameterBlock::SetShaderParameter(ShaderParameterHandle handle, const Mat3& x)
+{
+	GFW_ASSERT(GetType(handle) == ShaderParameterType::MAT3);
+	Store(handle, &x, sizeof(x));
+}
+
+/**
+ * \brief Set the value of a 4x4 matrix parameter.
+ * \param handle The handle of the parameter.
+ * \param x The new value.
+ */
+void GFW::ShaderParameterBlock::SetShaderParameter(ShaderParameterHandle handle, const Mat4& x)
+{
+	GFW_ASSERT(GetType(handle) == ShaderParameterType::MAT4);
+	Store(handle, &x, sizeof(x));
+}
+
+/**
+ * \brief Set the texture of a sampler parameter.
+ * \param handle The handle of the parameter.
+ * \param x The texture to bind.
+ */
+void GFW::ShaderParameterBlock::SetShaderParameter(ShaderParameterHandle handle, const ITexture* x)
+{
+	GFW_ASSERT(IsSampler(GetType(handle)));
+	Store(handle, &x, sizeof(x));
+}
+
+/**
+ * \brief Set the sampler of a sampler parameter.
+ * \param handle The handle of the parameter.
+ * \param x The sampler to bind.
+ */
+void GFW::ShaderParameterBlock::SetShaderParameter(ShaderParameterHandle handle, const ISampler* x)
+{
+	GFW_ASSERT(IsSampler(GetType(handle)));
+	Store(handle, &x, sizeof(x), sizeof(const ITexture*));
+}
+
+/**
+ * \brief Set the buffer of a uniform or shader storage buffer parameter.
+ * \param handle The handle of the parameter.
+ * \param x The buffer to bind.
+ */
+void GFW::ShaderParameterBlock::SetShaderParameter(ShaderParameterHandle handle, const IBuffer* x)
+{
+	GFW_ASSERT(GetType(handle) == ShaderParameterType::UNIFORM_BUFFER || GetType(handle) == ShaderParameterType::SHADER_STORAGE_BUFFER);
+	Store(handle, &x, sizeof(x));
+}
+
+/**
+ * \brief Set all parameters on a shader program.
+ * \param shader The shader program the block was created for.
+ */
+void GFW::ShaderParameterBlock::Apply(IShader* shader) const
+{
+	GFW_ASSERT(shader != nullptr);
+	ApplyTo(*shader);
+}
+
+/**
+ * \brief Set all parameters through the parameter cache of a shader program, so values that didn't change since the last draw are skipped.
+ * \param cache The parameter cache of the shader program the block was created for.
+ */
+void GFW::ShaderParameterBlock::Apply(ShaderParameterCache& cache) const
+{
+	ApplyTo(cache);
+}
+
+/**
+ * \return The type of a parameter. Asserts that the handle is valid and belongs to the block, so the type checks of the setters never read out of bounds.
+ */
+GFW::ShaderParameterType GFW::ShaderParameterBlock::GetType(ShaderParameterHandle handle) const
+{
+	GFW_ASSERT(handle.IsValid() && size_t(handle.index) < m_types.size());
+	return m_types[handle.index];
+}
+
+/**
+ * \brief Copy a value into the blob.
+ * \param handle The handle of the parameter.
+ * \param value The value to copy.
+ * \param size The size of @value in bytes.
+ * \param offset Offset of @value in the packed value of the parameter.
+ */
+void GFW::ShaderParameterBlock::Store(ShaderParameterHandle handle, const void* value, size_t size, size_t offset)
+{
+	GFW_ASSERT(handle.IsValid() && size_t(handle.index) < m_types.size());
+	GFW_ASSERT(offset + size <= GetValueSize(m_types[handle.index]));
+	memcpy(m_values.data() + m_offsets[handle.index] + offset, value, size);
+}
+
+/**
+ * \brief Walk the parameter arrays in order and set every value on @target.
+ * \param target IShader or ShaderParameterCache.
+ */
+template<typename Target>
+void GFW::ShaderParameterBlock::ApplyTo(Target& target) const
+{
+	for(size_t i = 0; i < m_types.size(); ++i)
+	{
+		const ShaderParameterHandle handle(static_cast<int>(i));
+		const unsigned char* value = m_values.data() + m_offsets[i];
+		switch(m_types[i])
+		{
+		case ShaderParameterType::BOOL:
+			target.SetShaderParameter(handle, Load<bool>(value));
+			break;
+		case ShaderParameterType::INT:
+			target.SetShaderParameter(handle, Load<int>(value));
+			break;
+		case ShaderParameterType::UNSIGNED_INT:
+			target.SetShaderParameter(handle, Load<unsigned>(value));
+			break;
+		case ShaderParameterType::FLOAT:
+			target.SetShaderParameter(handle, Load<float>(value));
+			break;
+		case ShaderParameterType::DOUBLE:
+			target.SetShaderParameter(handle, Load<double>(value));
+			break;
+		case ShaderParameterType::BVEC2:
+			target.SetShaderParameter(handle, Load<BVec2>(value));
+			break;
+		case ShaderParameterType::IVEC2:
+			target.SetShaderParameter(handle, Load<IVec2>(value));
+			break;
+		case ShaderParameterType::UVEC2:
+			target.SetShaderParameter(handle, Load<UVec2>(value));
+			break;
+		case ShaderParameterType::VEC2:
+			target.SetShaderParameter(handle, Load<Vec2>(value));
+			break;
+		case ShaderParameterType::DVEC2:
+			target.SetShaderParameter(handle, Load<DVec2>(value));
+			break;
+		case ShaderParameterType::BVEC3:
+			target.SetShaderParameter(handle, Load<BVec3>(value));
+			break;
+		case ShaderParameterType::IVEC3:
+			target.SetShaderParameter(handle, Load<IVec3>(value));
+			break;
+		case ShaderParameterType::UVEC3:
+			target.SetShaderParameter(handle, Load<UVec3>(value));
+			break;
+		case ShaderParameterType::VEC3:
+			target.SetShaderParameter(handle, Load<Vec3>(value));
+			break;
+		case ShaderParameterType::DVEC3:
+			target.SetShaderParameter(handle, Load<DVec3>(value));
+			break;
+		case ShaderParameterType::BVEC4:
+			target.SetShaderParameter(handle, Load<BVec4>(value));
+			break;
+		case ShaderParameterType::IVEC4:
+			target.SetShaderParameter(handle, Load<IVec4>(value));
+			break;
+		case ShaderParameterType::UVEC4:
+			target.SetShaderParameter(handle, Load<UVec4>(value));
+			break;
+		case ShaderParameterType::VEC4:
+			target.SetShaderParameter(handle, Load<Vec4>(value));
+			break;
+		case ShaderParameterType::DVEC4:
+			target.SetShaderParameter(handle, Load<DVec4>(value));
+			break;
+		case ShaderParameterType::MAT2:
+			target.SetShaderParameter(handle, Load<Mat2>(value));
+			break;
+		case ShaderParameterType::MAT3:
+			target.SetShaderParameter(handle, Load<Mat3>(value));
+			break;
+		case ShaderParameterType::MAT4:
+			target.SetShaderParameter(handle, Load<Mat4>(value));
+			break;
+		case ShaderParameterType::UNIFORM_BUFFER:
+		case ShaderParameterType::SHADER_STORAGE_BUFFER:
+			target.SetShaderParameter(handle, Load<const IBuffer*>(value));
+			break;
+		default:
+			target.SetShaderParameter(handle, Load<const ITexture*>(value));
+			target.SetShaderParameter(handle, Load<const ISampler*>(value + sizeof(const ITexture*)));
+			break;
+		}
+	}
+}
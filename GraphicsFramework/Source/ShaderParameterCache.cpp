@@ -0,0 +1,738 @@
+#include <ShaderParameterCache.h>
+#include <cstring>
+#include "Logging.h"
+
+/**
+ * \brief Creates an empty cache, the first set of every parameter is forwarded.
+ * \param shader The shader program to forward changed parameters to. The cache doesn't take ownership.
+ */
+GFW::ShaderParameterCache::ShaderParameterCache(IShader* shader) : m_shader(shader), m_skippedCount(0), m_forwardedCount(0)
+{
+	GFW_ASSERT(m_shader != nullptr);
+}
+
+/**
+ * \return The shader program the parameters are forwarded to.
+ */
+GFW::IShader* GFW::ShaderParameterCache::GetShader() const
+{
+	return m_shader;
+}
+
+/**
+ * \brief Resolve a shader parameter name to a handle of the shader program.
+ * \param name The name of the shader parameter.
+ * \return The handle of the shader parameter, invalid if the shader program has no parameter named @name.
+ */
+GFW::ShaderParameterHandle GFW::ShaderParameterCache::GetParameterHandle(const string& name) const
+{
+	return m_shader->GetParameterHandle(name);
+}
+
+/**
+ * \brief Resolve a hashed shader parameter name to a handle of the shader program.
+ * \param name The hashed name of the shader parameter.
+ * \return The handle of the shader parameter, invalid if the shader program has no parameter with the hash of @name.
+ */
+GFW::ShaderParameterHandle GFW::ShaderParameterCache::GetParameterHandle(ShaderParameterName name) const
+{
+	return m_shader->GetParameterHandle(name);
+}
+
+/**
+ * \brief Set bool shader parameter if it differs from the cached value.
+ * \param handle The handle of the shader parameter.
+ * \param x The value to set the shader parameter to.
+ */
+void GFW::ShaderParameterCache::SetShaderParameter(ShaderParameterHandle handle, bool x)
+{
+	if(Update(handle, &x, sizeof(x)))
+		m_shader->SetShaderParameter(handle, x);
+}
+
+/**
+ * \brief Set int shader parameter if it differs from the cached value.
+ * \param handle The handle of the shader parameter.
+ * \param x The value to set the shader parameter to.
+ */
+void GFW::ShaderParameterCache::SetShaderParameter(ShaderParameterHandle handle, int x)
+{
+	if(Update(handle, &x, sizeof(x)))
+		m_shader->SetShaderParameter(handle, x);
+}
+
+/**
+ * \brief Set unsigned int shader parameter if it differs from the cached value.
+ * \param handle The handle of the shader parameter.
+ * \param x The value to set the shader parameter to.
+ */
+void GFW::ShaderParameterCache::SetShaderParameter(ShaderParameterHandle handle, unsigned x)
+{
+	if(Update(handle, &x, sizeof(x)))
+		m_shader->SetShaderParameter(handle, x);
+}
+
+/**
+ * \brief Set float shader parameter if it differs from the cached value.
+ * \param handle The handle of the shader parameter.
+ * \param x The value to set the shader parameter to.
+ */
+void GFW::ShaderParameterCache::SetShaderParameter(ShaderParameterHandle handle, float x)
+{
+	if(Update(handle, &x, sizeof(x)))
+		m_shader->SetShaderParameter(handle, x);
+}
+
+/**
+ * \brief Set double shader parameter if it differs from the cached value.
+ * \param handle The handle of the shader parameter.
+ * \param x The value to set the shader parameter to.
+ */
+void GFW::ShaderParameterCache::SetShaderParameter(ShaderParameterHandle handle, double x)
+{
+	if(Update(handle, &x, sizeof(x)))
+		m_shader->SetShaderParameter(handle, x);
+}
+
+/**
+ * \brief Set 2 component bool vector shader parameter if it differs from the cached value.
+ * \param handle The handle of the shader parameter.
+ * \param x The value to set the shader parameter to.
+ */
+void GFW::ShaderParameterCache::SetShaderParameter(ShaderParameterHandle handle, const BVec2& x)
+{
+	if(Update(handle, &x, sizeof(x)))
+		m_shader->SetShaderParameter(handle, x);
+}
+
+/**
+ * \brief Set 2 component int vector shader parameter if it differs from the cached value.
+ * \param handle The handle of the shader parameter.
+ * \param x The value to set the shader parameter to.
+ */
+void GFW::ShaderParameterCache::SetShaderParameter(ShaderParameterHandle handle, const IVec2& x)
+{
+	if(Update(handle, &x, sizeof(x)))
+		m_shader->SetShaderParameter(handle, x);
+}
+
+/**
+ * \brief Set 2 component unsigned int vector shader parameter if it differs from the cached value.
+ * \param handle The handle of the shader parameter.
+ * \param x The value to set the shader parameter to.
+ */
+void GFW::ShaderParameterCache::SetShaderParameter(ShaderParameterHandle handle, const UVec2& x)
+{
+	if(Update(handle, &x, sizeof(x)))
+		m_shader->SetShaderParameter(handle, x);
+}
+
+/**
+ * \brief Set 2 component float vector shader parameter if it differs from the cached value.
+ * \param handle The handle of the shader parameter.
+ * \param x The value to set the shader parameter to.
+ */
+void GFW::ShaderParameterCache::SetShaderParameter(ShaderParameterHandle handle, const Vec2& x)
+{
+	if(Update(handle, &x, sizeof(x)))
+		m_shader->SetShaderParameter(handle, x);
+}
+
+/**
+ * \brief Set 2 component double vector shader parameter if it differs from the cached value.
+ * \param handle The handle of the shader parameter.
+ * \param x The value to set the shader parameter to.
+ */
+void GFW::ShaderParameterCache::SetShaderParameter(ShaderParameterHandle handle, const DVec2& x)
+{
+	if(Update(handle, &x, sizeof(x)))
+		m_shader->SetShaderParameter(handle, x);
+}
+
+/**
+ * \brief Set 3 component bool vector shader parameter if it differs from the cached value.
+ * \param handle The handle of the shader parameter.
+ * \param x The value to set the shader parameter to.
+ */
+void GFW::ShaderParameterCache::SetShaderParameter(ShaderParameterHandle handle, const BVec3& x)
+{
+	if(Update(handle, &x, sizeof(x)))
+		m_shader->SetShaderParameter(handle, x);
+}
+
+/**
+ * \brief Set 3 component int vector shader parameter if it differs from the cached value.
+ * \param handle The handle of the shader parameter.
+ * \param x The value to set the shader parameter to.
+ */
+void GFW::ShaderParameterCache::SetShaderParameter(ShaderParameterHandle handle, const IVec3& x)
+{
+	if(Update(handle, &x, sizeof(x)))
+		m_shader->SetShaderParameter(handle, x);
+}
+
+/**
+ * \brief Set 3 component unsigned int vector shader parameter if it differs from the cached value.
+ * \param handle The handle of the shader parameter.
+ * \param x The value to set the shader parameter to.
+ */
+void GFW::ShaderParameterCache::SetShaderParameter(ShaderParameterHandle handle, const UVec3& x)
+{
+	if(Update(handle, &x, sizeof(x)))
+		m_shader->SetShaderParameter(handle, x);
+}
+
+/**
+ * \brief Set 3 component float vector shader parameter if it differs from the cached value.
+ * \param handle The handle of the shader parameter.
+ * \param x The value to set the shader parameter to.
+ */
+void GFW::ShaderParameterCache::SetShaderParameter(ShaderParameterHandle handle, const Vec3& x)
+{
+	if(Update(handle, &x, sizeof(x)))
+		m_shader->SetShaderParameter(handle, x);
+}
+
+/**
+ * \brief Set 3 component double vector shader parameter if it differs from the cached value.
+ * \param handle The handle of the shader parameter.
+ * \param x The value to set the shader parameter to.
+ */
+void GFW::ShaderParameterCache::SetShaderParameter(ShaderParameterHandle handle, const DVec3& x)
+{
+	if(Update(handle, &x, sizeof(x)))
+		m_shader->SetShaderParameter(handle, x);
+}
+
+/**
+ * \brief Set 4 component bool vector shader parameter if it differs from the cached value.
+ * \param handle The handle of the shader parameter.
+ * \param x The value to set the shader parameter to.
+ */
+void GFW::ShaderParameterCache::SetShaderParameter(ShaderParameterHandle handle, const BVec4& x)
+{
+	if(Update(handle, &x, sizeof(x)))
+		m_shader->SetShaderParameter(handle, x);
+}
+
+/**
+ * \brief Set 4 component int vector shader parameter if it differs from the cached value.
+ * \param handle The handle of the shader parameter.
+ * \param x The value to set the shader parameter to.
+ */
+void GFW::ShaderParameterCache::SetShaderParameter(ShaderParameterHandle handle, const IVec4& x)
+{
+	if(Update(handle, &x, sizeof(x)))
+		m_shader->SetShaderParameter(handle, x);
+}
+
+/**
+ * \brief Set 4 component unsigned int vector shader parameter if it differs from the cached value.
+ * \param handle The handle of the shader parameter.
+ * \param x The value to set the shader parameter to.
+ */
+void GFW::ShaderParameterCache::SetShaderParameter(ShaderParameterHandle handle, const UVec4& x)
+{
+	if(Update(handle, &x, sizeof(x)))
+		m_shader->SetShaderParameter(handle, x);
+}
+
+/**
+ * \brief Set 4 component float vector shader parameter if it differs from the cached value.
+ * \param handle The handle of the shader parameter.
+ * \param x The value to set the shader parameter to.
+ */
+void GFW::ShaderParameterCache::SetShaderParameter(ShaderParameterHandle handle, const Vec4& x)
+{
+	if(Update(handle, &x, sizeof(x)))
+		m_shader->SetShaderParameter(handle, x);
+}
+
+/**
+ * \brief Set 4 component double vector shader parameter if it differs from the cached value.
+ * \param handle The handle of the shader parameter.
+ * \param x The value to set the shader parameter to.
+ */
+void GFW::ShaderParameterCache::SetShaderParameter(ShaderParameterHandle handle, const DVec4& x)
+{
+	if(Update(handle, &x, sizeof(x)))
+		m_shader->SetShaderParameter(handle, x);
+}
+
+/**
+ * \brief Set 2x2 matrix shader parameter if it differs from the cached value.
+ * \param handle The handle of the shader parameter.
+ * \param x The value to set the shader parameter to.
+ */
+void GFW::ShaderParameterCache::SetShaderParameter(ShaderParameterHandle handle, const Mat2& x)
+{
+	if(Update(handle, &x, sizeof(x)))
+		m_shader->SetShaderParameter(handle, x);
+}
+
+/**
+ * \brief Set 3x3 matrix shader parameter if it differs from the cached value.
+ * \param handle The handle of the shader parameter.
+ * \param x The value to set the shader parameter to.
+ */
+void GFW::ShaderParameterCache::SetShaderParameter(ShaderParameterHandle handle, const Mat3& x)
+{
+	if(Update(handle, &x, sizeof(x)))
+		m_shader->SetShaderParameter(handle, x);
+}
+
+/**
+ * \brief Set 4x4 matrix shader parameter if it differs from the cached value.
+ * \param handle The handle of the shader parameter.
+ * \param x The value to set the shader parameter to.
+ */
+void GFW::ShaderParameterCache::SetShaderParameter(ShaderParameterHandle handle, const Mat4& x)
+{
+	if(Update(handle, &x, sizeof(x)))
+		m_shader->SetShaderParameter(handle, x);
+}
+
+/**
+ * \brief Set texture shader parameter. Always forwarded to the shader.
+ * \param handle The handle of the shader parameter.
+ * \param x The texture to bind.
+ */
+void GFW::ShaderParameterCache::SetShaderParameter(ShaderParameterHandle handle, const ITexture* x)
+{
+	++m_forwardedCount;
+	m_shader->SetShaderParameter(handle, x);
+}
+
+/**
+ * \brief Set sampler shader parameter. Always forwarded to the shader.
+ * \param handle The handle of the shader parameter.
+ * \param x The sampler to bind.
+ */
+void GFW::ShaderParameterCache::SetShaderParameter(ShaderParameterHandle handle, const ISampler* x)
+{
+	++m_forwardedCount;
+	m_shader->SetShaderParameter(handle, x);
+}
+
+/**
+ * \brief Set buffer shader parameter. Always forwarded to the shader.
+ * \param handle The handle of the shader parameter.
+ * \param x The buffer to bind.
+ */
+void GFW::ShaderParameterCache::SetShaderParameter(ShaderParameterHandle handle, const IBuffer* x)
+{
+	++m_forwardedCount;
+	m_shader->SetShaderParameter(handle, x);
+}
+
+/**
+ * \brief Set elements of a bool array shader parameter. Always forwarded to the shader.
+ * \param handle The handle of the shader parameter.
+ * \param x The values to set the elements to.
+ * \param count The amount of elements to set.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterCache::SetShaderParameterArray(ShaderParameterHandle handle, const bool* x, int count, int firstElement)
+{
+	ForwardArray(handle, x, count, firstElement);
+}
+
+/**
+ * \brief Set elements of a int array shader parameter. Always forwarded to the shader.
+ * \param handle The handle of the shader parameter.
+ * \param x The values to set the elements to.
+ * \param count The amount of elements to set.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterCache::SetShaderParameterArray(ShaderParameterHandle handle, const int* x, int count, int firstElement)
+{
+	ForwardArray(handle, x, count, firstElement);
+}
+
+/**
+ * \brief Set elements of a unsigned int array shader parameter. Always forwarded to the shader.
+ * \param handle The handle of the shader parameter.
+ * \param x The values to set the elements to.
+ * \param count The amount of elements to set.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterCache::SetShaderParameterArray(ShaderParameterHandle handle, const unsigned* x, int count, int firstElement)
+{
+	ForwardArray(handle, x, count, firstElement);
+}
+
+/**
+ * \brief Set elements of a float array shader parameter. Always forwarded to the shader.
+ * \param handle The handle of the shader parameter.
+ * \param x The values to set the elements to.
+ * \param count The amount of elements to set.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterCache::SetShaderParameterArray(ShaderParameterHandle handle, const float* x, int count, int firstElement)
+{
+	ForwardArray(handle, x, count, firstElement);
+}
+
+/**
+ * \brief Set elements of a double array shader parameter. Always forwarded to the shader.
+ * \param handle The handle of the shader parameter.
+ * \param x The values to set the elements to.
+ * \param count The amount of elements to set.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterCache::SetShaderParameterArray(ShaderParameterHandle handle, const double* x, int count, int firstElement)
+{
+	ForwardArray(handle, x, count, firstElement);
+}
+
+/**
+ * \brief Set elements of a 2 component bool vector array shader parameter. Always forwarded to the shader.
+ * \param handle The handle of the shader parameter.
+ * \param x The values to set the elements to.
+ * \param count The amount of elements to set.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterCache::SetShaderParameterArray(ShaderParameterHandle handle, const BVec2* x, int count, int firstElement)
+{
+	ForwardArray(handle, x, count, firstElement);
+}
+
+/**
+ * \brief Set elements of a 2 component int vector array shader parameter. Always forwarded to the shader.
+ * \param handle The handle of the shader parameter.
+ * \param x The values to set the elements to.
+ * \param count The amount of elements to set.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterCache::SetShaderParameterArray(ShaderParameterHandle handle, const IVec2* x, int count, int firstElement)
+{
+	ForwardArray(handle, x, count, firstElement);
+}
+
+/**
+ * \brief Set elements of a 2 component unsigned int vector array shader parameter. Always forwarded to the shader.
+ * \param handle The handle of the shader parameter.
+ * \param x The values to set the elements to.
+ * \param count The amount of elements to set.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterCache::SetShaderParameterArray(ShaderParameterHandle handle, const UVec2* x, int count, int firstElement)
+{
+	ForwardArray(handle, x, count, firstElement);
+}
+
+/**
+ * \brief Set elements of a 2 component float vector array shader parameter. Always forwarded to the shader.
+ * \param handle The handle of the shader parameter.
+ * \param x The values to set the elements to.
+ * \param count The amount of elements to set.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterCache::SetShaderParameterArray(ShaderParameterHandle handle, const Vec2* x, int count, int firstElement)
+{
+	ForwardArray(handle, x, count, firstElement);
+}
+
+/**
+ * \brief Set elements of a 2 component double vector array shader parameter. Always forwarded to the shader.
+ * \param handle The handle of the shader parameter.
+ * \param x The values to set the elements to.
+ * \param count The amount of elements to set.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterCache::SetShaderParameterArray(ShaderParameterHandle handle, const DVec2* x, int count, int firstElement)
+{
+	ForwardArray(handle, x, count, firstElement);
+}
+
+/**
+ * \brief Set elements of a 3 component bool vector array shader parameter. Always forwarded to the shader.
+ * \param handle The handle of the shader parameter.
+ * \param x The values to set the elements to.
+ * \param count The amount of elements to set.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterCache::SetShaderParameterArray(ShaderParameterHandle handle, const BVec3* x, int count, int firstElement)
+{
+	ForwardArray(handle, x, count, firstElement);
+}
+
+/**
+ * \brief Set elements of a 3 component int vector array shader parameter. Always forwarded to the shader.
+ * \param handle The handle of the shader parameter.
+ * \param x The values to set the elements to.
+ * \param count The amount of elements to set.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterCache::SetShaderParameterArray(ShaderParameterHandle handle, const IVec3* x, int count, int firstElement)
+{
+	ForwardArray(handle, x, count, firstElement);
+}
+
+/**
+ * \brief Set elements of a 3 component unsigned int vector array shader parameter. Always forwarded to the shader.
+ * \param handle The handle of the shader parameter.
+ * \param x The values to set the elements to.
+ * \param count The amount of elements to set.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterCache::SetShaderParameterArray(ShaderParameterHandle handle, const UVec3* x, int count, int firstElement)
+{
+	ForwardArray(handle, x, count, firstElement);
+}
+
+/**
+ * \brief Set elements of a 3 component float vector array shader parameter. Always forwarded to the shader.
+ * \param handle The handle of the shader parameter.
+ * \param x The values to set the elements to.
+ * \param count The amount of elements to set.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterCache::SetShaderParameterArray(ShaderParameterHandle handle, const Vec3* x, int count, int firstElement)
+{
+	ForwardArray(handle, x, count, firstElement);
+}
+
+/**
+ * \brief Set elements of a 3 component double vector array shader parameter. Always forwarded to the shader.
+ * \param handle The handle of the shader parameter.
+ * \param x The values to set the elements to.
+ * \param count The amount of elements to set.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterCache::SetShaderParameterArray(ShaderParameterHandle handle, const DVec3* x, int count, int firstElement)
+{
+	ForwardArray(handle, x, count, firstElement);
+}
+
+/**
+ * \brief Set elements of a 4 component bool vector array shader parameter. Always forwarded to the shader.
+ * \param handle The handle of the shader parameter.
+ * \param x The values to set the elements to.
+ * \param count The amount of elements to set.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterCache::SetShaderParameterArray(ShaderParameterHandle handle, const BVec4* x, int count, int firstElement)
+{
+	ForwardArray(handle, x, count, firstElement);
+}
+
+/**
+ * \brief Set elements of a 4 component int vector array shader parameter. Always forwarded to the shader.
+ * \param handle The handle of the shader parameter.
+ * \param x The values to set the elements to.
+ * \param count The amount of elements to set.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterCache::SetShaderParameterArray(ShaderParameterHandle handle, const IVec4* x, int count, int firstElement)
+{
+	ForwardArray(handle, x, count, firstElement);
+}
+
+/**
+ * \brief Set elements of a 4 component unsigned int vector array shader parameter. Always forwarded to the shader.
+ * \param handle The handle of the shader parameter.
+ * \param x The values to set the elements to.
+ * \param count The amount of elements to set.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterCache::SetShaderParameterArray(ShaderParameterHandle handle, const UVec4* x, int count, int firstElement)
+{
+	ForwardArray(handle, x, count, firstElement);
+}
+
+/**
+ * \brief Set elements of a 4 component float vector array shader parameter. Always forwarded to the shader.
+ * \param handle The handle of the shader parameter.
+ * \param x The values to set the elements to.
+ * \param count The amount of elements to set.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterCache::SetShaderParameterArray(ShaderParameterHandle handle, const Vec4* x, int count, int firstElement)
+{
+	ForwardArray(handle, x, count, firstElement);
+}
+
+/**
+ * \brief Set elements of a 4 component double vector array shader parameter. Always forwarded to the shader.
+ * \param handle The handle of the shader parameter.
+ * \param x The values to set the elements to.
+ * \param count The amount of elements to set.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterCache::SetShaderParameterArray(ShaderParameterHandle handle, const DVec4* x, int count, int firstElement)
+{
+	ForwardArray(handle, x, count, firstElement);
+}
+
+/**
+ * \brief Set elements of a 2x2 matrix array shader parameter. Always forwarded to the shader.
+ * \param handle The handle of the shader parameter.
+ * \param x The values to set the elements to.
+ * \param count The amount of elements to set.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterCache::SetShaderParameterArray(ShaderParameterHandle handle, const Mat2* x, int count, int firstElement)
+{
+	ForwardArray(handle, x, count, firstElement);
+}
+
+/**
+ * \brief Set elements of a 3x3 matrix array shader parameter. Always forwarded to the shader.
+ * \param handle The handle of the shader parameter.
+ * \param x The values to set the elements to.
+ * \param count The amount of elements to set.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterCache::SetShaderParameterArray(ShaderParameterHandle handle, const Mat3* x, int count, int firstElement)
+{
+	ForwardArray(handle, x, count, firstElement);
+}
+
+/**
+ * \brief Set elements of a 4x4 matrix array shader parameter. Always forwarded to the shader.
+ * \param handle The handle of the shader parameter.
+ * \param x The values to set the elements to.
+ * \param count The amount of elements to set.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterCache::SetShaderParameterArray(ShaderParameterHandle handle, const Mat4* x, int count, int firstElement)
+{
+	ForwardArray(handle, x, count, firstElement);
+}
+
+/**
+ * \brief Set elements of a texture array shader parameter. Always forwarded to the shader.
+ * \param handle The handle of the shader parameter.
+ * \param x The textures to bind.
+ * \param count The amount of elements to set.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterCache::SetShaderParameterArray(ShaderParameterHandle handle, const ITexture* const* x, int count, int firstElement)
+{
+	ForwardArray(handle, x, count, firstElement);
+}
+
+/**
+ * \brief Set elements of a sampler array shader parameter. Always forwarded to the shader.
+ * \param handle The handle of the shader parameter.
+ * \param x The samplers to bind.
+ * \param count The amount of elements to set.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterCache::SetShaderParameterArray(ShaderParameterHandle handle, const ISampler* const* x, int count, int firstElement)
+{
+	ForwardArray(handle, x, count, firstElement);
+}
+
+/**
+ * \brief Set elements of a buffer array shader parameter. Always forwarded to the shader.
+ * \param handle The handle of the shader parameter.
+ * \param x The buffers to bind.
+ * \param count The amount of elements to set.
+ * \param firstElement The first element to set.
+ */
+void GFW::ShaderParameterCache::SetShaderParameterArray(ShaderParameterHandle handle, const IBuffer* const* x, int count, int firstElement)
+{
+	ForwardArray(handle, x, count, firstElement);
+}
+
+/**
+ * \brief Set many parameters at once through IShader::SetShaderParameters(). Always forwarded to the shader, the cached values of all parameters
+ * in the batch are dropped.
+ * \param batch The parameters to set.
+ */
+void GFW::ShaderParameterCache::SetShaderParameters(const ShaderParameterBatch& batch)
+{
+	for(int i = 0; i < batch.GetEntryCount(); ++i)
+		Invalidate(batch.GetEntry(i).handle);
+	m_forwardedCount += uint64_t(batch.GetEntryCount());
+	m_shader->SetShaderParameters(batch);
+}
+
+/**
+ * \brief Forget all cached values, so the next set of every parameter is forwarded. Call this after the shader program is relinked
+ * or its parameters are set without going through the cache.
+ */
+void GFW::ShaderParameterCache::Invalidate()
+{
+	m_values.clear();
+}
+
+/**
+ * \brief Forget the cached value of one parameter, so its next set is forwarded. Call this after setting the parameter without going through the cache.
+ * \param handle The handle of the shader parameter.
+ */
+void GFW::ShaderParameterCache::Invalidate(ShaderParameterHandle handle)
+{
+	if(handle.IsValid() && size_t(handle.index) < m_values.size())
+		m_values[handle.index].size = 0;
+}
+
+/**
+ * \return The amount of sets that weren't forwarded because the value didn't change.
+ */
+uint64_t GFW::ShaderParameterCache::GetSkippedCount() const
+{
+	return m_skippedCount;
+}
+
+/**
+ * \return The amount of sets forwarded to the shader.
+ */
+uint64_t GFW::ShaderParameterCache::GetForwardedCount() const
+{
+	return m_forwardedCount;
+}
+
+/**
+ * \brief Reset the skipped and forwarded counters, for example at the start of every frame.
+ */
+void GFW::ShaderParameterCache::ResetCounters()
+{
+	m_skippedCount = 0;
+	m_forwardedCount = 0;
+}
+
+/**
+ * \brief Compare a value with the cached value of a parameter and cache it if it differs. Invalid handles aren't cached but forwarded,
+ * so the shader can report them.
+ * \param handle The handle of the shader parameter.
+ * \param value The new value.
+ * \param size The size of @value in bytes.
+ * \return True if the value has to be forwarded to the shader.
+ */
+bool GFW::ShaderParameterCache::Update(ShaderParameterHandle handle, const void* value, size_t size)
+{
+	GFW_ASSERT(size <= sizeof(CachedValue::value));
+	if(!handle.IsValid())
+	{
+		++m_forwardedCount;
+		return true;
+	}
+
+	if(size_t(handle.index) >= m_values.size())
+		m_values.resize(size_t(handle.index) + 1, CachedValue{ 0, {} });
+	CachedValue& cached = m_values[handle.index];
+	if(cached.size == size && memcmp(cached.value, value, size) == 0)
+	{
+		++m_skippedCount;
+		return false;
+	}
+
+	cached.size = size;
+	memcpy(cached.value, value, size);
+	++m_forwardedCount;
+	return true;
+}
+
+/**
+ * \brief Forward an array set to the shader and drop the cached value of the parameter, which only describes its first element.
+ */
+template<typename T>
+void GFW::ShaderParameterCache::ForwardArray(ShaderParameterHandle handle, const T* x, int count, int firstElement)
+{
+	Invalidate(handle);
+	++m_forwardedCount;
+	m_shader->SetShaderParameterArray(handle, x, count, firstElement);
+}
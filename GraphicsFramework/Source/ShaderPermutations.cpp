@@ -0,0 +1,442 @@
+#include <ShaderPermutations.h>
+#include <algorithm>
+#include <cstdio>
+#include "Hash.h"
+#include "Logging.h"
+
+namespace
+{
+	/**
+	 * \brief Read a text file.
+	 */
+	bool LoadFile(const std::string& path, std::string& source)
+	{
+		FILE* stream = fopen(path.c_str(), "rb");
+		if(!stream)
+			return false;
+
+		source.clear();
+		char buffer[4096];
+		size_t read;
+		while((read = fread(buffer, 1, sizeof(buffer), stream)) > 0)
+			source.append(buffer, read);
+		fclose(stream);
+		return true;
+	}
+
+	/**
+	 * \return The directory of @path including the trailing separator, empty if @path has no directory.
+	 */
+	std::string GetDirectory(const std::string& path)
+	{
+		const size_t separator = path.find_last_of("/\\");
+		return separator == std::string::npos ? std::string() : path.substr(0, separator + 1);
+	}
+
+	/**
+	 * \return The position of the first character at or after @position that isn't whitespace or part of a comment, the size of @source if there is none.
+	 */
+	size_t SkipWhitespaceAndComments(const std::string& source, size_t position)
+	{
+		while(position < source.size())
+		{
+			if(source[position] == ' ' || source[position] == '\t' || source[position] == '\r' || source[position] == '\n')
+				++position;
+			else if(source.compare(position, 2, "//") == 0)
+				position = std::min(source.find('\n', position), source.size());
+			else if(source.compare(position, 2, "/*") == 0)
+				position = std::min(source.find("*/", position + 2), source.size() - 2) + 2;
+			else
+				break;
+		}
+		return position;
+	}
+
+	/**
+	 * \brief Find the #version directive, which can only be preceded by whitespace and comments.
+	 * \return The position after the line break that ends the directive, outside of comments. 0 if the source doesn't start with a #version directive.
+	 */
+	size_t FindVersionEnd(const std::string& source)
+	{
+		size_t position = SkipWhitespaceAndComments(source, 0);
+		if(position == source.size() || source[position] != '#')
+			return 0;
+		position = source.find_first_not_of(" \t", position + 1);
+		if(position == std::string::npos || source.compare(position, 7, "version") != 0)
+			return 0;
+
+		while(position < source.size() && source[position] != '\n')
+		{
+			if(source.compare(position, 2, "//") == 0)
+				position = std::min(source.find('\n', position), source.size());
+			else if(source.compare(position, 2, "/*") == 0)
+				position = std::min(source.find("*/", position + 2), source.size() - 2) + 2;
+			else
+				++position;
+		}
+		return std::min(position + 1, source.size());
+	}
+
+	/**
+	 * \brief Parse an #include directive.
+	 * \param line The line without the line break.
+	 * \param file Output for the included file.
+	 * \return True if @line is an #include directive.
+	 */
+	bool ParseInclude(const std::string& line, std::string& file)
+	{
+		size_t position = line.find_first_not_of(" \t");
+		if(position == std::string::npos || line[position] != '#')
+			return false;
+		position = line.find_first_not_of(" \t", position + 1);
+		if(position == std::string::npos || line.compare(position, 7, "include") != 0)
+			return false;
+		position = line.find_first_not_of(" \t", position + 7);
+		if(position == std::string::npos || (line[position] != '"' && line[position] != '<'))
+			return false;
+
+		const size_t end = line.find(line[position] == '"' ? '"' : '>', position + 1);
+		if(end == std::string::npos)
+			return false;
+		file = line.substr(position + 1, end - position - 1);
+		return true;
+	}
+}
+
+/**
+ * \brief Create an empty permutation cache.
+ * \param factory Creates an empty shader of the graphics API that's used.
+ * \param loader Loads source files, nullptr to read them from disk.
+ * \param threadPool The pool on which variants are precompiled, nullptr to use the default pool.
+ */
+GFW::ShaderPermutations::ShaderPermutations(ShaderFactory factory, SourceLoader loader, ThreadPool* threadPool) : m_factory(std::move(factory)),
+	m_loader(loader ? std::move(loader) : SourceLoader(&LoadFile)), m_threadPool(threadPool ? threadPool : &ThreadPool::GetDefault()), m_binaryCache(nullptr), m_hits(0)
+{
+	GFW_ASSERT(m_factory != nullptr);
+}
+
+/**
+ * \brief Declare a set of mutually exclusive keywords. At most one keyword of every set is defined in a variant, all sets together can use up to 64 bits.
+ * \param keywords The keywords of the set. The first one is used when a variant enables none of them, an empty keyword defines nothing.
+ * \return The index of the set.
+ */
+int GFW::ShaderPermutations::AddKeywordSet(const std::vector<std::string>& keywords)
+{
+	GFW_ASSERT(!keywords.empty());
+	KeywordSet set;
+	set.keywords = keywords;
+	set.offset = m_keywordSets.empty() ? 0 : m_keywordSets.back().offset + m_keywordSets.back().bits;
+	set.bits = 0;
+	while((size_t(1) << set.bits) < keywords.size())
+		++set.bits;
+	GFW_ASSERT(set.offset + set.bits <= 64);
+
+	m_keywordSets.push_back(std::move(set));
+	return int(m_keywordSets.size()) - 1;
+}
+
+/**
+ * \return The amount of declared keyword sets.
+ */
+int GFW::ShaderPermutations::GetKeywordSetCount() const
+{
+	return int(m_keywordSets.size());
+}
+
+/**
+ * \brief Compute the key of the variant that enables @keywords. Keywords that aren't declared are ignored, if several keywords of one set are enabled the first one is used.
+ * \param keywords The enabled keywords.
+ * \return The variant key.
+ */
+uint64_t GFW::ShaderPermutations::GetVariantKey(const std::vector<std::string>& keywords) const
+{
+	uint64_t key = 0;
+	for(const KeywordSet& set : m_keywordSets)
+	{
+		for(const std::string& keyword : keywords)
+		{
+			const auto found = std::find(set.keywords.begin(), set.keywords.end(), keyword);
+			if(found != set.keywords.end())
+			{
+				key |= uint64_t(found - set.keywords.begin()) << set.offset;
+				break;
+			}
+		}
+	}
+	return key;
+}
+
+/**
+ * \return The keyword of every set enabled by @variantKey, empty keywords left out.
+ */
+std::vector<std::string> GFW::ShaderPermutations::GetKeywords(uint64_t variantKey) const
+{
+	std::vector<std::string> keywords;
+	for(const KeywordSet& set : m_keywordSets)
+	{
+		const size_t index = set.bits > 0 ? size_t((variantKey >> set.offset) & ((uint64_t(1) << set.bits) - 1)) : 0;
+		GFW_ASSERT(index < set.keywords.size());
+		if(index < set.keywords.size() && !set.keywords[index].empty())
+			keywords.push_back(set.keywords[index]);
+	}
+	return keywords;
+}
+
+/**
+ * \brief Get a variant of a shader source, compiling it on the calling thread the first time it's requested.
+ * \param path The path of the source file.
+ * \param variantKey The key of the variant, see GetVariantKey().
+ * \return The compiled variant, owned by the cache. nullptr if the source or one of its includes can't be loaded, or the variant failed to compile or link.
+ * Failed variants are kept, so they aren't compiled again until their source changes.
+ */
+GFW::IShader* GFW::ShaderPermutations::GetVariant(const std::string& path, uint64_t variantKey)
+{
+	PreparedVariant variant;
+	if(!PrepareVariant(path, variantKey, variant))
+		return nullptr;
+
+	IShader* shader = variant.shader ? variant.shader : CreateVariant(variant);
+	return shader->IsValid() ? shader : nullptr;
+}
+
+/**
+ * \brief Look up a variant and build its source if it isn't compiled yet, without creating a program. Can be called from any thread,
+ * so the preprocessing can run on a worker while CreateVariant() runs on the thread that owns the context.
+ * \param path The path of the source file.
+ * \param variantKey The key of the variant, see GetVariantKey().
+ * \param variant Output for the variant. Its shader is set if the variant was already compiled, its source otherwise.
+ * \return False if the source or one of its includes can't be loaded.
+ */
+bool GFW::ShaderPermutations::PrepareVariant(const std::string& path, uint64_t variantKey, PreparedVariant& variant)
+{
+	std::shared_ptr<const std::string> source;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		std::vector<std::string> stack;
+		const SourceNode* node = ResolveSource(path, stack);
+		if(!node)
+			return false;
+
+		variant.sourceHash = node->hash;
+		variant.variantKey = variantKey;
+		variant.source.clear();
+		variant.shader = nullptr;
+		const auto found = m_variants.find(VariantId{ node->hash, variantKey });
+		if(found != m_variants.end())
+		{
+			++m_hits;
+			variant.shader = found->second.get();
+			return true;
+		}
+		source = node->source;
+	}
+
+	// The expanded source is shared with the node, so the variant is built without holding the lock even if the node is invalidated meanwhile.
+	variant.source = BuildVariantSource(*source, variantKey);
+	return true;
+}
+
+/**
+ * \brief Create the program of a variant prepared by PrepareVariant() and store it. Compiles without holding the lock,
+ * if another thread compiled the same variant meanwhile its program is kept.
+ * \param variant The prepared variant.
+ * \return The program, owned by the cache. Check IShader::IsValid() to see if it compiled.
+ */
+GFW::IShader* GFW::ShaderPermutations::CreateVariant(const PreparedVariant& variant)
+{
+	if(variant.shader)
+		return variant.shader;
+
+	std::unique_ptr<IShader> shader = Compile(variant.source);
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto& stored = m_variants[VariantId{ variant.sourceHash, variant.variantKey }];
+	if(!stored)
+		stored = std::move(shader);
+	return stored.get();
+}
+
+/**
+ * \brief Compile a declared set of variants up front, for example at startup. The variant sources are built on the thread pool,
+ * the programs are created afterwards on the calling thread.
+ * \param path The path of the source file.
+ * \param variantKeys The keys of the variants to compile. Variants that are already compiled are skipped.
+ * \param parallelCreate If the shaders are also created on the thread pool. Only set this if IShader::Create() of the shaders the factory returns
+ * may be called from worker threads, for example when every worker has its own shared context. Otherwise they are created on the calling thread.
+ */
+void GFW::ShaderPermutations::Precompile(const std::string& path, const std::vector<uint64_t>& variantKeys, bool parallelCreate)
+{
+	std::vector<uint64_t> keys;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		std::vector<std::string> stack;
+		const SourceNode* node = ResolveSource(path, stack);
+		if(!node)
+			return;
+
+		for(const uint64_t key : variantKeys)
+		{
+			if(m_variants.find(VariantId{ node->hash, key }) == m_variants.end() && std::find(keys.begin(), keys.end(), key) == keys.end())
+				keys.push_back(key);
+		}
+	}
+
+	std::vector<PreparedVariant> variants(keys.size());
+	std::vector<char> prepared(keys.size(), 0);
+	m_threadPool->ParallelFor(0, int(keys.size()), [&](int begin, int end)
+	{
+		for(int i = begin; i < end; ++i)
+		{
+			prepared[i] = PrepareVariant(path, keys[i], variants[i]);
+			if(prepared[i] && parallelCreate)
+				CreateVariant(variants[i]);
+		}
+	});
+
+	if(!parallelCreate)
+	{
+		for(size_t i = 0; i < keys.size(); ++i)
+		{
+			if(prepared[i])
+				CreateVariant(variants[i]);
+		}
+	}
+}
+
+/**
+ * \brief Drop the cached expanded sources of a file and of every file that includes it, so they are loaded again on the next request.
+ * Compiled variants of the old sources stay alive, variants of the changed sources get a different source hash.
+ * \param path The path of the changed file.
+ */
+void GFW::ShaderPermutations::InvalidateSource(const std::string& path)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for(auto i = m_sources.begin(); i != m_sources.end();)
+	{
+		if(std::find(i->second.files.begin(), i->second.files.end(), path) != i->second.files.end())
+			i = m_sources.erase(i);
+		else
+			++i;
+	}
+}
+
+/**
+ * \brief Load compiled variants from a persistent cache, and store new variants in it. Set this before requesting variants.
+ * \param binaryCache The cache to use, nullptr to always compile variants from source. Not owned by this class.
+ */
+void GFW::ShaderPermutations::SetBinaryCache(ShaderBinaryCache* binaryCache)
+{
+	m_binaryCache = binaryCache;
+}
+
+/**
+ * \return The amount of compiled variants.
+ */
+int GFW::ShaderPermutations::GetVariantCount() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return int(m_variants.size());
+}
+
+/**
+ * \return The amount of GetVariant() calls that returned a variant that was already compiled.
+ */
+unsigned long long GFW::ShaderPermutations::GetHitCount() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_hits;
+}
+
+/**
+ * \brief Get the expanded source of a file from the cache, or load it and expand its includes. Included files are resolved relative to the including file.
+ * \param path The path of the file.
+ * \param stack The files currently being expanded, used to detect include cycles.
+ * \return The cached node, nullptr if the file or one of its includes can't be loaded or the includes form a cycle.
+ */
+const GFW::ShaderPermutations::SourceNode* GFW::ShaderPermutations::ResolveSource(const std::string& path, std::vector<std::string>& stack)
+{
+	const auto found = m_sources.find(path);
+	if(found != m_sources.end())
+		return &found->second;
+	if(std::find(stack.begin(), stack.end(), path) != stack.end())
+		return nullptr;
+
+	std::string text;
+	if(!m_loader(path, text))
+		return nullptr;
+
+	SourceNode node;
+	std::string expanded;
+	node.files.push_back(path);
+	stack.push_back(path);
+	const std::string directory = GetDirectory(path);
+	size_t lineStart = 0;
+	while(lineStart < text.size())
+	{
+		size_t lineEnd = text.find('\n', lineStart);
+		lineEnd = lineEnd == std::string::npos ? text.size() : lineEnd + 1;
+		const std::string line = text.substr(lineStart, lineEnd - lineStart);
+		std::string include;
+		if(ParseInclude(line.substr(0, line.find_last_not_of("\r\n") + 1), include))
+		{
+			const SourceNode* child = ResolveSource(directory + include, stack);
+			if(!child)
+			{
+				stack.pop_back();
+				return nullptr;
+			}
+
+			expanded += *child->source;
+			if(!expanded.empty() && expanded.back() != '\n')
+				expanded += '\n';
+			for(const std::string& file : child->files)
+			{
+				if(std::find(node.files.begin(), node.files.end(), file) == node.files.end())
+					node.files.push_back(file);
+			}
+		}
+		else
+			expanded += line;
+		lineStart = lineEnd;
+	}
+	stack.pop_back();
+
+	node.hash = HashFnv1a64(expanded.data(), expanded.size());
+	node.source = std::make_shared<const std::string>(std::move(expanded));
+	return &(m_sources[path] = std::move(node));
+}
+
+/**
+ * \brief Insert the defines of a variant into a source, after the #version directive if the source starts with one.
+ * \param source The expanded source.
+ * \param variantKey The key of the variant.
+ * \return The source of the variant.
+ */
+std::string GFW::ShaderPermutations::BuildVariantSource(const std::string& source, uint64_t variantKey) const
+{
+	std::string defines;
+	for(const std::string& keyword : GetKeywords(variantKey))
+		defines += "#define " + keyword + " 1\n";
+
+	const size_t position = FindVersionEnd(source);
+	std::string variant;
+	variant.reserve(source.size() + defines.size() + 1);
+	variant.append(source, 0, position);
+	if(position > 0 && variant.back() != '\n')
+		variant += '\n';
+	variant += defines;
+	variant.append(source, position, std::string::npos);
+	return variant;
+}
+
+/**
+ * \brief Create a shader from the source of a variant, through the binary cache if one is set.
+ */
+std::unique_ptr<GFW::IShader> GFW::ShaderPermutations::Compile(const std::string& source)
+{
+	if(m_binaryCache)
+		return m_binaryCache->Create(source);
+
+	std::unique_ptr<IShader> shader = m_factory();
+	shader->Create(source.c_str());
+	return shader;
+}
@@ -0,0 +1,234 @@
+#include <ShaderReflection.h>
+#include <algorithm>
+#include <cstring>
+#include "Logging.h"
+
+namespace
+{
+	const int KEYS_PER_BUCKET = 4;
+	const uint32_t MAX_SEED_ATTEMPTS = 1 << 16;
+
+	/**
+	 * \brief Mix a name hash with a seed, so every seed spreads the names differently.
+	 */
+	uint32_t MixHash(uint32_t hash, uint32_t seed)
+	{
+		hash ^= seed * 0x9E3779B9u;
+		hash ^= hash >> 16;
+		hash *= 0x85EBCA6Bu;
+		hash ^= hash >> 13;
+		hash *= 0xC2B2AE35u;
+		return hash ^ (hash >> 16);
+	}
+}
+
+GFW::ShaderReflection::ShaderReflection() : m_hashCollisions(false)
+{
+}
+
+/**
+ * \brief Store the reflection of a shader program and build the name lookup. Call this once after the program is linked.
+ * \param attributes All attributes of the program.
+ * \param parameters All parameters of the program. The position of a parameter becomes its index and handle. Only the names, types and locations are kept.
+ */
+void GFW::ShaderReflection::Create(vector<ShaderAttribute> attributes, const vector<ShaderParameter>& parameters)
+{
+	m_attributes = std::move(attributes);
+
+	size_t namesSize = 0;
+	for(const ShaderParameter& parameter : parameters)
+		namesSize += parameter.name.size() + 1;
+	m_names.clear();
+	m_names.reserve(namesSize);
+	m_types.resize(parameters.size());
+	m_locations.resize(parameters.size());
+	m_nameOffsets.resize(parameters.size());
+	m_nameHashes.resize(parameters.size());
+	for(size_t i = 0; i < parameters.size(); ++i)
+	{
+		const string& name = parameters[i].name;
+		m_types[i] = parameters[i].type;
+		m_locations[i] = parameters[i].location;
+		m_nameOffsets[i] = uint32_t(m_names.size());
+		m_names.insert(m_names.end(), name.c_str(), name.c_str() + name.size() + 1);
+		m_nameHashes[i] = HashShaderParameterName(name.c_str());
+	}
+	BuildPerfectHash();
+}
+
+/**
+ * \return All attributes of the program.
+ */
+const GFW::vector<GFW::ShaderAttribute>& GFW::ShaderReflection::GetAttributes() const
+{
+	return m_attributes;
+}
+
+/**
+ * \return The amount of parameters of the program.
+ */
+int GFW::ShaderReflection::GetParameterCount() const
+{
+	return int(m_types.size());
+}
+
+/**
+ * \return The interned name of parameter @index.
+ */
+const char* GFW::ShaderReflection::GetParameterName(int index) const
+{
+	return m_names.data() + m_nameOffsets[index];
+}
+
+/**
+ * \return The type of parameter @index.
+ */
+GFW::ShaderParameterType GFW::ShaderReflection::GetParameterType(int index) const
+{
+	return m_types[index];
+}
+
+/**
+ * \return The location, or the binding point of samplers and buffers, of parameter @index.
+ */
+int GFW::ShaderReflection::GetParameterLocation(int index) const
+{
+	return m_locations[index];
+}
+
+/**
+ * \return The types of all parameters, in the order of their indices.
+ */
+const GFW::vector<GFW::ShaderParameterType>& GFW::ShaderReflection::GetParameterTypes() const
+{
+	return m_types;
+}
+
+/**
+ * \return The locations of all parameters, in the order of their indices.
+ */
+const GFW::vector<int>& GFW::ShaderReflection::GetParameterLocations() const
+{
+	return m_locations;
+}
+
+/**
+ * \param name The name of the shader parameter.
+ * \return The index of the parameter named @name, -1 if the program has no such parameter.
+ */
+int GFW::ShaderReflection::FindParameter(const string& name) const
+{
+	const int index = FindSlot(HashShaderParameterName(name.c_str()));
+	if(index >= 0 && strcmp(GetParameterName(index), name.c_str()) == 0)
+		return index;
+
+	// Names sharing a hash with another name aren't in the perfect hash.
+	if(m_hashCollisions)
+	{
+		for(size_t i = 0; i < m_nameOffsets.size(); ++i)
+		{
+			if(strcmp(GetParameterName(int(i)), name.c_str()) == 0)
+				return int(i);
+		}
+	}
+	return -1;
+}
+
+/**
+ * \brief Find a parameter by the hash of its name. Without the name, parameters whose names share a hash can't be told apart,
+ * the first of them is returned.
+ * \param name The hashed name of the shader parameter.
+ * \return The index of the parameter with the hash of @name, -1 if the program has no such parameter.
+ */
+int GFW::ShaderReflection::FindParameter(ShaderParameterName name) const
+{
+	return FindSlot(name.hash);
+}
+
+/**
+ * \return The parameter in the perfect hash slot of @hash if its name has the same hash, -1 otherwise.
+ */
+int GFW::ShaderReflection::FindSlot(uint32_t hash) const
+{
+	if(m_slots.empty())
+		return -1;
+
+	const uint32_t seed = m_seeds[MixHash(hash, 0) % m_seeds.size()];
+	const int index = m_slots[MixHash(hash, seed) % m_slots.size()];
+	return index >= 0 && m_nameHashes[index] == hash ? index : -1;
+}
+
+/**
+ * \brief Build a hash and displace perfect hash of the name hashes. The hashes are split into buckets of about KEYS_PER_BUCKET,
+ * and starting with the largest bucket a seed is searched for every bucket that moves all its hashes to free slots.
+ */
+void GFW::ShaderReflection::BuildPerfectHash()
+{
+	m_seeds.clear();
+	m_slots.clear();
+	m_hashCollisions = false;
+	if(m_nameHashes.empty())
+		return;
+
+	// Only the first parameter of every name hash can be in the table.
+	vector<int> keys;
+	for(size_t i = 0; i < m_nameHashes.size(); ++i)
+	{
+		if(std::find(m_nameHashes.begin(), m_nameHashes.begin() + i, m_nameHashes[i]) == m_nameHashes.begin() + i)
+			keys.push_back(int(i));
+		else
+			m_hashCollisions = true;
+	}
+
+	const size_t bucketCount = (keys.size() + KEYS_PER_BUCKET - 1) / KEYS_PER_BUCKET;
+	vector<vector<int>> buckets(bucketCount);
+	for(const int key : keys)
+		buckets[MixHash(m_nameHashes[key], 0) % bucketCount].push_back(key);
+	vector<size_t> order(bucketCount);
+	for(size_t i = 0; i < bucketCount; ++i)
+		order[i] = i;
+	std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return buckets[a].size() > buckets[b].size(); });
+
+	// Start with a table a quarter larger than the key count and grow it if a bucket can't be placed.
+	size_t slotCount = keys.size() + keys.size() / 4 + 1;
+	vector<size_t> bucketSlots;
+	for(;;)
+	{
+		m_seeds.assign(bucketCount, 0);
+		m_slots.assign(slotCount, -1);
+		bool placed = true;
+		for(const size_t bucket : order)
+		{
+			placed = false;
+			for(uint32_t seed = 1; seed < MAX_SEED_ATTEMPTS && !placed; ++seed)
+			{
+				bucketSlots.clear();
+				placed = true;
+				for(const int key : buckets[bucket])
+				{
+					const size_t slot = MixHash(m_nameHashes[key], seed) % slotCount;
+					if(m_slots[slot] >= 0 || std::find(bucketSlots.begin(), bucketSlots.end(), slot) != bucketSlots.end())
+					{
+						placed = false;
+						break;
+					}
+					bucketSlots.push_back(slot);
+				}
+
+				if(placed)
+				{
+					m_seeds[bucket] = seed;
+					for(size_t i = 0; i < bucketSlots.size(); ++i)
+						m_slots[bucketSlots[i]] = buckets[bucket][i];
+				}
+			}
+
+			if(!placed)
+				break;
+		}
+
+		if(placed)
+			return;
+		slotCount *= 2;
+	}
+}
@@ -0,0 +1,417 @@
+#include <TextureAtlas.h>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include "Logging.h"
+#include "TextureUtilities.h"
+
+namespace
+{
+	template<typename RectType>
+	bool Contains(const RectType& outer, const RectType& inner)
+	{
+		return inner.x >= outer.x && inner.y >= outer.y && inner.x + inner.width <= outer.x + outer.width && inner.y + inner.height <= outer.y + outer.height;
+	}
+
+	template<typename RectType>
+	bool Intersects(const RectType& a, const RectType& b)
+	{
+		return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+	}
+}
+
+/**
+ * \brief Creates the atlas with a single layer.
+ * \param texture The texture to use as atlas. Gets initialized as a 2D texture array and is recreated when layers are added or removed.
+ * \param width The width of every layer.
+ * \param height The height of every layer.
+ * \param format The format of the texture.
+ * \param type The type of the pixel data passed to Insert().
+ * \param padding The amount of pixels kept around every image. They are filled with the edge pixels of the image.
+ * \param maxLayers The maximum amount of layers the atlas can grow to.
+ */
+GFW::TextureAtlas::TextureAtlas(ITexture* texture, int width, int height, TextureFormat format, TextureDataType type, int padding, int maxLayers)
+	: m_texture(texture), m_width(width), m_height(height), m_format(format), m_type(type), m_pixelSize(TextureUtilities::GetPixelSize(format, type)),
+	m_padding(padding), m_maxLayers(maxLayers), m_usedArea(0)
+{
+	GFW_ASSERT(m_texture != nullptr && m_pixelSize > 0 && m_maxLayers > 0);
+	ResizeLayers(1);
+}
+
+/**
+ * \brief Pack an image into the atlas and upload it. Adds a layer when the image doesn't fit in any of the existing layers.
+ * \param width The width of the image.
+ * \param height The height of the image.
+ * \param pixelData Tightly packed pixel data of the image.
+ * \return Id of the image in the atlas. -1 if the image doesn't fit.
+ */
+int GFW::TextureAtlas::Insert(int width, int height, const unsigned char* pixelData)
+{
+	GFW_ASSERT(width > 0 && height > 0 && pixelData != nullptr);
+	const int paddedWidth = width + m_padding * 2;
+	const int paddedHeight = height + m_padding * 2;
+	if(paddedWidth > m_width || paddedHeight > m_height)
+		return -1;
+
+	int layer;
+	Rect rect;
+	if(!FindPosition(paddedWidth, paddedHeight, 0, GetLayerCount() - 1, layer, rect))
+	{
+		if(GetLayerCount() == m_maxLayers)
+			return -1;
+		ResizeLayers(GetLayerCount() + 1);
+		layer = GetLayerCount() - 1;
+		rect = Rect{ 0, 0, paddedWidth, paddedHeight };
+	}
+
+	int id;
+	if(m_freeIds.empty())
+	{
+		id = int(m_entries.size());
+		m_entries.emplace_back();
+	}
+	else
+	{
+		id = m_freeIds.back();
+		m_freeIds.pop_back();
+	}
+
+	Entry& entry = m_entries[id];
+	entry.used = true;
+	entry.layer = layer;
+	entry.rect = rect;
+	entry.pixels.assign(pixelData, pixelData + size_t(width) * height * m_pixelSize);
+	m_usedArea += (long long)width * height;
+
+	Occupy(layer, rect);
+	Upload(entry);
+	return id;
+}
+
+/**
+ * \brief Remove an image from the atlas. Its area becomes available for new images, the texture itself isn't changed.
+ * \param id The id returned by Insert().
+ */
+void GFW::TextureAtlas::Remove(int id)
+{
+	GFW_ASSERT(id >= 0 && id < int(m_entries.size()) && m_entries[id].used);
+	Entry& entry = m_entries[id];
+	Release(entry.layer, entry.rect);
+	m_usedArea -= (long long)(entry.rect.width - m_padding * 2) * (entry.rect.height - m_padding * 2);
+
+	entry.used = false;
+	entry.pixels = std::vector<unsigned char>();
+	m_freeIds.push_back(id);
+}
+
+/**
+ * \brief Get the location of an image in the atlas. Locations change when Repack() moves the image.
+ * \param id The id returned by Insert().
+ * \param region Output for the location of the image.
+ * \return False if @id isn't a valid image.
+ */
+bool GFW::TextureAtlas::GetRegion(int id, TextureAtlasRegion& region) const
+{
+	if(id < 0 || id >= int(m_entries.size()) || !m_entries[id].used)
+		return false;
+
+	const Entry& entry = m_entries[id];
+	region.layer = entry.layer;
+	region.x = entry.rect.x + m_padding;
+	region.y = entry.rect.y + m_padding;
+	region.width = entry.rect.width - m_padding * 2;
+	region.height = entry.rect.height - m_padding * 2;
+	region.uvRect = Vec4(float(region.x) / m_width, float(region.y) / m_height, float(region.x + region.width) / m_width, float(region.y + region.height) / m_height);
+	return true;
+}
+
+/**
+ * \brief Reduce fragmentation by moving a limited amount of images. Images in the last layer are moved into earlier layers and the last layer is removed once it's empty.
+ * With a single layer the layer is packed again from scratch, largest images first, if it holds no more than @maxMoves images.
+ * Regions returned by GetRegion() must be queried again after images are moved.
+ * \param maxMoves The maximum amount of images to move, to spread the uploads over multiple frames.
+ * \return The amount of images that were moved.
+ */
+int GFW::TextureAtlas::Repack(int maxMoves)
+{
+	const int lastLayer = GetLayerCount() - 1;
+	std::vector<int> ids;
+	for(int id = 0; id < int(m_entries.size()); ++id)
+		if(m_entries[id].used && m_entries[id].layer == lastLayer)
+			ids.push_back(id);
+	std::sort(ids.begin(), ids.end(), [this](int a, int b)
+	{
+		const Rect& rectA = m_entries[a].rect;
+		const Rect& rectB = m_entries[b].rect;
+		return std::max(rectA.width, rectA.height) > std::max(rectB.width, rectB.height);
+	});
+
+	int moves = 0;
+	if(lastLayer > 0)
+	{
+		for(size_t i = 0; i < ids.size() && moves < maxMoves; ++i)
+		{
+			Entry& entry = m_entries[ids[i]];
+			int layer;
+			Rect rect;
+			if(!FindPosition(entry.rect.width, entry.rect.height, 0, lastLayer - 1, layer, rect))
+				continue;
+
+			Release(entry.layer, entry.rect);
+			Occupy(layer, rect);
+			entry.layer = layer;
+			entry.rect = rect;
+			Upload(entry);
+			++moves;
+		}
+
+		if(moves == int(ids.size()))
+			ResizeLayers(lastLayer);
+	}
+	else if(!ids.empty() && int(ids.size()) <= maxMoves)
+	{
+		std::vector<Rect> previousFreeRects = m_freeRects[0];
+		m_freeRects[0].assign(1, Rect{ 0, 0, m_width, m_height });
+
+		std::vector<Rect> rects(ids.size());
+		for(size_t i = 0; i < ids.size(); ++i)
+		{
+			int layer;
+			if(!FindPosition(m_entries[ids[i]].rect.width, m_entries[ids[i]].rect.height, 0, 0, layer, rects[i]))
+			{
+				m_freeRects[0] = previousFreeRects;
+				return 0;
+			}
+			Occupy(0, rects[i]);
+		}
+
+		for(size_t i = 0; i < ids.size(); ++i)
+		{
+			Entry& entry = m_entries[ids[i]];
+			if(memcmp(&entry.rect, &rects[i], sizeof(Rect)) == 0)
+				continue;
+			entry.rect = rects[i];
+			Upload(entry);
+			++moves;
+		}
+	}
+	return moves;
+}
+
+/**
+ * \return The amount of layers in the atlas texture.
+ */
+int GFW::TextureAtlas::GetLayerCount() const
+{
+	return int(m_freeRects.size());
+}
+
+/**
+ * \return The amount of images in the atlas.
+ */
+int GFW::TextureAtlas::GetEntryCount() const
+{
+	return int(m_entries.size() - m_freeIds.size());
+}
+
+/**
+ * \return The fraction of the texture covered by images, excluding padding.
+ */
+float GFW::TextureAtlas::GetOccupancy() const
+{
+	return float(double(m_usedArea) / (double(m_width) * m_height * GetLayerCount()));
+}
+
+/**
+ * \return The fraction of the free area that isn't part of the largest free rectangle of its layer. 0 when the free area of every layer is one rectangle, approaching 1 when the free area is scattered.
+ */
+float GFW::TextureAtlas::GetFragmentation() const
+{
+	std::vector<long long> freeArea(m_freeRects.size(), (long long)m_width * m_height);
+	for(const Entry& entry : m_entries)
+		if(entry.used)
+			freeArea[entry.layer] -= (long long)entry.rect.width * entry.rect.height;
+
+	long long totalFree = 0;
+	long long scatteredFree = 0;
+	for(size_t layer = 0; layer < m_freeRects.size(); ++layer)
+	{
+		long long largest = 0;
+		for(const Rect& rect : m_freeRects[layer])
+			largest = std::max(largest, (long long)rect.width * rect.height);
+		totalFree += freeArea[layer];
+		scatteredFree += freeArea[layer] - largest;
+	}
+	return totalFree > 0 ? float(double(scatteredFree) / double(totalFree)) : 0.0f;
+}
+
+/**
+ * \brief Find the free rectangle that fits the size with the smallest leftover on its shortest side.
+ * \return False if the size doesn't fit in any of the layers in [@firstLayer, @lastLayer].
+ */
+bool GFW::TextureAtlas::FindPosition(int width, int height, int firstLayer, int lastLayer, int& layer, Rect& rect) const
+{
+	int bestShortSide = std::numeric_limits<int>::max();
+	int bestLongSide = std::numeric_limits<int>::max();
+	for(int i = firstLayer; i <= lastLayer; ++i)
+	{
+		for(const Rect& freeRect : m_freeRects[i])
+		{
+			if(freeRect.width < width || freeRect.height < height)
+				continue;
+
+			const int leftoverX = freeRect.width - width;
+			const int leftoverY = freeRect.height - height;
+			const int shortSide = std::min(leftoverX, leftoverY);
+			const int longSide = std::max(leftoverX, leftoverY);
+			if(shortSide < bestShortSide || (shortSide == bestShortSide && longSide < bestLongSide))
+			{
+				bestShortSide = shortSide;
+				bestLongSide = longSide;
+				layer = i;
+				rect = Rect{ freeRect.x, freeRect.y, width, height };
+			}
+		}
+	}
+	return bestShortSide != std::numeric_limits<int>::max();
+}
+
+/**
+ * \brief Mark an area of a layer as used by splitting every free rectangle that overlaps it.
+ */
+void GFW::TextureAtlas::Occupy(int layer, const Rect& rect)
+{
+	std::vector<Rect>& freeRects = m_freeRects[layer];
+	const size_t count = freeRects.size();
+	for(size_t i = 0; i < count; ++i)
+	{
+		const Rect freeRect = freeRects[i];
+		if(!Intersects(freeRect, rect))
+			continue;
+
+		if(rect.x > freeRect.x)
+			freeRects.push_back(Rect{ freeRect.x, freeRect.y, rect.x - freeRect.x, freeRect.height });
+		if(rect.x + rect.width < freeRect.x + freeRect.width)
+			freeRects.push_back(Rect{ rect.x + rect.width, freeRect.y, freeRect.x + freeRect.width - rect.x - rect.width, freeRect.height });
+		if(rect.y > freeRect.y)
+			freeRects.push_back(Rect{ freeRect.x, freeRect.y, freeRect.width, rect.y - freeRect.y });
+		if(rect.y + rect.height < freeRect.y + freeRect.height)
+			freeRects.push_back(Rect{ freeRect.x, rect.y + rect.height, freeRect.width, freeRect.y + freeRect.height - rect.y - rect.height });
+		freeRects[i].width = 0;
+	}
+	PruneFreeRects(layer);
+}
+
+/**
+ * \brief Mark an area of a layer as free again and merge it with neighbouring free rectangles that share a full edge.
+ */
+void GFW::TextureAtlas::Release(int layer, const Rect& rect)
+{
+	std::vector<Rect>& freeRects = m_freeRects[layer];
+	freeRects.push_back(rect);
+
+	bool merged = true;
+	while(merged)
+	{
+		merged = false;
+		for(size_t i = 0; i < freeRects.size() && !merged; ++i)
+		{
+			for(size_t j = i + 1; j < freeRects.size() && !merged; ++j)
+			{
+				Rect& a = freeRects[i];
+				const Rect& b = freeRects[j];
+				if(a.x == b.x && a.width == b.width && (a.y + a.height == b.y || b.y + b.height == a.y))
+				{
+					a.y = std::min(a.y, b.y);
+					a.height += b.height;
+					merged = true;
+				}
+				else if(a.y == b.y && a.height == b.height && (a.x + a.width == b.x || b.x + b.width == a.x))
+				{
+					a.x = std::min(a.x, b.x);
+					a.width += b.width;
+					merged = true;
+				}
+				if(merged)
+					freeRects.erase(freeRects.begin() + j);
+			}
+		}
+	}
+	PruneFreeRects(layer);
+}
+
+/**
+ * \brief Remove empty free rectangles and free rectangles that are contained by another free rectangle.
+ */
+void GFW::TextureAtlas::PruneFreeRects(int layer)
+{
+	std::vector<Rect>& freeRects = m_freeRects[layer];
+	freeRects.erase(std::remove_if(freeRects.begin(), freeRects.end(), [](const Rect& rect) { return rect.width <= 0 || rect.height <= 0; }), freeRects.end());
+
+	for(size_t i = 0; i < freeRects.size(); ++i)
+	{
+		for(size_t j = i + 1; j < freeRects.size(); ++j)
+		{
+			if(Contains(freeRects[j], freeRects[i]))
+			{
+				freeRects.erase(freeRects.begin() + i);
+				--i;
+				break;
+			}
+			if(Contains(freeRects[i], freeRects[j]))
+			{
+				freeRects.erase(freeRects.begin() + j);
+				--j;
+			}
+		}
+	}
+}
+
+/**
+ * \brief Upload the pixel data of an entry to its location in the texture. The padding around the image is filled with the edge pixels of the image,
+ * so the whole padded area is overwritten and filtering at the edges doesn't pick up pixels of an image that was removed or moved away.
+ */
+void GFW::TextureAtlas::Upload(Entry& entry)
+{
+	const int width = entry.rect.width - m_padding * 2;
+	const int height = entry.rect.height - m_padding * 2;
+	if(m_padding == 0)
+	{
+		m_texture->UpdateTexture(entry.rect.x, entry.rect.y, entry.layer, width, height, 1, 0, m_format, m_type, entry.pixels.data());
+		return;
+	}
+
+	const size_t rowSize = size_t(width) * m_pixelSize;
+	const size_t paddedRowSize = size_t(entry.rect.width) * m_pixelSize;
+	const size_t paddingSize = size_t(m_padding) * m_pixelSize;
+	m_uploadBuffer.resize(paddedRowSize * entry.rect.height);
+	for(int y = 0; y < entry.rect.height; ++y)
+	{
+		const int sourceY = std::min(std::max(y - m_padding, 0), height - 1);
+		const unsigned char* source = entry.pixels.data() + rowSize * sourceY;
+		unsigned char* destination = m_uploadBuffer.data() + paddedRowSize * y;
+		memcpy(destination + paddingSize, source, rowSize);
+		for(int x = 0; x < m_padding; ++x)
+		{
+			memcpy(destination + size_t(x) * m_pixelSize, source, size_t(m_pixelSize));
+			memcpy(destination + paddingSize + rowSize + size_t(x) * m_pixelSize, source + rowSize - m_pixelSize, size_t(m_pixelSize));
+		}
+	}
+	m_texture->UpdateTexture(entry.rect.x, entry.rect.y, entry.layer, entry.rect.width, entry.rect.height, 1, 0, m_format, m_type, m_uploadBuffer.data());
+}
+
+/**
+ * \brief Recreate the texture with a different amount of layers and upload all images again. Layers that are removed must be empty.
+ */
+void GFW::TextureAtlas::ResizeLayers(int layers)
+{
+	m_freeRects.resize(size_t(layers), std::vector<Rect>(1, Rect{ 0, 0, m_width, m_height }));
+	m_texture->CreateArray(m_width, m_height, layers, false, m_format, m_type, nullptr);
+	for(Entry& entry : m_entries)
+	{
+		if(!entry.used)
+			continue;
+		GFW_ASSERT(entry.layer < layers);
+		Upload(entry);
+	}
+}
@@ -0,0 +1,356 @@
+#include <TextureCache.h>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include "DdsKtxFile.h"
+#include "Logging.h"
+#include "TextureContainer.h"
+#include "TextureUtilities.h"
+
+namespace
+{
+	const uint64_t HASH_CHUNK_SIZE = 1 << 20;
+	const uint64_t PRIME1 = 0x9E3779B185EBCA87ull;
+	const uint64_t PRIME2 = 0xC2B2AE3D27D4EB4Full;
+	const uint64_t PRIME3 = 0x165667B19E3779F9ull;
+	const uint64_t PRIME4 = 0x85EBCA77C2B2AE63ull;
+	const uint64_t PRIME5 = 0x27D4EB2F165667C5ull;
+
+	/**
+	 * \brief A piece of pixel data that's hashed on its own.
+	 */
+	struct HashChunk
+	{
+		const unsigned char* data;	// Start of the chunk.
+		uint64_t size;				// The size of the chunk in bytes.
+	};
+
+	uint64_t RotateLeft(uint64_t value, int bits)
+	{
+		return (value << bits) | (value >> (64 - bits));
+	}
+
+	uint64_t Read64(const unsigned char* data)
+	{
+		uint64_t value;
+		memcpy(&value, data, sizeof(value));
+		return value;
+	}
+
+	uint64_t Round(uint64_t accumulator, uint64_t input)
+	{
+		return RotateLeft(accumulator + input * PRIME2, 31) * PRIME1;
+	}
+
+	uint64_t Avalanche(uint64_t hash)
+	{
+		hash = (hash ^ (hash >> 33)) * PRIME2;
+		hash = (hash ^ (hash >> 29)) * PRIME3;
+		return hash ^ (hash >> 32);
+	}
+
+	/**
+	 * \brief Hash a block of memory into 128 bits. Four independent lanes consume 32 bytes per step like xxHash64 and are folded into two differently mixed halves.
+	 */
+	GFW::TextureHash HashMemory(const unsigned char* data, uint64_t size, uint64_t seed)
+	{
+		uint64_t lanes[4] = { seed + PRIME1 + PRIME2, seed + PRIME2, seed, seed - PRIME1 };
+		const uint64_t remainder = size % 32;
+		const unsigned char* end = data + (size - remainder);
+		for(; data < end; data += 32)
+		{
+			lanes[0] = Round(lanes[0], Read64(data));
+			lanes[1] = Round(lanes[1], Read64(data + 8));
+			lanes[2] = Round(lanes[2], Read64(data + 16));
+			lanes[3] = Round(lanes[3], Read64(data + 24));
+		}
+
+		// The tail is zero padded, folding in the size keeps it apart from data that really ends in zeros.
+		if(remainder)
+		{
+			unsigned char tail[32] = {};
+			memcpy(tail, data, size_t(remainder));
+			for(int lane = 0; lane < 4; ++lane)
+				lanes[lane] = Round(lanes[lane], Read64(tail + lane * 8));
+		}
+
+		GFW::TextureHash hash;
+		hash.low = Avalanche(RotateLeft(lanes[0], 1) + RotateLeft(lanes[1], 7) + RotateLeft(lanes[2], 12) + RotateLeft(lanes[3], 18) + size * PRIME5);
+		hash.high = Avalanche((lanes[0] * PRIME3) ^ RotateLeft(lanes[1] * PRIME4, 17) ^ RotateLeft(lanes[2] * PRIME5, 31) ^ RotateLeft(lanes[3] * PRIME1, 47) ^ (size * PRIME2));
+		return hash;
+	}
+
+	/**
+	 * \return The storage the graphics API allocates for a texture created from @description.
+	 */
+	uint64_t GetTextureSize(const GFW::TextureDescription& description, bool mipmaps)
+	{
+		const int levels = mipmaps ? GFW::TextureUtilities::GetMipmapCount(description.width, description.height, description.depth) : 1;
+		return GFW::TextureUtilities::GetStorageSize(description.format, description.width, description.height, description.depth, description.layers * description.faces, levels);
+	}
+
+	/**
+	 * \return Pointers to every slice of an opened TextureContainer or DdsKtxFile, indexed by level * layers * faces + slice.
+	 */
+	template<class T>
+	std::vector<unsigned char*> GetSlices(const T& file)
+	{
+		const GFW::TextureDescription& description = file.GetDescription();
+		const int sliceCount = description.layers * description.faces;
+		std::vector<unsigned char*> slices(size_t(description.levels * sliceCount));
+		for(int level = 0; level < description.levels; ++level)
+			for(int slice = 0; slice < sliceCount; ++slice)
+				slices[level * sliceCount + slice] = file.GetSliceData(level, slice);
+		return slices;
+	}
+}
+
+/**
+ * \param factory Function that creates an empty texture whenever a texture isn't in the cache yet.
+ * \param decoder Decoder for image files like PNG and JPG. Not owned by the cache. nullptr to only support DDS, KTX and TextureContainer files.
+ * \param threadPool The pool to hash large textures on. nullptr to use the default thread pool.
+ */
+GFW::TextureCache::TextureCache(TextureFactory factory, IImageDecoder* decoder, ThreadPool* threadPool) :
+	m_factory(factory), m_decoder(decoder), m_threadPool(threadPool ? threadPool : &ThreadPool::GetDefault()), m_hits(0), m_savedSize(0)
+{
+	GFW_ASSERT(m_factory);
+}
+
+/**
+ * \brief Get a 1D or 2D texture with the given contents. Creates the texture if the cache doesn't hold one with identical contents yet.
+ * \param width The width of the texture.
+ * \param height The height of the texture. Setting this to 1 will create a 1D texture.
+ * \param generateMipmaps If mipmaps should be generated for this texture. Textures with and without mipmaps aren't shared.
+ * \param format The format of the texture.
+ * \param type The type of @pixelData.
+ * \param pixelData The tightly packed pixel data to initialize the texture to.
+ * \return A new reference to the texture, release it with Release().
+ */
+GFW::ITexture* GFW::TextureCache::Create(int width, int height, bool generateMipmaps, TextureFormat format, TextureDataType type, const unsigned char* pixelData)
+{
+	GFW_ASSERT(pixelData != nullptr);
+	TextureDescription description;
+	description.format = format;
+	description.type = type;
+	description.width = width;
+	description.height = height;
+
+	const TextureHash hash = ComputeHash(description, generateMipmaps, &pixelData, m_threadPool);
+	if(ITexture* texture = Find(hash))
+		return texture;
+
+	std::unique_ptr<ITexture> texture = m_factory();
+	texture->Create(width, height, generateMipmaps, format, type, pixelData, TextureUtilities::GetRowSize(format, type, width));
+	return Insert(hash, std::move(texture), GetTextureSize(description, generateMipmaps));
+}
+
+/**
+ * \brief Get a 3D texture with the given contents. Creates the texture if the cache doesn't hold one with identical contents yet.
+ * \param width The width of the texture.
+ * \param height The height of the texture.
+ * \param depth The depth of the texture.
+ * \param generateMipmaps If mipmaps should be generated for this texture. Textures with and without mipmaps aren't shared.
+ * \param format The format of the texture.
+ * \param type The type of @pixelData.
+ * \param pixelData The tightly packed pixel data to initialize the texture to.
+ * \return A new reference to the texture, release it with Release().
+ */
+GFW::ITexture* GFW::TextureCache::Create(int width, int height, int depth, bool generateMipmaps, TextureFormat format, TextureDataType type, const unsigned char* pixelData)
+{
+	GFW_ASSERT(pixelData != nullptr);
+	TextureDescription description;
+	description.format = format;
+	description.type = type;
+	description.width = width;
+	description.height = height;
+	description.depth = depth;
+
+	const TextureHash hash = ComputeHash(description, generateMipmaps, &pixelData, m_threadPool);
+	if(ITexture* texture = Find(hash))
+		return texture;
+
+	const uint64_t rowPitch = TextureUtilities::GetRowSize(format, type, width);
+	std::unique_ptr<ITexture> texture = m_factory();
+	texture->Create(width, height, depth, generateMipmaps, format, type, pixelData, rowPitch, TextureUtilities::GetDataSize(format, type, width, height));
+	return Insert(hash, std::move(texture), GetTextureSize(description, generateMipmaps));
+}
+
+/**
+ * \brief Get a texture with the contents of a file. DDS, KTX and TextureContainer files are hashed straight from the mapped file, other files are decoded first.
+ * \param file The texture file to load.
+ * \param mipmaps When set to true the mipmaps in the file are used, or generated when the file has none. When set to false only the base level is used.
+ * \return A new reference to the texture, release it with Release(). nullptr if the file couldn't be read.
+ */
+GFW::ITexture* GFW::TextureCache::CreateFromFile(const char* file, bool mipmaps)
+{
+	DdsKtxFile ddsKtxFile;
+	TextureContainer container;
+	if(ddsKtxFile.Open(file) || container.Open(file))
+	{
+		const TextureDescription& description = ddsKtxFile.IsOpen() ? ddsKtxFile.GetDescription() : container.GetDescription();
+		const std::vector<unsigned char*> slices = ddsKtxFile.IsOpen() ? GetSlices(ddsKtxFile) : GetSlices(container);
+		const TextureHash hash = ComputeHash(description, mipmaps, slices.data(), m_threadPool);
+		if(ITexture* texture = Find(hash))
+			return texture;
+
+		std::unique_ptr<ITexture> texture = m_factory();
+		TextureContainer::UploadLevels(texture.get(), description, slices.data(), mipmaps);
+		return Insert(hash, std::move(texture), GetTextureSize(description, mipmaps));
+	}
+
+	int width;
+	int height;
+	TextureFormat format;
+	TextureDataType type;
+	std::vector<unsigned char> pixelData;
+	if(!m_decoder || !m_decoder->Decode(file, width, height, format, type, pixelData))
+		return nullptr;
+	return Create(width, height, mipmaps, format, type, pixelData.data());
+}
+
+/**
+ * \brief Add a reference to a texture returned by the cache.
+ */
+void GFW::TextureCache::Acquire(ITexture* texture)
+{
+	const auto hash = m_hashes.find(texture);
+	GFW_ASSERT(hash != m_hashes.end());
+	Entry& entry = m_entries.at(hash->second);
+	++entry.references;
+	m_savedSize += entry.size;
+}
+
+/**
+ * \brief Release a reference to a texture returned by the cache. The texture is destroyed once its last reference is released.
+ * \return True if the texture was destroyed.
+ */
+bool GFW::TextureCache::Release(ITexture* texture)
+{
+	const auto hash = m_hashes.find(texture);
+	GFW_ASSERT(hash != m_hashes.end());
+	const auto entry = m_entries.find(hash->second);
+	if(entry->second.references > 1)
+	{
+		--entry->second.references;
+		m_savedSize -= entry->second.size;
+		return false;
+	}
+
+	m_entries.erase(entry);
+	m_hashes.erase(hash);
+	return true;
+}
+
+/**
+ * \return The amount of distinct textures in the cache.
+ */
+int GFW::TextureCache::GetTextureCount() const
+{
+	return int(m_entries.size());
+}
+
+/**
+ * \return The amount of unreleased references to @texture. 0 if the texture isn't in the cache.
+ */
+int GFW::TextureCache::GetReferenceCount(ITexture* texture) const
+{
+	const auto hash = m_hashes.find(texture);
+	return hash == m_hashes.end() ? 0 : m_entries.at(hash->second).references;
+}
+
+/**
+ * \return The amount of Create() and CreateFromFile() calls that returned an existing texture instead of creating a duplicate.
+ */
+unsigned long long GFW::TextureCache::GetHitCount() const
+{
+	return m_hits;
+}
+
+/**
+ * \return The size in bytes of the storage the graphics API would need for the duplicates that currently share a texture.
+ */
+uint64_t GFW::TextureCache::GetSavedSize() const
+{
+	return m_savedSize;
+}
+
+/**
+ * \brief Hash the contents of a texture. Slices are split into 1 MiB chunks that are hashed in parallel, the chunk hashes are then hashed together with the description.
+ * The result doesn't depend on the amount of threads.
+ * \param description Description of the texture.
+ * \param mipmaps If mipmaps are generated or used for the texture.
+ * \param slices Tightly packed pixel data of every slice, indexed by level * layers * faces + slice.
+ * \param threadPool The pool to hash on. nullptr to use the default thread pool.
+ * \return The hash of the texture.
+ */
+GFW::TextureHash GFW::TextureCache::ComputeHash(const TextureDescription& description, bool mipmaps, const unsigned char* const* slices, ThreadPool* threadPool)
+{
+	const int sliceCount = description.layers * description.faces;
+	std::vector<HashChunk> chunks;
+	for(int level = 0; level < description.levels; ++level)
+	{
+		const uint64_t sliceSize = TextureUtilities::GetDataSize(description.format, description.type, TextureUtilities::GetMipmapDimension(description.width, level),
+			TextureUtilities::GetMipmapDimension(description.height, level), TextureUtilities::GetMipmapDimension(description.depth, level));
+		for(int slice = 0; slice < sliceCount; ++slice)
+		{
+			const unsigned char* data = slices[level * sliceCount + slice];
+			for(uint64_t offset = 0; offset < sliceSize; offset += HASH_CHUNK_SIZE)
+				chunks.push_back({ data + offset, std::min(HASH_CHUNK_SIZE, sliceSize - offset) });
+		}
+	}
+
+	// The description goes first, followed by the hashes of all chunks.
+	const size_t headerSize = 9;
+	std::vector<uint64_t> key(headerSize + chunks.size() * 2);
+	key[0] = uint64_t(description.format);
+	key[1] = uint64_t(description.type);
+	key[2] = uint64_t(description.width);
+	key[3] = uint64_t(description.height);
+	key[4] = uint64_t(description.depth);
+	key[5] = uint64_t(description.layers);
+	key[6] = uint64_t(description.faces);
+	key[7] = uint64_t(description.levels);
+	key[8] = mipmaps ? 1 : 0;
+
+	ThreadPool& pool = threadPool ? *threadPool : ThreadPool::GetDefault();
+	pool.ParallelFor(0, int(chunks.size()), [&](int begin, int end)
+	{
+		for(int chunk = begin; chunk < end; ++chunk)
+		{
+			const TextureHash hash = HashMemory(chunks[chunk].data, chunks[chunk].size, uint64_t(chunk));
+			key[headerSize + chunk * 2] = hash.low;
+			key[headerSize + chunk * 2 + 1] = hash.high;
+		}
+	});
+	return HashMemory(reinterpret_cast<const unsigned char*>(key.data()), key.size() * sizeof(uint64_t), 0);
+}
+
+/**
+ * \return A new reference to the texture with @hash. nullptr if the cache doesn't hold it.
+ */
+GFW::ITexture* GFW::TextureCache::Find(const TextureHash& hash)
+{
+	const auto entry = m_entries.find(hash);
+	if(entry == m_entries.end())
+		return nullptr;
+
+	++entry->second.references;
+	++m_hits;
+	m_savedSize += entry->second.size;
+	return entry->second.texture.get();
+}
+
+/**
+ * \brief Add a newly created texture to the cache with a single reference.
+ * \return The texture.
+ */
+GFW::ITexture* GFW::TextureCache::Insert(const TextureHash& hash, std::unique_ptr<ITexture> texture, uint64_t size)
+{
+	ITexture* result = texture.get();
+	Entry& entry = m_entries[hash];
+	entry.texture = std::move(texture);
+	entry.references = 1;
+	entry.size = size;
+	m_hashes[result] = hash;
+	return result;
+}
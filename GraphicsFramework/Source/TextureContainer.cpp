@@ -0,0 +1,323 @@
+#include <TextureContainer.h>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "Logging.h"
+#include "TextureUtilities.h"
+
+namespace
+{
+	const char CONTAINER_MAGIC[4] = { 'G', 'F', 'W', 'T' };
+	const uint32_t CONTAINER_VERSION = 1;
+
+	/**
+	 * \brief The header at the start of every container file. All values are stored little endian.
+	 */
+	struct ContainerHeader
+	{
+		char magic[4];											// Always "GFWT"
+		uint32_t version;										// Version of the container layout
+		uint32_t format;										// TextureFormat of the texture
+		uint32_t type;											// TextureDataType of the pixel data
+		uint32_t width;											// Width of the base level
+		uint32_t height;										// Height of the base level
+		uint32_t depth;											// Depth of the base level
+		uint32_t layers;										// Amount of array layers
+		uint32_t faces;											// 6 for cubemaps, 1 otherwise
+		uint32_t levels;										// Amount of mipmap levels
+		uint32_t reserved[6];									// Reserved for future use, must be 0
+		uint64_t levelOffsets[GFW::TextureContainer::MAX_LEVELS];	// Offset of every level blob from the start of the file
+		uint64_t levelSizes[GFW::TextureContainer::MAX_LEVELS];		// Size of every level blob in bytes
+	};
+
+	uint64_t AlignLevelOffset(uint64_t offset)
+	{
+		const uint64_t alignment = GFW::TextureContainer::LEVEL_ALIGNMENT;
+		return (offset + alignment - 1) / alignment * alignment;
+	}
+
+	/**
+	 * \brief Fills in the header for @description and calculates where every level goes.
+	 * \return False if @description can't be stored in a container. Cubemaps must be a single square 2D cube and arrays of 3D textures aren't supported,
+	 * since UploadLevels() has no way to create either of them.
+	 */
+	bool BuildHeader(const GFW::TextureDescription& description, ContainerHeader& header)
+	{
+		if(description.levels < 1 || description.levels > GFW::TextureContainer::MAX_LEVELS || description.width < 1 || description.height < 1 ||
+			description.depth < 1 || description.layers < 1 || (description.faces != 1 && description.faces != 6))
+			return false;
+		if((description.faces == 6 && (description.layers != 1 || description.depth != 1 || description.width != description.height)) ||
+			(description.depth != 1 && description.layers != 1))
+			return false;
+
+		memset(&header, 0, sizeof(header));
+		memcpy(header.magic, CONTAINER_MAGIC, sizeof(header.magic));
+		header.version = CONTAINER_VERSION;
+		header.format = uint32_t(description.format);
+		header.type = uint32_t(description.type);
+		header.width = uint32_t(description.width);
+		header.height = uint32_t(description.height);
+		header.depth = uint32_t(description.depth);
+		header.layers = uint32_t(description.layers);
+		header.faces = uint32_t(description.faces);
+		header.levels = uint32_t(description.levels);
+
+		uint64_t offset = AlignLevelOffset(sizeof(ContainerHeader));
+		for(int level = 0; level < description.levels; ++level)
+		{
+			const uint64_t sliceSize = GFW::TextureUtilities::GetDataSize(description.format, description.type,
+				GFW::TextureUtilities::GetMipmapDimension(description.width, level), GFW::TextureUtilities::GetMipmapDimension(description.height, level),
+				GFW::TextureUtilities::GetMipmapDimension(description.depth, level));
+			header.levelOffsets[level] = offset;
+			header.levelSizes[level] = sliceSize * description.layers * description.faces;
+			offset = AlignLevelOffset(offset + header.levelSizes[level]);
+		}
+		return true;
+	}
+}
+
+const int GFW::TextureContainer::MAX_LEVELS;
+const uint64_t GFW::TextureContainer::LEVEL_ALIGNMENT;
+
+GFW::TextureContainer::TextureContainer() : m_levelOffsets{}
+{
+}
+
+/**
+ * \brief Map a container file into memory and validate its header. Closes the previously opened container.
+ * \param file The container file to open.
+ * \return False if the file couldn't be mapped or isn't a valid container.
+ */
+bool GFW::TextureContainer::Open(const char* file)
+{
+	Close();
+	if(!m_file.Open(file) || m_file.GetSize() < sizeof(ContainerHeader))
+	{
+		Close();
+		return false;
+	}
+
+	const ContainerHeader* header = reinterpret_cast<const ContainerHeader*>(m_file.GetData());
+	TextureDescription description;
+	description.format = TextureFormat(header->format);
+	description.type = TextureDataType(header->type);
+	description.width = int(header->width);
+	description.height = int(header->height);
+	description.depth = int(header->depth);
+	description.layers = int(header->layers);
+	description.faces = int(header->faces);
+	description.levels = int(header->levels);
+
+	// Rebuilding the header from the description validates the dimensions and the offsets and sizes of all levels at once.
+	ContainerHeader expected;
+	if(memcmp(header->magic, CONTAINER_MAGIC, sizeof(header->magic)) != 0 || header->version != CONTAINER_VERSION || !BuildHeader(description, expected) ||
+		memcmp(header->levelOffsets, expected.levelOffsets, sizeof(expected.levelOffsets)) != 0 || memcmp(header->levelSizes, expected.levelSizes, sizeof(expected.levelSizes)) != 0 ||
+		expected.levelOffsets[description.levels - 1] + expected.levelSizes[description.levels - 1] > m_file.GetSize())
+	{
+		Close();
+		return false;
+	}
+
+	m_description = description;
+	memcpy(m_levelOffsets, header->levelOffsets, sizeof(m_levelOffsets));
+	return true;
+}
+
+/**
+ * \brief Unmap the container file. Pointers returned by GetSliceData() become invalid.
+ */
+void GFW::TextureContainer::Close()
+{
+	m_file.Close();
+	m_description = TextureDescription();
+	memset(m_levelOffsets, 0, sizeof(m_levelOffsets));
+}
+
+/**
+ * \return If a container file is opened.
+ */
+bool GFW::TextureContainer::IsOpen() const
+{
+	return m_file.IsOpen();
+}
+
+/**
+ * \return Description of the texture stored in the container.
+ */
+const GFW::TextureDescription& GFW::TextureContainer::GetDescription() const
+{
+	return m_description;
+}
+
+/**
+ * \brief Get a pointer to the pixel data of a single slice directly in the mapped file.
+ * \param level The mipmap level of the slice.
+ * \param slice The slice within the level. Slices are ordered by layer and then by cubemap face.
+ * \return Pointer to the tightly packed pixel data of the slice.
+ */
+unsigned char* GFW::TextureContainer::GetSliceData(int level, int slice) const
+{
+	GFW_ASSERT(IsOpen() && level >= 0 && level < m_description.levels && slice >= 0 && slice < m_description.layers * m_description.faces);
+	return m_file.GetData() + m_levelOffsets[level] + GetSliceSize(level) * slice;
+}
+
+/**
+ * \return The size in bytes of a single slice of mipmap @level.
+ */
+uint64_t GFW::TextureContainer::GetSliceSize(int level) const
+{
+	return TextureUtilities::GetDataSize(m_description.format, m_description.type, TextureUtilities::GetMipmapDimension(m_description.width, level),
+		TextureUtilities::GetMipmapDimension(m_description.height, level), TextureUtilities::GetMipmapDimension(m_description.depth, level));
+}
+
+/**
+ * \brief Initialize a texture with the contents of the container. The slices are passed straight from the mapped file to the texture.
+ * \param texture The texture to initialize.
+ * \param mipmaps When set to true the mipmaps in the container are used, or generated when the container has none. When set to false only the base level is used.
+ * \return False if no container is opened.
+ */
+bool GFW::TextureContainer::Upload(ITexture* texture, bool mipmaps) const
+{
+	if(!IsOpen())
+		return false;
+
+	const int sliceCount = m_description.layers * m_description.faces;
+	std::vector<unsigned char*> slices(size_t(m_description.levels * sliceCount));
+	for(int level = 0; level < m_description.levels; ++level)
+		for(int slice = 0; slice < sliceCount; ++slice)
+			slices[level * sliceCount + slice] = GetSliceData(level, slice);
+
+	UploadLevels(texture, m_description, slices.data(), mipmaps);
+	return true;
+}
+
+/**
+ * \return The size in bytes of a container file holding a texture with @description. 0 if the texture can't be stored in a container.
+ */
+uint64_t GFW::TextureContainer::GetContainerSize(const TextureDescription& description)
+{
+	ContainerHeader header;
+	if(!BuildHeader(description, header))
+		return 0;
+	return header.levelOffsets[description.levels - 1] + header.levelSizes[description.levels - 1];
+}
+
+/**
+ * \brief Write a texture in the container layout to memory. Usable to implement ITexture::Export().
+ * \param description Description of the texture.
+ * \param slices Tightly packed pixel data of every slice, indexed by level * layers * faces + slice.
+ * \param destination Output buffer for the container.
+ * \param destinationSize The size of @destination. Must be at least GetContainerSize(@description).
+ * \return False if @destination is too small or the texture can't be stored in a container.
+ */
+bool GFW::TextureContainer::Write(const TextureDescription& description, const unsigned char* const* slices, char* destination, uint64_t destinationSize)
+{
+	ContainerHeader header;
+	if(!BuildHeader(description, header) || destinationSize < GetContainerSize(description))
+		return false;
+
+	memset(destination, 0, size_t(header.levelOffsets[0]));
+	memcpy(destination, &header, sizeof(header));
+
+	const int sliceCount = description.layers * description.faces;
+	for(int level = 0; level < description.levels; ++level)
+	{
+		const uint64_t sliceSize = header.levelSizes[level] / sliceCount;
+		char* levelData = destination + header.levelOffsets[level];
+		for(int slice = 0; slice < sliceCount; ++slice)
+			memcpy(levelData + sliceSize * slice, slices[level * sliceCount + slice], size_t(sliceSize));
+
+		const uint64_t end = header.levelOffsets[level] + header.levelSizes[level];
+		if(level + 1 < description.levels)
+			memset(destination + end, 0, size_t(header.levelOffsets[level + 1] - end));
+	}
+	return true;
+}
+
+/**
+ * \brief Write a texture to a container file.
+ * \param file The file to write to. Overwritten if it already exists.
+ * \param description Description of the texture.
+ * \param slices Tightly packed pixel data of every slice, indexed by level * layers * faces + slice.
+ * \return False if the file couldn't be written or the texture can't be stored in a container.
+ */
+bool GFW::TextureContainer::Save(const char* file, const TextureDescription& description, const unsigned char* const* slices)
+{
+	ContainerHeader header;
+	if(!BuildHeader(description, header))
+		return false;
+
+	FILE* stream = fopen(file, "wb");
+	if(!stream)
+		return false;
+
+	bool success = fwrite(&header, sizeof(header), 1, stream) == 1;
+	uint64_t position = sizeof(header);
+	const std::vector<char> padding(size_t(LEVEL_ALIGNMENT), 0);
+	const int sliceCount = description.layers * description.faces;
+	for(int level = 0; level < description.levels && success; ++level)
+	{
+		success = fwrite(padding.data(), 1, size_t(header.levelOffsets[level] - position), stream) == header.levelOffsets[level] - position;
+
+		const size_t sliceSize = size_t(header.levelSizes[level] / sliceCount);
+		for(int slice = 0; slice < sliceCount && success; ++slice)
+			success = fwrite(slices[level * sliceCount + slice], 1, sliceSize, stream) == sliceSize;
+		position = header.levelOffsets[level] + header.levelSizes[level];
+	}
+
+	return fclose(stream) == 0 && success;
+}
+
+/**
+ * \brief Initialize a texture from a set of slices. Picks the create function that matches the description and uploads the remaining mipmap levels through UpdateTexture().
+ * Cubemap faces are updated as the layers of a 2D texture array.
+ * \param texture The texture to initialize.
+ * \param description Description of the texture.
+ * \param slices Pixel data of every slice, indexed by level * layers * faces + slice.
+ * \param mipmaps When set to true the mipmap levels in @slices are used, or generated when there's only a base level. When set to false only the base level is used.
+ */
+void GFW::TextureContainer::UploadLevels(ITexture* texture, const TextureDescription& description, unsigned char* const* slices, bool mipmaps)
+{
+	GFW_ASSERT(texture != nullptr && slices != nullptr);
+	const int sliceCount = description.layers * description.faces;
+	const int levels = mipmaps ? description.levels : 1;
+
+	if(description.faces == 6)
+	{
+		unsigned char* faces[6];
+		for(int face = 0; face < 6; ++face)
+			faces[face] = slices[face];
+		texture->CreateCube(description.width, description.height, mipmaps, description.format, description.type, faces);
+	}
+	else if(description.layers > 1)
+		texture->CreateArray(description.width, description.height, description.layers, mipmaps, description.format, description.type, const_cast<unsigned char**>(slices));
+	else if(description.depth > 1)
+		texture->Create(description.width, description.height, description.depth, mipmaps, description.format, description.type, slices[0]);
+	else
+		texture->Create(description.width, description.height, mipmaps, description.format, description.type, slices[0]);
+
+	for(int level = 1; level < levels; ++level)
+	{
+		const int width = TextureUtilities::GetMipmapDimension(description.width, level);
+		const int height = TextureUtilities::GetMipmapDimension(description.height, level);
+		const int depth = TextureUtilities::GetMipmapDimension(description.depth, level);
+		unsigned char* const* levelSlices = slices + level * sliceCount;
+
+		if(sliceCount > 1 && description.height == 1)
+		{
+			for(int slice = 0; slice < sliceCount; ++slice)
+				texture->UpdateTexture(0, slice, width, 1, level, description.format, description.type, levelSlices[slice]);
+		}
+		else if(sliceCount > 1)
+		{
+			for(int slice = 0; slice < sliceCount; ++slice)
+				texture->UpdateTexture(0, 0, slice, width, height, 1, level, description.format, description.type, levelSlices[slice]);
+		}
+		else if(description.depth > 1)
+			texture->UpdateTexture(0, 0, 0, width, height, depth, level, description.format, description.type, levelSlices[0]);
+		else if(description.height > 1)
+			texture->UpdateTexture(0, 0, width, height, level, description.format, description.type, levelSlices[0]);
+		else
+			texture->UpdateTexture(0, width, level, description.format, description.type, levelSlices[0]);
+	}
+}
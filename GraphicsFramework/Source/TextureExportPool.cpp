@@ -0,0 +1,128 @@
+#include <TextureExportPool.h>
+#include <algorithm>
+#include "Logging.h"
+
+namespace
+{
+	const uint64_t BLOCK_GRANULARITY = 64 * 1024;
+}
+
+GFW::TextureExportPool::TextureExportPool() : m_state(std::make_shared<State>())
+{
+}
+
+/**
+ * \brief Delete all free blocks. Blocks that are checked out are deleted when their last reference is released.
+ */
+GFW::TextureExportPool::~TextureExportPool()
+{
+	std::lock_guard<std::mutex> lock(m_state->mutex);
+	m_state->open = false;
+	for(const Block& block : m_state->freeBlocks)
+	{
+		m_state->pooledSize -= block.capacity;
+		delete[] block.data;
+	}
+	m_state->freeBlocks.clear();
+}
+
+/**
+ * \brief Export a single mipmap level of a layer of a texture into a pooled block.
+ * \param texture The texture to export.
+ * \param level The mipmap level to export.
+ * \param layer The layer of a texture array, the face of a cubemap or 0 for other textures.
+ * \param size Set to the size of the exported data.
+ * \return The block holding the exported data. It returns to the pool once every reference to it is released.
+ */
+std::shared_ptr<char> GFW::TextureExportPool::Export(ITexture* texture, int level, int layer, uint64_t& size)
+{
+	GFW_ASSERT(texture);
+	const uint64_t exportSize = texture->GetExportSize(level, layer);
+	std::shared_ptr<char> block = Acquire(exportSize);
+	size = texture->Export(level, layer, block.get(), exportSize);
+	return block;
+}
+
+/**
+ * \brief Get a block of at least @size bytes. The smallest free block that's large enough is reused, a new block is only allocated if there's none.
+ * \param size The minimum size of the block.
+ * \return The block. It returns to the pool once every reference to it is released.
+ */
+std::shared_ptr<char> GFW::TextureExportPool::Acquire(uint64_t size)
+{
+	Block block = {};
+	{
+		std::lock_guard<std::mutex> lock(m_state->mutex);
+		std::vector<Block>& freeBlocks = m_state->freeBlocks;
+		auto bestBlock = freeBlocks.end();
+		for(auto it = freeBlocks.begin(); it != freeBlocks.end(); ++it)
+		{
+			if(it->capacity >= size && (bestBlock == freeBlocks.end() || it->capacity < bestBlock->capacity))
+				bestBlock = it;
+		}
+
+		if(bestBlock != freeBlocks.end())
+		{
+			block = *bestBlock;
+			*bestBlock = freeBlocks.back();
+			freeBlocks.pop_back();
+		}
+		else
+		{
+			block.capacity = (std::max(size, uint64_t(1)) + BLOCK_GRANULARITY - 1) / BLOCK_GRANULARITY * BLOCK_GRANULARITY;
+			m_state->pooledSize += block.capacity;
+			++m_state->allocations;
+		}
+	}
+
+	if(!block.data)
+		block.data = new char[size_t(block.capacity)];
+	return std::shared_ptr<char>(block.data, BlockReturner{ m_state, block.capacity });
+}
+
+/**
+ * \brief Release the memory of all free blocks. Blocks that are in use are kept.
+ */
+void GFW::TextureExportPool::Trim()
+{
+	std::lock_guard<std::mutex> lock(m_state->mutex);
+	for(const Block& block : m_state->freeBlocks)
+	{
+		m_state->pooledSize -= block.capacity;
+		delete[] block.data;
+	}
+	m_state->freeBlocks.clear();
+}
+
+/**
+ * \return The total size of all blocks the pool holds, free or in use.
+ */
+uint64_t GFW::TextureExportPool::GetPooledSize()
+{
+	std::lock_guard<std::mutex> lock(m_state->mutex);
+	return m_state->pooledSize;
+}
+
+/**
+ * \return The amount of blocks allocated since the pool was created. Stops increasing once the pool holds enough blocks.
+ */
+unsigned long long GFW::TextureExportPool::GetAllocationCount()
+{
+	std::lock_guard<std::mutex> lock(m_state->mutex);
+	return m_state->allocations;
+}
+
+/**
+ * \brief Return a block to the free blocks of its pool, or delete it if the pool was destroyed.
+ */
+void GFW::TextureExportPool::BlockReturner::operator()(char* data) const
+{
+	std::lock_guard<std::mutex> lock(state->mutex);
+	if(state->open)
+		state->freeBlocks.push_back(Block{ data, capacity });
+	else
+	{
+		state->pooledSize -= capacity;
+		delete[] data;
+	}
+}
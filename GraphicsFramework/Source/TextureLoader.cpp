@@ -0,0 +1,274 @@
+#include <TextureLoader.h>
+#include <algorithm>
+#include "Logging.h"
+#include "TextureUtilities.h"
+
+GFW::TextureLoadRequest::TextureLoadRequest(ITexture* texture, const char* file, bool mipmaps, int priority)
+	: m_texture(texture), m_file(file), m_mipmaps(mipmaps), m_priority(priority), m_state(TextureLoadState::QUEUED),
+	m_width(0), m_height(0), m_format(TextureFormat::RGBA8), m_type(TextureDataType::GL_UNSIGNED_BYTE), m_levelCount(0), m_finestUploadedLevel(-1)
+{
+}
+
+/**
+ * \return The current stage of the load.
+ */
+GFW::TextureLoadState GFW::TextureLoadRequest::GetState() const
+{
+	return m_state;
+}
+
+/**
+ * \return The texture that is being loaded.
+ */
+GFW::ITexture* GFW::TextureLoadRequest::GetTexture() const
+{
+	return m_texture;
+}
+
+/**
+ * \return The file the texture is loaded from.
+ */
+const std::string& GFW::TextureLoadRequest::GetFile() const
+{
+	return m_file;
+}
+
+/**
+ * \return The priority of the load.
+ */
+int GFW::TextureLoadRequest::GetPriority() const
+{
+	return m_priority;
+}
+
+/**
+ * \return The amount of mipmap levels that will be uploaded. 0 until the file is decoded.
+ */
+int GFW::TextureLoadRequest::GetLevelCount() const
+{
+	return m_levelCount;
+}
+
+/**
+ * \return The finest mipmap level that is uploaded. -1 when nothing is uploaded yet. Sampling should be limited to this level and coarser levels until the load is complete.
+ * Safe to read from any thread, the value can be one level behind an upload that is in progress.
+ */
+int GFW::TextureLoadRequest::GetFinestUploadedLevel() const
+{
+	return m_finestUploadedLevel;
+}
+
+/**
+ * \brief Creates the loader.
+ * \param decoder The decoder used to decode the image files. Must be thread-safe and must outlive the loader.
+ * \param threadPool The pool to decode the files on. nullptr to use the default thread pool.
+ */
+GFW::TextureLoader::TextureLoader(IImageDecoder* decoder, ThreadPool* threadPool)
+	: m_decoder(decoder), m_threadPool(threadPool ? threadPool : &ThreadPool::GetDefault()), m_activeTasks(0)
+{
+	GFW_ASSERT(m_decoder != nullptr);
+}
+
+/**
+ * \brief Cancels all loads that haven't been decoded yet and waits for the running decode tasks to finish.
+ */
+GFW::TextureLoader::~TextureLoader()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	for(auto& request : m_queued)
+		request->m_state = TextureLoadState::CANCELLED;
+	m_queued.clear();
+	m_tasksFinished.wait(lock, [this]() { return m_activeTasks == 0; });
+}
+
+/**
+ * \brief Start loading a texture from a file. Returns immediately, the file is decoded on the thread pool and uploaded by ProcessUploads().
+ * \param texture The texture to load the file into. Must stay alive until the load is complete, failed or cancelled.
+ * \param file The texture file to load.
+ * \param mipmaps When set to true the mipmaps are generated on the thread pool and uploaded from smallest to largest. When set to false only the base level is uploaded.
+ * \param priority Loads with a higher priority are decoded and uploaded before loads with a lower priority.
+ * \return Handle to track, reprioritize or cancel the load.
+ */
+GFW::TextureLoadHandle GFW::TextureLoader::CreateFromFileAsync(ITexture* texture, const char* file, bool mipmaps, int priority)
+{
+	GFW_ASSERT(texture != nullptr && file != nullptr);
+	TextureLoadHandle handle(new TextureLoadRequest(texture, file, mipmaps, priority));
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_queued.push_back(handle);
+		++m_activeTasks;
+	}
+
+	// Every task decodes whichever queued request has the highest priority at the time it runs, so priority changes still apply to queued requests.
+	m_threadPool->Submit([this]() { DecodeNext(); }, priority);
+	return handle;
+}
+
+/**
+ * \brief Change the priority of a load that hasn't completed yet.
+ * \param handle The load to change the priority of.
+ * \param priority The new priority.
+ */
+void GFW::TextureLoader::SetPriority(const TextureLoadHandle& handle, int priority)
+{
+	GFW_ASSERT(handle != nullptr);
+	handle->m_priority = priority;
+}
+
+/**
+ * \brief Cancel a load, for textures that are no longer needed. Mipmap levels that were already uploaded stay in the texture.
+ * \param handle The load to cancel.
+ */
+void GFW::TextureLoader::Cancel(const TextureLoadHandle& handle)
+{
+	GFW_ASSERT(handle != nullptr);
+	std::lock_guard<std::mutex> lock(m_mutex);
+	const TextureLoadState state = handle->m_state;
+	if(state == TextureLoadState::COMPLETE || state == TextureLoadState::FAILED)
+		return;
+
+	handle->m_state = TextureLoadState::CANCELLED;
+	m_queued.erase(std::remove(m_queued.begin(), m_queued.end(), handle), m_queued.end());
+}
+
+/**
+ * \brief Upload decoded mipmap levels to their textures. Must be called on the thread that owns the context, for example once per frame.
+ * Levels are uploaded from the smallest to the largest and loads with a higher priority go first.
+ * \param maxLevels The maximum amount of mipmap levels to upload during this call. Used to spread uploads over multiple frames.
+ * \return The amount of mipmap levels that were uploaded.
+ */
+int GFW::TextureLoader::ProcessUploads(int maxLevels)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_uploading.insert(m_uploading.end(), m_decoded.begin(), m_decoded.end());
+		m_decoded.clear();
+	}
+
+	int uploaded = 0;
+	while(uploaded < maxLevels)
+	{
+		TextureLoadHandle request = PopHighestPriority(m_uploading);
+		if(!request)
+			break;
+		if(request->m_state == TextureLoadState::CANCELLED)
+			continue;
+
+		ITexture* texture = request->m_texture;
+		const int level = request->m_finestUploadedLevel < 0 ? request->m_levelCount - 1 : request->m_finestUploadedLevel - 1;
+		const int width = TextureUtilities::GetMipmapDimension(request->m_width, level);
+		const int height = TextureUtilities::GetMipmapDimension(request->m_height, level);
+		unsigned char* pixelData = request->m_levels[level].data();
+
+		// With several levels the texture is created without data, so it only allocates the levels and doesn't generate them. Every level is uploaded explicitly.
+		if(request->m_finestUploadedLevel < 0)
+			texture->Create(request->m_width, request->m_height, request->m_mipmaps, request->m_format, request->m_type, request->m_levelCount == 1 ? pixelData : nullptr);
+		if(request->m_finestUploadedLevel >= 0 || request->m_levelCount > 1)
+		{
+			if(request->m_height == 1)
+				texture->UpdateTexture(0, width, level, request->m_format, request->m_type, pixelData);
+			else
+				texture->UpdateTexture(0, 0, width, height, level, request->m_format, request->m_type, pixelData);
+		}
+
+		request->m_levels[level] = std::vector<unsigned char>();
+		request->m_finestUploadedLevel = level;
+		++uploaded;
+
+		if(level == 0)
+		{
+			request->m_levels.clear();
+			TextureLoadState expected = TextureLoadState::UPLOADING;
+			request->m_state.compare_exchange_strong(expected, TextureLoadState::COMPLETE);
+		}
+		else
+			m_uploading.push_back(request);
+	}
+	return uploaded;
+}
+
+/**
+ * \return True when there are no loads left to decode or upload.
+ */
+bool GFW::TextureLoader::IsIdle()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_activeTasks == 0 && m_decoded.empty() && m_uploading.empty();
+}
+
+/**
+ * \brief Executed on the thread pool. Decodes the queued request with the highest priority and generates its mipmaps.
+ */
+void GFW::TextureLoader::DecodeNext()
+{
+	TextureLoadHandle request;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		request = PopHighestPriority(m_queued);
+		if(request)
+			request->m_state = TextureLoadState::DECODING;
+	}
+
+	if(request)
+	{
+		std::vector<unsigned char> pixelData;
+		int width = 0, height = 0;
+		TextureFormat format = TextureFormat::RGBA8;
+		TextureDataType type = TextureDataType::GL_UNSIGNED_BYTE;
+		const bool decoded = m_decoder->Decode(request->m_file.c_str(), width, height, format, type, pixelData);
+		if(decoded && request->m_state != TextureLoadState::CANCELLED)
+		{
+			request->m_width = width;
+			request->m_height = height;
+			request->m_format = format;
+			request->m_type = type;
+
+			// The levels are generated into the request's own storage, which no other thread reads until the request is handed over below.
+			// The level count is only published once all levels exist, so GetLevelCount() never reports a level that is still being generated.
+			const int levelCount = request->m_mipmaps ? TextureUtilities::GetMipmapCount(width, height) : 1;
+			request->m_levels.resize(levelCount);
+			request->m_levels[0] = std::move(pixelData);
+			int generated = 1;
+
+			for(int level = 1; level < levelCount && request->m_state != TextureLoadState::CANCELLED; ++level)
+			{
+				const int levelWidth = TextureUtilities::GetMipmapDimension(width, level);
+				const int levelHeight = TextureUtilities::GetMipmapDimension(height, level);
+				request->m_levels[level].resize(size_t(TextureUtilities::GetDataSize(format, type, levelWidth, levelHeight)));
+
+				const int previousWidth = TextureUtilities::GetMipmapDimension(width, level - 1);
+				const int previousHeight = TextureUtilities::GetMipmapDimension(height, level - 1);
+				if(!TextureUtilities::GenerateMipmap(format, type, request->m_levels[level - 1].data(), previousWidth, previousHeight, request->m_levels[level].data()))
+					break;
+				generated = level + 1;
+			}
+			request->m_levels.resize(generated);
+			request->m_levelCount = generated;
+		}
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		TextureLoadState expected = TextureLoadState::DECODING;
+		if(request->m_state.compare_exchange_strong(expected, decoded ? TextureLoadState::UPLOADING : TextureLoadState::FAILED) && decoded)
+			m_decoded.push_back(request);
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if(--m_activeTasks == 0)
+		m_tasksFinished.notify_all();
+}
+
+/**
+ * \brief Remove and return the request with the highest priority from @requests.
+ * \return The request with the highest priority or nullptr when @requests is empty.
+ */
+GFW::TextureLoadHandle GFW::TextureLoader::PopHighestPriority(std::vector<TextureLoadHandle>& requests)
+{
+	if(requests.empty())
+		return nullptr;
+
+	auto highest = std::max_element(requests.begin(), requests.end(), [](const TextureLoadHandle& a, const TextureLoadHandle& b) { return a->m_priority < b->m_priority; });
+	TextureLoadHandle request = std::move(*highest);
+	*highest = std::move(requests.back());
+	requests.pop_back();
+	return request;
+}
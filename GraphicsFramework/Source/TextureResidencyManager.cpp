@@ -0,0 +1,209 @@
+#include <TextureResidencyManager.h>
+#include <algorithm>
+#include <limits>
+#include "Logging.h"
+#include "TextureUtilities.h"
+
+/**
+ * \param handler Handler that releases and restores the mipmap levels of the textures.
+ * \param budget The maximum amount of bytes the registered textures may use.
+ */
+GFW::TextureResidencyManager::TextureResidencyManager(ITextureResidencyHandler* handler, uint64_t budget) : m_handler(handler), m_budget(budget), m_residentSize(0),
+	m_requestedSize(0), m_frame(0), m_evictedLevels(0), m_restoredLevels(0)
+{
+	GFW_ASSERT(handler);
+}
+
+/**
+ * \brief Start managing a texture. All its levels are expected to be resident. Call Enforce() afterwards to bring the usage back within the budget.
+ * \param texture The texture to manage.
+ * \param description Description of the texture, used to calculate the size of every mipmap level.
+ */
+void GFW::TextureResidencyManager::Register(ITexture* texture, const TextureDescription& description)
+{
+	GFW_ASSERT(texture && description.levels > 0 && m_records.find(texture) == m_records.end());
+
+	Record& record = m_records[texture];
+	record.sizeFromLevel.resize(description.levels + 1, 0);
+	for(int level = description.levels - 1; level >= 0; --level)
+	{
+		record.sizeFromLevel[level] = record.sizeFromLevel[level + 1] + TextureUtilities::GetStorageSize(description.format, TextureUtilities::GetMipmapDimension(description.width, level),
+			TextureUtilities::GetMipmapDimension(description.height, level), TextureUtilities::GetMipmapDimension(description.depth, level)) * description.layers * description.faces;
+	}
+	record.lastUse = m_frame;
+
+	m_residentSize += record.sizeFromLevel[0];
+	m_requestedSize += record.sizeFromLevel[0];
+	if(description.levels > 1)
+		m_evictable.insert(LruKey(record.lastUse, texture));
+}
+
+/**
+ * \brief Stop managing a texture. Its levels aren't changed.
+ * \param texture The texture to forget.
+ */
+void GFW::TextureResidencyManager::Unregister(ITexture* texture)
+{
+	const auto it = m_records.find(texture);
+	if(it == m_records.end())
+		return;
+
+	m_evictable.erase(LruKey(it->second.lastUse, texture));
+	m_residentSize -= it->second.sizeFromLevel[it->second.firstResidentLevel];
+	m_requestedSize -= it->second.sizeFromLevel[0];
+	m_records.erase(it);
+}
+
+/**
+ * \brief Start a new frame. Textures used in the current frame are never evicted, so call this once per frame before touching the textures.
+ */
+void GFW::TextureResidencyManager::NextFrame()
+{
+	++m_frame;
+}
+
+/**
+ * \brief Mark a texture as used in the current frame and restore its levels up to @requiredLevel if they were released.
+ * \param texture The texture that's used.
+ * \param requiredLevel The finest mipmap level the texture needs.
+ */
+void GFW::TextureResidencyManager::Touch(ITexture* texture, int requiredLevel)
+{
+	const auto it = m_records.find(texture);
+	GFW_ASSERT(it != m_records.end());
+	Record& record = it->second;
+
+	const int levels = int(record.sizeFromLevel.size()) - 1;
+	m_evictable.erase(LruKey(record.lastUse, texture));
+	record.lastUse = m_frame;
+
+	requiredLevel = std::min(std::max(requiredLevel, 0), levels - 1);
+	if(record.firstResidentLevel > requiredLevel)
+		SetResidentLevels(texture, record, requiredLevel);
+
+	// Textures with only their smallest level resident have nothing left to release.
+	if(record.firstResidentLevel < levels - 1)
+		m_evictable.insert(LruKey(record.lastUse, texture));
+}
+
+/**
+ * \brief Release the finest mipmap levels of the least recently used textures until the resident size is within the budget.
+ * The smallest level of a texture is never released, and neither are textures used in the current frame.
+ * \return The amount of levels that were released.
+ */
+int GFW::TextureResidencyManager::Enforce()
+{
+	int evicted = 0;
+	while(m_residentSize > m_budget && !m_evictable.empty())
+	{
+		const LruKey key = *m_evictable.begin();
+		if(key.first == m_frame)
+			break;
+
+		Record& record = m_records[key.second];
+		const int smallestLevel = int(record.sizeFromLevel.size()) - 2;
+		if(record.firstResidentLevel < smallestLevel)
+		{
+			SetResidentLevels(key.second, record, record.firstResidentLevel + 1);
+			++evicted;
+		}
+
+		// Only the smallest level is left, so there's nothing more to release.
+		if(record.firstResidentLevel >= smallestLevel)
+			m_evictable.erase(m_evictable.begin());
+	}
+	return evicted;
+}
+
+/**
+ * \brief Change the budget. Call Enforce() afterwards to apply it.
+ * \param budget The maximum amount of bytes the registered textures may use.
+ */
+void GFW::TextureResidencyManager::SetBudget(uint64_t budget)
+{
+	m_budget = budget;
+}
+
+/**
+ * \return The maximum amount of bytes the registered textures may use.
+ */
+uint64_t GFW::TextureResidencyManager::GetBudget() const
+{
+	return m_budget;
+}
+
+/**
+ * \return The amount of bytes the resident levels of all textures use.
+ */
+uint64_t GFW::TextureResidencyManager::GetResidentSize() const
+{
+	return m_residentSize;
+}
+
+/**
+ * \return The amount of bytes all textures would use if all their levels were resident.
+ */
+uint64_t GFW::TextureResidencyManager::GetRequestedSize() const
+{
+	return m_requestedSize;
+}
+
+/**
+ * \return The ratio between the size all textures would use with all their levels resident and the budget. Above 1 levels have to be released.
+ */
+float GFW::TextureResidencyManager::GetPressure() const
+{
+	return m_budget == 0 ? (m_requestedSize == 0 ? 0.0f : std::numeric_limits<float>::infinity()) : float(double(m_requestedSize) / double(m_budget));
+}
+
+/**
+ * \return The amount of mipmap levels released since the manager was created.
+ */
+unsigned long long GFW::TextureResidencyManager::GetEvictedLevelCount() const
+{
+	return m_evictedLevels;
+}
+
+/**
+ * \return The amount of mipmap levels restored since the manager was created.
+ */
+unsigned long long GFW::TextureResidencyManager::GetRestoredLevelCount() const
+{
+	return m_restoredLevels;
+}
+
+/**
+ * \return The finest mipmap level of @texture that's resident.
+ */
+int GFW::TextureResidencyManager::GetFirstResidentLevel(ITexture* texture) const
+{
+	const auto it = m_records.find(texture);
+	GFW_ASSERT(it != m_records.end());
+	return it->second.firstResidentLevel;
+}
+
+/**
+ * \return The amount of bytes the resident levels of @texture use.
+ */
+uint64_t GFW::TextureResidencyManager::GetResidentSize(ITexture* texture) const
+{
+	const auto it = m_records.find(texture);
+	GFW_ASSERT(it != m_records.end());
+	return it->second.sizeFromLevel[it->second.firstResidentLevel];
+}
+
+/**
+ * \brief Let the handler change the resident levels of a texture and update the statistics.
+ */
+void GFW::TextureResidencyManager::SetResidentLevels(ITexture* texture, Record& record, int firstLevel)
+{
+	m_handler->SetResidentLevels(texture, firstLevel);
+
+	if(firstLevel > record.firstResidentLevel)
+		m_evictedLevels += firstLevel - record.firstResidentLevel;
+	else
+		m_restoredLevels += record.firstResidentLevel - firstLevel;
+
+	m_residentSize = m_residentSize - record.sizeFromLevel[record.firstResidentLevel] + record.sizeFromLevel[firstLevel];
+	record.firstResidentLevel = firstLevel;
+}
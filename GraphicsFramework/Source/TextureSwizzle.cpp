@@ -0,0 +1,354 @@
+#include <TextureSwizzle.h>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include "Logging.h"
+#include "Simd.h"
+
+namespace
+{
+	/**
+	 * \brief Index offsets along each axis of a layout. The index of texel (x, y, z) is x[x] + y[y] + z[z], which holds for every layout because they're all separable per axis.
+	 */
+	struct AxisOffsets
+	{
+		std::vector<uint64_t> x;	// Offset of every column.
+		std::vector<uint64_t> y;	// Offset of every row.
+		std::vector<uint64_t> z;	// Offset of every slice.
+		int runLength;				// Aligned runs of this many texels along x are stored contiguously.
+		bool mortonQuads;			// If 2x2 blocks at even coordinates are stored as 4 contiguous texels.
+	};
+
+	int GetTileSize(GFW::TextureLayout layout)
+	{
+		return layout == GFW::TextureLayout::TILED_4X4 ? 4 : layout == GFW::TextureLayout::TILED_8X8 ? 8 : 1;
+	}
+
+	int GetBitCount(int dimension)
+	{
+		int bits = 0;
+		while((1 << bits) < dimension)
+			++bits;
+		return bits;
+	}
+
+	void GetPaddedDimensions(GFW::TextureLayout layout, int width, int height, int depth, int& paddedWidth, int& paddedHeight, int& paddedDepth)
+	{
+		if(layout == GFW::TextureLayout::MORTON)
+		{
+			paddedWidth = 1 << GetBitCount(width);
+			paddedHeight = 1 << GetBitCount(height);
+			paddedDepth = 1 << GetBitCount(depth);
+			return;
+		}
+
+		const int tileSize = GetTileSize(layout);
+		paddedWidth = (width + tileSize - 1) / tileSize * tileSize;
+		paddedHeight = (height + tileSize - 1) / tileSize * tileSize;
+		paddedDepth = depth;
+	}
+
+	/**
+	 * \brief Calculate which bits of the Morton index belong to which axis. Bits are interleaved x, y, z from the lowest bit, axes that run out of bits are skipped.
+	 */
+	void GetMortonMasks(int width, int height, int depth, uint64_t masks[3])
+	{
+		const int bits[3] = { GetBitCount(width), GetBitCount(height), GetBitCount(depth) };
+		masks[0] = masks[1] = masks[2] = 0;
+		int outputBit = 0;
+		for(int bit = 0; bit < std::max(bits[0], std::max(bits[1], bits[2])); ++bit)
+		{
+			for(int axis = 0; axis < 3; ++axis)
+			{
+				if(bit < bits[axis])
+					masks[axis] |= uint64_t(1) << outputBit++;
+			}
+		}
+	}
+
+	/**
+	 * \brief Spread the bits of @value over the set bits of @mask, from low to high.
+	 */
+	uint64_t DepositBits(uint64_t value, uint64_t mask)
+	{
+		uint64_t result = 0;
+		for(uint64_t bit = 1; mask != 0 && value != 0; bit <<= 1)
+		{
+			if(mask & bit)
+			{
+				if(value & 1)
+					result |= bit;
+				value >>= 1;
+				mask &= ~bit;
+			}
+		}
+		return result;
+	}
+
+	void BuildAxisOffsets(GFW::TextureLayout layout, int width, int height, int depth, AxisOffsets& offsets)
+	{
+		int paddedWidth, paddedHeight, paddedDepth;
+		GetPaddedDimensions(layout, width, height, depth, paddedWidth, paddedHeight, paddedDepth);
+		offsets.x.resize(width);
+		offsets.y.resize(height);
+		offsets.z.resize(depth);
+		offsets.mortonQuads = false;
+
+		if(layout == GFW::TextureLayout::MORTON)
+		{
+			uint64_t masks[3];
+			GetMortonMasks(paddedWidth, paddedHeight, paddedDepth, masks);
+			for(int i = 0; i < width; ++i)
+				offsets.x[i] = DepositBits(uint64_t(i), masks[0]);
+			for(int i = 0; i < height; ++i)
+				offsets.y[i] = DepositBits(uint64_t(i), masks[1]);
+			for(int i = 0; i < depth; ++i)
+				offsets.z[i] = DepositBits(uint64_t(i), masks[2]);
+			offsets.runLength = paddedWidth > 1 ? 2 : 1;
+			offsets.mortonQuads = paddedWidth > 1 && paddedHeight > 1;
+			return;
+		}
+
+		if(layout == GFW::TextureLayout::LINEAR)
+		{
+			for(int i = 0; i < width; ++i)
+				offsets.x[i] = uint64_t(i);
+			for(int i = 0; i < height; ++i)
+				offsets.y[i] = uint64_t(i) * width;
+			offsets.runLength = width;
+		}
+		else
+		{
+			const uint64_t tileSize = uint64_t(GetTileSize(layout));
+			for(int i = 0; i < width; ++i)
+				offsets.x[i] = i / tileSize * tileSize * tileSize + i % tileSize;
+			for(int i = 0; i < height; ++i)
+				offsets.y[i] = i / tileSize * paddedWidth * tileSize + i % tileSize * tileSize;
+			offsets.runLength = int(tileSize);
+		}
+		for(int i = 0; i < depth; ++i)
+			offsets.z[i] = uint64_t(i) * paddedWidth * paddedHeight;
+	}
+
+	/**
+	 * \brief Copy @size bytes, using 16 byte vector copies for the bulk so short tile rows don't go through memcpy.
+	 */
+	inline void CopyBytes(unsigned char* destination, const unsigned char* source, size_t size)
+	{
+#ifdef GFW_SSE2
+		for(; size >= 16; size -= 16, source += 16, destination += 16)
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination), _mm_loadu_si128(reinterpret_cast<const __m128i*>(source)));
+#endif
+		memcpy(destination, source, size);
+	}
+
+	/**
+	 * \brief Copy texels [@begin, @end) of a row of the region between the linear data and the layout, one contiguous run at a time.
+	 */
+	template<bool toLayout>
+	void CopyRow(const AxisOffsets& offsets, int pixelSize, int x, uint64_t rowOffset, int begin, int end, unsigned char* linearRow, unsigned char* layoutData)
+	{
+		while(begin < end)
+		{
+			const int texelX = x + begin;
+			const int count = std::min(end - begin, (texelX / offsets.runLength + 1) * offsets.runLength - texelX);
+			unsigned char* linear = linearRow + size_t(begin) * pixelSize;
+			unsigned char* layout = layoutData + (rowOffset + offsets.x[texelX]) * pixelSize;
+			if(toLayout)
+				CopyBytes(layout, linear, size_t(count) * pixelSize);
+			else
+				CopyBytes(linear, layout, size_t(count) * pixelSize);
+			begin += count;
+		}
+	}
+
+	/**
+	 * \brief Copy two rows of 4 byte texels at once in Morton layout. Two texels of both rows form a 2x2 block that's contiguous in the layout,
+	 * so 4 texels of both rows are shuffled into two blocks with 64 bit unpacks.
+	 */
+	template<bool toLayout>
+	void CopyMortonRowPair(const AxisOffsets& offsets, int x, uint64_t rowOffset, uint64_t nextRowOffset, int width, unsigned char* linearRow0, unsigned char* linearRow1,
+		unsigned char* layoutData)
+	{
+		int begin = 0;
+		if(x & 1)
+		{
+			CopyRow<toLayout>(offsets, 4, x, rowOffset, 0, 1, linearRow0, layoutData);
+			CopyRow<toLayout>(offsets, 4, x, nextRowOffset, 0, 1, linearRow1, layoutData);
+			begin = 1;
+		}
+
+#ifdef GFW_SSE2
+		for(; begin + 4 <= width; begin += 4)
+		{
+			__m128i* row0 = reinterpret_cast<__m128i*>(linearRow0 + begin * 4);
+			__m128i* row1 = reinterpret_cast<__m128i*>(linearRow1 + begin * 4);
+			__m128i* block0 = reinterpret_cast<__m128i*>(layoutData + (rowOffset + offsets.x[x + begin]) * 4);
+			__m128i* block1 = reinterpret_cast<__m128i*>(layoutData + (rowOffset + offsets.x[x + begin + 2]) * 4);
+			if(toLayout)
+			{
+				const __m128i texels0 = _mm_loadu_si128(row0);
+				const __m128i texels1 = _mm_loadu_si128(row1);
+				_mm_storeu_si128(block0, _mm_unpacklo_epi64(texels0, texels1));
+				_mm_storeu_si128(block1, _mm_unpackhi_epi64(texels0, texels1));
+			}
+			else
+			{
+				const __m128i texels0 = _mm_loadu_si128(block0);
+				const __m128i texels1 = _mm_loadu_si128(block1);
+				_mm_storeu_si128(row0, _mm_unpacklo_epi64(texels0, texels1));
+				_mm_storeu_si128(row1, _mm_unpackhi_epi64(texels0, texels1));
+			}
+		}
+#endif
+
+		CopyRow<toLayout>(offsets, 4, x, rowOffset, begin, width, linearRow0, layoutData);
+		CopyRow<toLayout>(offsets, 4, x, nextRowOffset, begin, width, linearRow1, layoutData);
+	}
+
+	template<bool toLayout>
+	void CopyRegion(GFW::TextureLayout layout, int pixelSize, int width, int height, int depth, int x, int y, int z, int regionWidth, int regionHeight, int regionDepth,
+		unsigned char* linearData, unsigned char* layoutData)
+	{
+		GFW_ASSERT(pixelSize > 0 && x >= 0 && y >= 0 && z >= 0 && regionWidth >= 0 && regionHeight >= 0 && regionDepth >= 0 &&
+			x + regionWidth <= width && y + regionHeight <= height && z + regionDepth <= depth);
+
+		AxisOffsets offsets;
+		BuildAxisOffsets(layout, width, height, depth, offsets);
+		const size_t rowSize = size_t(regionWidth) * pixelSize;
+
+		for(int slice = 0; slice < regionDepth; ++slice)
+		{
+			unsigned char* linearSlice = linearData + size_t(slice) * regionHeight * rowSize;
+			for(int row = 0; row < regionHeight; ++row)
+			{
+				const uint64_t rowOffset = offsets.y[y + row] + offsets.z[z + slice];
+				if(offsets.mortonQuads && pixelSize == 4 && ((y + row) & 1) == 0 && row + 1 < regionHeight)
+				{
+					CopyMortonRowPair<toLayout>(offsets, x, rowOffset, offsets.y[y + row + 1] + offsets.z[z + slice], regionWidth,
+						linearSlice + row * rowSize, linearSlice + (row + 1) * rowSize, layoutData);
+					++row;
+				}
+				else
+					CopyRow<toLayout>(offsets, pixelSize, x, rowOffset, 0, regionWidth, linearSlice + row * rowSize, layoutData);
+			}
+		}
+	}
+}
+
+/**
+ * \param layout The layout of the data.
+ * \param pixelSize The size in bytes of a texel.
+ * \param width The width of the texture.
+ * \param height The height of the texture.
+ * \param depth The depth of the texture.
+ * \return The size in bytes of a texture stored in @layout, including padding.
+ */
+uint64_t GFW::TextureSwizzle::GetLayoutSize(TextureLayout layout, int pixelSize, int width, int height, int depth)
+{
+	int paddedWidth, paddedHeight, paddedDepth;
+	GetPaddedDimensions(layout, width, height, depth, paddedWidth, paddedHeight, paddedDepth);
+	return uint64_t(paddedWidth) * paddedHeight * paddedDepth * pixelSize;
+}
+
+/**
+ * \brief Calculate where a texel is stored in a layout. Convenient for random access, use Swizzle() and Unswizzle() to convert whole regions.
+ * \param layout The layout of the data.
+ * \param width The width of the texture.
+ * \param height The height of the texture.
+ * \param depth The depth of the texture.
+ * \param x The column of the texel.
+ * \param y The row of the texel.
+ * \param z The slice of the texel.
+ * \return The index of the texel, multiply by the pixel size for the offset in bytes.
+ */
+uint64_t GFW::TextureSwizzle::GetTexelIndex(TextureLayout layout, int width, int height, int depth, int x, int y, int z)
+{
+	int paddedWidth, paddedHeight, paddedDepth;
+	GetPaddedDimensions(layout, width, height, depth, paddedWidth, paddedHeight, paddedDepth);
+
+	if(layout == TextureLayout::MORTON)
+	{
+		uint64_t masks[3];
+		GetMortonMasks(paddedWidth, paddedHeight, paddedDepth, masks);
+		return DepositBits(uint64_t(x), masks[0]) | DepositBits(uint64_t(y), masks[1]) | DepositBits(uint64_t(z), masks[2]);
+	}
+
+	const uint64_t tileSize = uint64_t(GetTileSize(layout));
+	const uint64_t tile = (uint64_t(z) * (paddedHeight / tileSize) + y / tileSize) * (paddedWidth / tileSize) + x / tileSize;
+	return tile * tileSize * tileSize + y % tileSize * tileSize + x % tileSize;
+}
+
+/**
+ * \brief Convert a whole texture from linear to @layout.
+ * \param layout The layout to convert to.
+ * \param pixelSize The size in bytes of a texel.
+ * \param width The width of the texture.
+ * \param height The height of the texture.
+ * \param depth The depth of the texture.
+ * \param source The tightly packed linear texel data.
+ * \param destination The data in @layout, at least GetLayoutSize() bytes. Padding isn't written.
+ */
+void GFW::TextureSwizzle::Swizzle(TextureLayout layout, int pixelSize, int width, int height, int depth, const unsigned char* source, unsigned char* destination)
+{
+	Swizzle(layout, pixelSize, width, height, depth, 0, 0, 0, width, height, depth, source, destination);
+}
+
+/**
+ * \brief Write a region of linear texel data into a texture stored in @layout, the counterpart of ITexture::UpdateTexture().
+ * \param layout The layout of the destination.
+ * \param pixelSize The size in bytes of a texel.
+ * \param width The width of the texture.
+ * \param height The height of the texture.
+ * \param depth The depth of the texture.
+ * \param x The column to start writing at.
+ * \param y The row to start writing at.
+ * \param z The slice to start writing at.
+ * \param regionWidth The width in texels to write.
+ * \param regionHeight The height in texels to write.
+ * \param regionDepth The depth in texels to write.
+ * \param source The tightly packed linear texel data of the region.
+ * \param destination The texture data in @layout.
+ */
+void GFW::TextureSwizzle::Swizzle(TextureLayout layout, int pixelSize, int width, int height, int depth, int x, int y, int z, int regionWidth, int regionHeight, int regionDepth,
+	const unsigned char* source, unsigned char* destination)
+{
+	CopyRegion<true>(layout, pixelSize, width, height, depth, x, y, z, regionWidth, regionHeight, regionDepth, const_cast<unsigned char*>(source), destination);
+}
+
+/**
+ * \brief Convert a whole texture from @layout to linear.
+ * \param layout The layout to convert from.
+ * \param pixelSize The size in bytes of a texel.
+ * \param width The width of the texture.
+ * \param height The height of the texture.
+ * \param depth The depth of the texture.
+ * \param source The data in @layout.
+ * \param destination The tightly packed linear texel data.
+ */
+void GFW::TextureSwizzle::Unswizzle(TextureLayout layout, int pixelSize, int width, int height, int depth, const unsigned char* source, unsigned char* destination)
+{
+	Unswizzle(layout, pixelSize, width, height, depth, 0, 0, 0, width, height, depth, source, destination);
+}
+
+/**
+ * \brief Read a region of a texture stored in @layout into linear texel data, used when reading back or exporting.
+ * \param layout The layout of the source.
+ * \param pixelSize The size in bytes of a texel.
+ * \param width The width of the texture.
+ * \param height The height of the texture.
+ * \param depth The depth of the texture.
+ * \param x The column to start reading at.
+ * \param y The row to start reading at.
+ * \param z The slice to start reading at.
+ * \param regionWidth The width in texels to read.
+ * \param regionHeight The height in texels to read.
+ * \param regionDepth The depth in texels to read.
+ * \param source The texture data in @layout.
+ * \param destination The tightly packed linear texel data of the region.
+ */
+void GFW::TextureSwizzle::Unswizzle(TextureLayout layout, int pixelSize, int width, int height, int depth, int x, int y, int z, int regionWidth, int regionHeight, int regionDepth,
+	const unsigned char* source, unsigned char* destination)
+{
+	CopyRegion<false>(layout, pixelSize, width, height, depth, x, y, z, regionWidth, regionHeight, regionDepth, destination, const_cast<unsigned char*>(source));
+}
@@ -0,0 +1,463 @@
+#include <TextureUtilities.h>
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+#include "Logging.h"
+#include "Simd.h"
+
+namespace
+{
+	/**
+	 * \brief Averages 2x2 blocks of texels, clamping to the edge for odd dimensions.
+	 */
+	template<typename ComponentType, typename SumType>
+	void BoxFilter(const unsigned char* source, int width, int height, int channels, unsigned char* destination)
+	{
+		const ComponentType* src = reinterpret_cast<const ComponentType*>(source);
+		ComponentType* dst = reinterpret_cast<ComponentType*>(destination);
+		const int dstWidth = std::max(width / 2, 1);
+		const int dstHeight = std::max(height / 2, 1);
+
+		for(int y = 0; y < dstHeight; ++y)
+		{
+			const ComponentType* row0 = src + size_t(std::min(y * 2, height - 1)) * width * channels;
+			const ComponentType* row1 = src + size_t(std::min(y * 2 + 1, height - 1)) * width * channels;
+			for(int x = 0; x < dstWidth; ++x)
+			{
+				const int x0 = std::min(x * 2, width - 1) * channels;
+				const int x1 = std::min(x * 2 + 1, width - 1) * channels;
+				for(int c = 0; c < channels; ++c)
+				{
+					const SumType sum = SumType(row0[x0 + c]) + SumType(row0[x1 + c]) + SumType(row1[x0 + c]) + SumType(row1[x1 + c]);
+					*dst++ = std::is_floating_point<ComponentType>::value ? ComponentType(sum * SumType(0.25)) : ComponentType((sum + SumType(2)) / SumType(4));
+				}
+			}
+		}
+	}
+
+	/**
+	 * \brief Averages 2x2 blocks of half float texels in single precision.
+	 */
+	void BoxFilterHalf(const unsigned char* source, int width, int height, int channels, unsigned char* destination)
+	{
+		const uint16_t* src = reinterpret_cast<const uint16_t*>(source);
+		uint16_t* dst = reinterpret_cast<uint16_t*>(destination);
+		const int dstWidth = std::max(width / 2, 1);
+		const int dstHeight = std::max(height / 2, 1);
+
+		for(int y = 0; y < dstHeight; ++y)
+		{
+			const uint16_t* row0 = src + size_t(std::min(y * 2, height - 1)) * width * channels;
+			const uint16_t* row1 = src + size_t(std::min(y * 2 + 1, height - 1)) * width * channels;
+			for(int x = 0; x < dstWidth; ++x)
+			{
+				const int x0 = std::min(x * 2, width - 1) * channels;
+				const int x1 = std::min(x * 2 + 1, width - 1) * channels;
+				for(int c = 0; c < channels; ++c)
+				{
+					const float sum = GFW::TextureUtilities::HalfToFloat(row0[x0 + c]) + GFW::TextureUtilities::HalfToFloat(row0[x1 + c]) +
+						GFW::TextureUtilities::HalfToFloat(row1[x0 + c]) + GFW::TextureUtilities::HalfToFloat(row1[x1 + c]);
+					*dst++ = GFW::TextureUtilities::FloatToHalf(sum * 0.25f);
+				}
+			}
+		}
+	}
+}
+
+/**
+ * \return If @format is a block compressed format.
+ */
+bool GFW::TextureUtilities::IsCompressed(TextureFormat format)
+{
+	return format >= TextureFormat::COMPRESSED_RGB_S3TC_DXT1;
+}
+
+/**
+ * \return If @format is meant for depth or stencil framebuffers.
+ */
+bool GFW::TextureUtilities::IsDepthOrStencil(TextureFormat format)
+{
+	return format >= TextureFormat::DEPTH_COMPONENT16 && format <= TextureFormat::STENCIL_INDEX8;
+}
+
+/**
+ * \return If @format stores unnormalized integers, which can't be filtered or averaged.
+ */
+bool GFW::TextureUtilities::IsInteger(TextureFormat format)
+{
+	return format >= TextureFormat::R8I && format <= TextureFormat::RGBA32UI;
+}
+
+/**
+ * \return The amount of channels per pixel of @format.
+ */
+int GFW::TextureUtilities::GetChannelCount(TextureFormat format)
+{
+	switch(format)
+	{
+	case TextureFormat::RG8: case TextureFormat::RG8_SNORM: case TextureFormat::RG16: case TextureFormat::RG16_SNORM:
+	case TextureFormat::RG16F: case TextureFormat::RG32F: case TextureFormat::RG8I: case TextureFormat::RG8UI:
+	case TextureFormat::RG16I: case TextureFormat::RG16UI: case TextureFormat::RG32I: case TextureFormat::RG32UI:
+		return 2;
+	case TextureFormat::RGB16_SNORM: case TextureFormat::RGB32F: case TextureFormat::RGB32I: case TextureFormat::RGB32UI:
+	case TextureFormat::COMPRESSED_RGB_S3TC_DXT1: case TextureFormat::COMPRESSED_SRGB_S3TC_DXT1:
+		return 3;
+	case TextureFormat::RGBA8: case TextureFormat::RGBA8_SNORM: case TextureFormat::RGBA16: case TextureFormat::RGBA16F:
+	case TextureFormat::RGBA32F: case TextureFormat::RGBA8I: case TextureFormat::RGBA8UI: case TextureFormat::RGBA16I:
+	case TextureFormat::RGBA16UI: case TextureFormat::RGBA32I: case TextureFormat::RGBA32UI:
+	case TextureFormat::COMPRESSED_RGBA_S3TC_DXT1: case TextureFormat::COMPRESSED_SRGB_ALPHA_S3TC_DXT1:
+	case TextureFormat::COMPRESSED_RGBA_S3TC_DXT3: case TextureFormat::COMPRESSED_SRGB_ALPHA_S3TC_DXT3:
+	case TextureFormat::COMPRESSED_RGBA_S3TC_DXT5: case TextureFormat::COMPRESSED_SRGB_ALPHA_S3TC_DXT5:
+		return 4;
+	default:
+		return 1;
+	}
+}
+
+/**
+ * \return The amount of bytes a single pixel of @format takes up in the storage of the graphics API. 0 for compressed formats.
+ */
+int GFW::TextureUtilities::GetBytesPerPixel(TextureFormat format)
+{
+	switch(format)
+	{
+	case TextureFormat::R8: case TextureFormat::R8_SNORM: case TextureFormat::R8I: case TextureFormat::R8UI:
+	case TextureFormat::STENCIL_INDEX8:
+		return 1;
+	case TextureFormat::R16: case TextureFormat::R16_SNORM: case TextureFormat::RG8: case TextureFormat::RG8_SNORM:
+	case TextureFormat::R16F: case TextureFormat::R16I: case TextureFormat::R16UI: case TextureFormat::RG8I:
+	case TextureFormat::RG8UI: case TextureFormat::DEPTH_COMPONENT16:
+		return 2;
+	case TextureFormat::RGB16_SNORM:
+		return 6;
+	case TextureFormat::RG16: case TextureFormat::RG16_SNORM: case TextureFormat::RGBA8: case TextureFormat::RGBA8_SNORM:
+	case TextureFormat::RG16F: case TextureFormat::R32F: case TextureFormat::R32I: case TextureFormat::R32UI:
+	case TextureFormat::RG16I: case TextureFormat::RG16UI: case TextureFormat::RGBA8I: case TextureFormat::RGBA8UI:
+	case TextureFormat::DEPTH_COMPONENT24: case TextureFormat::DEPTH_COMPONENT32: case TextureFormat::DEPTH_COMPONENT32F:
+	case TextureFormat::DEPTH24_STENCIL8:
+		return 4;
+	case TextureFormat::RGBA16: case TextureFormat::RGBA16F: case TextureFormat::RG32F: case TextureFormat::RG32I:
+	case TextureFormat::RG32UI: case TextureFormat::RGBA16I: case TextureFormat::RGBA16UI: case TextureFormat::DEPTH32F_STENCIL8:
+		return 8;
+	case TextureFormat::RGB32F: case TextureFormat::RGB32I: case TextureFormat::RGB32UI:
+		return 12;
+	case TextureFormat::RGBA32F: case TextureFormat::RGBA32I: case TextureFormat::RGBA32UI:
+		return 16;
+	default:
+		return 0;
+	}
+}
+
+/**
+ * \return The amount of bytes a 4x4 block of pixels of the compressed @format takes up. 0 for uncompressed formats.
+ */
+int GFW::TextureUtilities::GetCompressedBlockSize(TextureFormat format)
+{
+	switch(format)
+	{
+	case TextureFormat::COMPRESSED_RGB_S3TC_DXT1: case TextureFormat::COMPRESSED_SRGB_S3TC_DXT1:
+	case TextureFormat::COMPRESSED_RGBA_S3TC_DXT1: case TextureFormat::COMPRESSED_SRGB_ALPHA_S3TC_DXT1:
+		return 8;
+	case TextureFormat::COMPRESSED_RGBA_S3TC_DXT3: case TextureFormat::COMPRESSED_SRGB_ALPHA_S3TC_DXT3:
+	case TextureFormat::COMPRESSED_RGBA_S3TC_DXT5: case TextureFormat::COMPRESSED_SRGB_ALPHA_S3TC_DXT5:
+		return 16;
+	default:
+		return 0;
+	}
+}
+
+/**
+ * \return The data type that matches the components of @format without any conversion.
+ */
+GFW::TextureDataType GFW::TextureUtilities::GetDefaultDataType(TextureFormat format)
+{
+	switch(format)
+	{
+	case TextureFormat::R8_SNORM: case TextureFormat::RG8_SNORM: case TextureFormat::RGBA8_SNORM:
+	case TextureFormat::R8I: case TextureFormat::RG8I: case TextureFormat::RGBA8I:
+		return TextureDataType::GL_BYTE;
+	case TextureFormat::R16: case TextureFormat::RG16: case TextureFormat::RGBA16: case TextureFormat::R16UI:
+	case TextureFormat::RG16UI: case TextureFormat::RGBA16UI: case TextureFormat::DEPTH_COMPONENT16:
+		return TextureDataType::GL_UNSIGNED_SHORT;
+	case TextureFormat::R16_SNORM: case TextureFormat::RG16_SNORM: case TextureFormat::RGB16_SNORM:
+	case TextureFormat::R16I: case TextureFormat::RG16I: case TextureFormat::RGBA16I:
+		return TextureDataType::GL_SHORT;
+	case TextureFormat::R16F: case TextureFormat::RG16F: case TextureFormat::RGBA16F: case TextureFormat::R32F:
+	case TextureFormat::RG32F: case TextureFormat::RGB32F: case TextureFormat::RGBA32F: case TextureFormat::DEPTH_COMPONENT32F:
+	case TextureFormat::DEPTH32F_STENCIL8:
+		return TextureDataType::GL_FLOAT;
+	case TextureFormat::R32I: case TextureFormat::RG32I: case TextureFormat::RGB32I: case TextureFormat::RGBA32I:
+		return TextureDataType::GL_INT;
+	case TextureFormat::R32UI: case TextureFormat::RG32UI: case TextureFormat::RGB32UI: case TextureFormat::RGBA32UI:
+	case TextureFormat::DEPTH_COMPONENT24: case TextureFormat::DEPTH_COMPONENT32: case TextureFormat::DEPTH24_STENCIL8:
+		return TextureDataType::GL_UNSIGNED_INT;
+	default:
+		return TextureDataType::GL_UNSIGNED_BYTE;
+	}
+}
+
+/**
+ * \return The size in bytes of a single component of @type.
+ */
+int GFW::TextureUtilities::GetDataTypeSize(TextureDataType type)
+{
+	switch(type)
+	{
+	case TextureDataType::GL_UNSIGNED_SHORT: case TextureDataType::GL_SHORT: case TextureDataType::GL_HALF_FLOAT:
+		return 2;
+	case TextureDataType::GL_UNSIGNED_INT: case TextureDataType::GL_INT: case TextureDataType::GL_FLOAT:
+		return 4;
+	default:
+		return 1;
+	}
+}
+
+/**
+ * \return The size in bytes of a single pixel of client side pixel data with @format and @type. 0 for compressed formats.
+ */
+int GFW::TextureUtilities::GetPixelSize(TextureFormat format, TextureDataType type)
+{
+	return IsCompressed(format) ? 0 : GetChannelCount(format) * GetDataTypeSize(type);
+}
+
+/**
+ * \return The maximum amount of samples per pixel of @sampleCount.
+ */
+int GFW::TextureUtilities::GetSampleCount(TextureMultisampleCount sampleCount)
+{
+	return 1 << int(sampleCount);
+}
+
+/**
+ * \return The amount of mipmap levels in a full mipmap chain, including the base level.
+ */
+int GFW::TextureUtilities::GetMipmapCount(int width, int height, int depth)
+{
+	int levels = 1;
+	for(int size = std::max(std::max(width, height), depth); size > 1; size >>= 1)
+		++levels;
+	return levels;
+}
+
+/**
+ * \return The size of @dimension at mipmap @level.
+ */
+int GFW::TextureUtilities::GetMipmapDimension(int dimension, int level)
+{
+	return std::max(dimension >> level, 1);
+}
+
+/**
+ * \return The size in bytes of a tightly packed row of client side pixel data. For compressed formats this is a row of 4x4 blocks.
+ */
+uint64_t GFW::TextureUtilities::GetRowSize(TextureFormat format, TextureDataType type, int width)
+{
+	if(IsCompressed(format))
+		return uint64_t((width + 3) / 4) * GetCompressedBlockSize(format);
+	return uint64_t(width) * GetPixelSize(format, type);
+}
+
+/**
+ * \return The size in bytes of tightly packed client side pixel data with the given dimensions.
+ */
+uint64_t GFW::TextureUtilities::GetDataSize(TextureFormat format, TextureDataType type, int width, int height, int depth)
+{
+	const int rows = IsCompressed(format) ? (height + 3) / 4 : height;
+	return GetRowSize(format, type, width) * rows * depth;
+}
+
+/**
+ * \return The size in bytes the graphics API needs to store a single image with the given dimensions.
+ */
+uint64_t GFW::TextureUtilities::GetStorageSize(TextureFormat format, int width, int height, int depth)
+{
+	if(IsCompressed(format))
+		return uint64_t((width + 3) / 4) * ((height + 3) / 4) * depth * GetCompressedBlockSize(format);
+	return uint64_t(width) * height * depth * GetBytesPerPixel(format);
+}
+
+/**
+ * \brief Calculate the size in bytes the graphics API needs to store a texture including its mipmaps.
+ * \param format The format of the texture.
+ * \param width The width of the base level.
+ * \param height The height of the base level.
+ * \param depth The depth of the base level. Halves every mipmap level.
+ * \param layers The amount of array layers or cubemap faces. Stays the same for every mipmap level.
+ * \param levels The amount of mipmap levels, including the base level.
+ * \return The size in bytes of the texture.
+ */
+uint64_t GFW::TextureUtilities::GetStorageSize(TextureFormat format, int width, int height, int depth, int layers, int levels)
+{
+	uint64_t size = 0;
+	for(int level = 0; level < levels; ++level)
+		size += GetStorageSize(format, GetMipmapDimension(width, level), GetMipmapDimension(height, level), GetMipmapDimension(depth, level));
+	return size * layers;
+}
+
+/**
+ * \brief Convert a float to a half float, rounding to nearest even. Values too large for a half float become infinity.
+ * \param value The value to convert.
+ * \return The bits of the half float.
+ */
+uint16_t GFW::TextureUtilities::FloatToHalf(float value)
+{
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	const uint16_t sign = uint16_t((bits >> 16) & 0x8000);
+	bits &= 0x7FFFFFFF;
+
+	// Too large for a half float, infinity or NaN.
+	if(bits >= 0x47800000)
+		return sign | (bits > 0x7F800000 ? 0x7E00 : 0x7C00);
+
+	// Denormal half floats, rounded by letting the FPU align the mantissa against 0.5.
+	if(bits < 0x38800000)
+	{
+		float denormal;
+		memcpy(&denormal, &bits, sizeof(denormal));
+		denormal += 0.5f;
+		memcpy(&bits, &denormal, sizeof(bits));
+		return sign | uint16_t(bits - 0x3F000000);
+	}
+
+	// Rebias the exponent and round the mantissa to nearest even.
+	const uint32_t mantissaOdd = (bits >> 13) & 1;
+	bits += 0xC8000FFF + mantissaOdd;
+	return sign | uint16_t(bits >> 13);
+}
+
+/**
+ * \brief Convert a half float to a float. Every half float can be represented exactly.
+ * \param value The bits of the half float.
+ * \return The value as float.
+ */
+float GFW::TextureUtilities::HalfToFloat(uint16_t value)
+{
+	uint32_t bits = uint32_t(value & 0x7FFF) << 13;
+	const uint32_t exponent = bits & 0x0F800000;
+	bits += (127 - 15) << 23;
+
+	float result;
+	if(exponent == 0x0F800000)
+	{
+		// Infinity or NaN.
+		bits += (128 - 16) << 23;
+		memcpy(&result, &bits, sizeof(result));
+	}
+	else if(exponent == 0)
+	{
+		// Denormal, renormalized by the FPU.
+		bits += 1 << 23;
+		memcpy(&result, &bits, sizeof(result));
+		result -= 6.103515625e-05f;
+	}
+	else
+		memcpy(&result, &bits, sizeof(result));
+	return (value & 0x8000) ? -result : result;
+}
+
+/**
+ * \brief Read a single component of client side pixel data as float.
+ * \param data The pixel data.
+ * \param type The type of @data. Unsigned bytes, unsigned shorts, floats and half floats are supported.
+ * \param index The index of the component in @data.
+ * \return The component, normalized to [0, 1] for unsigned bytes and shorts.
+ */
+float GFW::TextureUtilities::ReadComponent(const unsigned char* data, TextureDataType type, size_t index)
+{
+	switch(type)
+	{
+	case TextureDataType::GL_UNSIGNED_BYTE:
+		return data[index] * (1.0f / 255.0f);
+	case TextureDataType::GL_UNSIGNED_SHORT:
+		return reinterpret_cast<const uint16_t*>(data)[index] * (1.0f / 65535.0f);
+	case TextureDataType::GL_HALF_FLOAT:
+		return HalfToFloat(reinterpret_cast<const uint16_t*>(data)[index]);
+	default:
+		GFW_ASSERT(type == TextureDataType::GL_FLOAT);
+		return reinterpret_cast<const float*>(data)[index];
+	}
+}
+
+/**
+ * \brief Copy rows of pixel data between images with different row and slice pitches, like a region of a larger image into a tightly packed buffer.
+ * Rows are copied with 64 byte vector moves when SSE2 is available.
+ * \param source The first row to copy.
+ * \param sourceRowPitch The distance in bytes between the starts of two rows in @source.
+ * \param sourceSlicePitch The distance in bytes between the starts of two slices in @source.
+ * \param destination The memory to copy the rows to.
+ * \param destinationRowPitch The distance in bytes between the starts of two rows in @destination.
+ * \param destinationSlicePitch The distance in bytes between the starts of two slices in @destination.
+ * \param rowSize The amount of bytes to copy of every row. See GetRowSize().
+ * \param rows The amount of rows to copy per slice, rows of blocks for compressed formats.
+ * \param slices The amount of slices to copy.
+ */
+void GFW::TextureUtilities::CopyPitched(const unsigned char* source, uint64_t sourceRowPitch, uint64_t sourceSlicePitch, unsigned char* destination, uint64_t destinationRowPitch,
+	uint64_t destinationSlicePitch, uint64_t rowSize, int rows, int slices)
+{
+	GFW_ASSERT(rowSize <= sourceRowPitch && rowSize <= destinationRowPitch);
+
+	// Both sides tightly packed, so everything is a single copy.
+	if(rowSize == sourceRowPitch && rowSize == destinationRowPitch && (slices == 1 || (sourceSlicePitch == rowSize * rows && destinationSlicePitch == rowSize * rows)))
+	{
+		memcpy(destination, source, size_t(rowSize * rows * slices));
+		return;
+	}
+
+	for(int slice = 0; slice < slices; ++slice)
+	{
+		for(int row = 0; row < rows; ++row)
+		{
+			const unsigned char* src = source + sourceSlicePitch * slice + sourceRowPitch * row;
+			unsigned char* dst = destination + destinationSlicePitch * slice + destinationRowPitch * row;
+			size_t size = size_t(rowSize);
+#ifdef GFW_SSE2
+			for(; size >= 64; size -= 64, src += 64, dst += 64)
+			{
+				const __m128i data0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+				const __m128i data1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 16));
+				const __m128i data2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 32));
+				const __m128i data3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 48));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst), data0);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 16), data1);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 32), data2);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 48), data3);
+			}
+			for(; size >= 16; size -= 16, src += 16, dst += 16)
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_loadu_si128(reinterpret_cast<const __m128i*>(src)));
+#endif
+			memcpy(dst, src, size);
+		}
+	}
+}
+
+/**
+ * \brief Generate the next mipmap level of an image by averaging 2x2 blocks of pixels.
+ * \param format The format of the image.
+ * \param type The type of @source and @destination.
+ * \param source Tightly packed pixel data of the image.
+ * \param width The width of the image.
+ * \param height The height of the image. 1 for a 1D image.
+ * \param destination Output for the tightly packed pixel data of the next level. Must be large enough to hold max(width / 2, 1) * max(height / 2, 1) pixels.
+ * \return False if mipmaps can't be generated on the CPU for @format, which is the case for compressed formats.
+ */
+bool GFW::TextureUtilities::GenerateMipmap(TextureFormat format, TextureDataType type, const unsigned char* source, int width, int height, unsigned char* destination)
+{
+	GFW_ASSERT(source != nullptr && destination != nullptr);
+	if(IsCompressed(format))
+		return false;
+
+	const int channels = GetChannelCount(format);
+	switch(type)
+	{
+	case TextureDataType::GL_UNSIGNED_BYTE: BoxFilter<uint8_t, uint32_t>(source, width, height, channels, destination); break;
+	case TextureDataType::GL_BYTE: BoxFilter<int8_t, int32_t>(source, width, height, channels, destination); break;
+	case TextureDataType::GL_UNSIGNED_SHORT: BoxFilter<uint16_t, uint32_t>(source, width, height, channels, destination); break;
+	case TextureDataType::GL_SHORT: BoxFilter<int16_t, int32_t>(source, width, height, channels, destination); break;
+	case TextureDataType::GL_UNSIGNED_INT: BoxFilter<uint32_t, uint64_t>(source, width, height, channels, destination); break;
+	case TextureDataType::GL_INT: BoxFilter<int32_t, int64_t>(source, width, height, channels, destination); break;
+	case TextureDataType::GL_FLOAT: BoxFilter<float, float>(source, width, height, channels, destination); break;
+	case TextureDataType::GL_HALF_FLOAT: BoxFilterHalf(source, width, height, channels, destination); break;
+	}
+	return true;
+}
@@ -0,0 +1,145 @@
+#include <ThreadPool.h>
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include "Logging.h"
+
+/**
+ * \brief Creates the pool and starts the worker threads.
+ * \param threadCount The amount of worker threads. 0 to use one thread per hardware thread.
+ */
+GFW::ThreadPool::ThreadPool(unsigned threadCount) : m_submitted(0), m_stopping(false)
+{
+	if(threadCount == 0)
+		threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+	m_threads.reserve(threadCount);
+	for(unsigned i = 0; i < threadCount; ++i)
+		m_threads.emplace_back(&ThreadPool::WorkerLoop, this);
+}
+
+/**
+ * \brief Finishes all submitted tasks and joins the worker threads.
+ */
+GFW::ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+	m_condition.notify_all();
+
+	for(auto& thread : m_threads)
+		thread.join();
+}
+
+/**
+ * \brief Queue a task for execution on one of the worker threads.
+ * \param task The task to execute.
+ * \param priority Tasks with a higher priority are picked up before tasks with a lower priority.
+ */
+void GFW::ThreadPool::Submit(std::function<void()> task, int priority)
+{
+	GFW_ASSERT(task);
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_tasks.push(Task{ std::move(task), priority, m_submitted++ });
+	}
+	m_condition.notify_one();
+}
+
+/**
+ * \brief Split the range [begin, end) into chunks and execute them in parallel. The calling thread takes part in the work and the function returns once all chunks are done.
+ * Because the calling thread also executes chunks this can safely be called from within a task running on the pool.
+ * \param begin The first index of the range.
+ * \param end One past the last index of the range.
+ * \param body Function that is called with the first and one past the last index of a chunk.
+ * \param grainSize The minimum amount of indices per chunk.
+ */
+void GFW::ThreadPool::ParallelFor(int begin, int end, const std::function<void(int, int)>& body, int grainSize)
+{
+	if(end <= begin)
+		return;
+
+	const int count = end - begin;
+	const int chunkSize = std::max(grainSize, (count + int(m_threads.size()) * 4 - 1) / (int(m_threads.size()) * 4));
+	const int chunkCount = (count + chunkSize - 1) / chunkSize;
+	if(chunkCount == 1)
+	{
+		body(begin, end);
+		return;
+	}
+
+	struct ParallelForState
+	{
+		std::atomic<int> nextChunk{ 0 };
+		std::atomic<int> remainingChunks{ 0 };
+		std::mutex mutex;
+		std::condition_variable finished;
+	};
+	auto state = std::make_shared<ParallelForState>();
+	state->remainingChunks = chunkCount;
+
+	// Chunks are claimed from a shared counter so it doesn't matter which thread ends up executing them.
+	auto runChunks = [state, &body, begin, end, chunkSize, chunkCount]()
+	{
+		int chunk;
+		while((chunk = state->nextChunk.fetch_add(1)) < chunkCount)
+		{
+			const int chunkBegin = begin + chunk * chunkSize;
+			body(chunkBegin, std::min(chunkBegin + chunkSize, end));
+			if(state->remainingChunks.fetch_sub(1) == 1)
+			{
+				std::lock_guard<std::mutex> lock(state->mutex);
+				state->finished.notify_all();
+			}
+		}
+	};
+
+	const int helperCount = std::min(chunkCount - 1, int(m_threads.size()));
+	for(int i = 0; i < helperCount; ++i)
+		Submit(runChunks, std::numeric_limits<int>::max());
+
+	runChunks();
+
+	std::unique_lock<std::mutex> lock(state->mutex);
+	state->finished.wait(lock, [&state]() { return state->remainingChunks == 0; });
+}
+
+/**
+ * \return The amount of worker threads in the pool.
+ */
+unsigned GFW::ThreadPool::GetThreadCount() const
+{
+	return unsigned(m_threads.size());
+}
+
+/**
+ * \return Pool shared by the framework, with one worker per hardware thread. Created on first use.
+ */
+GFW::ThreadPool& GFW::ThreadPool::GetDefault()
+{
+	static ThreadPool pool;
+	return pool;
+}
+
+/**
+ * \brief Loop executed by every worker thread. Executes tasks until the pool is stopped and the queue is empty.
+ */
+void GFW::ThreadPool::WorkerLoop()
+{
+	for(;;)
+	{
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_condition.wait(lock, [this]() { return m_stopping || !m_tasks.empty(); });
+			if(m_tasks.empty())
+				return;
+
+			task = std::move(const_cast<Task&>(m_tasks.top()).function);
+			m_tasks.pop();
+		}
+		task();
+	}
+}
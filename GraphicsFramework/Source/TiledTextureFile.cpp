@@ -0,0 +1,267 @@
+#include <TiledTextureFile.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "Logging.h"
+#include "TextureUtilities.h"
+
+namespace
+{
+	const char TILED_MAGIC[4] = { 'G', 'F', 'W', 'V' };
+	const uint32_t TILED_VERSION = 1;
+	const uint64_t TILE_ALIGNMENT = 4096;
+
+	/**
+	 * \brief The header at the start of every tiled file. All values are stored little endian.
+	 */
+	struct TiledHeader
+	{
+		char magic[4];			// Always "GFWV"
+		uint32_t version;		// Version of the tiled layout
+		uint32_t format;		// TextureFormat of the texture
+		uint32_t type;			// TextureDataType of the pixel data
+		uint32_t width;			// Width of the base level
+		uint32_t height;		// Height of the base level
+		uint32_t levels;		// Amount of mipmap levels
+		uint32_t tileSize;		// Size of a tile without its border
+		uint32_t border;		// Width of the border around every tile
+		uint32_t reserved[7];	// Reserved for future use, must be 0
+	};
+
+	uint64_t AlignTileOffset(uint64_t offset)
+	{
+		return (offset + TILE_ALIGNMENT - 1) / TILE_ALIGNMENT * TILE_ALIGNMENT;
+	}
+
+	/**
+	 * \brief Calculate where the tiles of every level are stored.
+	 * \return The size of the file. 0 if the description can't be stored in a tiled file.
+	 */
+	uint64_t ComputeLayout(const GFW::TextureDescription& description, int tileSize, int border, uint64_t& tileStride, uint64_t* levelOffsets)
+	{
+		if(description.levels < 1 || description.levels > GFW::TiledTextureFile::MAX_LEVELS || description.width < 1 || description.height < 1 || tileSize < 1 || border < 0 ||
+			GFW::TextureUtilities::IsCompressed(description.format))
+			return 0;
+
+		const int paddedTileSize = tileSize + border * 2;
+		tileStride = AlignTileOffset(GFW::TextureUtilities::GetDataSize(description.format, description.type, paddedTileSize, paddedTileSize));
+
+		uint64_t offset = AlignTileOffset(sizeof(TiledHeader));
+		for(int level = 0; level < description.levels; ++level)
+		{
+			const int tilesX = (GFW::TextureUtilities::GetMipmapDimension(description.width, level) + tileSize - 1) / tileSize;
+			const int tilesY = (GFW::TextureUtilities::GetMipmapDimension(description.height, level) + tileSize - 1) / tileSize;
+			levelOffsets[level] = offset;
+			offset += tileStride * tilesX * tilesY;
+		}
+		return offset;
+	}
+}
+
+const int GFW::TiledTextureFile::MAX_LEVELS;
+
+GFW::TiledTextureFile::TiledTextureFile() : m_tileSize(0), m_border(0), m_tileStride(0), m_levelOffsets{}
+{
+}
+
+/**
+ * \brief Map a tiled file into memory and validate its header. Closes the previously opened file.
+ * \param file The tiled file to open.
+ * \return False if the file couldn't be mapped or isn't a valid tiled file.
+ */
+bool GFW::TiledTextureFile::Open(const char* file)
+{
+	Close();
+	if(!m_file.Open(file) || m_file.GetSize() < sizeof(TiledHeader))
+	{
+		Close();
+		return false;
+	}
+
+	const TiledHeader* header = reinterpret_cast<const TiledHeader*>(m_file.GetData());
+	TextureDescription description;
+	description.format = TextureFormat(header->format);
+	description.type = TextureDataType(header->type);
+	description.width = int(header->width);
+	description.height = int(header->height);
+	description.levels = int(header->levels);
+
+	const uint64_t size = ComputeLayout(description, int(header->tileSize), int(header->border), m_tileStride, m_levelOffsets);
+	if(memcmp(header->magic, TILED_MAGIC, sizeof(header->magic)) != 0 || header->version != TILED_VERSION || size == 0 || size > m_file.GetSize())
+	{
+		Close();
+		return false;
+	}
+
+	m_description = description;
+	m_tileSize = int(header->tileSize);
+	m_border = int(header->border);
+	return true;
+}
+
+/**
+ * \brief Unmap the tiled file. Pointers returned by GetTileData() become invalid.
+ */
+void GFW::TiledTextureFile::Close()
+{
+	m_file.Close();
+	m_description = TextureDescription();
+	m_tileSize = 0;
+	m_border = 0;
+	m_tileStride = 0;
+	memset(m_levelOffsets, 0, sizeof(m_levelOffsets));
+}
+
+/**
+ * \return If a tiled file is opened.
+ */
+bool GFW::TiledTextureFile::IsOpen() const
+{
+	return m_file.IsOpen();
+}
+
+/**
+ * \return Description of the texture stored in the file.
+ */
+const GFW::TextureDescription& GFW::TiledTextureFile::GetDescription() const
+{
+	return m_description;
+}
+
+/**
+ * \return The size of a tile without its border.
+ */
+int GFW::TiledTextureFile::GetTileSize() const
+{
+	return m_tileSize;
+}
+
+/**
+ * \return The width of the border around every tile.
+ */
+int GFW::TiledTextureFile::GetBorder() const
+{
+	return m_border;
+}
+
+/**
+ * \return The size of a tile including its border.
+ */
+int GFW::TiledTextureFile::GetPaddedTileSize() const
+{
+	return m_tileSize + m_border * 2;
+}
+
+/**
+ * \return The amount of tile columns of mipmap @level.
+ */
+int GFW::TiledTextureFile::GetTileCountX(int level) const
+{
+	return (TextureUtilities::GetMipmapDimension(m_description.width, level) + m_tileSize - 1) / m_tileSize;
+}
+
+/**
+ * \return The amount of tile rows of mipmap @level.
+ */
+int GFW::TiledTextureFile::GetTileCountY(int level) const
+{
+	return (TextureUtilities::GetMipmapDimension(m_description.height, level) + m_tileSize - 1) / m_tileSize;
+}
+
+/**
+ * \return The size in bytes of the tightly packed pixel data of a tile, including its border.
+ */
+uint64_t GFW::TiledTextureFile::GetTileDataSize() const
+{
+	return TextureUtilities::GetDataSize(m_description.format, m_description.type, GetPaddedTileSize(), GetPaddedTileSize());
+}
+
+/**
+ * \brief Get a pointer to the pixel data of a tile directly in the mapped file. Tiles at the right and bottom edge are padded to the full tile size.
+ * \param level The mipmap level of the tile.
+ * \param x The column of the tile.
+ * \param y The row of the tile.
+ * \return Pointer to the tightly packed pixel data of the tile, including its border.
+ */
+const unsigned char* GFW::TiledTextureFile::GetTileData(int level, int x, int y) const
+{
+	GFW_ASSERT(IsOpen() && level >= 0 && level < m_description.levels && x >= 0 && x < GetTileCountX(level) && y >= 0 && y < GetTileCountY(level));
+	return m_file.GetData() + m_levelOffsets[level] + m_tileStride * (uint64_t(y) * GetTileCountX(level) + x);
+}
+
+/**
+ * \brief Write a texture to a tiled file. The source is read one tile at a time so textures larger than memory can be converted.
+ * \param file The file to write to. Overwritten if it already exists.
+ * \param description Description of the texture. Only the format, type, width, height and levels are used. Compressed formats aren't supported.
+ * \param tileSize The size of a tile without its border.
+ * \param border The width of the border around every tile. Pixels outside the texture are clamped to the edge.
+ * \param readRegion Function that reads a region of a mipmap level of the source texture. Regions never exceed the bounds of the level.
+ * \return False if the file couldn't be written or the texture can't be stored in a tiled file.
+ */
+bool GFW::TiledTextureFile::Save(const char* file, const TextureDescription& description, int tileSize, int border, const RegionReader& readRegion)
+{
+	uint64_t tileStride;
+	uint64_t levelOffsets[MAX_LEVELS];
+	if(ComputeLayout(description, tileSize, border, tileStride, levelOffsets) == 0)
+		return false;
+
+	FILE* stream = fopen(file, "wb");
+	if(!stream)
+		return false;
+
+	TiledHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, TILED_MAGIC, sizeof(header.magic));
+	header.version = TILED_VERSION;
+	header.format = uint32_t(description.format);
+	header.type = uint32_t(description.type);
+	header.width = uint32_t(description.width);
+	header.height = uint32_t(description.height);
+	header.levels = uint32_t(description.levels);
+	header.tileSize = uint32_t(tileSize);
+	header.border = uint32_t(border);
+
+	const int paddedTileSize = tileSize + border * 2;
+	const size_t pixelSize = size_t(TextureUtilities::GetPixelSize(description.format, description.type));
+	std::vector<unsigned char> region(paddedTileSize * paddedTileSize * pixelSize);
+	std::vector<unsigned char> tile(size_t(tileStride), 0);
+
+	std::vector<unsigned char> headerBlock(size_t(levelOffsets[0]), 0);
+	memcpy(headerBlock.data(), &header, sizeof(header));
+	bool success = fwrite(headerBlock.data(), 1, headerBlock.size(), stream) == headerBlock.size();
+
+	for(int level = 0; level < description.levels && success; ++level)
+	{
+		const int levelWidth = TextureUtilities::GetMipmapDimension(description.width, level);
+		const int levelHeight = TextureUtilities::GetMipmapDimension(description.height, level);
+		const int tilesX = (levelWidth + tileSize - 1) / tileSize;
+		const int tilesY = (levelHeight + tileSize - 1) / tileSize;
+
+		for(int tileY = 0; tileY < tilesY && success; ++tileY)
+		{
+			for(int tileX = 0; tileX < tilesX && success; ++tileX)
+			{
+				// Read the part of the padded tile that lies within the level and replicate its edges to fill the rest.
+				const int x0 = std::max(tileX * tileSize - border, 0);
+				const int y0 = std::max(tileY * tileSize - border, 0);
+				const int x1 = std::min(tileX * tileSize - border + paddedTileSize, levelWidth);
+				const int y1 = std::min(tileY * tileSize - border + paddedTileSize, levelHeight);
+				readRegion(level, x0, y0, x1 - x0, y1 - y0, region.data());
+
+				for(int y = 0; y < paddedTileSize; ++y)
+				{
+					const int sourceY = std::min(std::max(tileY * tileSize - border + y, y0), y1 - 1) - y0;
+					for(int x = 0; x < paddedTileSize; ++x)
+					{
+						const int sourceX = std::min(std::max(tileX * tileSize - border + x, x0), x1 - 1) - x0;
+						memcpy(&tile[(size_t(y) * paddedTileSize + x) * pixelSize], &region[(size_t(sourceY) * (x1 - x0) + sourceX) * pixelSize], pixelSize);
+					}
+				}
+				success = fwrite(tile.data(), 1, tile.size(), stream) == tile.size();
+			}
+		}
+	}
+
+	return fclose(stream) == 0 && success;
+}
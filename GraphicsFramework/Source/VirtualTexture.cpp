@@ -0,0 +1,410 @@
+#include <VirtualTexture.h>
+#include <algorithm>
+#include <cstring>
+#include "Logging.h"
+#include "TextureUtilities.h"
+
+namespace
+{
+	uint32_t PackPageEntry(int slotX, int slotY, int level)
+	{
+		return uint32_t(slotX) | uint32_t(slotY) << 8 | uint32_t(level) << 16 | 0xFFu << 24;
+	}
+
+	int NextPowerOfTwo(int value)
+	{
+		int result = 1;
+		while(result < value)
+			result <<= 1;
+		return result;
+	}
+}
+
+const uint32_t GFW::VirtualTexture::FEEDBACK_NONE;
+
+/**
+ * \brief Creates the virtual texture. The textures are initialized by Open().
+ * \param physicalTexture The texture that holds the resident tiles.
+ * \param pageTable The texture that maps tiles to slots in the physical texture.
+ * \param slotsX The amount of slot columns in the physical texture. At most 256.
+ * \param slotsY The amount of slot rows in the physical texture. At most 256.
+ * \param threadPool The pool to read tiles on. nullptr to use the default thread pool.
+ */
+GFW::VirtualTexture::VirtualTexture(ITexture* physicalTexture, ITexture* pageTable, int slotsX, int slotsY, ThreadPool* threadPool)
+	: m_physicalTexture(physicalTexture), m_pageTable(pageTable), m_slotsX(slotsX), m_slotsY(slotsY), m_threadPool(threadPool ? threadPool : &ThreadPool::GetDefault()), m_pageTableLevels(0),
+	m_runningLoads(0), m_cacheHits(0), m_cacheMisses(0)
+{
+	GFW_ASSERT(m_physicalTexture != nullptr && m_pageTable != nullptr);
+	GFW_ASSERT(slotsX > 0 && slotsX <= 256 && slotsY > 0 && slotsY <= 256);
+}
+
+/**
+ * \brief Waits for the tiles that are being read.
+ */
+GFW::VirtualTexture::~VirtualTexture()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_loadsFinished.wait(lock, [this]() { return m_runningLoads == 0; });
+}
+
+/**
+ * \brief Open a tiled texture file, initialize the physical texture and page table and make the coarsest mipmap level resident.
+ * \param file The tiled texture file to stream the tiles from.
+ * \return False if the file couldn't be opened or the tiles of its coarsest level don't fit in the cache.
+ */
+bool GFW::VirtualTexture::Open(const char* file)
+{
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_loadsFinished.wait(lock, [this]() { return m_runningLoads == 0; });
+		m_pendingTiles.clear();
+		m_loadedTiles.clear();
+	}
+
+	const int topLevel = m_file.Open(file) ? m_file.GetDescription().levels - 1 : -1;
+	if(topLevel < 0 || m_file.GetTileCountX(topLevel) * m_file.GetTileCountY(topLevel) > m_slotsX * m_slotsY)
+	{
+		m_file.Close();
+		return false;
+	}
+
+	const TextureDescription& description = m_file.GetDescription();
+	const int paddedTileSize = m_file.GetPaddedTileSize();
+	m_physicalTexture->Create(m_slotsX * paddedTileSize, m_slotsY * paddedTileSize, false, description.format, description.type, nullptr);
+	const int pageTableWidth = NextPowerOfTwo(m_file.GetTileCountX(0));
+	const int pageTableHeight = NextPowerOfTwo(m_file.GetTileCountY(0));
+	m_pageTable->Create(pageTableWidth, pageTableHeight, description.levels > 1, TextureFormat::RGBA8, TextureDataType::GL_UNSIGNED_BYTE, nullptr);
+
+	// Levels coarser than the last page table mipmap all have a single tile. They only live in the CPU copy of the page table,
+	// the last page table mipmap takes over their entry through the fallback chain as long as its own tile isn't resident.
+	m_pageTableLevels = std::min(description.levels > 1 ? TextureUtilities::GetMipmapCount(pageTableWidth, pageTableHeight) : 1, description.levels);
+
+	m_slots.assign(size_t(m_slotsX * m_slotsY), Slot());
+	m_lru.clear();
+	m_freeSlots.clear();
+	for(int slot = int(m_slots.size()) - 1; slot >= 0; --slot)
+		m_freeSlots.push_back(slot);
+	m_residentTiles.clear();
+	m_pageEntries.resize(size_t(description.levels));
+	for(int level = 0; level < description.levels; ++level)
+		m_pageEntries[level].assign(size_t(m_file.GetTileCountX(level) * m_file.GetTileCountY(level)), 0);
+
+	// The coarsest level is pinned so every page table entry always has a resident fallback.
+	for(int y = 0; y < m_file.GetTileCountY(topLevel); ++y)
+	{
+		for(int x = 0; x < m_file.GetTileCountX(topLevel); ++x)
+		{
+			const int slot = AcquireSlot();
+			m_slots[slot].pinned = true;
+			PlaceTile(PackFeedback(x, y, topLevel), slot, m_file.GetTileData(topLevel, x, y));
+		}
+	}
+	return true;
+}
+
+/**
+ * \brief Turn the feedback of the renderer into tile requests. Resident tiles are marked as used, missing tiles are read on the thread pool, coarse tiles first.
+ * \param feedback Packed tiles the renderer wanted to sample, see PackFeedback(). Duplicates and FEEDBACK_NONE are allowed.
+ * \param count The amount of values in @feedback.
+ */
+void GFW::VirtualTexture::AnalyzeFeedback(const uint32_t* feedback, int count)
+{
+	if(!m_file.IsOpen())
+		return;
+
+	std::vector<uint32_t> tiles(feedback, feedback + count);
+	std::sort(tiles.begin(), tiles.end());
+	tiles.erase(std::unique(tiles.begin(), tiles.end()), tiles.end());
+
+	// Tiles are packed with the level in the highest bits, so walking backwards requests coarse tiles first.
+	const int levels = m_file.GetDescription().levels;
+	for(auto it = tiles.rbegin(); it != tiles.rend(); ++it)
+	{
+		int x, y, level;
+		UnpackFeedback(*it, x, y, level);
+		if(*it == FEEDBACK_NONE || level >= levels || x >= m_file.GetTileCountX(level) || y >= m_file.GetTileCountY(level))
+			continue;
+
+		auto resident = m_residentTiles.find(*it);
+		if(resident != m_residentTiles.end())
+		{
+			Touch(resident->second);
+			++m_cacheHits;
+			continue;
+		}
+
+		// Keep the tile that's currently used as fallback in the cache until the requested tile arrives.
+		for(int parentLevel = level + 1, parentX = x >> 1, parentY = y >> 1; parentLevel < levels; ++parentLevel, parentX >>= 1, parentY >>= 1)
+		{
+			parentX = std::min(parentX, m_file.GetTileCountX(parentLevel) - 1);
+			parentY = std::min(parentY, m_file.GetTileCountY(parentLevel) - 1);
+			auto parent = m_residentTiles.find(PackFeedback(parentX, parentY, parentLevel));
+			if(parent != m_residentTiles.end())
+			{
+				Touch(parent->second);
+				break;
+			}
+		}
+
+		++m_cacheMisses;
+		RequestTile(*it);
+	}
+}
+
+/**
+ * \brief Upload tiles that finished reading into the physical texture and update the page table. Must be called on the thread that owns the context.
+ * \param maxUploads The maximum amount of tiles to upload during this call.
+ * \return The amount of tiles that were uploaded.
+ */
+int GFW::VirtualTexture::Update(int maxUploads)
+{
+	std::vector<LoadedTile> loaded;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		const size_t count = std::min(m_loadedTiles.size(), size_t(std::max(maxUploads, 0)));
+		loaded.assign(std::make_move_iterator(m_loadedTiles.begin()), std::make_move_iterator(m_loadedTiles.begin() + count));
+		m_loadedTiles.erase(m_loadedTiles.begin(), m_loadedTiles.begin() + count);
+		for(const LoadedTile& tile : loaded)
+			m_pendingTiles.erase(tile.tile);
+	}
+
+	int uploaded = 0;
+	for(LoadedTile& tile : loaded)
+	{
+		if(m_residentTiles.count(tile.tile) != 0)
+			continue;
+
+		const int slot = AcquireSlot();
+		if(slot < 0)
+			break;
+		PlaceTile(tile.tile, slot, tile.pixels.data());
+		++uploaded;
+	}
+	return uploaded;
+}
+
+/**
+ * \return The tiled file the tiles are streamed from.
+ */
+const GFW::TiledTextureFile& GFW::VirtualTexture::GetFile() const
+{
+	return m_file;
+}
+
+/**
+ * \return The amount of tiles in the physical texture.
+ */
+int GFW::VirtualTexture::GetResidentTileCount() const
+{
+	return int(m_residentTiles.size());
+}
+
+/**
+ * \return The amount of tiles that are requested but not uploaded yet.
+ */
+int GFW::VirtualTexture::GetPendingTileCount()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return int(m_pendingTiles.size());
+}
+
+/**
+ * \return The amount of requested tiles that were already resident.
+ */
+unsigned long long GFW::VirtualTexture::GetCacheHits() const
+{
+	return m_cacheHits;
+}
+
+/**
+ * \return The amount of requested tiles that weren't resident.
+ */
+unsigned long long GFW::VirtualTexture::GetCacheMisses() const
+{
+	return m_cacheMisses;
+}
+
+/**
+ * \brief Pack a tile into a single feedback value. This is the value the renderer writes to its feedback buffer.
+ * \param x The column of the tile. Less than 16384.
+ * \param y The row of the tile. Less than 16384.
+ * \param level The mipmap level of the tile. Less than 16.
+ * \return The packed tile.
+ */
+uint32_t GFW::VirtualTexture::PackFeedback(int x, int y, int level)
+{
+	return uint32_t(level) << 28 | uint32_t(y) << 14 | uint32_t(x);
+}
+
+/**
+ * \brief Unpack a feedback value created by PackFeedback().
+ */
+void GFW::VirtualTexture::UnpackFeedback(uint32_t feedback, int& x, int& y, int& level)
+{
+	x = int(feedback & 0x3FFF);
+	y = int(feedback >> 14 & 0x3FFF);
+	level = int(feedback >> 28);
+}
+
+/**
+ * \brief Start reading a tile on the thread pool. The amount of tiles being read is limited to the size of the cache.
+ */
+void GFW::VirtualTexture::RequestTile(uint32_t tile)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if(m_pendingTiles.size() >= m_slots.size() || !m_pendingTiles.insert(tile).second)
+			return;
+		++m_runningLoads;
+	}
+
+	int x, y, level;
+	UnpackFeedback(tile, x, y, level);
+	m_threadPool->Submit([this, tile, x, y, level]()
+	{
+		// Copying the tile out of the mapped file is where the actual disk reads happen.
+		LoadedTile loaded;
+		loaded.tile = tile;
+		loaded.pixels.resize(size_t(m_file.GetTileDataSize()));
+		memcpy(loaded.pixels.data(), m_file.GetTileData(level, x, y), loaded.pixels.size());
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_loadedTiles.push_back(std::move(loaded));
+		if(--m_runningLoads == 0)
+			m_loadsFinished.notify_all();
+	}, level);
+}
+
+/**
+ * \brief Mark a slot as most recently used.
+ */
+void GFW::VirtualTexture::Touch(int slot)
+{
+	if(!m_slots[slot].pinned)
+		m_lru.splice(m_lru.begin(), m_lru, m_slots[slot].lruPosition);
+}
+
+/**
+ * \return A free slot, evicting the least recently used tile when the cache is full. -1 if every slot is pinned.
+ */
+int GFW::VirtualTexture::AcquireSlot()
+{
+	if(!m_freeSlots.empty())
+	{
+		const int slot = m_freeSlots.back();
+		m_freeSlots.pop_back();
+		return slot;
+	}
+	if(m_lru.empty())
+		return -1;
+
+	const int slot = m_lru.back();
+	EvictTile(slot);
+	m_freeSlots.pop_back();
+	return slot;
+}
+
+/**
+ * \brief Upload a tile into a slot and point the page table at it.
+ */
+void GFW::VirtualTexture::PlaceTile(uint32_t tile, int slot, const unsigned char* pixels)
+{
+	int x, y, level;
+	UnpackFeedback(tile, x, y, level);
+
+	const TextureDescription& description = m_file.GetDescription();
+	const int paddedTileSize = m_file.GetPaddedTileSize();
+	m_physicalTexture->UpdateTexture(slot % m_slotsX * paddedTileSize, slot / m_slotsX * paddedTileSize, paddedTileSize, paddedTileSize, 0, description.format, description.type, pixels,
+		TextureUtilities::GetRowSize(description.format, description.type, paddedTileSize));
+
+	Slot& slotInfo = m_slots[slot];
+	slotInfo.tile = tile;
+	if(!slotInfo.pinned)
+	{
+		m_lru.push_front(slot);
+		slotInfo.lruPosition = m_lru.begin();
+	}
+	m_residentTiles[tile] = slot;
+	RefreshPageTable(level, x, y);
+}
+
+/**
+ * \brief Remove the tile from a slot and point the page table back at its fallback.
+ */
+void GFW::VirtualTexture::EvictTile(int slot)
+{
+	Slot& slotInfo = m_slots[slot];
+	GFW_ASSERT(!slotInfo.pinned && slotInfo.tile != FEEDBACK_NONE);
+
+	const uint32_t tile = slotInfo.tile;
+	m_lru.erase(slotInfo.lruPosition);
+	m_residentTiles.erase(tile);
+	slotInfo.tile = FEEDBACK_NONE;
+	m_freeSlots.push_back(slot);
+
+	int x, y, level;
+	UnpackFeedback(tile, x, y, level);
+	RefreshPageTable(level, x, y);
+}
+
+/**
+ * \brief Recalculate the page table entries of a tile and of all finer tiles it covers, then upload the changed entries.
+ * Entries of tiles that aren't resident copy the entry of their parent tile.
+ */
+void GFW::VirtualTexture::RefreshPageTable(int level, int x, int y)
+{
+	// The range of tiles covered at every finer level follows the parent lookup below: children map to min(child / 2, last parent),
+	// so the last parent of a level also covers the children beyond twice its index when a tile count isn't a power of two.
+	const int levels = m_file.GetDescription().levels;
+	int x0 = x;
+	int y0 = y;
+	int x1 = x + 1;
+	int y1 = y + 1;
+	for(int current = level; current >= 0; --current)
+	{
+		const int tilesX = m_file.GetTileCountX(current);
+		const int tilesY = m_file.GetTileCountY(current);
+		if(current < level)
+		{
+			const bool lastX = x1 == m_file.GetTileCountX(current + 1);
+			const bool lastY = y1 == m_file.GetTileCountY(current + 1);
+			x0 = std::min(x0 * 2, tilesX);
+			y0 = std::min(y0 * 2, tilesY);
+			x1 = lastX ? tilesX : std::min(x1 * 2, tilesX);
+			y1 = lastY ? tilesY : std::min(y1 * 2, tilesY);
+		}
+		if(x0 == x1 || y0 == y1)
+			break;
+
+		std::vector<uint32_t>& entries = m_pageEntries[current];
+		for(int tileY = y0; tileY < y1; ++tileY)
+		{
+			for(int tileX = x0; tileX < x1; ++tileX)
+			{
+				auto resident = m_residentTiles.find(PackFeedback(tileX, tileY, current));
+				if(resident != m_residentTiles.end())
+					entries[tileY * tilesX + tileX] = PackPageEntry(resident->second % m_slotsX, resident->second / m_slotsX, current);
+				else if(current + 1 < levels)
+				{
+					const int parentX = std::min(tileX >> 1, m_file.GetTileCountX(current + 1) - 1);
+					const int parentY = std::min(tileY >> 1, m_file.GetTileCountY(current + 1) - 1);
+					entries[tileY * tilesX + tileX] = m_pageEntries[current + 1][parentY * m_file.GetTileCountX(current + 1) + parentX];
+				}
+			}
+		}
+		UploadPageTable(current, x0, y0, x1, y1);
+	}
+}
+
+/**
+ * \brief Upload a rectangle of page table entries of a mipmap level. Levels the page table texture doesn't have are skipped.
+ */
+void GFW::VirtualTexture::UploadPageTable(int level, int x0, int y0, int x1, int y1)
+{
+	if(level >= m_pageTableLevels)
+		return;
+
+	const int tilesX = m_file.GetTileCountX(level);
+	m_pageTable->UpdateTexture(x0, y0, x1 - x0, y1 - y0, level, TextureFormat::RGBA8, TextureDataType::GL_UNSIGNED_BYTE,
+		reinterpret_cast<const unsigned char*>(&m_pageEntries[level][y0 * tilesX + x0]), uint64_t(tilesX) * sizeof(uint32_t));
+}
@@ -0,0 +1,413 @@
+#include <VolumeOccupancyGrid.h>
+#include <algorithm>
+#include <limits>
+#include "Logging.h"
+#include "TextureUtilities.h"
+
+namespace
+{
+	/**
+	 * \brief Convert a float to a half float that's rounded towards negative (@up false) or positive (@up true) infinity, so ranges stay conservative.
+	 */
+	uint16_t FloatToHalfDirected(float value, bool up)
+	{
+		uint16_t half = GFW::TextureUtilities::FloatToHalf(value);
+		const float rounded = GFW::TextureUtilities::HalfToFloat(half);
+		if(up && rounded < value)
+			half = (half & 0x8000) ? (half == 0x8000 ? 0x0001 : uint16_t(half - 1)) : uint16_t(half + 1);
+		else if(!up && rounded > value)
+			half = (half & 0x8000) ? uint16_t(half + 1) : (half == 0 ? 0x8001 : uint16_t(half - 1));
+		return half;
+	}
+
+	/**
+	 * \brief Scan a box of texels for the range of a channel, comparing the stored values and normalizing only the result.
+	 */
+	template<typename T>
+	GFW::Math::Vec2 ScanRange(const T* pixelData, int width, int height, int channels, int channel, const GFW::Math::IVec3& first, const GFW::Math::IVec3& last, float scale)
+	{
+		T minimum = pixelData[((size_t(first.z) * height + first.y) * width + first.x) * channels + channel];
+		T maximum = minimum;
+		for(int z = first.z; z <= last.z; ++z)
+		{
+			for(int y = first.y; y <= last.y; ++y)
+			{
+				const T* row = pixelData + ((size_t(z) * height + y) * width) * channels + channel;
+				for(int x = first.x; x <= last.x; ++x)
+				{
+					minimum = std::min(minimum, row[x * channels]);
+					maximum = std::max(maximum, row[x * channels]);
+				}
+			}
+		}
+		return GFW::Math::Vec2(float(minimum) * scale, float(maximum) * scale);
+	}
+}
+
+/**
+ * \param cellSize The amount of texels along each axis of a level 0 cell. Smaller cells skip more space but need more steps to traverse.
+ */
+GFW::VolumeOccupancyGrid::VolumeOccupancyGrid(int cellSize) : m_cellSize(cellSize), m_width(0), m_height(0), m_depth(0), m_format(TextureFormat::R8),
+	m_type(TextureDataType::GL_UNSIGNED_BYTE), m_channel(0)
+{
+	GFW_ASSERT(cellSize > 0);
+}
+
+/**
+ * \brief Build the grid from the texel data of a 3D texture, as passed to ITexture::Create(). Level 0 is built in parallel.
+ * \param width The width of the volume.
+ * \param height The height of the volume.
+ * \param depth The depth of the volume.
+ * \param format The format of the volume. Compressed, depth, stencil and integer formats aren't supported.
+ * \param type The type of @pixelData. Unsigned bytes, unsigned shorts, floats and half floats are supported.
+ * \param pixelData Tightly packed texel data of the volume.
+ * \param channel The channel the ranges are built from, usually the density.
+ * \param threadPool The pool to build on. nullptr to use the default thread pool.
+ * \return False if the format, type or channel isn't supported.
+ */
+bool GFW::VolumeOccupancyGrid::Build(int width, int height, int depth, TextureFormat format, TextureDataType type, const unsigned char* pixelData, int channel,
+	ThreadPool* threadPool)
+{
+	GFW_ASSERT(width > 0 && height > 0 && depth > 0 && pixelData != nullptr);
+	if(TextureUtilities::IsCompressed(format) || TextureUtilities::IsDepthOrStencil(format) || TextureUtilities::IsInteger(format) ||
+		channel < 0 || channel >= TextureUtilities::GetChannelCount(format) || (type != TextureDataType::GL_UNSIGNED_BYTE &&
+		type != TextureDataType::GL_UNSIGNED_SHORT && type != TextureDataType::GL_FLOAT && type != TextureDataType::GL_HALF_FLOAT))
+		return false;
+
+	m_width = width;
+	m_height = height;
+	m_depth = depth;
+	m_format = format;
+	m_type = type;
+	m_channel = channel;
+
+	m_levels.clear();
+	Level level;
+	level.width = (width + m_cellSize - 1) / m_cellSize;
+	level.height = (height + m_cellSize - 1) / m_cellSize;
+	level.depth = (depth + m_cellSize - 1) / m_cellSize;
+	for(;;)
+	{
+		level.ranges.resize(size_t(level.width) * level.height * level.depth);
+		m_levels.push_back(level);
+		if(level.width == 1 && level.height == 1 && level.depth == 1)
+			break;
+		level.width = (level.width + 1) / 2;
+		level.height = (level.height + 1) / 2;
+		level.depth = (level.depth + 1) / 2;
+	}
+
+	const Math::IVec3 last(m_levels[0].width - 1, m_levels[0].height - 1, m_levels[0].depth - 1);
+	BuildCells(pixelData, Math::IVec3(0), last, threadPool ? *threadPool : ThreadPool::GetDefault());
+	for(int index = 1; index < int(m_levels.size()); ++index)
+		ReduceCells(index, Math::IVec3(0), Math::IVec3(m_levels[index].width - 1, m_levels[index].height - 1, m_levels[index].depth - 1));
+	return true;
+}
+
+/**
+ * \brief Update the grid after a region of the volume changed, as passed to ITexture::UpdateTexture(). Only the cells that cover the region and their parents are rebuilt.
+ * \param pixelData Tightly packed texel data of the whole volume, including the update.
+ * \param x The offset of the updated region in the width of the volume.
+ * \param y The offset of the updated region in the height of the volume.
+ * \param z The offset of the updated region in the depth of the volume.
+ * \param width The width of the updated region.
+ * \param height The height of the updated region.
+ * \param depth The depth of the updated region.
+ * \param threadPool The pool to rebuild on. nullptr to use the default thread pool.
+ */
+void GFW::VolumeOccupancyGrid::Refit(const unsigned char* pixelData, int x, int y, int z, int width, int height, int depth, ThreadPool* threadPool)
+{
+	GFW_ASSERT(!m_levels.empty() && x >= 0 && y >= 0 && z >= 0 && width > 0 && height > 0 && depth > 0 && x + width <= m_width && y + height <= m_height &&
+		z + depth <= m_depth);
+
+	// Cells also cover the texels one step beyond their edges, so a texel on the lower edge of a cell also belongs to the previous cell
+	// and a texel on the upper edge also belongs to the next one.
+	const Level& cells = m_levels[0];
+	Math::IVec3 first(std::max(x - 1, 0) / m_cellSize, std::max(y - 1, 0) / m_cellSize, std::max(z - 1, 0) / m_cellSize);
+	Math::IVec3 last(std::min((x + width) / m_cellSize, cells.width - 1), std::min((y + height) / m_cellSize, cells.height - 1),
+		std::min((z + depth) / m_cellSize, cells.depth - 1));
+	BuildCells(pixelData, first, last, threadPool ? *threadPool : ThreadPool::GetDefault());
+	for(int level = 1; level < int(m_levels.size()); ++level)
+	{
+		first /= 2;
+		last /= 2;
+		ReduceCells(level, first, last);
+	}
+}
+
+/**
+ * \brief Check if a cell can contain values in a range.
+ * \param level The level of the cell.
+ * \param x The column of the cell.
+ * \param y The row of the cell.
+ * \param z The slice of the cell.
+ * \param minValue The lowest value that isn't empty.
+ * \param maxValue The highest value that isn't empty.
+ * \return True if the range of the cell overlaps [@minValue, @maxValue].
+ */
+bool GFW::VolumeOccupancyGrid::IsOccupied(int level, int x, int y, int z, float minValue, float maxValue) const
+{
+	const Level& cells = m_levels[level];
+	const Math::Vec2& range = cells.ranges[(size_t(z) * cells.height + y) * cells.width + x];
+	return range.x <= maxValue && range.y >= minValue;
+}
+
+/**
+ * \brief Find the parts of a ray that cross occupied cells. Occupied cells are found top down, skipping every empty cell of a coarser level in one step,
+ * and adjacent level 0 cells are merged into a single segment. Only the returned segments have to be ray marched.
+ * \param origin The origin of the ray in normalized volume coordinates.
+ * \param direction The direction of the ray in normalized volume coordinates. Doesn't have to be normalized, the segments are in units of its length.
+ * \param minValue The lowest value that isn't empty.
+ * \param maxValue The highest value that isn't empty.
+ * \param segments Cleared and filled with the start (x) and end (y) distance of every segment along the ray, front to back. Distances are at least 0.
+ * \return The amount of segments.
+ */
+int GFW::VolumeOccupancyGrid::FindOccupiedSegments(const Math::Vec3& origin, const Math::Vec3& direction, float minValue, float maxValue,
+	std::vector<Math::Vec2>& segments) const
+{
+	segments.clear();
+	if(!m_levels.empty())
+		Traverse(int(m_levels.size()) - 1, 0, 0, 0, origin, direction, minValue, maxValue, segments);
+	return int(segments.size());
+}
+
+/**
+ * \brief Initialize a texture with a level of the grid. The texture becomes an RG16F 3D texture with the minimum in red and the maximum in green,
+ * rounded outwards so the ranges stay conservative.
+ * \param texture The texture to initialize.
+ * \param level The level to upload.
+ * \return False if the grid isn't built.
+ */
+bool GFW::VolumeOccupancyGrid::Upload(ITexture* texture, int level) const
+{
+	GFW_ASSERT(texture != nullptr);
+	if(level < 0 || level >= int(m_levels.size()))
+		return false;
+
+	const Level& cells = m_levels[level];
+	std::vector<uint16_t> ranges(cells.ranges.size() * 2);
+	for(size_t cell = 0; cell < cells.ranges.size(); ++cell)
+	{
+		ranges[cell * 2] = FloatToHalfDirected(cells.ranges[cell].x, false);
+		ranges[cell * 2 + 1] = FloatToHalfDirected(cells.ranges[cell].y, true);
+	}
+
+	const uint64_t rowPitch = uint64_t(cells.width) * 2 * sizeof(uint16_t);
+	texture->Create(cells.width, cells.height, cells.depth, false, TextureFormat::RG16F, TextureDataType::GL_HALF_FLOAT, reinterpret_cast<const unsigned char*>(ranges.data()),
+		rowPitch, rowPitch * cells.height);
+	return true;
+}
+
+/**
+ * \return The amount of texels along each axis of a level 0 cell. Every next level doubles it.
+ */
+int GFW::VolumeOccupancyGrid::GetCellSize() const
+{
+	return m_cellSize;
+}
+
+/**
+ * \return The amount of levels, 0 if the grid isn't built. The last level is a single cell.
+ */
+int GFW::VolumeOccupancyGrid::GetLevelCount() const
+{
+	return int(m_levels.size());
+}
+
+/**
+ * \brief Get the amount of cells along every axis of a level.
+ */
+void GFW::VolumeOccupancyGrid::GetLevelSize(int level, int& x, int& y, int& z) const
+{
+	x = m_levels[level].width;
+	y = m_levels[level].height;
+	z = m_levels[level].depth;
+}
+
+/**
+ * \return The minimum (x) and maximum (y) value of every cell of a level, x fastest.
+ */
+const std::vector<GFW::Math::Vec2>& GFW::VolumeOccupancyGrid::GetLevel(int level) const
+{
+	return m_levels[level].ranges;
+}
+
+/**
+ * \brief Compute the ranges of a box of level 0 cells from the texel data. Every cell scans its texels and the texels one step beyond its edges,
+ * with texel centres at (i + 0.5) / size a position just inside a face still interpolates the texel outside it. Rows of cells are processed in parallel.
+ * \param pixelData Tightly packed texel data of the volume.
+ * \param first The first cell of the box.
+ * \param last The last cell of the box, inclusive.
+ * \param threadPool The pool to build on.
+ */
+void GFW::VolumeOccupancyGrid::BuildCells(const unsigned char* pixelData, const Math::IVec3& first, const Math::IVec3& last, ThreadPool& threadPool)
+{
+	Level& cells = m_levels[0];
+	const int channels = TextureUtilities::GetChannelCount(m_format);
+	const int rowsY = last.y - first.y + 1;
+	threadPool.ParallelFor(0, rowsY * (last.z - first.z + 1), [&](int begin, int end)
+	{
+		for(int row = begin; row < end; ++row)
+		{
+			const int cellY = first.y + row % rowsY;
+			const int cellZ = first.z + row / rowsY;
+			const int y0 = std::max(cellY * m_cellSize - 1, 0);
+			const int z0 = std::max(cellZ * m_cellSize - 1, 0);
+			const int y1 = std::min(cellY * m_cellSize + m_cellSize, m_height - 1);
+			const int z1 = std::min(cellZ * m_cellSize + m_cellSize, m_depth - 1);
+			for(int cellX = first.x; cellX <= last.x; ++cellX)
+			{
+				const int x0 = std::max(cellX * m_cellSize - 1, 0);
+				const Math::IVec3 firstTexel(x0, y0, z0);
+				const Math::IVec3 lastTexel(std::min(cellX * m_cellSize + m_cellSize, m_width - 1), y1, z1);
+				Math::Vec2 range;
+				if(m_type == TextureDataType::GL_UNSIGNED_BYTE)
+					range = ScanRange(pixelData, m_width, m_height, channels, m_channel, firstTexel, lastTexel, 1.0f / 255.0f);
+				else if(m_type == TextureDataType::GL_UNSIGNED_SHORT)
+					range = ScanRange(reinterpret_cast<const uint16_t*>(pixelData), m_width, m_height, channels, m_channel, firstTexel, lastTexel, 1.0f / 65535.0f);
+				else if(m_type == TextureDataType::GL_FLOAT)
+					range = ScanRange(reinterpret_cast<const float*>(pixelData), m_width, m_height, channels, m_channel, firstTexel, lastTexel, 1.0f);
+				else
+				{
+					// Half floats don't order like integers, so they're converted one by one.
+					range = Math::Vec2(std::numeric_limits<float>::max(), -std::numeric_limits<float>::max());
+					for(int z = z0; z <= z1; ++z)
+					{
+						for(int y = y0; y <= y1; ++y)
+						{
+							const size_t rowStart = (size_t(z) * m_height + y) * m_width;
+							for(int x = x0; x <= lastTexel.x; ++x)
+							{
+								const float value = TextureUtilities::ReadComponent(pixelData, m_type, (rowStart + x) * channels + m_channel);
+								range.x = std::min(range.x, value);
+								range.y = std::max(range.y, value);
+							}
+						}
+					}
+				}
+				cells.ranges[(size_t(cellZ) * cells.height + cellY) * cells.width + cellX] = range;
+			}
+		}
+	});
+}
+
+/**
+ * \brief Compute the ranges of a box of cells from the ranges of their children in the previous level.
+ * \param level The level of the cells, at least 1.
+ * \param first The first cell of the box.
+ * \param last The last cell of the box, inclusive.
+ */
+void GFW::VolumeOccupancyGrid::ReduceCells(int level, const Math::IVec3& first, const Math::IVec3& last)
+{
+	const Level& children = m_levels[level - 1];
+	Level& cells = m_levels[level];
+	for(int z = first.z; z <= last.z; ++z)
+	{
+		for(int y = first.y; y <= last.y; ++y)
+		{
+			for(int x = first.x; x <= last.x; ++x)
+			{
+				Math::Vec2 range(std::numeric_limits<float>::max(), -std::numeric_limits<float>::max());
+				for(int childZ = z * 2; childZ < std::min(z * 2 + 2, children.depth); ++childZ)
+				{
+					for(int childY = y * 2; childY < std::min(y * 2 + 2, children.height); ++childY)
+					{
+						for(int childX = x * 2; childX < std::min(x * 2 + 2, children.width); ++childX)
+						{
+							const Math::Vec2& child = children.ranges[(size_t(childZ) * children.height + childY) * children.width + childX];
+							range.x = std::min(range.x, child.x);
+							range.y = std::max(range.y, child.y);
+						}
+					}
+				}
+				cells.ranges[(size_t(z) * cells.height + y) * cells.width + x] = range;
+			}
+		}
+	}
+}
+
+/**
+ * \brief Append the occupied parts of a cell to @segments, visiting its children front to back.
+ */
+void GFW::VolumeOccupancyGrid::Traverse(int level, int x, int y, int z, const Math::Vec3& origin, const Math::Vec3& direction, float minValue, float maxValue,
+	std::vector<Math::Vec2>& segments) const
+{
+	float enter;
+	float exit;
+	if(!IsOccupied(level, x, y, z, minValue, maxValue) || !IntersectCell(level, x, y, z, origin, direction, enter, exit))
+		return;
+
+	if(level == 0)
+	{
+		if(!segments.empty() && enter <= segments.back().y)
+			segments.back().y = std::max(segments.back().y, exit);
+		else
+			segments.push_back(Math::Vec2(enter, exit));
+		return;
+	}
+
+	struct Child
+	{
+		float enter;	// Distance at which the ray enters the child.
+		int x;			// The column of the child.
+		int y;			// The row of the child.
+		int z;			// The slice of the child.
+	};
+	Child children[8];
+	int childCount = 0;
+	const Level& childLevel = m_levels[level - 1];
+	for(int childZ = z * 2; childZ < std::min(z * 2 + 2, childLevel.depth); ++childZ)
+	{
+		for(int childY = y * 2; childY < std::min(y * 2 + 2, childLevel.height); ++childY)
+		{
+			for(int childX = x * 2; childX < std::min(x * 2 + 2, childLevel.width); ++childX)
+			{
+				float childExit;
+				if(IntersectCell(level - 1, childX, childY, childZ, origin, direction, children[childCount].enter, childExit))
+				{
+					children[childCount].x = childX;
+					children[childCount].y = childY;
+					children[childCount].z = childZ;
+					++childCount;
+				}
+			}
+		}
+	}
+
+	std::sort(children, children + childCount, [](const Child& a, const Child& b) { return a.enter < b.enter; });
+	for(int child = 0; child < childCount; ++child)
+		Traverse(level - 1, children[child].x, children[child].y, children[child].z, origin, direction, minValue, maxValue, segments);
+}
+
+/**
+ * \brief Intersect a ray with the box a cell covers, clipped to distances of at least 0.
+ * \return False if the ray misses the cell.
+ */
+bool GFW::VolumeOccupancyGrid::IntersectCell(int level, int x, int y, int z, const Math::Vec3& origin, const Math::Vec3& direction, float& enter, float& exit) const
+{
+	const int cellTexels = m_cellSize << level;
+	const int cell[3] = { x, y, z };
+	const int size[3] = { m_width, m_height, m_depth };
+	enter = 0.0f;
+	exit = std::numeric_limits<float>::max();
+	for(int axis = 0; axis < 3; ++axis)
+	{
+		const float lower = float(cell[axis] * cellTexels) / size[axis];
+		const float upper = float(std::min((cell[axis] + 1) * cellTexels, size[axis])) / size[axis];
+		if(direction[axis] == 0.0f)
+		{
+			if(origin[axis] < lower || origin[axis] > upper)
+				return false;
+			continue;
+		}
+
+		const float inverse = 1.0f / direction[axis];
+		float nearDistance = (lower - origin[axis]) * inverse;
+		float farDistance = (upper - origin[axis]) * inverse;
+		if(nearDistance > farDistance)
+			std::swap(nearDistance, farDistance);
+		enter = std::max(enter, nearDistance);
+		exit = std::min(exit, farDistance);
+	}
+	return enter <= exit;
+}